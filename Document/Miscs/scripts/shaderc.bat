@@ -21,5 +21,9 @@ set root=..
 
 glslc -fshader-stage=vert %root%/shaders/glsl/simple_vertex.glsl -o %root%/shaders/spir-v/simple_vertex.spv
 glslc -fshader-stage=frag %root%/shaders/glsl/simple_fragment.glsl -o %root%/shaders/spir-v/simple_fragment.spv
+glslc -fshader-stage=comp %root%/shaders/glsl/gpu_cull_compute.glsl -o %root%/shaders/spir-v/gpu_cull_compute.spv
+glslc -fshader-stage=comp %root%/shaders/glsl/gpu_cluster_cull_compute.glsl -o %root%/shaders/spir-v/gpu_cluster_cull_compute.spv
+glslc -fshader-stage=vert %root%/shaders/glsl/gpu_driven_vertex.glsl -o %root%/shaders/spir-v/gpu_driven_vertex.spv
+glslc -fshader-stage=vert %root%/shaders/glsl/instanced_vertex.glsl -o %root%/shaders/spir-v/instanced_vertex.spv
 
 robocopy %root%/shaders/spir-v %root%/cmake-build-debug/shaders/spir-v /e /r:0 /w:0 >nul
\ No newline at end of file
@@ -0,0 +1,96 @@
+#version 450
+
+layout(local_size_x = 64) in;
+
+struct Object {
+    mat4 transform;
+    vec4 boundingSphere;
+    uint mesh;
+    uint bucket;
+    uint padding[2];
+};
+
+struct Mesh {
+    uint indexCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint meshletOffset;
+    uint meshletCount;
+    uint lodOffset;
+    uint lodCount;
+    uint padding;
+};
+
+struct Meshlet {
+    vec4 boundingSphere;
+    vec4 cone;
+    uint firstIndex;
+    uint indexCount;
+    uint padding[2];
+};
+
+struct DrawIndexedIndirectCommand {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Objects { Object objects[]; };
+layout(std430, set = 0, binding = 1) readonly buffer Meshes { Mesh meshes[]; };
+layout(std430, set = 0, binding = 2) readonly buffer Buckets { uint firstCommands[]; };
+layout(std430, set = 0, binding = 3) writeonly buffer Commands { DrawIndexedIndirectCommand commands[]; };
+layout(std430, set = 0, binding = 4) buffer Counts { uint counts[]; };
+layout(std430, set = 0, binding = 5) readonly buffer Meshlets { Meshlet meshlets[]; };
+layout(std430, set = 0, binding = 6) readonly buffer Clusters { uvec2 clusters[]; };
+layout(std430, set = 0, binding = 8) buffer LodStats { uint lodStats[]; };
+
+layout(push_constant) uniform PushConst {
+    vec4 frustumPlanes[6];
+    vec4 cameraPosition; /* w = lodScale */
+    uint objectCount;
+    uint clusterCount;
+    uint frameSlot;
+    float lodThreshold;
+} upc;
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= upc.clusterCount)
+        return;
+
+    uvec2 cluster = clusters[index];
+    Object object = objects[cluster.x];
+    if (object.bucket == 0xFFFFFFFFu)
+        return;
+
+    Meshlet meshlet = meshlets[cluster.y];
+    vec3 center = (object.transform * vec4(meshlet.boundingSphere.xyz, 1.0f)).xyz;
+    float scale = max(length(object.transform[0].xyz), max(length(object.transform[1].xyz), length(object.transform[2].xyz)));
+    float radius = meshlet.boundingSphere.w * scale;
+
+    for (int i = 0; i < 6; i++) {
+        if (dot(upc.frustumPlanes[i].xyz, center) + upc.frustumPlanes[i].w < -radius)
+            return;
+    }
+
+    /* every triangle faces away when the camera sits inside the back of the normal cone */
+    vec3 axis = normalize(mat3(object.transform) * meshlet.cone.xyz);
+    vec3 direction = center - upc.cameraPosition.xyz;
+    if (dot(direction, axis) >= meshlet.cone.w * length(direction) + radius)
+        return;
+
+    atomicAdd(lodStats[2u * upc.frameSlot + 0u], meshlet.indexCount / 3u);
+    atomicAdd(lodStats[2u * upc.frameSlot + 1u], meshlet.indexCount / 3u);
+
+    Mesh mesh = meshes[object.mesh];
+    uint slot = firstCommands[object.bucket] + atomicAdd(counts[object.bucket], 1u);
+
+    commands[slot].indexCount = meshlet.indexCount;
+    commands[slot].instanceCount = 1u;
+    commands[slot].firstIndex = meshlet.firstIndex;
+    commands[slot].vertexOffset = mesh.vertexOffset;
+    commands[slot].firstInstance = cluster.x;
+}
\ No newline at end of file
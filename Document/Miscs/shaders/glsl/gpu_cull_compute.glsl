@@ -0,0 +1,119 @@
+#version 450
+
+layout(local_size_x = 64) in;
+
+struct Object {
+    mat4 transform;
+    vec4 boundingSphere;
+    uint mesh;
+    uint bucket;
+    uint padding[2];
+};
+
+struct Mesh {
+    uint indexCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint meshletOffset;
+    uint meshletCount;
+    uint lodOffset;
+    uint lodCount;
+    uint padding;
+};
+
+struct MeshLod {
+    uint firstIndex;
+    uint indexCount;
+    float error;
+    uint padding;
+};
+
+struct DrawIndexedIndirectCommand {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Objects { Object objects[]; };
+layout(std430, set = 0, binding = 1) readonly buffer Meshes { Mesh meshes[]; };
+layout(std430, set = 0, binding = 2) readonly buffer Buckets { uint firstCommands[]; };
+layout(std430, set = 0, binding = 3) writeonly buffer Commands { DrawIndexedIndirectCommand commands[]; };
+layout(std430, set = 0, binding = 4) buffer Counts { uint counts[]; };
+layout(std430, set = 0, binding = 7) readonly buffer Lods { MeshLod lods[]; };
+layout(std430, set = 0, binding = 8) buffer LodStats { uint lodStats[]; };
+/* current LOD per object, shared by every frame slot */
+layout(std430, set = 0, binding = 9) buffer ObjectLods { uint objectLods[]; };
+
+/* GPU_SCENE_LOD_HYSTERESIS */
+const float LOD_HYSTERESIS = 0.75f;
+
+layout(push_constant) uniform PushConst {
+    vec4 frustumPlanes[6];
+    vec4 cameraPosition; /* w = lodScale */
+    uint objectCount;
+    uint clusterCount;
+    uint frameSlot;
+    float lodThreshold;
+} upc;
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= upc.objectCount)
+        return;
+
+    Object object = objects[index];
+    if (object.bucket == 0xFFFFFFFFu)
+        return;
+
+    /* clustered meshes are emitted per meshlet by gpu_cluster_cull_compute.glsl */
+    Mesh mesh = meshes[object.mesh];
+    if (mesh.meshletCount > 0u)
+        return;
+
+    vec3 center = (object.transform * vec4(object.boundingSphere.xyz, 1.0f)).xyz;
+    float scale = max(length(object.transform[0].xyz), max(length(object.transform[1].xyz), length(object.transform[2].xyz)));
+    float radius = object.boundingSphere.w * scale;
+
+    for (int i = 0; i < 6; i++) {
+        if (dot(upc.frustumPlanes[i].xyz, center) + upc.frustumPlanes[i].w < -radius)
+            return;
+    }
+
+    uint indexCount = mesh.indexCount;
+    uint firstIndex = mesh.firstIndex;
+
+    /* coarsest LOD under the threshold, the current one is kept inside the hysteresis band */
+    if (mesh.lodCount > 0u) {
+        uint lod = 0u;
+        float distance = length(center - upc.cameraPosition.xyz) - radius;
+
+        if (mesh.lodCount > 1u && distance > 0.0f) {
+            float pixelsPerUnit = scale * upc.cameraPosition.w / distance;
+            lod = min(objectLods[index], mesh.lodCount - 1u);
+
+            while (lod + 1u < mesh.lodCount && lods[mesh.lodOffset + lod + 1u].error * pixelsPerUnit <= upc.lodThreshold * LOD_HYSTERESIS)
+                lod++;
+            while (lod > 0u && lods[mesh.lodOffset + lod].error * pixelsPerUnit > upc.lodThreshold)
+                lod--;
+        }
+
+        objectLods[index] = lod;
+        indexCount = lods[mesh.lodOffset + lod].indexCount;
+        firstIndex = lods[mesh.lodOffset + lod].firstIndex;
+    }
+
+    /* full detail and drawn triangles of this frame slot */
+    atomicAdd(lodStats[2u * upc.frameSlot + 0u], mesh.indexCount / 3u);
+    atomicAdd(lodStats[2u * upc.frameSlot + 1u], indexCount / 3u);
+
+    uint slot = firstCommands[object.bucket] + atomicAdd(counts[object.bucket], 1u);
+
+    commands[slot].indexCount = indexCount;
+    commands[slot].instanceCount = 1u;
+    commands[slot].firstIndex = firstIndex;
+    commands[slot].vertexOffset = mesh.vertexOffset;
+    commands[slot].firstInstance = index;
+}
\ No newline at end of file
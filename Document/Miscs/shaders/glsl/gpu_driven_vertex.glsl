@@ -0,0 +1,36 @@
+#version 450
+
+/* locations 0..2 and DecodePosition/TexCoord/Normal() of the cooked vertex format, set 1 binding 0
+   holds the VertexDecodeParams of the mesh */
+#include "vertex_decode.glsl"
+
+layout(location = 0) out vec3 fragPos;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out vec3 fragNormal;
+
+struct Object {
+    mat4 transform;
+    vec4 boundingSphere;
+    uint mesh;
+    uint bucket;
+    uint padding[2];
+};
+
+/* firstInstance of the indirect command is the object index */
+layout(std430, set = 0, binding = 0) readonly buffer Objects { Object objects[]; };
+
+layout(push_constant) uniform PushConst {
+    mat4 viewProjection;
+} upc;
+
+void main()
+{
+    mat4 model = objects[gl_InstanceIndex].transform;
+    vec4 worldPos = model * vec4(DecodePosition(), 1.0f);
+
+    gl_Position = upc.viewProjection * worldPos;
+
+    fragPos = worldPos.xyz;
+    fragTexCoord = DecodeTexCoord();
+    fragNormal = mat3(model) * DecodeNormal();
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#version 450
+
+/* locations 0..2 and DecodePosition/TexCoord/Normal() of the cooked vertex format, set 1 binding 0
+   holds the VertexDecodeParams of the mesh */
+#include "vertex_decode.glsl"
+
+/* binding 1, VK_VERTEX_INPUT_RATE_INSTANCE, one InstanceData per draw packet. Only bound for
+   pipelines created with GraphicsPipelineDesc::instanceStride */
+layout(location = 3) in mat4 inTransform;
+layout(location = 7) in uint inMaterialIndex;
+
+layout(location = 0) out vec3 fragPos;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out vec3 fragNormal;
+layout(location = 3) flat out uint fragMaterialIndex;
+
+layout(push_constant) uniform PushConst {
+    mat4 viewProjection;
+} upc;
+
+void main()
+{
+    vec4 worldPos = inTransform * vec4(DecodePosition(), 1.0f);
+
+    gl_Position = upc.viewProjection * worldPos;
+
+    fragPos = worldPos.xyz;
+    fragTexCoord = DecodeTexCoord();
+    fragNormal = mat3(inTransform) * DecodeNormal();
+    fragMaterialIndex = inMaterialIndex;
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 450
+
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 2) in vec3 inNormal;
+
+layout(location = 0) out vec4 fragColor;
+
+/* untextured, for meshes drawn without a material set */
+void main()
+{
+    fragColor = vec4(normalize(inNormal) * 0.5f + 0.5f, 1.0f);
+}
\ No newline at end of file
@@ -27,6 +27,17 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
+
+/* averages over a sliding window of recent frames, all times in milliseconds */
+typedef struct GoghFrameStats {
+    double cpuFrameTime;           /* CPU time per frame, excluding the wait on the GPU */
+    double gpuFrameTime;           /* GPU time between the first and last command of the frame */
+    double waitOnGpuTime;          /* CPU blocked on the fence of frame N-K */
+    double presentInterval;        /* time between two presents */
+    double low1PercentFrameTime;   /* mean present interval of the slowest 1% frames */
+    double low01PercentFrameTime;  /* mean present interval of the slowest 0.1% frames */
+    uint64_t frameCount;
+} GoghFrameStats;
     
 GOGH_API void Gogh_Engine_Init(uint32_t w, uint32_t h, const char *title);
 GOGH_API void Gogh_Engine_Terminate();
@@ -37,6 +48,58 @@ GOGH_API void Gogh_Engine_PollEvents();
 GOGH_API void Gogh_Engine_BeginNewFrame();
 GOGH_API void Gogh_Engine_EndNewFrame();
 
+GOGH_API void Gogh_Engine_GetFrameStats(GoghFrameStats* pStats);
+
+/* render data of the frame being built, call between Begin/EndNewFrame or from the simulate callback */
+GOGH_API void Gogh_Engine_SetCamera(const float view[16], const float projection[16]);
+/* one draw of layer 0 through Gogh_Engine_SubmitDraws() on thread index 0 */
+GOGH_API void Gogh_Engine_PushRenderObject(const float transform[16], uint32_t mesh, uint32_t material);
+
+/* uploads a mesh written by the cooker, returns its handle or UINT32_MAX, not while draws are submitted */
+GOGH_API uint32_t Gogh_Engine_LoadMesh(const char* path);
+
+typedef struct GoghDraw {
+    float transform[16];    /* column major object to world */
+    uint32_t mesh;          /* from Gogh_Engine_LoadMesh() */
+    uint32_t material;      /* instance material index handed to the shaders */
+    uint32_t layer;         /* 0..15, lower layers are drawn first */
+} GoghDraw;
+
+/*
+ * Emits draw packets into the render queue of the frame being built, same rules as
+ * Gogh_Engine_SetCamera() which has to come first, the packets are sorted front to back
+ * with it. Threads emitting at the same time pass different threadIndex values (0..15),
+ * equal draws of one mesh are merged into an instanced draw whatever thread sent them.
+ */
+GOGH_API void Gogh_Engine_SubmitDraws(uint32_t threadIndex, uint32_t drawCount, const GoghDraw* pDraws);
+
+/*
+ * Persistent objects of the GPU driven scene, culled and LOD selected on the GPU and
+ * drawn with indirect commands, for large counts of objects that outlive a frame. They
+ * are drawn every frame until removed. Not from the simulate callback of
+ * Gogh_Engine_RunDecoupled(), the render thread reads the scene meanwhile.
+ */
+GOGH_API uint32_t Gogh_Engine_AddSceneObject(const float transform[16], uint32_t mesh); /* UINT32_MAX when full */
+GOGH_API void Gogh_Engine_UpdateSceneObject(uint32_t object, const float transform[16]);
+GOGH_API void Gogh_Engine_RemoveSceneObject(uint32_t object);
+
+/*
+ * Runs until the window closes. The simulate callback runs on the calling (main) thread
+ * at a fixed timestep, while a dedicated render thread draws the last published frame.
+ * Begin/EndNewFrame must not be used in this mode.
+ */
+typedef void (*PFN_GoghSimulate)(double fixedDeltaTime, void* pUserData);
+GOGH_API void Gogh_Engine_RunDecoupled(double fixedDeltaTime, PFN_GoghSimulate pfnSimulate, void* pUserData);
+
+/*
+ * Cooks every mesh, texture and shader under sourceDirectory into the same tree under
+ * outputDirectory. Results are kept in cacheDirectory keyed by source content, cooker
+ * version and settings, unchanged assets are skipped. Does not need Gogh_Engine_Init(),
+ * workerCount 0 uses one worker per hardware thread.
+ */
+GOGH_API GOGH_BOOL Gogh_Cooker_CookDirectory(const char* sourceDirectory, const char* outputDirectory,
+                                             const char* cacheDirectory, uint32_t workerCount);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
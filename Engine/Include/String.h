@@ -27,4 +27,10 @@
 class String : public std::string {
 public:
     using std::string::string;
-};
\ No newline at end of file
+
+    String(const std::string& str) : std::string(str) {}
+    String(std::string&& str) : std::string(std::move(str)) {}
+};
+
+template<>
+struct std::hash<String> : std::hash<std::string> {};
\ No newline at end of file
@@ -0,0 +1,33 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include <Engine/Engine.h>
+
+#include "Cooker/AssetCooker.h"
+
+GOGH_API GOGH_BOOL Gogh_Cooker_CookDirectory(const char* sourceDirectory, const char* outputDirectory,
+                                             const char* cacheDirectory, uint32_t workerCount)
+{
+    JobSystem jobSystem(workerCount);
+    AssetCooker cooker(cacheDirectory, &jobSystem);
+    
+    return cooker.CookDirectory(sourceDirectory, outputDirectory, nullptr) ? GOGH_TRUE : GOGH_FALSE;
+}
@@ -22,26 +22,86 @@
 
 #include "Window/Window.h"
 #include "Driver/RenderDevice.h"
+#include "Render/Renderer.h"
+#include "Render/RenderThread.h"
+#include "Streaming/StreamingManager.h"
+#include "Shader/ShaderLibrary.h"
+#include "Mesh/CookedMesh.h"
 
 // std
 #include <memory>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 // include
 #include <Error.h>
 #include <Logger.h>
 
+// glm
+#include <glm/gtc/type_ptr.hpp>
+
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "NullDereference"
 
+struct EngineMesh
+{
+    Buffer* vertexBuffer = nullptr;
+    Buffer* indexBuffer = nullptr;
+    /* LOD 0, coarser LODs follow it in the index buffer */
+    uint32_t indexCount = 0;
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+    /* VertexDecodeParams of the vertex buffer, bound at VERTEX_DECODE_SET */
+    Buffer* decodeBuffer = nullptr;
+    VkDescriptorSet geometry = VK_NULL_HANDLE;
+    glm::vec4 boundingSphere = glm::vec4(0.0f);
+    /* GPU scene mesh, and its bucket once an object of the mesh was added */
+    uint32_t sceneMesh = UINT32_MAX;
+    uint32_t sceneBucket = UINT32_MAX;
+};
+
 struct EngineContext
 {
     std::unique_ptr<Window> window;
     std::unique_ptr<RenderDevice> renderDevice;
+    std::unique_ptr<Renderer> renderer;
+    std::unique_ptr<JobSystem> jobSystem;
+    std::unique_ptr<StreamingManager> streaming;
+    std::unique_ptr<ShaderLibrary> shaders;
+    bool frameBegun = false;
+    
+    TripleBuffer<RenderSnapshot> snapshots;
+    uint64_t simulationFrame = 0;
+
+    Vector<EngineMesh> meshes;
+    VkDescriptorSetLayout geometryLayout = VK_NULL_HANDLE;
+
+    /* aliased sort key fields are reported once, they cost batching but draw correctly */
+    std::atomic<bool> sortKeyOverflowReported = false;
 };
 
+/* fixed steps per main loop iteration before simulation time is dropped */
+#define ENGINE_MAX_SIMULATION_STEPS 8
+
+/* compiled SPIR-V of the shader library, relative to the working directory */
+#define ENGINE_SHADER_CACHE_DIRECTORY "cache/shaders"
+
 static EngineContext* engine = nullptr;
 static RenderDevice* RD = nullptr;
 
+/* set VERTEX_DECODE_SET of the mesh shaders, as reflected from the generated decode block */
+static const VkDescriptorSetLayoutBinding ENGINE_GEOMETRY_BINDING = {
+    VERTEX_DECODE_BINDING, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, VK_NULL_HANDLE
+};
+
+static void _BeginSnapshot()
+{
+    RenderSnapshot& snapshot = engine->snapshots.GetWriteBuffer();
+    snapshot.simulationFrame = ++engine->simulationFrame;
+    snapshot.queue.Reset();
+}
+
 GOGH_API void Gogh_Engine_Init(uint32_t w, uint32_t h, const char *title)
 {
     if (engine)
@@ -51,8 +111,14 @@ GOGH_API void Gogh_Engine_Init(uint32_t w, uint32_t h, const char *title)
     
     engine->window = std::make_unique<Window>(w, h, title);
     engine->renderDevice = std::make_unique<RenderDevice>(engine->window.get());
+    engine->renderer = std::make_unique<Renderer>(engine->renderDevice.get());
+    engine->jobSystem = std::make_unique<JobSystem>();
+    engine->streaming = std::make_unique<StreamingManager>(engine->jobSystem.get());
+    engine->shaders = std::make_unique<ShaderLibrary>(engine->renderDevice.get(), engine->jobSystem.get(), ENGINE_SHADER_CACHE_DIRECTORY);
+    engine->renderer->SetShaderLibrary(engine->shaders.get());
 
     RD = engine->renderDevice.get();
+    engine->geometryLayout = RD->GetLayoutCache()->AcquireSetLayout(1, &ENGINE_GEOMETRY_BINDING);
     
     GOGH_LOGGER_DEBUG("[Engine] Initialize successful, engine has start");
 }
@@ -66,6 +132,19 @@ GOGH_API void Gogh_Engine_Terminate()
         return;        
     }
 
+    /* mesh buffers may still be read by frames in flight */
+    vkDeviceWaitIdle(RD->GetDevice());
+    
+    for (const EngineMesh& mesh : engine->meshes) {
+        RD->DestroyBuffer(mesh.vertexBuffer);
+        RD->DestroyBuffer(mesh.indexBuffer);
+        RD->DestroyBuffer(mesh.decodeBuffer);
+        RD->FreeDescriptorSet(mesh.geometry);
+    }
+
+    if (engine->geometryLayout)
+        RD->GetLayoutCache()->ReleaseSetLayout(engine->geometryLayout);
+    
     delete engine;
     engine = nullptr;
     GOGH_LOGGER_DEBUG("[Engine] Engine termination successful");
@@ -83,12 +162,252 @@ GOGH_API void Gogh_Engine_PollEvents()
 
 GOGH_API void Gogh_Engine_BeginNewFrame()
 {
-    
+    RD->GetResidencyManager()->Update();
+    engine->streaming->Update();
+    /* streamed uploads land on the queue ahead of this frame */
+    RD->GetUploadBatcher()->Submit();
+    engine->frameBegun = engine->renderer->BeginFrame();
+    _BeginSnapshot();
 }
 
 GOGH_API void Gogh_Engine_EndNewFrame()
 {
+    engine->snapshots.GetWriteBuffer().queue.Sort();
+    engine->snapshots.Publish();
+    engine->snapshots.Acquire();
+    
+    if (engine->frameBegun) {
+        engine->renderer->SetSnapshot(&engine->snapshots.GetReadBuffer());
+        engine->renderer->EndFrame();
+    }
+    engine->frameBegun = false;
+    
+    RD->GetDefragmenter()->Step();
+}
+
+GOGH_API void Gogh_Engine_GetFrameStats(GoghFrameStats* pStats)
+{
+    engine->renderer->GetFrameStats(pStats);
+}
+
+GOGH_API void Gogh_Engine_SetCamera(const float view[16], const float projection[16])
+{
+    RenderSnapshot& snapshot = engine->snapshots.GetWriteBuffer();
+    snapshot.view = glm::make_mat4(view);
+    snapshot.projection = glm::make_mat4(projection);
+}
+
+GOGH_API void Gogh_Engine_PushRenderObject(const float transform[16], uint32_t mesh, uint32_t material)
+{
+    GoghDraw draw = {};
+    std::copy_n(transform, 16, draw.transform);
+    draw.mesh = mesh;
+    draw.material = material;
+    
+    Gogh_Engine_SubmitDraws(0, 1, &draw);
+}
+
+GOGH_API uint32_t Gogh_Engine_LoadMesh(const char* path)
+{
+    CookedMesh cooked(path);
+    EngineMesh mesh;
+    VertexFormat format = {};
+    
+    if (!cooked.IsValid()) {
+        GOGH_LOGGER_ERROR("[Engine] Failed to load mesh, (path=%s)", path);
+        return UINT32_MAX;
+    }
+
+    /* the mesh pipelines are built for the default format */
+    VertexFormat cookedFormat = cooked.GetVertexFormat();
+    if (cookedFormat.position != format.position || cookedFormat.normal != format.normal || cookedFormat.texcoord != format.texcoord) {
+        GOGH_LOGGER_ERROR("[Engine] Mesh was cooked with a vertex format the mesh pipelines do not read, (path=%s)", path);
+        return UINT32_MAX;
+    }
+
+    if (!engine->geometryLayout || !cooked.Upload(RD, 0, &mesh.vertexBuffer, &mesh.indexBuffer)) {
+        GOGH_LOGGER_ERROR("[Engine] Failed to load mesh, (path=%s)", path);
+        return UINT32_MAX;
+    }
+
+    mesh.decodeBuffer = RD->CreateBuffer(sizeof(VertexDecodeParams), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+    mesh.geometry = RD->AllocateDescriptorSet(engine->geometryLayout);
+    
+    if (!mesh.decodeBuffer || !mesh.geometry) {
+        GOGH_LOGGER_ERROR("[Engine] Failed to create mesh decode parameters, (path=%s)", path);
+        
+        RD->DestroyBuffer(mesh.vertexBuffer);
+        RD->DestroyBuffer(mesh.indexBuffer);
+        if (mesh.decodeBuffer)
+            RD->DestroyBuffer(mesh.decodeBuffer);
+        if (mesh.geometry)
+            RD->FreeDescriptorSet(mesh.geometry);
+        
+        return UINT32_MAX;
+    }
+
+    /* mesh.geometry keeps the VkBuffer for the lifetime of the mesh, defragmentation must not move it */
+    mesh.decodeBuffer->SetResidencyPriority(RESIDENCY_PRIORITY_CRITICAL);
+    mesh.decodeBuffer->Write(0, sizeof(VertexDecodeParams), &cooked.GetDecodeParams());
+
+    VkDescriptorBufferInfo descriptorBufferInfo = {
+        .buffer = mesh.decodeBuffer->GetVkBuffer(),
+        .offset = 0,
+        .range = VK_WHOLE_SIZE,
+    };
+
+    VkWriteDescriptorSet writeDescriptorSet = {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = mesh.geometry,
+        .dstBinding = VERTEX_DECODE_BINDING,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        .pBufferInfo = &descriptorBufferInfo,
+    };
+
+    vkUpdateDescriptorSets(RD->GetDevice(), 1, &writeDescriptorSet, 0, VK_NULL_HANDLE);
+    mesh.indexType = cooked.GetIndexType();
+
+    mesh.indexCount = cooked.GetLodCount() > 0 ? cooked.GetLods()[0].indexCount : cooked.GetIndexCount();
+    mesh.boundingSphere = cooked.GetHeader().boundingSphere;
+
+    Vector<MeshLod> lods(cooked.GetLods(), cooked.GetLods() + cooked.GetLodCount());
+    mesh.sceneMesh = engine->renderer->GetGPUScene()->AddMesh(mesh.indexCount, 0, 0, VK_NULL_HANDLE, &lods);
+    
+    engine->meshes.push_back(mesh);
+    
+    return (uint32_t) std::size(engine->meshes) - 1;
+}
+
+GOGH_API void Gogh_Engine_SubmitDraws(uint32_t threadIndex, uint32_t drawCount, const GoghDraw* pDraws)
+{
+    RenderSnapshot& snapshot = engine->snapshots.GetWriteBuffer();
+    Pipeline* pipeline = engine->renderer->GetQueuePipeline();
+    uint32_t pipelineId = pipeline ? pipeline->GetSortId() : 0;
+    glm::mat4 viewProjection = snapshot.projection * snapshot.view;
+
+    if (threadIndex >= snapshot.queue.GetBucketCount()) {
+        GOGH_LOGGER_ERROR("[Engine] Draw thread index out of range, (threadIndex=%u, buckets=%u)", threadIndex, snapshot.queue.GetBucketCount());
+        return;
+    }
+
+    CommandBucket* bucket = snapshot.queue.GetBucket(threadIndex);
+    
+    for (uint32_t i = 0; i < drawCount; i++) {
+        const GoghDraw& draw = pDraws[i];
+        
+        if (draw.mesh >= std::size(engine->meshes)) {
+            GOGH_LOGGER_WARN("[Engine] Draw of an unknown mesh dropped, (mesh=%u)", draw.mesh);
+            continue;
+        }
+
+        /* the layer orders draws, an aliased one would draw in the wrong place */
+        if (!SortKey::Fits(draw.layer, SortKey::LAYER_BITS)) {
+            GOGH_LOGGER_WARN("[Engine] Draw with a layer out of range dropped, (layer=%u)", draw.layer);
+            continue;
+        }
+
+        if ((!SortKey::Fits(pipelineId, SortKey::PIPELINE_BITS) || !SortKey::Fits(draw.material, SortKey::MATERIAL_BITS) ||
+             !SortKey::Fits(draw.mesh, SortKey::MESH_BITS)) && !engine->sortKeyOverflowReported.exchange(true)) {
+            GOGH_LOGGER_WARN("[Engine] Draw sort key fields overflow, unrelated state interleaves and fewer draws are instanced, "
+                             "(pipeline=%u, material=%u, mesh=%u)", pipelineId, draw.material, draw.mesh);
+        }
+
+        const EngineMesh& mesh = engine->meshes[draw.mesh];
+        
+        DrawPacket packet;
+        packet.transform = glm::make_mat4(draw.transform);
+        packet.pipeline = pipeline;
+        packet.geometry = mesh.geometry;
+        packet.vertexBuffer = mesh.vertexBuffer;
+        packet.indexBuffer = mesh.indexBuffer;
+        packet.indexType = mesh.indexType;
+        packet.indexCount = mesh.indexCount;
+        packet.materialIndex = draw.material;
+
+        /* [0, 1] clip depth of the object origin, behind the camera sorts first */
+        glm::vec4 clip = viewProjection * packet.transform[3];
+        float depth = clip.w > 0.0f ? clip.z / clip.w : 0.0f;
+        
+        packet.key = SortKey::Make(draw.layer, 0, pipelineId, draw.material, draw.mesh, SortKey::QuantizeDepth(depth, 0.0f, 1.0f));
+        bucket->Submit(packet);
+    }
+}
+
+GOGH_API uint32_t Gogh_Engine_AddSceneObject(const float transform[16], uint32_t mesh)
+{
+    GPUScene* gpuScene = engine->renderer->GetGPUScene();
+    
+    if (mesh >= std::size(engine->meshes) || engine->meshes[mesh].sceneMesh == UINT32_MAX) {
+        GOGH_LOGGER_ERROR("[Engine] Scene object of an unknown mesh, (mesh=%u)", mesh);
+        return UINT32_MAX;
+    }
+
+    /* one bucket per mesh, every mesh has its own vertex and index buffer */
+    EngineMesh& engineMesh = engine->meshes[mesh];
+    if (engineMesh.sceneBucket == UINT32_MAX)
+        engineMesh.sceneBucket = gpuScene->AddBucket(engineMesh.vertexBuffer, engineMesh.indexBuffer, engineMesh.indexType, engineMesh.geometry);
+
+    if (engineMesh.sceneBucket == UINT32_MAX)
+        return UINT32_MAX;
+    
+    return gpuScene->AddObject(glm::make_mat4(transform), engineMesh.boundingSphere, engineMesh.sceneMesh, engineMesh.sceneBucket);
+}
+
+GOGH_API void Gogh_Engine_UpdateSceneObject(uint32_t object, const float transform[16])
+{
+    engine->renderer->GetGPUScene()->UpdateObject(object, glm::make_mat4(transform));
+}
+
+GOGH_API void Gogh_Engine_RemoveSceneObject(uint32_t object)
+{
+    engine->renderer->GetGPUScene()->RemoveObject(object);
+}
+
+GOGH_API void Gogh_Engine_RunDecoupled(double fixedDeltaTime, PFN_GoghSimulate pfnSimulate, void* pUserData)
+{
+    using Clock = std::chrono::steady_clock;
+    
+    RenderThread renderThread(RD, engine->renderer.get(), &engine->snapshots);
+    renderThread.Start();
+
+    GOGH_LOGGER_DEBUG("[Engine] Run decoupled, fixed delta time %.4f", fixedDeltaTime);
     
+    double accumulator = 0.0;
+    double simulationTime = 0.0;
+    Clock::time_point previous = Clock::now();
+    
+    while (!engine->window->IsShouldClose()) {
+        engine->window->PollEvents();
+        engine->streaming->Update();
+
+        Clock::time_point now = Clock::now();
+        accumulator += std::chrono::duration<double>(now - previous).count();
+        previous = now;
+
+        uint32_t steps = 0;
+        while (accumulator >= fixedDeltaTime && steps < ENGINE_MAX_SIMULATION_STEPS) {
+            _BeginSnapshot();
+            pfnSimulate(fixedDeltaTime, pUserData);
+
+            simulationTime += fixedDeltaTime;
+            engine->snapshots.GetWriteBuffer().simulationTime = simulationTime;
+            engine->snapshots.GetWriteBuffer().queue.Sort();
+            engine->snapshots.Publish();
+            
+            accumulator -= fixedDeltaTime;
+            ++steps;
+        }
+
+        /* spiral of death, the simulation can not keep up so drop the backlog */
+        if (steps == ENGINE_MAX_SIMULATION_STEPS)
+            accumulator = 0.0;
+
+        if (steps == 0)
+            std::this_thread::sleep_for(std::chrono::duration<double>(fixedDeltaTime - accumulator));
+    }
+
+    renderThread.Stop();
 }
 
 #pragma clang diagnostic pop
\ No newline at end of file
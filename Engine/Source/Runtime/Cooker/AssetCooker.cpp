@@ -0,0 +1,359 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "AssetCooker.h"
+#include "Core/Hash.h"
+#include "Core/MappedFile.h"
+#include "Mesh/CookedMesh.h"
+#include "Mesh/MeshOptimizer.h"
+#include "Mesh/ObjImporter.h"
+#include "Texture/KtxTexture.h"
+#include "Texture/TextureCooker.h"
+
+#include <Logger.h>
+
+// std
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <filesystem>
+#include <stdio.h>
+#include <string.h>
+
+static bool _EndsWith(const String& value, const char* suffix)
+{
+    size_t length = strlen(suffix);
+    return std::size(value) >= length && value.compare(std::size(value) - length, length, suffix) == 0;
+}
+
+static bool _IsShaderStage(const String& stem)
+{
+    return _EndsWith(stem, "_vertex") || _EndsWith(stem, "_fragment") || _EndsWith(stem, "_compute");
+}
+
+static String _GetSubdirectory(const char* cacheDirectory, const char* name)
+{
+    return (std::filesystem::path(cacheDirectory) / name).generic_string().c_str();
+}
+
+AssetCooker::AssetCooker(const char* cacheDirectory, JobSystem* pJobSystem, const AssetCookSettings& settings)
+    : cache(cacheDirectory), jobSystem(pJobSystem), settings(settings),
+      includeDirectory(_GetSubdirectory(cacheDirectory, "include")),
+      shaderCompiler(_GetSubdirectory(cacheDirectory, "shaders").c_str(), { settings.shaderCompiler, settings.shaderFlags, { includeDirectory } })
+{
+    
+    const VertexFormat& format = settings.meshVertexFormat;
+    uint32_t vertexFormat = (format.position << 8) | (format.normal << 4) | (format.texcoord << 1) | format.allowIndex16;
+
+    uint64_t mesh = HashCombine(ASSET_COOKER_MESH_VERSION, COOKED_MESH_VERSION);
+    mesh = HashCombine(mesh, settings.meshMaxLods);
+    mesh = HashCombine(mesh, std::bit_cast<uint32_t>(settings.meshLodReduction));
+    mesh = HashCombine(mesh, std::bit_cast<uint32_t>(settings.meshMaxError));
+    mesh = HashCombine(mesh, settings.meshMeshlets ? (MESHLET_MAX_VERTICES << 16) | MESHLET_MAX_TRIANGLES : 0);
+    mesh = HashCombine(mesh, MESH_OPTIMIZER_CACHE_SIZE);
+    mesh = HashCombine(mesh, vertexFormat);
+    
+    uint64_t texture = HashCombine(ASSET_COOKER_TEXTURE_VERSION, ((uint64_t) settings.textureMips << 1) | settings.textureHighQuality);
+    
+    /* compiler and flags are in the ShaderCompiler key, the generated decode include is part of the include closure */
+    uint64_t shader = HashCombine(ASSET_COOKER_SHADER_VERSION, ASSET_TYPE_SHADER);
+    
+    settingsHashes[ASSET_TYPE_MESH] = HashCombine(mesh, ASSET_TYPE_MESH);
+    settingsHashes[ASSET_TYPE_TEXTURE] = HashCombine(texture, ASSET_TYPE_TEXTURE);
+    settingsHashes[ASSET_TYPE_SHADER] = shader;
+}
+
+bool AssetCooker::GetAssetType(const char* path, AssetType* pType, String* pOutputExtension)
+{
+    std::filesystem::path file = path;
+    String extension = file.extension().string().c_str();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char) tolower(c); });
+
+    if (extension == ".obj") {
+        *pType = ASSET_TYPE_MESH;
+        *pOutputExtension = ".mesh";
+        return true;
+    }
+
+    if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp") {
+        *pType = ASSET_TYPE_TEXTURE;
+        *pOutputExtension = ".ktx2";
+        return true;
+    }
+
+    if (extension == ".hdr" || extension == ".ktx2") {
+        *pType = ASSET_TYPE_TEXTURE;
+        *pOutputExtension = extension;
+        return true;
+    }
+
+    if (extension == ".glsl" && _IsShaderStage(file.stem().string().c_str())) {
+        *pType = ASSET_TYPE_SHADER;
+        *pOutputExtension = ".spv";
+        return true;
+    }
+
+    return false;
+}
+
+bool AssetCooker::CookDirectory(const char* sourceDirectory, const char* outputDirectory, AssetCookStats* pStats)
+{
+    auto start = std::chrono::steady_clock::now();
+    Vector<std::pair<uintmax_t, CookItem>> items;
+    std::error_code error;
+    
+    if (!cache.IsValid() || !_WriteVertexDecode())
+        return false;
+
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(sourceDirectory, error)) {
+        CookItem item;
+        
+        if (!entry.is_regular_file())
+            continue;
+        
+        if (!GetAssetType(entry.path().string().c_str(), &item.type, &item.outputExtension))
+            continue;
+
+        std::filesystem::path output = outputDirectory / std::filesystem::relative(entry.path(), sourceDirectory);
+        output.replace_extension(item.outputExtension.c_str());
+        
+        item.sourcePath = entry.path().generic_string().c_str();
+        item.outputPath = output.generic_string().c_str();
+        items.emplace_back(entry.file_size(), std::move(item));
+    }
+
+    if (error) {
+        GOGH_LOGGER_ERROR("[Cooker] Failed to scan source directory, (directory=%s)", sourceDirectory);
+        return false;
+    }
+    
+    /* largest first, a big mesh queued last would run alone on one thread */
+    std::sort(items.begin(), items.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    
+    AtomicStats stats;
+    jobSystem->Dispatch((uint32_t) std::size(items), [&](uint32_t index) {
+        _CookItem(items[index].second, &stats);
+    });
+
+    cache.SaveStamps();
+    
+    AssetCookStats result;
+    result.upToDate = stats.upToDate;
+    result.cached = stats.cached;
+    result.cooked = stats.cooked;
+    result.failed = stats.failed;
+    result.hashed = stats.hashed;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    if (pStats)
+        *pStats = result;
+
+    GOGH_LOGGER_INFO("[Cooker] Cook %s finished, (assets=%zu, upToDate=%u, cached=%u, cooked=%u, failed=%u, hashed=%u, threads=%u, time=%.1f ms)",
+                     sourceDirectory, std::size(items), result.upToDate, result.cached, result.cooked, result.failed, result.hashed,
+                     jobSystem->GetThreadCount(), result.seconds * 1000.0);
+    
+    return result.failed == 0;
+}
+
+bool AssetCooker::_GetContentHash(const String& path, SourceStamp* pStamp, AtomicStats* pStats)
+{
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(path.c_str(), error);
+    int64_t time = std::filesystem::last_write_time(path.c_str(), error).time_since_epoch().count();
+
+    if (error) {
+        GOGH_LOGGER_ERROR("[Cooker] Failed to stat source, (path=%s)", path.c_str());
+        return false;
+    }
+    
+    if (cache.FindStamp(path, pStamp) && pStamp->size == size && pStamp->time == time)
+        return true;
+
+    MappedFile file(path.c_str());
+    if (!file.IsValid())
+        return false;
+
+    pStamp->size = size;
+    pStamp->time = time;
+    pStamp->contentHash = Hash64(file.GetData(), file.GetSize());
+    pStats->hashed++;
+    
+    return true;
+}
+
+bool AssetCooker::_WriteVertexDecode()
+{
+    String source = VertexFormatEncoder::GenerateShaderDecode(settings.meshVertexFormat, VERTEX_DECODE_SET, VERTEX_DECODE_BINDING);
+    std::filesystem::path path = std::filesystem::path(includeDirectory.c_str()) / VERTEX_DECODE_INCLUDE;
+    std::error_code error;
+
+    /* an unchanged file keeps its write time */
+    if (std::filesystem::file_size(path, error) == std::size(source) && !error) {
+        MappedFile current(path.string().c_str());
+        if (current.IsValid() && memcmp(current.GetData(), std::data(source), std::size(source)) == 0)
+            return true;
+    }
+    
+    std::filesystem::create_directories(includeDirectory.c_str(), error);
+    
+    FILE* fp = fopen(path.string().c_str(), "wb");
+    bool written = fp && fwrite(std::data(source), 1, std::size(source), fp) == std::size(source);
+    written = fp && fclose(fp) == 0 && written;
+    
+    if (!written) {
+        GOGH_LOGGER_ERROR("[Cooker] Failed to write vertex decode include, (path=%s)", path.string().c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool AssetCooker::_CookItem(const CookItem& item, AtomicStats* pStats)
+{
+    SourceStamp stamp;
+    std::error_code error;
+    const char* extension = item.outputExtension.c_str();
+    
+    if (!_GetContentHash(item.sourcePath, &stamp, pStats)) {
+        pStats->failed++;
+        return false;
+    }
+
+    uint64_t key = HashCombine(stamp.contentHash, settingsHashes[item.type]);
+
+    /* the source stamp alone misses edits to included files */
+    if (item.type == ASSET_TYPE_SHADER) {
+        uint64_t shaderKey;
+        
+        if (!shaderCompiler.GetKey(item.sourcePath.c_str(), {}, &shaderKey, nullptr)) {
+            pStats->failed++;
+            return false;
+        }
+
+        key = HashCombine(shaderKey, settingsHashes[item.type]);
+    }
+    
+    if (stamp.outputKey == key && std::filesystem::is_regular_file(item.outputPath.c_str(), error)) {
+        pStats->upToDate++;
+        cache.UpdateStamp(item.sourcePath, stamp);
+        return true;
+    }
+
+    if (cache.Contains(key, extension)) {
+        pStats->cached++;
+    } else {
+        String tempPath = cache.GetTempPath(key, extension);
+        bool cooked = false;
+        
+        switch (item.type) {
+            case ASSET_TYPE_MESH: cooked = _CookMesh(item.sourcePath.c_str(), tempPath.c_str()); break;
+            case ASSET_TYPE_TEXTURE: cooked = _CookTexture(item.sourcePath.c_str(), tempPath.c_str()); break;
+            case ASSET_TYPE_SHADER: cooked = _CookShader(item.sourcePath.c_str(), tempPath.c_str()); break;
+            default: break;
+        }
+
+        if (!cooked || !cache.Store(key, extension, tempPath.c_str())) {
+            std::filesystem::remove(tempPath.c_str(), error);
+            GOGH_LOGGER_ERROR("[Cooker] Failed to cook asset, (source=%s)", item.sourcePath.c_str());
+            pStats->failed++;
+            return false;
+        }
+
+        pStats->cooked++;
+    }
+
+    std::filesystem::path output = item.outputPath.c_str();
+    std::filesystem::create_directories(output.parent_path(), error);
+    std::filesystem::copy_file(cache.GetPath(key, extension).c_str(), output, std::filesystem::copy_options::overwrite_existing, error);
+    
+    if (error) {
+        GOGH_LOGGER_ERROR("[Cooker] Failed to write output, (path=%s)", item.outputPath.c_str());
+        pStats->failed++;
+        return false;
+    }
+
+    stamp.outputKey = key;
+    cache.UpdateStamp(item.sourcePath, stamp);
+    
+    GOGH_LOGGER_DEBUG("[Cooker] Cook asset successful, (source=%s, key=%016llx)", item.sourcePath.c_str(), (unsigned long long) key);
+    return true;
+}
+
+bool AssetCooker::_CookMesh(const char* sourcePath, const char* destinationPath)
+{
+    MeshData mesh;
+    MeshletData meshlets;
+    
+    if (!ObjImporter::Import(sourcePath, jobSystem, &mesh))
+        return false;
+
+    if (settings.meshMaxLods > 1)
+        MeshSimplifier::GenerateLods(&mesh, settings.meshMaxLods, settings.meshLodReduction, settings.meshMaxError);
+    
+    MeshOptimizer::Optimize(&mesh);
+
+    if (settings.meshMeshlets)
+        MeshletBuilder::Build(mesh, MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES, &meshlets);
+    
+    return CookedMesh::Write(destinationPath, mesh, settings.meshMeshlets ? &meshlets : nullptr, settings.meshVertexFormat);
+}
+
+bool AssetCooker::_CookTexture(const char* sourcePath, const char* destinationPath)
+{
+    String extension = std::filesystem::path(sourcePath).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char) tolower(c); });
+
+    /* float images have no block encoder yet and KTX2 is already cooked */
+    if (extension == ".hdr" || extension == ".ktx2") {
+        std::error_code error;
+        return std::filesystem::copy_file(sourcePath, destinationPath, std::filesystem::copy_options::overwrite_existing, error);
+    }
+
+    TextureImage image;
+    TextureData texture;
+    TextureCookSettings textureSettings;
+    
+    if (!TextureCooker::Import(sourcePath, &image))
+        return false;
+
+    textureSettings.role = TextureCooker::GetRoleFromPath(sourcePath);
+    textureSettings.generateMips = settings.textureMips;
+    textureSettings.highQuality = settings.textureHighQuality;
+    TextureCooker::Cook(image, textureSettings, jobSystem, &texture);
+    
+    return KtxTexture::Write(destinationPath, texture);
+}
+
+bool AssetCooker::_CookShader(const char* sourcePath, const char* destinationPath)
+{
+    Vector<uint32_t> code;
+    
+    if (!shaderCompiler.Compile(sourcePath, {}, &code, nullptr)) {
+        GOGH_LOGGER_ERROR("[Cooker] Shader compiler failed, (source=%s)", sourcePath);
+        return false;
+    }
+
+    FILE* fp = fopen(destinationPath, "wb");
+    bool written = fp && fwrite(std::data(code), sizeof(uint32_t), std::size(code), fp) == std::size(code);
+    written = fp && fclose(fp) == 0 && written;
+
+    return written;
+}
@@ -0,0 +1,132 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "DerivedDataCache.h"
+#include "Core/JobSystem.h"
+#include "Mesh/MeshSimplifier.h"
+#include "Mesh/VertexFormat.h"
+#include "Shader/ShaderCompiler.h"
+
+// std
+#include <atomic>
+
+/*
+ * Bump when a cooker changes its output for the same input, every cached entry of
+ * that type is then cooked again.
+ */
+#define ASSET_COOKER_MESH_VERSION 2
+#define ASSET_COOKER_TEXTURE_VERSION 3
+#define ASSET_COOKER_SHADER_VERSION 2
+
+enum AssetType
+{
+    ASSET_TYPE_MESH = 0,    /* .obj -> .mesh (CookedMesh) */
+    ASSET_TYPE_TEXTURE,     /* .png/.jpg/.tga/.bmp -> .ktx2 (KtxTexture), .hdr/.ktx2 copied as is */
+    ASSET_TYPE_SHADER,      /* *_vertex/_fragment/_compute.glsl -> .spv */
+    ASSET_TYPE_MAX_ENUM,
+};
+
+struct AssetCookSettings
+{
+    uint32_t meshMaxLods = MESH_SIMPLIFIER_MAX_LODS;
+    float meshLodReduction = MESH_SIMPLIFIER_LOD_REDUCTION;
+    float meshMaxError = MESH_SIMPLIFIER_MAX_ERROR;
+    bool meshMeshlets = true;
+    /* shaders see the matching decode functions through #include VERTEX_DECODE_INCLUDE */
+    VertexFormat meshVertexFormat;
+
+    bool textureMips = true;
+    bool textureHighQuality = false;
+    
+    String shaderCompiler = "glslc";
+    String shaderFlags = "-O";
+};
+
+struct AssetCookStats
+{
+    uint32_t upToDate = 0;  /* output already holds the entry of the current key */
+    uint32_t cached = 0;    /* entry found in the cache and copied to the output */
+    uint32_t cooked = 0;
+    uint32_t failed = 0;
+    uint32_t hashed = 0;    /* sources read because their stamp changed */
+    double seconds = 0.0;
+};
+
+/*
+ * Turns source assets into the cooked formats the runtime loads. Each output is keyed
+ * by a hash of the source content, the cooker version and the settings of its type and
+ * stored in a DerivedDataCache; assets whose key did not change are skipped without
+ * cooking or copying anything. Assets are cooked in parallel on the job system.
+ *
+ * The decode functions of the mesh vertex format are generated into an include
+ * directory next to the cache, shaders are compiled with it on the include path.
+ * Shaders go through the ShaderCompiler, their key covers the whole include closure
+ * so editing a shared header cooks every shader that includes it again.
+ */
+class AssetCooker
+{
+public:
+    AssetCooker(const char* cacheDirectory, JobSystem* pJobSystem, const AssetCookSettings& settings = {});
+   ~AssetCooker() = default;
+
+    /* cooks every known asset under sourceDirectory into the same tree under outputDirectory */
+    bool CookDirectory(const char* sourceDirectory, const char* outputDirectory, AssetCookStats* pStats);
+
+    /* type and cooked extension of a source file, false for files the cooker ignores */
+    static bool GetAssetType(const char* path, AssetType* pType, String* pOutputExtension);
+
+private:
+    struct CookItem
+    {
+        AssetType type;
+        String sourcePath;
+        String outputPath;
+        String outputExtension;
+    };
+
+    struct AtomicStats
+    {
+        std::atomic<uint32_t> upToDate = 0;
+        std::atomic<uint32_t> cached = 0;
+        std::atomic<uint32_t> cooked = 0;
+        std::atomic<uint32_t> failed = 0;
+        std::atomic<uint32_t> hashed = 0;
+    };
+
+    bool _CookItem(const CookItem& item, AtomicStats* pStats);
+    bool _GetContentHash(const String& path, SourceStamp* pStamp, AtomicStats* pStats);
+    /* rewrites VERTEX_DECODE_INCLUDE when the generated source changed */
+    bool _WriteVertexDecode();
+    
+    bool _CookMesh(const char* sourcePath, const char* destinationPath);
+    bool _CookTexture(const char* sourcePath, const char* destinationPath);
+    bool _CookShader(const char* sourcePath, const char* destinationPath);
+    
+private:
+    DerivedDataCache cache;
+    JobSystem* jobSystem = nullptr;
+    AssetCookSettings settings;
+    String includeDirectory;
+    ShaderCompiler shaderCompiler;
+    uint64_t settingsHashes[ASSET_TYPE_MAX_ENUM] = {};
+};
@@ -0,0 +1,158 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "DerivedDataCache.h"
+
+#include <Logger.h>
+
+// std
+#include <filesystem>
+#include <thread>
+#include <stdio.h>
+
+DerivedDataCache::DerivedDataCache(const char* directory) : directory(directory)
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    if (!std::filesystem::is_directory(directory)) {
+        GOGH_LOGGER_ERROR("[Cooker] Failed to create derived data cache, (directory=%s)", directory);
+        return;
+    }
+
+    valid = true;
+    _LoadStamps();
+
+    GOGH_LOGGER_DEBUG("[Cooker] Open derived data cache successful, (directory=%s, stamps=%zu)", directory, std::size(stamps));
+}
+
+String DerivedDataCache::GetPath(uint64_t key, const char* extension) const
+{
+    return String(std::format("{}/{:016x}{}", directory, key, extension));
+}
+
+String DerivedDataCache::GetTempPath(uint64_t key, const char* extension) const
+{
+    size_t thread = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    return String(std::format("{}/{:016x}{}.{:x}.tmp", directory, key, extension, thread));
+}
+
+bool DerivedDataCache::Contains(uint64_t key, const char* extension) const
+{
+    std::error_code error;
+    return std::filesystem::is_regular_file(GetPath(key, extension).c_str(), error);
+}
+
+bool DerivedDataCache::Store(uint64_t key, const char* extension, const char* path)
+{
+    std::error_code error;
+    String entry = GetPath(key, extension);
+    
+    std::filesystem::rename(path, entry.c_str(), error);
+    if (error) {
+        std::filesystem::remove(path, error);
+        GOGH_LOGGER_ERROR("[Cooker] Failed to store cache entry, (entry=%s)", entry.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool DerivedDataCache::FindStamp(const String& path, SourceStamp* pStamp)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    auto it = stamps.find(path);
+    if (it == stamps.end())
+        return false;
+
+    *pStamp = it->second;
+    return true;
+}
+
+void DerivedDataCache::UpdateStamp(const String& path, const SourceStamp& stamp)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    stamps[path] = stamp;
+    stampsDirty = true;
+}
+
+void DerivedDataCache::_LoadStamps()
+{
+    String stampsPath = String(std::format("{}/{}", directory, DERIVED_DATA_CACHE_STAMPS_FILE));
+    
+    FILE* fp = fopen(stampsPath.c_str(), "rb");
+    if (!fp)
+        return;
+
+    /* one stamp per line: size time contentHash outputKey path */
+    char line[4096];
+    while (fgets(line, sizeof(line), fp)) {
+        SourceStamp stamp;
+        unsigned long long size, contentHash, outputKey;
+        long long time;
+        int pathOffset = 0;
+
+        if (sscanf(line, "%llu %lld %llx %llx %n", &size, &time, &contentHash, &outputKey, &pathOffset) != 4 || pathOffset == 0)
+            continue;
+
+        String path = line + pathOffset;
+        while (!std::empty(path) && (path.back() == '\n' || path.back() == '\r'))
+            path.pop_back();
+
+        stamp.size = size;
+        stamp.time = time;
+        stamp.contentHash = contentHash;
+        stamp.outputKey = outputKey;
+        stamps[path] = stamp;
+    }
+
+    fclose(fp);
+}
+
+bool DerivedDataCache::SaveStamps()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    if (!valid || !stampsDirty)
+        return true;
+
+    String stampsPath = String(std::format("{}/{}", directory, DERIVED_DATA_CACHE_STAMPS_FILE));
+    String tempPath = stampsPath + ".tmp";
+
+    FILE* fp = fopen(tempPath.c_str(), "wb");
+    if (!fp) {
+        GOGH_LOGGER_ERROR("[Cooker] Failed to save source stamps, (path=%s)", stampsPath.c_str());
+        return false;
+    }
+
+    for (const auto& [path, stamp] : stamps)
+        fprintf(fp, "%llu %lld %016llx %016llx %s\n", (unsigned long long) stamp.size, (long long) stamp.time,
+                (unsigned long long) stamp.contentHash, (unsigned long long) stamp.outputKey, path.c_str());
+
+    fclose(fp);
+
+    std::error_code error;
+    std::filesystem::rename(tempPath.c_str(), stampsPath.c_str(), error);
+    stampsDirty = error.operator bool();
+    
+    return !error;
+}
@@ -0,0 +1,80 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include <String.h>
+#include <HashMap.h>
+
+// std
+#include <mutex>
+
+/* name of the source stamp table inside the cache directory */
+#define DERIVED_DATA_CACHE_STAMPS_FILE "stamps.txt"
+
+struct SourceStamp
+{
+    uint64_t size = 0;
+    int64_t time = 0;
+    uint64_t contentHash = 0;
+    uint64_t outputKey = 0;   /* key of the entry last copied to the output, 0 if none */
+};
+
+/*
+ * On disk store of cooked artifacts, one file per entry named after its 64 bit key.
+ * Entries are immutable: a key mixes the source content hash, the cooker version and
+ * the settings, so a hit never has to be checked again.
+ *
+ * The cache also remembers the size and write time of every source it hashed, an
+ * unchanged source is recognised from one stat() without reading it again.
+ */
+class DerivedDataCache
+{
+public:
+    DerivedDataCache(const char* directory);
+   ~DerivedDataCache() = default;
+
+    bool IsValid() const { return valid; }
+
+    /* path of the entry, whether or not it exists */
+    String GetPath(uint64_t key, const char* extension) const;
+    bool Contains(uint64_t key, const char* extension) const;
+    
+    /* moves a finished file into the cache, readers never see a partial entry */
+    bool Store(uint64_t key, const char* extension, const char* path);
+    /* scratch file next to the entries so Store() is a rename on the same volume */
+    String GetTempPath(uint64_t key, const char* extension) const;
+    
+    bool FindStamp(const String& path, SourceStamp* pStamp);
+    void UpdateStamp(const String& path, const SourceStamp& stamp);
+    bool SaveStamps();
+    
+private:
+    void _LoadStamps();
+    
+private:
+    String directory;
+    bool valid = false;
+    
+    std::mutex mutex;
+    HashMap<String, SourceStamp> stamps;
+    bool stampsDirty = false;
+};
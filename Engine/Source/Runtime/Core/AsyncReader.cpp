@@ -0,0 +1,371 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "AsyncReader.h"
+
+#include <Logger.h>
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <errno.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif /* _WIN32 */
+
+#ifdef __linux__
+#  include <linux/io_uring.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <sys/uio.h>
+#endif /* __linux__ */
+
+/* blocking read of the whole file, used by the fallback workers */
+static bool _ReadWholeFile(AsyncRead* pRead)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(pRead->path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    size_t offset = 0;
+    while (offset < pRead->size) {
+        DWORD chunk = (DWORD) std::min<size_t>(pRead->size - offset, ASYNC_READER_MAX_READ_SIZE);
+        DWORD bytesRead = 0;
+        
+        if (!ReadFile(file, pRead->pDestination + offset, chunk, &bytesRead, nullptr) || bytesRead == 0)
+            break;
+        offset += bytesRead;
+    }
+
+    CloseHandle(file);
+    return offset == pRead->size;
+#else
+    int fd = open(pRead->path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    size_t offset = 0;
+    while (offset < pRead->size) {
+        size_t chunk = std::min<size_t>(pRead->size - offset, ASYNC_READER_MAX_READ_SIZE);
+        ssize_t bytesRead = pread(fd, pRead->pDestination + offset, chunk, (off_t) offset);
+
+        if (bytesRead < 0 && errno == EINTR)
+            continue;
+        if (bytesRead <= 0)
+            break;
+        offset += (size_t) bytesRead;
+    }
+
+    close(fd);
+    return offset == pRead->size;
+#endif /* _WIN32 */
+}
+
+AsyncReader::AsyncReader(uint32_t queueDepth, uint32_t fallbackThreadCount)
+{
+    if (_CreateRing(queueDepth)) {
+        GOGH_LOGGER_DEBUG("[IO] Create async reader successful, (backend=io_uring, depth=%u, AsyncReader: %p)", ring.sqEntries, this);
+        return;
+    }
+
+    for (uint32_t i = 0; i < std::max(fallbackThreadCount, 1u); i++)
+        workers.emplace_back(&AsyncReader::_WorkerMain, this);
+    
+    GOGH_LOGGER_DEBUG("[IO] Create async reader successful, (backend=threads, threads=%zu, AsyncReader: %p)", std::size(workers), this);
+}
+
+AsyncReader::~AsyncReader()
+{
+    /* in flight reads write into buffers the owner is about to free */
+    AsyncRead* reads[ASYNC_READER_QUEUE_DEPTH];
+    while (pending > 0)
+        Complete(reads, ASYNC_READER_QUEUE_DEPTH, true);
+    
+    if (IsUsingUring())
+        _DestroyRing();
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    
+    requestCondition.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+
+    GOGH_LOGGER_DEBUG("[IO] Destroying async reader, (AsyncReader: %p)", this);
+}
+
+void AsyncReader::Submit(AsyncRead* pRead)
+{
+    pRead->succeeded = false;
+    pRead->offset = 0;
+    pending++;
+    
+    if (!IsUsingUring()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.push_back(pRead);
+        }
+        requestCondition.notify_one();
+        return;
+    }
+
+#ifdef __linux__
+    pRead->file = open(pRead->path, O_RDONLY);
+#endif /* __linux__ */
+    
+    /* failed opens and empty files complete without touching the ring */
+    if (pRead->file < 0 || pRead->size == 0) {
+        pRead->succeeded = pRead->file >= 0;
+        
+#ifdef __linux__
+        /* the reap closes what went through the ring, this never does */
+        if (pRead->file >= 0)
+            close((int) pRead->file);
+#endif /* __linux__ */
+        pRead->file = -1;
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        completed.push_back(pRead);
+        return;
+    }
+
+    if (!std::empty(backlog) || !_PushRead(pRead))
+        backlog.push_back(pRead);
+}
+
+uint32_t AsyncReader::Complete(AsyncRead** ppReads, uint32_t maxCount, bool wait)
+{
+    uint32_t count = 0;
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        
+        if (!IsUsingUring() && wait && pending > 0)
+            completeCondition.wait(lock, [this] { return !std::empty(completed); });
+        
+        while (count < maxCount && !std::empty(completed)) {
+            ppReads[count++] = completed.front();
+            completed.pop_front();
+        }
+    }
+    
+    if (IsUsingUring() && count < maxCount) {
+        _SubmitBacklog();
+        count += _ReapRing(ppReads + count, maxCount - count);
+        
+        while (wait && count == 0 && pending > 0) {
+#ifdef __linux__
+            int result = (int) syscall(__NR_io_uring_enter, ring.fd, ring.toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (result >= 0)
+                ring.toSubmit -= std::min<uint32_t>(ring.toSubmit, (uint32_t) result);
+            else if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                GOGH_LOGGER_ERROR("[IO] io_uring_enter failed, (errno=%d)", errno);
+#endif /* __linux__ */
+            _SubmitBacklog();
+            count += _ReapRing(ppReads + count, maxCount - count);
+        }
+    }
+
+    pending -= count;
+    return count;
+}
+
+void AsyncReader::_WorkerMain()
+{
+    while (true) {
+        AsyncRead* read;
+        
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            requestCondition.wait(lock, [this] { return stopping || !std::empty(requests); });
+
+            if (stopping && std::empty(requests))
+                return;
+
+            read = requests.front();
+            requests.pop_front();
+        }
+
+        read->succeeded = _ReadWholeFile(read);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            completed.push_back(read);
+        }
+        completeCondition.notify_one();
+    }
+}
+
+#ifdef __linux__
+bool AsyncReader::_CreateRing(uint32_t queueDepth)
+{
+    io_uring_params params = {};
+    
+    ring.fd = (int) syscall(__NR_io_uring_setup, queueDepth, &params);
+    if (ring.fd < 0) {
+        GOGH_LOGGER_WARN("[IO] io_uring is not available, falling back to reader threads, (errno=%d)", errno);
+        return false;
+    }
+
+    ring.sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring.cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    ring.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    
+    /* 5.4+ kernels share one mapping between both rings */
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        ring.sqRingSize = ring.cqRingSize = std::max(ring.sqRingSize, ring.cqRingSize);
+
+    ring.sqRing = mmap(nullptr, ring.sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+    ring.cqRing = (params.features & IORING_FEAT_SINGLE_MMAP) ? ring.sqRing
+        : mmap(nullptr, ring.cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+    ring.sqes = mmap(nullptr, ring.sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES);
+
+    if (ring.sqRing == MAP_FAILED || ring.cqRing == MAP_FAILED || ring.sqes == MAP_FAILED) {
+        GOGH_LOGGER_WARN("[IO] Failed to map io_uring, falling back to reader threads");
+        _DestroyRing();
+        return false;
+    }
+
+    uint8_t* sq = static_cast<uint8_t*>(ring.sqRing);
+    ring.sqHead = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+    ring.sqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+    ring.sqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+    ring.sqMask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+    ring.sqEntries = params.sq_entries;
+
+    uint8_t* cq = static_cast<uint8_t*>(ring.cqRing);
+    ring.cqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+    ring.cqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+    ring.cqMask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+    ring.cqes = cq + params.cq_off.cqes;
+    
+    return true;
+}
+
+void AsyncReader::_DestroyRing()
+{
+    if (ring.sqes && ring.sqes != MAP_FAILED)
+        munmap(ring.sqes, ring.sqesSize);
+    if (ring.cqRing && ring.cqRing != MAP_FAILED && ring.cqRing != ring.sqRing)
+        munmap(ring.cqRing, ring.cqRingSize);
+    if (ring.sqRing && ring.sqRing != MAP_FAILED)
+        munmap(ring.sqRing, ring.sqRingSize);
+    
+    close(ring.fd);
+    ring.fd = -1;
+}
+
+bool AsyncReader::_PushRead(AsyncRead* pRead)
+{
+    uint32_t tail = *ring.sqTail;
+    uint32_t head = std::atomic_ref<uint32_t>(*ring.sqHead).load(std::memory_order_acquire);
+    
+    if (tail - head >= ring.sqEntries)
+        return false;
+
+    pRead->vector.base = pRead->pDestination + pRead->offset;
+    pRead->vector.length = std::min<size_t>(pRead->size - pRead->offset, ASYNC_READER_MAX_READ_SIZE);
+
+    /* READV rather than READ keeps 5.1 kernels working, the iovec lives in the read */
+    uint32_t index = tail & ring.sqMask;
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(ring.sqes) + index;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = (int) pRead->file;
+    sqe->addr = (uint64_t) (uintptr_t) &pRead->vector;
+    sqe->len = 1;
+    sqe->off = pRead->offset;
+    sqe->user_data = (uint64_t) (uintptr_t) pRead;
+    
+    ring.sqArray[index] = index;
+    std::atomic_ref<uint32_t>(*ring.sqTail).store(tail + 1, std::memory_order_release);
+    ring.toSubmit++;
+    
+    return true;
+}
+
+void AsyncReader::_SubmitBacklog()
+{
+    while (!std::empty(backlog) && _PushRead(backlog.front()))
+        backlog.pop_front();
+    
+    if (ring.toSubmit == 0)
+        return;
+    
+    int result = (int) syscall(__NR_io_uring_enter, ring.fd, ring.toSubmit, 0, 0, nullptr, 0);
+    if (result > 0)
+        ring.toSubmit -= (uint32_t) result;
+}
+
+uint32_t AsyncReader::_ReapRing(AsyncRead** ppReads, uint32_t maxCount)
+{
+    uint32_t count = 0;
+    uint32_t head = *ring.cqHead;
+    uint32_t tail = std::atomic_ref<uint32_t>(*ring.cqTail).load(std::memory_order_acquire);
+
+    while (head != tail && count < maxCount) {
+        const io_uring_cqe* cqe = static_cast<const io_uring_cqe*>(ring.cqes) + (head & ring.cqMask);
+        AsyncRead* read = reinterpret_cast<AsyncRead*>((uintptr_t) cqe->user_data);
+        int result = cqe->res;
+        head++;
+
+        if (result > 0 && read->offset + (size_t) result < read->size) {
+            /* short read, continue where it stopped */
+            read->offset += (size_t) result;
+            if (!std::empty(backlog) || !_PushRead(read))
+                backlog.push_back(read);
+            continue;
+        }
+
+        if (result == -EINTR || result == -EAGAIN) {
+            if (!std::empty(backlog) || !_PushRead(read))
+                backlog.push_back(read);
+            continue;
+        }
+
+        read->succeeded = result > 0 && read->offset + (size_t) result == read->size;
+        close((int) read->file);
+        read->file = -1;
+        ppReads[count++] = read;
+    }
+
+    std::atomic_ref<uint32_t>(*ring.cqHead).store(head, std::memory_order_release);
+    return count;
+}
+#else
+bool AsyncReader::_CreateRing(uint32_t)
+{
+    return false;
+}
+
+void AsyncReader::_DestroyRing() {}
+bool AsyncReader::_PushRead(AsyncRead*) { return false; }
+void AsyncReader::_SubmitBacklog() {}
+uint32_t AsyncReader::_ReapRing(AsyncRead**, uint32_t) { return 0; }
+#endif /* __linux__ */
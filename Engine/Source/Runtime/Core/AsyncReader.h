@@ -0,0 +1,125 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include <Vector.h>
+
+// std
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <stddef.h>
+#include <stdint.h>
+
+/* submission queue entries of the io_uring, reads past it wait in a backlog */
+#define ASYNC_READER_QUEUE_DEPTH 64
+
+/* blocking reader threads used when io_uring is not available */
+#define ASYNC_READER_FALLBACK_THREADS 4
+
+/* largest single read handed to the kernel, bigger files take several */
+#define ASYNC_READER_MAX_READ_SIZE (1u << 30)
+
+struct AsyncRead
+{
+    const char* path = nullptr;         /* must stay valid until the read completes */
+    uint8_t* pDestination = nullptr;
+    size_t size = 0;                    /* bytes to read from the start of the file */
+    bool succeeded = false;
+    void* pUserData = nullptr;
+    
+    /* owned by the reader while the read is in flight */
+    intptr_t file = -1;
+    size_t offset = 0;
+    struct { void* base; size_t length; } vector = {};
+};
+
+/*
+ * Whole file reads completed out of order. On Linux the reads go through one io_uring
+ * (raw syscalls, no liburing), so a single thread keeps the whole queue depth busy;
+ * elsewhere, or when the kernel refuses io_uring, a small pool of threads does blocking
+ * reads instead.
+ *
+ * Submit() and Complete() belong to one owning thread.
+ */
+class AsyncReader
+{
+public:
+    AsyncReader(uint32_t queueDepth = ASYNC_READER_QUEUE_DEPTH, uint32_t fallbackThreadCount = ASYNC_READER_FALLBACK_THREADS);
+   ~AsyncReader();
+
+    AsyncReader(const AsyncReader&) = delete;
+    AsyncReader& operator=(const AsyncReader&) = delete;
+    
+    bool IsUsingUring() const { return ring.fd >= 0; }
+    uint32_t GetPendingCount() const { return pending; }
+    
+    void Submit(AsyncRead* pRead);
+    
+    /* finished reads, blocks for at least one when wait is set and reads are pending */
+    uint32_t Complete(AsyncRead** ppReads, uint32_t maxCount, bool wait);
+    
+private:
+    bool _CreateRing(uint32_t queueDepth);
+    void _DestroyRing();
+    /* queues the next chunk of the read, false when the submission queue is full */
+    bool _PushRead(AsyncRead* pRead);
+    void _SubmitBacklog();
+    uint32_t _ReapRing(AsyncRead** ppReads, uint32_t maxCount);
+    
+    void _WorkerMain();
+    
+private:
+    uint32_t pending = 0;
+    std::deque<AsyncRead*> backlog;
+    
+    struct
+    {
+        int fd = -1;
+        uint32_t* sqHead = nullptr;
+        uint32_t* sqTail = nullptr;
+        uint32_t* sqArray = nullptr;
+        uint32_t sqMask = 0;
+        uint32_t sqEntries = 0;
+        void* sqes = nullptr;
+        uint32_t* cqHead = nullptr;
+        uint32_t* cqTail = nullptr;
+        uint32_t cqMask = 0;
+        void* cqes = nullptr;
+        
+        void* sqRing = nullptr;
+        size_t sqRingSize = 0;
+        void* cqRing = nullptr;
+        size_t cqRingSize = 0;
+        size_t sqesSize = 0;
+        uint32_t toSubmit = 0;
+    } ring;
+    
+    Vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable requestCondition;
+    std::condition_variable completeCondition;
+    std::deque<AsyncRead*> requests;
+    std::deque<AsyncRead*> completed;
+    bool stopping = false;
+};
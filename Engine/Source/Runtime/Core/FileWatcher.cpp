@@ -0,0 +1,147 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "FileWatcher.h"
+
+#include <Logger.h>
+
+// std
+#include <filesystem>
+
+#ifdef __linux__
+#  include <errno.h>
+#  include <sys/inotify.h>
+#  include <unistd.h>
+#endif /* __linux__ */
+
+FileWatcher::FileWatcher()
+{
+#ifdef __linux__
+    notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    
+    if (notify < 0)
+        GOGH_LOGGER_WARN("[Core] inotify not available, file watcher falls back to polling, (errno=%d)", errno);
+#endif /* __linux__ */
+
+    lastPoll = std::chrono::steady_clock::now();
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+    if (notify >= 0)
+        close(notify);
+#endif /* __linux__ */
+}
+
+void FileWatcher::Watch(const String& path)
+{
+    String file = Normalize(path);
+    
+    if (files.find(file) != files.end())
+        return;
+
+    files[file] = _GetWriteTime(file);
+
+#ifdef __linux__
+    if (notify < 0)
+        return;
+
+    /* the directory, not the file: saving through a rename replaces the inode */
+    String directory = String(std::filesystem::path(file.c_str()).parent_path().generic_string());
+    if (watches.find(directory) != watches.end())
+        return;
+
+    int watch = inotify_add_watch(notify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (watch < 0) {
+        GOGH_LOGGER_WARN("[Core] Failed to watch directory, (directory=%s, errno=%d)", directory.c_str(), errno);
+        return;
+    }
+
+    watches[directory] = watch;
+    directories[watch] = directory;
+#endif /* __linux__ */
+}
+
+void FileWatcher::Poll(Vector<String>* pChanged)
+{
+    size_t first = std::size(*pChanged);
+    
+#ifdef __linux__
+    if (notify >= 0) {
+        alignas(struct inotify_event) char buffer[4096];
+        ssize_t size;
+        
+        while ((size = read(notify, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + size; ) {
+                const struct inotify_event* event = (const struct inotify_event*) p;
+                p += sizeof(struct inotify_event) + event->len;
+
+                auto directory = directories.find(event->wd);
+                if (event->len == 0 || directory == directories.end())
+                    continue;
+
+                String file = directory->second + "/" + event->name;
+                if (files.find(file) == files.end())
+                    continue;
+
+                if (std::find(pChanged->begin() + first, pChanged->end(), file) == pChanged->end())
+                    pChanged->push_back(file);
+            }
+        }
+        
+        return;
+    }
+#endif /* __linux__ */
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastPoll < std::chrono::milliseconds(FILE_WATCHER_POLL_INTERVAL_MS))
+        return;
+
+    lastPoll = now;
+    
+    for (auto& [file, time] : files) {
+        int64_t current = _GetWriteTime(file);
+        
+        if (current != time) {
+            time = current;
+            pChanged->push_back(file);
+        }
+    }
+}
+
+String FileWatcher::Normalize(const String& path)
+{
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::weakly_canonical(path.c_str(), error);
+    
+    if (error)
+        absolute = std::filesystem::absolute(path.c_str(), error);
+    
+    return String(absolute.lexically_normal().generic_string());
+}
+
+int64_t FileWatcher::_GetWriteTime(const String& path)
+{
+    std::error_code error;
+    auto time = std::filesystem::last_write_time(path.c_str(), error);
+    return error ? -1 : (int64_t) time.time_since_epoch().count();
+}
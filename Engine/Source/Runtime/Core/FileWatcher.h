@@ -0,0 +1,70 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include <String.h>
+#include <Vector.h>
+#include <HashMap.h>
+
+// std
+#include <chrono>
+#include <stdint.h>
+
+/* write time checks of the polling fallback are spaced at least this far apart */
+#define FILE_WATCHER_POLL_INTERVAL_MS 250
+
+/*
+ * Reports files that were written since the last Poll(). On Linux the directories of
+ * the watched files are watched with inotify, which also catches editors that save
+ * through a rename; elsewhere, or when inotify is not available, Poll() compares the
+ * write times of the watched files instead. Poll() never blocks.
+ */
+class FileWatcher
+{
+public:
+    FileWatcher();
+   ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    void Watch(const String& path);
+
+    /* appends every watched path changed since the last call, each once */
+    void Poll(Vector<String>* pChanged);
+
+    /* absolute path with forward slashes, the form Poll() reports paths in */
+    static String Normalize(const String& path);
+
+private:
+    static int64_t _GetWriteTime(const String& path);
+    
+private:
+    /* normalized path -> last write time seen, the time is only kept up to date when polling */
+    HashMap<String, int64_t> files;
+    std::chrono::steady_clock::time_point lastPoll;
+
+    /* inotify descriptor, -1 when polling */
+    int notify = -1;
+    HashMap<int, String> directories;   /* watch descriptor -> directory */
+    HashMap<String, int> watches;       /* directory -> watch descriptor */
+};
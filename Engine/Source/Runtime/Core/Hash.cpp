@@ -0,0 +1,113 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "Hash.h"
+
+// std
+#include <string.h>
+
+#define HASH_PRIME_1 0x9e3779b185ebca87ull
+#define HASH_PRIME_2 0xc2b2ae3d27d4eb4full
+#define HASH_PRIME_3 0x165667b19e3779f9ull
+#define HASH_PRIME_4 0x85ebca77c2b2ae63ull
+#define HASH_PRIME_5 0x27d4eb2f165667c5ull
+
+static uint64_t _Rotate(uint64_t value, int count)
+{
+    return (value << count) | (value >> (64 - count));
+}
+
+static uint64_t _Read64(const uint8_t* p)
+{
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t _Read32(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint64_t _Round(uint64_t accumulator, uint64_t input)
+{
+    accumulator += input * HASH_PRIME_2;
+    return _Rotate(accumulator, 31) * HASH_PRIME_1;
+}
+
+static uint64_t _Merge(uint64_t hash, uint64_t accumulator)
+{
+    hash ^= _Round(0, accumulator);
+    return hash * HASH_PRIME_1 + HASH_PRIME_4;
+}
+
+uint64_t Hash64(const void* data, size_t size, uint64_t seed)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    uint64_t hash;
+
+    if (size >= 32) {
+        uint64_t v1 = seed + HASH_PRIME_1 + HASH_PRIME_2;
+        uint64_t v2 = seed + HASH_PRIME_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - HASH_PRIME_1;
+
+        /* four independent lanes keep the multipliers busy */
+        for (; p + 32 <= end; p += 32) {
+            v1 = _Round(v1, _Read64(p));
+            v2 = _Round(v2, _Read64(p + 8));
+            v3 = _Round(v3, _Read64(p + 16));
+            v4 = _Round(v4, _Read64(p + 24));
+        }
+
+        hash = _Rotate(v1, 1) + _Rotate(v2, 7) + _Rotate(v3, 12) + _Rotate(v4, 18);
+        hash = _Merge(hash, v1);
+        hash = _Merge(hash, v2);
+        hash = _Merge(hash, v3);
+        hash = _Merge(hash, v4);
+    } else {
+        hash = seed + HASH_PRIME_5;
+    }
+
+    hash += (uint64_t) size;
+
+    for (; p + 8 <= end; p += 8)
+        hash = _Rotate(hash ^ _Round(0, _Read64(p)), 27) * HASH_PRIME_1 + HASH_PRIME_4;
+
+    if (p + 4 <= end) {
+        hash = _Rotate(hash ^ ((uint64_t) _Read32(p) * HASH_PRIME_1), 23) * HASH_PRIME_2 + HASH_PRIME_3;
+        p += 4;
+    }
+
+    for (; p < end; p++)
+        hash = _Rotate(hash ^ (*p * HASH_PRIME_5), 11) * HASH_PRIME_1;
+
+    hash ^= hash >> 33;
+    hash *= HASH_PRIME_2;
+    hash ^= hash >> 29;
+    hash *= HASH_PRIME_3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
@@ -0,0 +1,136 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "JobSystem.h"
+
+#include <Logger.h>
+
+JobSystem::JobSystem(uint32_t workerCount)
+{
+    if (workerCount == 0) {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; i++)
+        workers.emplace_back(&JobSystem::_WorkerMain, this);
+    
+    GOGH_LOGGER_DEBUG("[Job] Create job system successful, (workers=%u, JobSystem: %p)", workerCount, this);
+}
+
+JobSystem::~JobSystem()
+{
+    Wait();
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    
+    wakeCondition.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+    
+    GOGH_LOGGER_DEBUG("[Job] Destroying job system, (JobSystem: %p)", this);
+}
+
+void JobSystem::Schedule(Job job)
+{
+    pending.fetch_add(1, std::memory_order_relaxed);
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(job));
+    }
+    
+    wakeCondition.notify_one();
+}
+
+void JobSystem::Wait()
+{
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (!_RunOne())
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::Dispatch(uint32_t jobCount, const IndexedJob& job)
+{
+    std::atomic<uint32_t> remaining = jobCount;
+
+    /* the caller takes job 0 itself, the rest go through the queue */
+    for (uint32_t i = 1; i < jobCount; i++) {
+        Schedule([&job, &remaining, i]() {
+            job(i);
+            remaining.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    if (jobCount > 0) {
+        job(0);
+        remaining.fetch_sub(1, std::memory_order_release);
+    }
+    
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        if (!_RunOne())
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::_WorkerMain()
+{
+    for (;;) {
+        Job job;
+        
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCondition.wait(lock, [this]() { return stopping || !std::empty(queue); });
+            
+            if (std::empty(queue))
+                return;
+            
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        job();
+        pending.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+bool JobSystem::_RunOne()
+{
+    Job job;
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (std::empty(queue))
+            return false;
+        
+        job = std::move(queue.front());
+        queue.pop_front();
+    }
+
+    job();
+    pending.fetch_sub(1, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,74 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include <Vector.h>
+
+// std
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/*
+ * Fixed pool of worker threads fed from one FIFO queue. Threads waiting on jobs help
+ * run queued ones instead of blocking, so Dispatch() may be nested inside a job.
+ */
+class JobSystem
+{
+public:
+    using Job = std::function<void()>;
+    using IndexedJob = std::function<void(uint32_t index)>;
+    
+public:
+    /* workerCount 0 uses one worker per hardware thread besides the caller */
+    JobSystem(uint32_t workerCount = 0);
+   ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    
+    /* threads that run jobs, the workers plus the calling thread */
+    uint32_t GetThreadCount() const { return (uint32_t) std::size(workers) + 1; }
+    
+    /* fire and forget, Wait() returns once every scheduled job finished */
+    void Schedule(Job job);
+    void Wait();
+
+    /* runs job(0) .. job(jobCount - 1) and returns when all of them finished */
+    void Dispatch(uint32_t jobCount, const IndexedJob& job);
+    
+private:
+    void _WorkerMain();
+    /* runs one queued job on the calling thread, false when the queue was empty */
+    bool _RunOne();
+    
+private:
+    Vector<std::thread> workers;
+    std::deque<Job> queue;
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::atomic<uint32_t> pending = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,106 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "MappedFile.h"
+
+#include <Logger.h>
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif /* _WIN32 */
+
+#ifdef _WIN32
+MappedFile::MappedFile(const char* path)
+{
+    LARGE_INTEGER fileSize;
+    
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        file = nullptr;
+        GOGH_LOGGER_ERROR("[IO] Failed to open file, (path=%s)", path);
+        return;
+    }
+
+    opened = true;
+    GetFileSizeEx(file, &fileSize);
+    size = (size_t) fileSize.QuadPart;
+
+    /* a zero length file can not be mapped, it stays valid and empty */
+    if (size == 0)
+        return;
+    
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping)
+        data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (!data)
+        GOGH_LOGGER_ERROR("[IO] Failed to map file, (path=%s, size=%zu)", path, size);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data)
+        UnmapViewOfFile(data);
+    if (mapping)
+        CloseHandle(mapping);
+    if (file)
+        CloseHandle(file);
+}
+#else
+MappedFile::MappedFile(const char* path)
+{
+    struct stat fileStat;
+    
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        GOGH_LOGGER_ERROR("[IO] Failed to open file, (path=%s)", path);
+        return;
+    }
+
+    opened = true;
+    fstat(fd, &fileStat);
+    size = (size_t) fileStat.st_size;
+
+    if (size > 0) {
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            data = static_cast<const uint8_t*>(mapped);
+            madvise(mapped, size, MADV_SEQUENTIAL);
+        } else {
+            GOGH_LOGGER_ERROR("[IO] Failed to map file, (path=%s, size=%zu)", path, size);
+        }
+    }
+
+    /* the mapping keeps its own reference to the file */
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data)
+        munmap(const_cast<uint8_t*>(data), size);
+}
+#endif /* _WIN32 */
@@ -0,0 +1,134 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "Process.h"
+
+#include <Logger.h>
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <spawn.h>
+#  include <sys/wait.h>
+#  include <errno.h>
+extern char** environ;
+#endif /* _WIN32 */
+
+#ifdef _WIN32
+/* quoting that CommandLineToArgvW and the CRT parse back into the same argument */
+static void _AppendQuoted(const String& argument, String* pCommandLine)
+{
+    if (!std::empty(*pCommandLine))
+        *pCommandLine += ' ';
+
+    if (!std::empty(argument) && argument.find_first_of(" \t\n\v\"") == String::npos) {
+        *pCommandLine += argument;
+        return;
+    }
+
+    *pCommandLine += '"';
+    
+    for (size_t i = 0; ; ++i) {
+        size_t backslashes = 0;
+        while (i < std::size(argument) && argument[i] == '\\') {
+            ++backslashes;
+            ++i;
+        }
+
+        if (i == std::size(argument)) {
+            /* the closing quote must not be escaped */
+            pCommandLine->append(backslashes * 2, '\\');
+            break;
+        }
+
+        if (argument[i] == '"') {
+            pCommandLine->append(backslashes * 2 + 1, '\\');
+        } else {
+            pCommandLine->append(backslashes, '\\');
+        }
+        
+        *pCommandLine += argument[i];
+    }
+    
+    *pCommandLine += '"';
+}
+
+bool RunProcess(const Vector<String>& arguments)
+{
+    String commandLine;
+    for (const auto& argument : arguments)
+        _AppendQuoted(argument, &commandLine);
+
+    STARTUPINFOA startupInfo = {};
+    startupInfo.cb = sizeof(startupInfo);
+    PROCESS_INFORMATION processInfo = {};
+
+    /* no application name, CreateProcess searches PATH for the first token like the shell did */
+    if (!CreateProcessA(nullptr, std::data(commandLine), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startupInfo, &processInfo)) {
+        GOGH_LOGGER_ERROR("[Process] Failed to start process, (program=%s, error=%lu)", arguments[0].c_str(), GetLastError());
+        return false;
+    }
+
+    DWORD exitCode = 1;
+    WaitForSingleObject(processInfo.hProcess, INFINITE);
+    GetExitCodeProcess(processInfo.hProcess, &exitCode);
+    
+    CloseHandle(processInfo.hThread);
+    CloseHandle(processInfo.hProcess);
+
+    return exitCode == 0;
+}
+#else
+bool RunProcess(const Vector<String>& arguments)
+{
+    Vector<char*> argv;
+    for (const auto& argument : arguments)
+        argv.push_back(const_cast<char*>(argument.c_str()));
+    argv.push_back(nullptr);
+
+    pid_t pid;
+    int err = posix_spawnp(&pid, argv[0], nullptr, nullptr, std::data(argv), environ);
+    
+    if (err != 0) {
+        GOGH_LOGGER_ERROR("[Process] Failed to start process, (program=%s, errno=%d)", argv[0], err);
+        return false;
+    }
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR)
+            return false;
+    }
+    
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+#endif /* _WIN32 */
+
+void AppendArguments(const String& flags, Vector<String>* pArguments)
+{
+    size_t begin = flags.find_first_not_of(" \t");
+    
+    while (begin != String::npos) {
+        size_t end = flags.find_first_of(" \t", begin);
+        pArguments->push_back(String(flags.substr(begin, end - begin)));
+        begin = end == String::npos ? end : flags.find_first_not_of(" \t", end);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include <String.h>
+#include <Vector.h>
+
+/*
+ * Runs a program with an argument vector and waits for it, arguments[0] is the
+ * program and is looked up on PATH. No shell is involved, so paths and defines
+ * are passed through verbatim whatever characters they contain.
+ *
+ * Returns true when the program ran and exited with 0.
+ */
+bool RunProcess(const Vector<String>& arguments);
+
+/* splits a flag string like "-O -g" on whitespace and appends the pieces */
+void AppendArguments(const String& flags, Vector<String>* pArguments);
\ No newline at end of file
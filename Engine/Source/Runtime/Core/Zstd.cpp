@@ -0,0 +1,948 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "Zstd.h"
+#include "Hash.h"
+
+#include <Vector.h>
+
+// std
+#include <algorithm>
+#include <bit>
+#include <string.h>
+
+#define ZSTD_MAGIC 0xfd2fb528u
+#define ZSTD_SKIPPABLE_MAGIC 0x184d2a50u    /* the low 4 bits are free */
+#define ZSTD_MAX_BLOCK_SIZE (128 * 1024)
+
+#define ZSTD_HUFFMAN_MAX_BITS 11
+#define ZSTD_HUFFMAN_MAX_WEIGHT_ACCURACY 6
+#define ZSTD_FSE_MAX_ACCURACY 9
+
+/* bytes a wild copy may write past its length */
+#define ZSTD_WILDCOPY_SLACK 16
+
+#define ZSTD_LITERALS_LENGTH_MAX_SYMBOL 35
+#define ZSTD_MATCH_LENGTH_MAX_SYMBOL 52
+#define ZSTD_OFFSET_MAX_SYMBOL 31
+
+enum ZstdSequenceTable
+{
+    ZSTD_TABLE_LITERALS_LENGTH = 0,
+    ZSTD_TABLE_OFFSET,
+    ZSTD_TABLE_MATCH_LENGTH,
+    ZSTD_TABLE_MAX_ENUM,
+};
+
+static const uint32_t LITERALS_LENGTH_BASE[ZSTD_LITERALS_LENGTH_MAX_SYMBOL + 1] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+    16, 18, 20, 22, 24, 28, 32, 40, 48, 64, 128, 256, 512, 1024, 2048, 4096,
+    8192, 16384, 32768, 65536,
+};
+
+static const uint8_t LITERALS_LENGTH_BITS[ZSTD_LITERALS_LENGTH_MAX_SYMBOL + 1] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 1, 1, 1, 2, 2, 3, 3, 4, 6, 7, 8, 9, 10, 11, 12,
+    13, 14, 15, 16,
+};
+
+static const uint32_t MATCH_LENGTH_BASE[ZSTD_MATCH_LENGTH_MAX_SYMBOL + 1] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18,
+    19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34,
+    35, 37, 39, 41, 43, 47, 51, 59, 67, 83, 99, 131, 259, 515, 1027, 2051,
+    4099, 8195, 16387, 32771, 65539,
+};
+
+static const uint8_t MATCH_LENGTH_BITS[ZSTD_MATCH_LENGTH_MAX_SYMBOL + 1] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 1, 1, 1, 2, 2, 3, 3, 4, 4, 5, 7, 8, 9, 10, 11,
+    12, 13, 14, 15, 16,
+};
+
+/* default distributions of the predefined mode, accuracy 6, 5 and 6 */
+static const int16_t LITERALS_LENGTH_DEFAULT[ZSTD_LITERALS_LENGTH_MAX_SYMBOL + 1] = {
+    4, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 1, 1, 1, 1, 1,
+    -1, -1, -1, -1,
+};
+
+static const int16_t OFFSET_DEFAULT[29] = {
+    1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1,
+};
+
+static const int16_t MATCH_LENGTH_DEFAULT[ZSTD_MATCH_LENGTH_MAX_SYMBOL + 1] = {
+    1, 4, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1,
+    -1, -1, -1, -1, -1,
+};
+
+static uint32_t _HighBit(uint32_t value)
+{
+    return (uint32_t) std::bit_width(value) - 1;
+}
+
+static uint64_t _Load64(const uint8_t* data, size_t size, size_t position)
+{
+    uint64_t value = 0;
+    
+    if (position + 8 <= size)
+        memcpy(&value, data + position, 8);
+    else if (position < size)
+        memcpy(&value, data + position, size - position);
+    
+    return value;
+}
+
+static uint32_t _Load16(const uint8_t* p)
+{
+    return p[0] | ((uint32_t) p[1] << 8);
+}
+
+static uint32_t _Load32(const uint8_t* p)
+{
+    return p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static inline void _WildCopy(uint8_t* pDestination, const uint8_t* pSource, size_t size)
+{
+    for (size_t i = 0; i < size; i += 16)
+        memcpy(pDestination + i, pSource + i, 16);
+}
+
+namespace
+{
+/* little endian bit reader for the table descriptions, reads past the end as zeros */
+struct ForwardBits
+{
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t position = 0;
+
+    uint32_t Read(uint32_t count)
+      {
+        uint64_t value = _Load64(data, size, position >> 3) >> (position & 7);
+        position += count;
+        return (uint32_t) (value & ((1ull << count) - 1));
+      }
+};
+
+/*
+ * Entropy coded streams are written forward and read backward, starting below the
+ * highest set bit of the last byte. Reads are served from a 64 bit window of the
+ * stream that is only reloaded when it runs out. Reading past the start yields zeros,
+ * callers check offset afterwards to tell a fully consumed stream from a corrupt one.
+ */
+struct BackwardBits
+{
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    int64_t offset = 0;
+    int64_t windowBase = 0;
+    uint64_t window = 0;
+
+    bool Init(const uint8_t* _data, size_t _size)
+      {
+        if (_size == 0 || _data[_size - 1] == 0)
+            return false;
+        
+        data = _data;
+        size = _size;
+        offset = (int64_t) _size * 8 - 8 + _HighBit(_data[_size - 1]);
+        windowBase = offset + 1;
+        return true;
+      }
+
+    /* count <= 56 */
+    uint64_t Read(uint32_t count)
+      {
+        int64_t top = offset;
+        offset -= count;
+
+        if (offset < windowBase) {
+            /* the lowest byte aligned window that still holds top */
+            int64_t byte = std::max<int64_t>(0, ((top + 7) >> 3) - 8);
+            windowBase = byte * 8;
+            window = _Load64(data, size, (size_t) byte);
+        }
+
+        if (offset >= 0)
+            return (window >> (offset - windowBase)) & ((1ull << count) - 1);
+
+        if (top <= 0)
+            return 0;
+        
+        return (window & ((1ull << top) - 1)) << -offset;
+      }
+};
+
+struct FseTable
+{
+    uint32_t accuracyLog = 0;
+    uint8_t symbols[1 << ZSTD_FSE_MAX_ACCURACY];
+    uint8_t bits[1 << ZSTD_FSE_MAX_ACCURACY];
+    uint16_t bases[1 << ZSTD_FSE_MAX_ACCURACY];
+};
+
+struct HuffmanTable
+{
+    uint32_t maxBits = 0;
+    uint8_t symbols[1 << ZSTD_HUFFMAN_MAX_BITS];
+    uint8_t bits[1 << ZSTD_HUFFMAN_MAX_BITS];
+};
+
+struct HuffmanStream
+{
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    int64_t offset = 0;
+    uint8_t* pDestination = nullptr;
+    size_t count = 0;
+};
+}
+
+static bool _BuildFseTable(FseTable* pTable, const int16_t* pCounts, uint32_t symbolCount, uint32_t accuracyLog)
+{
+    uint32_t size = 1u << accuracyLog;
+    uint32_t high = size;
+    uint16_t next[256];
+
+    /* "less than one" symbols take one state each at the top of the table */
+    for (uint32_t s = 0; s < symbolCount; s++) {
+        if (pCounts[s] == -1) {
+            pTable->symbols[--high] = (uint8_t) s;
+            next[s] = 1;
+        } else {
+            next[s] = (uint16_t) pCounts[s];
+        }
+    }
+
+    uint32_t step = (size >> 1) + (size >> 3) + 3;
+    uint32_t mask = size - 1;
+    uint32_t position = 0;
+
+    for (uint32_t s = 0; s < symbolCount; s++) {
+        for (int32_t i = 0; i < pCounts[s]; i++) {
+            pTable->symbols[position] = (uint8_t) s;
+            do {
+                position = (position + step) & mask;
+            } while (position >= high);
+        }
+    }
+
+    if (position != 0)
+        return false;
+
+    for (uint32_t i = 0; i < size; i++) {
+        uint32_t state = next[pTable->symbols[i]]++;
+        pTable->bits[i] = (uint8_t) (accuracyLog - _HighBit(state));
+        pTable->bases[i] = (uint16_t) ((state << pTable->bits[i]) - size);
+    }
+
+    pTable->accuracyLog = accuracyLog;
+    return true;
+}
+
+static bool _ReadFseTable(FseTable* pTable, const uint8_t* data, size_t size, uint32_t maxAccuracy, uint32_t maxSymbol, size_t* pConsumed)
+{
+    ForwardBits in = { data, size, 0 };
+    int16_t counts[256];
+    
+    uint32_t accuracyLog = in.Read(4) + 5;
+    if (accuracyLog > maxAccuracy)
+        return false;
+
+    int32_t remaining = 1 << accuracyLog;
+    uint32_t symbol = 0;
+
+    while (remaining > 0 && symbol <= maxSymbol) {
+        /* values below the threshold are one bit shorter */
+        uint32_t bits = _HighBit(remaining + 1) + 1;
+        uint32_t value = in.Read(bits);
+        uint32_t lowerMask = (1u << (bits - 1)) - 1;
+        uint32_t threshold = (1u << bits) - 1 - (remaining + 1);
+
+        if ((value & lowerMask) < threshold) {
+            in.position--;
+            value &= lowerMask;
+        } else if (value > lowerMask) {
+            value -= threshold;
+        }
+
+        int32_t count = (int32_t) value - 1;
+        remaining -= count < 0 ? -count : count;
+        counts[symbol++] = (int16_t) count;
+
+        if (count == 0) {
+            for (uint32_t repeat = in.Read(2); ; repeat = in.Read(2)) {
+                for (uint32_t i = 0; i < repeat && symbol <= maxSymbol; i++)
+                    counts[symbol++] = 0;
+                if (repeat != 3)
+                    break;
+            }
+        }
+    }
+
+    *pConsumed = (in.position + 7) / 8;
+    if (remaining != 0 || *pConsumed > size)
+        return false;
+
+    return _BuildFseTable(pTable, counts, symbol, accuracyLog);
+}
+
+static bool _ReadHuffmanTable(HuffmanTable* pTable, const uint8_t* data, size_t size, size_t* pConsumed)
+{
+    uint8_t weights[258] = {};
+    uint32_t weightCount = 0;
+
+    if (size == 0)
+        return false;
+
+    uint32_t header = data[0];
+    if (header >= 128) {
+        /* direct representation, 4 bits per weight */
+        weightCount = header - 127;
+        size_t bytes = (weightCount + 1) / 2;
+        if (1 + bytes > size)
+            return false;
+
+        for (uint32_t i = 0; i < weightCount; i++)
+            weights[i] = (i & 1) ? data[1 + i / 2] & 15 : data[1 + i / 2] >> 4;
+        
+        *pConsumed = 1 + bytes;
+    } else {
+        /* FSE compressed weights, two interleaved states over one stream */
+        FseTable table;
+        size_t tableSize;
+        BackwardBits in;
+        
+        if (1 + header > size || !_ReadFseTable(&table, data + 1, header, ZSTD_HUFFMAN_MAX_WEIGHT_ACCURACY, 255, &tableSize))
+            return false;
+
+        if (!in.Init(data + 1 + tableSize, header - tableSize))
+            return false;
+
+        uint32_t state1 = (uint32_t) in.Read(table.accuracyLog);
+        uint32_t state2 = (uint32_t) in.Read(table.accuracyLog);
+
+        while (weightCount < 256) {
+            weights[weightCount++] = table.symbols[state1];
+            state1 = table.bases[state1] + (uint32_t) in.Read(table.bits[state1]);
+            if (in.offset < 0) {
+                weights[weightCount++] = table.symbols[state2];
+                break;
+            }
+            
+            weights[weightCount++] = table.symbols[state2];
+            state2 = table.bases[state2] + (uint32_t) in.Read(table.bits[state2]);
+            if (in.offset < 0) {
+                weights[weightCount++] = table.symbols[state1];
+                break;
+            }
+        }
+
+        *pConsumed = 1 + header;
+    }
+
+    if (weightCount > 255)
+        return false;
+
+    /* the last weight is implied, it completes the sum to the next power of two */
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < weightCount; i++) {
+        if (weights[i] > ZSTD_HUFFMAN_MAX_BITS)
+            return false;
+        if (weights[i] > 0)
+            total += 1u << (weights[i] - 1);
+    }
+
+    if (total == 0)
+        return false;
+
+    uint32_t maxBits = _HighBit(total) + 1;
+    uint32_t left = (1u << maxBits) - total;
+    if (maxBits > ZSTD_HUFFMAN_MAX_BITS || (left & (left - 1)) != 0)
+        return false;
+
+    weights[weightCount++] = (uint8_t) (_HighBit(left) + 1);
+
+    /* longest codes first, each symbol fills 2^(maxBits - bits) consecutive entries */
+    uint8_t symbolBits[256];
+    uint32_t rankCount[ZSTD_HUFFMAN_MAX_BITS + 1] = {};
+    uint32_t rankIndex[ZSTD_HUFFMAN_MAX_BITS + 1] = {};
+
+    for (uint32_t i = 0; i < weightCount; i++) {
+        symbolBits[i] = weights[i] > 0 ? (uint8_t) (maxBits + 1 - weights[i]) : 0;
+        rankCount[symbolBits[i]]++;
+    }
+
+    rankIndex[maxBits] = 0;
+    for (uint32_t bits = maxBits; bits >= 1; bits--) {
+        uint32_t end = rankIndex[bits] + rankCount[bits] * (1u << (maxBits - bits));
+        memset(pTable->bits + rankIndex[bits], (int) bits, end - rankIndex[bits]);
+        if (bits > 1)
+            rankIndex[bits - 1] = end;
+    }
+
+    for (uint32_t i = 0; i < weightCount; i++) {
+        if (symbolBits[i] == 0)
+            continue;
+
+        uint32_t length = 1u << (maxBits - symbolBits[i]);
+        memset(pTable->symbols + rankIndex[symbolBits[i]], (int) i, length);
+        rankIndex[symbolBits[i]] += length;
+    }
+
+    pTable->maxBits = maxBits;
+    return true;
+}
+
+/* four symbols from one load, the caller makes sure 56 bits are left */
+static inline void _DecodeHuffmanFour(const HuffmanTable& table, HuffmanStream* pStream, size_t i)
+{
+    uint64_t mask = (1ull << table.maxBits) - 1;
+    int64_t start = pStream->offset - 56;
+    uint64_t container = _Load64(pStream->data, pStream->size, (size_t) start >> 3) >> (start & 7);
+    uint32_t top = 56;
+
+    for (uint32_t k = 0; k < 4; k++) {
+        uint32_t index = (uint32_t) ((container >> (top - table.maxBits)) & mask);
+        pStream->pDestination[i + k] = table.symbols[index];
+        top -= table.bits[index];
+    }
+
+    pStream->offset = start + top;
+}
+
+static bool _FinishHuffmanStream(const HuffmanTable& table, HuffmanStream* pStream, size_t i)
+{
+    uint32_t maxBits = table.maxBits;
+    uint64_t mask = (1ull << maxBits) - 1;
+
+    for (; pStream->offset >= 56 && i + 4 <= pStream->count; i += 4)
+        _DecodeHuffmanFour(table, pStream, i);
+    
+    for (; i < pStream->count; i++) {
+        int64_t offset = pStream->offset;
+        uint32_t index;
+
+        /* bits below the start of the stream read as zeros */
+        if (offset >= (int64_t) maxBits)
+            index = (uint32_t) ((_Load64(pStream->data, pStream->size, (size_t) (offset - maxBits) >> 3) >> ((offset - maxBits) & 7)) & mask);
+        else if (offset > 0)
+            index = (uint32_t) ((_Load64(pStream->data, pStream->size, 0) << (maxBits - offset)) & mask);
+        else
+            return false;
+
+        pStream->pDestination[i] = table.symbols[index];
+        pStream->offset -= table.bits[index];
+    }
+
+    /* a stream is valid only when it is consumed exactly */
+    return pStream->offset == 0;
+}
+
+/*
+ * The next maxBits bits of a stream index the table directly. The four streams of a
+ * block are independent, decoding them in lockstep hides the dependency of each
+ * lookup on the length of the previous code.
+ */
+static bool _DecodeHuffmanStreams(const HuffmanTable& table, HuffmanStream* pStreams, uint32_t streamCount)
+{
+    BackwardBits in;
+    size_t common = SIZE_MAX;
+    
+    for (uint32_t s = 0; s < streamCount; s++) {
+        if (!in.Init(pStreams[s].data, pStreams[s].size))
+            return false;
+        
+        pStreams[s].offset = in.offset;
+        common = std::min(common, pStreams[s].count);
+    }
+
+    size_t i = 0;
+    if (streamCount == 4) {
+        for (; i + 4 <= common; i += 4) {
+            if (pStreams[0].offset < 56 || pStreams[1].offset < 56 || pStreams[2].offset < 56 || pStreams[3].offset < 56)
+                break;
+            
+            _DecodeHuffmanFour(table, &pStreams[0], i);
+            _DecodeHuffmanFour(table, &pStreams[1], i);
+            _DecodeHuffmanFour(table, &pStreams[2], i);
+            _DecodeHuffmanFour(table, &pStreams[3], i);
+        }
+    }
+
+    for (uint32_t s = 0; s < streamCount; s++) {
+        if (!_FinishHuffmanStream(table, &pStreams[s], i))
+            return false;
+    }
+
+    return true;
+}
+
+namespace
+{
+class ZstdDecoder
+{
+public:
+    ZstdDecoder() : literalBuffer(ZSTD_MAX_BLOCK_SIZE + ZSTD_WILDCOPY_SLACK) {}
+
+    size_t Decompress(const uint8_t* pSource, size_t sourceSize, uint8_t* pDestination, size_t destinationCapacity)
+      {
+        output = pDestination;
+        outputEnd = pDestination + destinationCapacity;
+        
+        while (sourceSize > 0) {
+            size_t consumed;
+
+            if (sourceSize < 8)
+                return ZSTD_ERROR;
+            
+            uint32_t magic = _Load32(pSource);
+            if ((magic & 0xfffffff0u) == ZSTD_SKIPPABLE_MAGIC) {
+                consumed = 8 + (size_t) _Load32(pSource + 4);
+                if (consumed > sourceSize)
+                    return ZSTD_ERROR;
+            } else if (magic != ZSTD_MAGIC || !_DecodeFrame(pSource, sourceSize, &consumed)) {
+                return ZSTD_ERROR;
+            }
+
+            pSource += consumed;
+            sourceSize -= consumed;
+        }
+
+        return (size_t) (output - pDestination);
+      }
+    
+private:
+    bool _DecodeFrame(const uint8_t* data, size_t size, size_t* pConsumed);
+    bool _DecodeCompressedBlock(const uint8_t* data, size_t size);
+    bool _DecodeLiterals(const uint8_t* data, size_t size, size_t* pConsumed);
+    bool _ReadSequenceTable(ZstdSequenceTable type, uint32_t mode, const uint8_t* data, size_t size, size_t* pConsumed);
+    bool _DecodeSequences(const uint8_t* data, size_t size);
+    
+private:
+    uint8_t* output = nullptr;
+    uint8_t* outputEnd = nullptr;
+    uint8_t* frameStart = nullptr;
+
+    const uint8_t* literals = nullptr;
+    size_t literalCount = 0;
+    Vector<uint8_t> literalBuffer;
+
+    /* carried from block to block within a frame */
+    HuffmanTable huffman;
+    bool hasHuffman = false;
+    FseTable tables[ZSTD_TABLE_MAX_ENUM];
+    bool hasTable[ZSTD_TABLE_MAX_ENUM] = {};
+    uint64_t repeats[3] = {};
+};
+}
+
+bool ZstdDecoder::_DecodeFrame(const uint8_t* data, size_t size, size_t* pConsumed)
+{
+    static const uint32_t DICTIONARY_ID_SIZES[4] = { 0, 1, 2, 4 };
+    
+    uint32_t descriptor = data[4];
+    bool singleSegment = (descriptor >> 5) & 1;
+    bool checksum = (descriptor >> 2) & 1;
+    uint32_t contentSizeBytes = (descriptor >> 6) == 0 ? (singleSegment ? 1 : 0) : 1u << (descriptor >> 6);
+    uint32_t dictionaryIdBytes = DICTIONARY_ID_SIZES[descriptor & 3];
+
+    if (descriptor & 0x08)
+        return false;
+
+    size_t position = 5 + (singleSegment ? 0 : 1);
+    if (position + dictionaryIdBytes + contentSizeBytes > size)
+        return false;
+
+    uint64_t dictionaryId = _Load64(data, position + dictionaryIdBytes, position) & ((1ull << (dictionaryIdBytes * 8)) - 1);
+    if (dictionaryId != 0)
+        return false;
+    position += dictionaryIdBytes;
+    
+    uint64_t contentSize = UINT64_MAX;
+    if (contentSizeBytes > 0) {
+        contentSize = contentSizeBytes == 8 ? _Load64(data, size, position) : _Load64(data, size, position) & ((1ull << (contentSizeBytes * 8)) - 1);
+        contentSize += contentSizeBytes == 2 ? 256 : 0;
+        position += contentSizeBytes;
+
+        if (contentSize > (uint64_t) (outputEnd - output))
+            return false;
+    }
+
+    frameStart = output;
+    hasHuffman = false;
+    hasTable[0] = hasTable[1] = hasTable[2] = false;
+    repeats[0] = 1;
+    repeats[1] = 4;
+    repeats[2] = 8;
+
+    for (bool last = false; !last; ) {
+        if (position + 3 > size)
+            return false;
+
+        uint32_t blockHeader = data[position] | ((uint32_t) data[position + 1] << 8) | ((uint32_t) data[position + 2] << 16);
+        uint32_t blockType = (blockHeader >> 1) & 3;
+        size_t blockSize = blockHeader >> 3;
+        
+        last = blockHeader & 1;
+        position += 3;
+
+        if (blockSize > ZSTD_MAX_BLOCK_SIZE)
+            return false;
+        
+        switch (blockType) {
+            case 0: /* raw */
+                if (position + blockSize > size || blockSize > (size_t) (outputEnd - output))
+                    return false;
+                memcpy(output, data + position, blockSize);
+                output += blockSize;
+                position += blockSize;
+                break;
+            case 1: /* RLE, blockSize is the repeat count */
+                if (position + 1 > size || blockSize > (size_t) (outputEnd - output))
+                    return false;
+                memset(output, data[position], blockSize);
+                output += blockSize;
+                position += 1;
+                break;
+            case 2:
+                if (position + blockSize > size || !_DecodeCompressedBlock(data + position, blockSize))
+                    return false;
+                position += blockSize;
+                break;
+            default:
+                return false;
+        }
+    }
+
+    size_t written = (size_t) (output - frameStart);
+    if (contentSize != UINT64_MAX && contentSize != written)
+        return false;
+
+    if (checksum) {
+        if (position + 4 > size || _Load32(data + position) != (uint32_t) Hash64(frameStart, written))
+            return false;
+        position += 4;
+    }
+
+    *pConsumed = position;
+    return true;
+}
+
+bool ZstdDecoder::_DecodeCompressedBlock(const uint8_t* data, size_t size)
+{
+    size_t consumed;
+
+    if (!_DecodeLiterals(data, size, &consumed))
+        return false;
+
+    return _DecodeSequences(data + consumed, size - consumed);
+}
+
+bool ZstdDecoder::_DecodeLiterals(const uint8_t* data, size_t size, size_t* pConsumed)
+{
+    if (size == 0)
+        return false;
+
+    uint32_t type = data[0] & 3;
+    uint32_t sizeFormat = (data[0] >> 2) & 3;
+
+    if (type <= 1) {
+        /* raw or RLE literals */
+        size_t headerSize;
+        
+        switch (sizeFormat) {
+            case 1: headerSize = 2; break;
+            case 3: headerSize = 3; break;
+            default: headerSize = 1; break;
+        }
+
+        if (headerSize > size)
+            return false;
+
+        if (headerSize == 1)
+            literalCount = data[0] >> 3;
+        else if (headerSize == 2)
+            literalCount = (data[0] >> 4) | ((size_t) data[1] << 4);
+        else
+            literalCount = (data[0] >> 4) | ((size_t) data[1] << 4) | ((size_t) data[2] << 12);
+
+        if (literalCount > ZSTD_MAX_BLOCK_SIZE)
+            return false;
+        
+        if (type == 0) {
+            if (headerSize + literalCount > size)
+                return false;
+            literals = data + headerSize;
+            *pConsumed = headerSize + literalCount;
+        } else {
+            if (headerSize + 1 > size)
+                return false;
+            memset(std::data(literalBuffer), data[headerSize], literalCount);
+            literals = std::data(literalBuffer);
+            *pConsumed = headerSize + 1;
+        }
+
+        return true;
+    }
+
+    /* Huffman coded, type 3 reuses the table of the previous block */
+    size_t headerSize = sizeFormat <= 1 ? 3 : sizeFormat + 2;
+    uint32_t sizeBits = sizeFormat <= 1 ? 10 : sizeFormat == 2 ? 14 : 18;
+    uint32_t streamCount = sizeFormat == 0 ? 1 : 4;
+
+    if (headerSize > size)
+        return false;
+
+    uint64_t header = _Load64(data, headerSize, 0);
+    size_t compressedSize = (size_t) (header >> (4 + sizeBits)) & ((1u << sizeBits) - 1);
+    literalCount = (size_t) (header >> 4) & ((1u << sizeBits) - 1);
+
+    if (literalCount > ZSTD_MAX_BLOCK_SIZE || headerSize + compressedSize > size)
+        return false;
+
+    const uint8_t* source = data + headerSize;
+    size_t sourceSize = compressedSize;
+    
+    if (type == 2) {
+        size_t tableSize;
+        if (!_ReadHuffmanTable(&huffman, source, sourceSize, &tableSize))
+            return false;
+
+        hasHuffman = true;
+        source += tableSize;
+        sourceSize -= tableSize;
+    } else if (!hasHuffman) {
+        return false;
+    }
+
+    HuffmanStream streams[4];
+    
+    if (streamCount == 1) {
+        streams[0] = { source, sourceSize, 0, std::data(literalBuffer), literalCount };
+    } else {
+        if (sourceSize < 6)
+            return false;
+
+        size_t streamSizes[3] = { _Load16(source), _Load16(source + 2), _Load16(source + 4) };
+        size_t streamLiteralCount = (literalCount + 3) / 4;
+        
+        if (streamSizes[0] + streamSizes[1] + streamSizes[2] > sourceSize - 6 || streamLiteralCount * 3 > literalCount)
+            return false;
+
+        const uint8_t* streamData = source + 6;
+        for (uint32_t i = 0; i < 4; i++) {
+            size_t streamSize = i < 3 ? streamSizes[i] : sourceSize - 6 - streamSizes[0] - streamSizes[1] - streamSizes[2];
+            size_t count = i < 3 ? streamLiteralCount : literalCount - streamLiteralCount * 3;
+            
+            streams[i] = { streamData, streamSize, 0, std::data(literalBuffer) + streamLiteralCount * i, count };
+            streamData += streamSize;
+        }
+    }
+
+    if (!_DecodeHuffmanStreams(huffman, streams, streamCount))
+        return false;
+
+    literals = std::data(literalBuffer);
+    *pConsumed = headerSize + compressedSize;
+    return true;
+}
+
+bool ZstdDecoder::_ReadSequenceTable(ZstdSequenceTable type, uint32_t mode, const uint8_t* data, size_t size, size_t* pConsumed)
+{
+    static const uint32_t MAX_SYMBOLS[ZSTD_TABLE_MAX_ENUM] = { ZSTD_LITERALS_LENGTH_MAX_SYMBOL, ZSTD_OFFSET_MAX_SYMBOL, ZSTD_MATCH_LENGTH_MAX_SYMBOL };
+    static const uint32_t MAX_ACCURACIES[ZSTD_TABLE_MAX_ENUM] = { 9, 8, 9 };
+
+    FseTable* pTable = &tables[type];
+    *pConsumed = 0;
+    
+    switch (mode) {
+        case 0: /* predefined */
+            if (type == ZSTD_TABLE_LITERALS_LENGTH)
+                _BuildFseTable(pTable, LITERALS_LENGTH_DEFAULT, ZSTD_LITERALS_LENGTH_MAX_SYMBOL + 1, 6);
+            else if (type == ZSTD_TABLE_OFFSET)
+                _BuildFseTable(pTable, OFFSET_DEFAULT, 29, 5);
+            else
+                _BuildFseTable(pTable, MATCH_LENGTH_DEFAULT, ZSTD_MATCH_LENGTH_MAX_SYMBOL + 1, 6);
+            break;
+        case 1: /* RLE, one symbol and no bits */
+            if (size < 1 || data[0] > MAX_SYMBOLS[type])
+                return false;
+            pTable->accuracyLog = 0;
+            pTable->symbols[0] = data[0];
+            pTable->bits[0] = 0;
+            pTable->bases[0] = 0;
+            *pConsumed = 1;
+            break;
+        case 2:
+            if (!_ReadFseTable(pTable, data, size, MAX_ACCURACIES[type], MAX_SYMBOLS[type], pConsumed))
+                return false;
+            break;
+        default: /* repeat */
+            if (!hasTable[type])
+                return false;
+            break;
+    }
+
+    hasTable[type] = true;
+    return true;
+}
+
+bool ZstdDecoder::_DecodeSequences(const uint8_t* data, size_t size)
+{
+    const uint8_t* literalsEnd = literals + literalCount;
+
+    if (size < 1)
+        return false;
+
+    size_t sequenceCount = data[0];
+    size_t position = 1;
+    
+    if (sequenceCount >= 255) {
+        if (size < 3)
+            return false;
+        sequenceCount = data[1] + ((size_t) data[2] << 8) + 0x7f00;
+        position = 3;
+    } else if (sequenceCount >= 128) {
+        if (size < 2)
+            return false;
+        sequenceCount = ((sequenceCount - 128) << 8) + data[1];
+        position = 2;
+    }
+
+    if (sequenceCount > 0) {
+        if (position + 1 > size)
+            return false;
+
+        uint32_t modes = data[position++];
+        if (modes & 3)
+            return false;
+
+        const uint32_t tableModes[ZSTD_TABLE_MAX_ENUM] = { modes >> 6, (modes >> 4) & 3, (modes >> 2) & 3 };
+        for (uint32_t i = 0; i < ZSTD_TABLE_MAX_ENUM; i++) {
+            size_t consumed;
+            if (!_ReadSequenceTable((ZstdSequenceTable) i, tableModes[i], data + position, size - position, &consumed))
+                return false;
+            position += consumed;
+        }
+
+        const FseTable& literalsLengthTable = tables[ZSTD_TABLE_LITERALS_LENGTH];
+        const FseTable& offsetTable = tables[ZSTD_TABLE_OFFSET];
+        const FseTable& matchLengthTable = tables[ZSTD_TABLE_MATCH_LENGTH];
+        
+        BackwardBits in;
+        if (!in.Init(data + position, size - position))
+            return false;
+
+        uint32_t literalsLengthState = (uint32_t) in.Read(literalsLengthTable.accuracyLog);
+        uint32_t offsetState = (uint32_t) in.Read(offsetTable.accuracyLog);
+        uint32_t matchLengthState = (uint32_t) in.Read(matchLengthTable.accuracyLog);
+
+        for (size_t i = 0; i < sequenceCount; i++) {
+            uint32_t offsetCode = offsetTable.symbols[offsetState];
+            uint32_t matchLengthCode = matchLengthTable.symbols[matchLengthState];
+            uint32_t literalsLengthCode = literalsLengthTable.symbols[literalsLengthState];
+
+            uint64_t offsetValue = (1ull << offsetCode) + in.Read(offsetCode);
+            size_t matchLength = MATCH_LENGTH_BASE[matchLengthCode] + (size_t) in.Read(MATCH_LENGTH_BITS[matchLengthCode]);
+            size_t literalsLength = LITERALS_LENGTH_BASE[literalsLengthCode] + (size_t) in.Read(LITERALS_LENGTH_BITS[literalsLengthCode]);
+
+            if (i + 1 < sequenceCount) {
+                literalsLengthState = literalsLengthTable.bases[literalsLengthState] + (uint32_t) in.Read(literalsLengthTable.bits[literalsLengthState]);
+                matchLengthState = matchLengthTable.bases[matchLengthState] + (uint32_t) in.Read(matchLengthTable.bits[matchLengthState]);
+                offsetState = offsetTable.bases[offsetState] + (uint32_t) in.Read(offsetTable.bits[offsetState]);
+            }
+
+            /* 1..3 pick a recent offset, shifted by one when the sequence has no literals */
+            uint64_t offset;
+            if (offsetValue > 3) {
+                offset = offsetValue - 3;
+                repeats[2] = repeats[1];
+                repeats[1] = repeats[0];
+                repeats[0] = offset;
+            } else {
+                uint32_t index = (uint32_t) offsetValue - 1 + (literalsLength == 0 ? 1 : 0);
+                if (index == 0) {
+                    offset = repeats[0];
+                } else {
+                    offset = index < 3 ? repeats[index] : repeats[0] - 1;
+                    if (index > 1)
+                        repeats[2] = repeats[1];
+                    repeats[1] = repeats[0];
+                    repeats[0] = offset;
+                }
+            }
+            
+            if (literalsLength > (size_t) (literalsEnd - literals) || literalsLength + matchLength > (size_t) (outputEnd - output))
+                return false;
+
+            /* most sequences are a few bytes, copy in 16 byte steps while both sides have room to spare */
+            bool wild = (size_t) (outputEnd - output) >= literalsLength + matchLength + ZSTD_WILDCOPY_SLACK;
+            
+            if (wild && (size_t) (literalsEnd - literals) >= literalsLength + ZSTD_WILDCOPY_SLACK)
+                _WildCopy(output, literals, literalsLength);
+            else
+                memcpy(output, literals, literalsLength);
+            
+            literals += literalsLength;
+            output += literalsLength;
+
+            if (offset == 0 || offset > (uint64_t) (output - frameStart))
+                return false;
+
+            /* overlapping matches repeat the last offset bytes, 16 byte steps are safe from offset 16 on */
+            const uint8_t* match = output - offset;
+            if (wild && offset >= ZSTD_WILDCOPY_SLACK) {
+                _WildCopy(output, match, matchLength);
+            } else if (offset >= matchLength) {
+                memcpy(output, match, matchLength);
+            } else {
+                for (size_t j = 0; j < matchLength; j++)
+                    output[j] = match[j];
+            }
+            output += matchLength;
+        }
+
+        if (in.offset != 0)
+            return false;
+    } else if (position != size) {
+        return false;
+    }
+
+    size_t remaining = (size_t) (literalsEnd - literals);
+    if (remaining > (size_t) (outputEnd - output))
+        return false;
+
+    memcpy(output, literals, remaining);
+    output += remaining;
+    return true;
+}
+
+size_t ZstdDecompress(const void* pSource, size_t sourceSize, void* pDestination, size_t destinationCapacity)
+{
+    ZstdDecoder decoder;
+    return decoder.Decompress(static_cast<const uint8_t*>(pSource), sourceSize, static_cast<uint8_t*>(pDestination), destinationCapacity);
+}
@@ -0,0 +1,40 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+// std
+#include <stddef.h>
+#include <stdint.h>
+
+#define ZSTD_ERROR SIZE_MAX
+
+/*
+ * Zstandard decoder (RFC 8878), enough for KTX2 supercompressed levels and any other
+ * data written by a stock zstd encoder: raw, RLE and compressed blocks, Huffman and
+ * FSE entropy tables, repeat offsets and the optional XXH64 content checksum. The
+ * output is one flat buffer, so the window is the buffer itself and nothing is copied
+ * twice. Dictionaries are not supported.
+ *
+ * Returns the number of bytes written, ZSTD_ERROR on corrupt input or when the content
+ * does not fit into destinationCapacity.
+ */
+size_t ZstdDecompress(const void* pSource, size_t sourceSize, void* pDestination, size_t destinationCapacity);
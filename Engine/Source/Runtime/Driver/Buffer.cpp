@@ -20,7 +20,14 @@
 
 #include "Buffer.h"
 
-Buffer::Buffer(VmaAllocator _allocator, size_t _allocateSize, VkBufferUsageFlags _usage)
+// std
+#include <string.h>
+
+/* transfer bits let the defragmenter move the buffer with a GPU copy */
+#define BUFFER_USAGE_FLAGS(usage) ((usage) | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT)
+#define BUFFER_ALLOCATION_FLAGS (VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT)
+
+Buffer::Buffer(VmaAllocator _allocator, size_t _allocateSize, VkBufferUsageFlags _usage, VmaAllocationCreateFlags _allocationFlags)
     : allocator(_allocator), allocateSize(_allocateSize), usage(_usage)
 {
     VkResult err;
@@ -29,12 +36,12 @@ Buffer::Buffer(VmaAllocator _allocator, size_t _allocateSize, VkBufferUsageFlags
     VkBufferCreateInfo bufferCreateInfo = {
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         .size = allocateSize,
-        .usage = usage,
+        .usage = BUFFER_USAGE_FLAGS(usage),
         .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
     };
 
     VmaAllocationCreateInfo allocationCreateInfo = {
-        .flags = VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+        .flags = BUFFER_ALLOCATION_FLAGS | _allocationFlags,
         .usage = VMA_MEMORY_USAGE_AUTO,
     };
 
@@ -45,6 +52,8 @@ Buffer::Buffer(VmaAllocator _allocator, size_t _allocateSize, VkBufferUsageFlags
         return;
     }
 
+    vmaSetAllocationUserData(allocator, allocation, this);
+
     GOGH_LOGGER_DEBUG("[Vulkan] Create buffer successful, allocator=%p, size=%zu, usage=%u (Buffer: %p)", allocator, allocateSize, usage, this);
 }
 
@@ -54,18 +63,65 @@ Buffer::~Buffer()
     vmaDestroyBuffer(allocator, buffer, allocation);
 }
 
+uint32_t Buffer::FindHeapIndex(VmaAllocator allocator, size_t size, VkBufferUsageFlags usage)
+{
+    VkBufferCreateInfo bufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = size,
+        .usage = BUFFER_USAGE_FLAGS(usage),
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+
+    VmaAllocationCreateInfo allocationCreateInfo = {
+        .flags = BUFFER_ALLOCATION_FLAGS,
+        .usage = VMA_MEMORY_USAGE_AUTO,
+    };
+
+    uint32_t memoryTypeIndex;
+    if (vmaFindMemoryTypeIndexForBufferInfo(allocator, &bufferCreateInfo, &allocationCreateInfo, &memoryTypeIndex) != VK_SUCCESS)
+        return UINT32_MAX;
+
+    const VkPhysicalDeviceMemoryProperties* properties;
+    vmaGetMemoryProperties(allocator, &properties);
+    return properties->memoryTypes[memoryTypeIndex].heapIndex;
+}
+
+uint32_t Buffer::GetResidentHeap() const
+{
+    const VkPhysicalDeviceMemoryProperties* properties;
+    vmaGetMemoryProperties(allocator, &properties);
+    return properties->memoryTypes[allocationInfo.memoryType].heapIndex;
+}
+
 void Buffer::ReadBack(size_t offset, size_t size, void *dst)
 {
+    std::lock_guard<std::mutex> lock(moveMutex);
+    
+    /* GPU writes recorded after a defragmentation move land in the new allocation */
+    VmaAllocation srcAllocation = movingAllocation != VK_NULL_HANDLE ? movingAllocation : allocation;
+    
     void* src;
-    vmaMapMemory(allocator, allocation, &src);
+    vmaMapMemory(allocator, srcAllocation, &src);
     memcpy(dst, (static_cast<char*>(src) + offset), size);
-    vmaUnmapMemory(allocator, allocation);
+    vmaUnmapMemory(allocator, srcAllocation);
 }
 
 void Buffer::Write(size_t offset, size_t size, const void* src)
 {
+    std::lock_guard<std::mutex> lock(moveMutex);
+    
     void* dst;
     vmaMapMemory(allocator, allocation, &dst);
     memcpy((static_cast<char*>(dst) + offset), src, size);
     vmaUnmapMemory(allocator, allocation);
+
+    /*
+     * The defragmentation copy may run before or after this write, writing both
+     * sides keeps the moved buffer current either way.
+     */
+    if (movingAllocation != VK_NULL_HANDLE) {
+        vmaMapMemory(allocator, movingAllocation, &dst);
+        memcpy((static_cast<char*>(dst) + offset), src, size);
+        vmaUnmapMemory(allocator, movingAllocation);
+    }
 }
\ No newline at end of file
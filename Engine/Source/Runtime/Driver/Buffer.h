@@ -21,17 +21,34 @@
 #pragma once
 
 #include "VulkanInclude.h"
+#include "ResidencyManager.h"
 
-class Buffer
+// std
+#include <mutex>
+
+class Buffer : public ResidentResource
 {
 public:
-    Buffer(VmaAllocator _allocator, size_t _allocateSize, VkBufferUsageFlags _usage);
+    Buffer(VmaAllocator _allocator, size_t _allocateSize, VkBufferUsageFlags _usage, VmaAllocationCreateFlags _allocationFlags = 0);
    ~Buffer();
 
     void ReadBack(size_t offset, size_t size, void *dst);
     void Write(size_t offset, size_t size, const void* src);
+
+    VkBuffer GetVkBuffer() const { return buffer; }
+    size_t GetSize() const { return allocateSize; }
+
+    /* persistent mapping, follows defragmentation moves, so read it again rather than keeping it across frames */
+    void* GetMappedData() const { return allocationInfo.pMappedData; }
+
+    static uint32_t FindHeapIndex(VmaAllocator allocator, size_t size, VkBufferUsageFlags usage);
+
+    uint32_t GetResidentHeap() const override;
+    VkDeviceSize GetResidentSize() const override { return allocationInfo.size; }
     
 private:
+    friend class Defragmenter;
+
     VmaAllocator allocator = VK_NULL_HANDLE;
     size_t allocateSize = 0;
     VkBufferUsageFlags usage = 0;
@@ -39,4 +56,10 @@ private:
     VkBuffer buffer = VK_NULL_HANDLE;
     VmaAllocation allocation = VK_NULL_HANDLE;
     VmaAllocationInfo allocationInfo = {};
+
+    /* destination allocation while a defragmentation move of this buffer is in flight */
+    VmaAllocation movingAllocation = VK_NULL_HANDLE;
+
+    /* Write/ReadBack may run on another thread than the defragmenter swapping the fields above */
+    mutable std::mutex moveMutex;
 };
\ No newline at end of file
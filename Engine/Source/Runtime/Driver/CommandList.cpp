@@ -49,4 +49,150 @@ CommandList::~CommandList()
     GOGH_LOGGER_DEBUG("[Vulkan] Destroying command list object, (CommandList: %p)", this);
     GOGH_LOGGER_DEBUG("[Vulkan] Free VkCommandBuffer: %p (VkCommandPool: %p)", commandBuffer, commandPool);
     vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+}
+
+void CommandList::Begin(VkCommandBufferUsageFlags flags)
+{
+    VkCommandBufferBeginInfo commandBufferBeginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = flags,
+    };
+
+    vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+}
+
+void CommandList::End()
+{
+    vkEndCommandBuffer(commandBuffer);
+}
+
+void CommandList::Reset()
+{
+    vkResetCommandBuffer(commandBuffer, 0);
+}
+
+VkResult CommandList::Submit(uint32_t waitCount, const VkSemaphore* pWaits, const VkPipelineStageFlags* pWaitStageMasks,
+                             uint32_t signalCount, const VkSemaphore* pSignals, VkFence fence)
+{
+    VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .waitSemaphoreCount = waitCount,
+        .pWaitSemaphores = pWaits,
+        .pWaitDstStageMask = pWaitStageMasks,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &commandBuffer,
+        .signalSemaphoreCount = signalCount,
+        .pSignalSemaphores = pSignals,
+    };
+
+    return vkQueueSubmit(queue, 1, &submitInfo, fence);
+}
+
+void CommandList::BeginRendering(VkImageView imageView, uint32_t width, uint32_t height, const VkClearColorValue& clearColor)
+{
+    VkRenderingAttachmentInfo renderingAttachmentInfo = {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = imageView,
+        .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+        .clearValue = {
+            .color = clearColor,
+        },
+    };
+
+    VkRenderingInfo renderingInfo = {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+        .renderArea = {.offset = {0, 0}, .extent = {width, height}},
+        .layerCount = 1,
+        .colorAttachmentCount = 1,
+        .pColorAttachments = &renderingAttachmentInfo,
+        .pDepthAttachment = VK_NULL_HANDLE,
+    };
+
+    vkCmdBeginRendering(commandBuffer, &renderingInfo);
+
+    VkViewport viewport = {
+        .width = static_cast<float>(width),
+        .height = static_cast<float>(height),
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f,
+    };
+
+    VkRect2D scissor = {
+        .offset = {0, 0},
+        .extent = {width, height}
+    };
+
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+void CommandList::EndRendering()
+{
+    vkCmdEndRendering(commandBuffer);
+}
+
+void CommandList::ImageBarrier(VkImage image,
+                               VkAccessFlags srcAccessMask,
+                               VkAccessFlags dstAccessMask,
+                               VkImageLayout oldLayout,
+                               VkImageLayout newLayout,
+                               VkPipelineStageFlags srcStageMask,
+                               VkPipelineStageFlags dstStageMask)
+{
+    VkImageMemoryBarrier imageMemoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask = srcAccessMask,
+        .dstAccessMask = dstAccessMask,
+        .oldLayout = oldLayout,
+        .newLayout = newLayout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = VK_REMAINING_MIP_LEVELS,
+            .baseArrayLayer = 0,
+            .layerCount = VK_REMAINING_ARRAY_LAYERS,
+        },
+    };
+
+    vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, 0, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, 1, &imageMemoryBarrier);
+}
+
+void CommandList::BufferBarrier(VkBuffer buffer,
+                                VkAccessFlags srcAccessMask,
+                                VkAccessFlags dstAccessMask,
+                                VkPipelineStageFlags srcStageMask,
+                                VkPipelineStageFlags dstStageMask)
+{
+    VkBufferMemoryBarrier bufferMemoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .srcAccessMask = srcAccessMask,
+        .dstAccessMask = dstAccessMask,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = buffer,
+        .offset = 0,
+        .size = VK_WHOLE_SIZE,
+    };
+
+    vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, 0, 0, VK_NULL_HANDLE, 1, &bufferMemoryBarrier, 0, VK_NULL_HANDLE);
+}
+
+void CommandList::ImageBarriers(uint32_t barrierCount, const VkImageMemoryBarrier* pBarriers, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask)
+{
+    vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, 0, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, barrierCount, pBarriers);
+}
+
+void CommandList::CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t regionCount, const VkBufferImageCopy* pRegions)
+{
+    vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regionCount, pRegions);
+}
+
+void CommandList::CopyImage(VkImage src, VkImage dst, uint32_t regionCount, const VkImageCopy* pRegions)
+{
+    vkCmdCopyImage(commandBuffer, src, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regionCount, pRegions);
 }
\ No newline at end of file
@@ -22,12 +22,47 @@
 
 #include "VulkanInclude.h"
 #include "Buffer.h"
+#include "Image.h"
 
 class CommandList
 {
 public:
     CommandList(VkDevice _device, VkCommandPool _commandPool, VkQueue _queue);
    ~CommandList();
+
+    VkCommandBuffer GetCommandBuffer() const { return commandBuffer; }
+
+    void Begin(VkCommandBufferUsageFlags flags = 0);
+    void End();
+    void Reset();
+    VkResult Submit(uint32_t waitCount, const VkSemaphore* pWaits, const VkPipelineStageFlags* pWaitStageMasks,
+                    uint32_t signalCount, const VkSemaphore* pSignals, VkFence fence);
+
+    void BeginRendering(VkImageView imageView, uint32_t width, uint32_t height, const VkClearColorValue& clearColor);
+    void EndRendering();
+
+    void ImageBarrier(VkImage image,
+                      VkAccessFlags srcAccessMask,
+                      VkAccessFlags dstAccessMask,
+                      VkImageLayout oldLayout,
+                      VkImageLayout newLayout,
+                      VkPipelineStageFlags srcStageMask,
+                      VkPipelineStageFlags dstStageMask);
+
+    void BufferBarrier(VkBuffer buffer,
+                       VkAccessFlags srcAccessMask,
+                       VkAccessFlags dstAccessMask,
+                       VkPipelineStageFlags srcStageMask,
+                       VkPipelineStageFlags dstStageMask);
+
+    /* many image transitions in one vkCmdPipelineBarrier */
+    void ImageBarriers(uint32_t barrierCount, const VkImageMemoryBarrier* pBarriers, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask);
+
+    /* image in TRANSFER_DST_OPTIMAL */
+    void CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t regionCount, const VkBufferImageCopy* pRegions);
+
+    /* src in TRANSFER_SRC_OPTIMAL, dst in TRANSFER_DST_OPTIMAL */
+    void CopyImage(VkImage src, VkImage dst, uint32_t regionCount, const VkImageCopy* pRegions);
    
 private:
     VkDevice device = VK_NULL_HANDLE;
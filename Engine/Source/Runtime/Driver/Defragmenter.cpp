@@ -0,0 +1,395 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "Defragmenter.h"
+
+// std
+#include <string.h>
+
+/* check heap fragmentation every N frames while idle */
+#define DEFRAGMENT_AUTO_CHECK_INTERVAL 120
+
+/* ignore heaps with less free block space than this */
+#define DEFRAGMENT_AUTO_MIN_FREE_BYTES (64ull * 1024 * 1024)
+
+Defragmenter::Defragmenter(VkDevice _device, VmaAllocator _allocator, CommandList* _commandList)
+    : device(_device), allocator(_allocator), commandList(_commandList)
+{
+    VkResult err;
+    
+    VkFenceCreateInfo fenceCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+    };
+
+    err = vkCreateFence(device, &fenceCreateInfo, VK_NULL_HANDLE, &fence);
+
+    if (err != VK_SUCCESS) {
+        GOGH_LOGGER_WARN("[Vulkan] Failed to create defragmentation fence, (Defragmenter: %p)", this);
+        return;
+    }
+    
+    GOGH_LOGGER_DEBUG("[Vulkan] Create defragmenter successful, (Defragmenter: %p)", this);
+}
+
+Defragmenter::~Defragmenter()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    if (passPending) {
+        vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+        _EndPass();
+    }
+
+    if (context != VK_NULL_HANDLE)
+        _End();
+    
+    vkDestroyFence(device, fence, VK_NULL_HANDLE);
+    GOGH_LOGGER_DEBUG("[Vulkan] Destroying defragmenter, (Defragmenter: %p)", this);
+}
+
+void Defragmenter::Begin()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    _Begin();
+}
+
+void Defragmenter::Step()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    stepStart = std::chrono::steady_clock::now();
+
+    if (context == VK_NULL_HANDLE) {
+        if (autoThreshold <= 0.0f || ++autoCheckFrame < DEFRAGMENT_AUTO_CHECK_INTERVAL)
+            return;
+
+        autoCheckFrame = 0;
+        if (!_IsFragmented())
+            return;
+
+        _Begin();
+        if (context == VK_NULL_HANDLE)
+            return;
+    }
+
+    if (passPending) {
+        /* the copy is still running, never wait for it */
+        if (vkGetFenceStatus(device, fence) != VK_SUCCESS)
+            return;
+
+        _EndPass();
+        if (context == VK_NULL_HANDLE)
+            return;
+    }
+
+    if (_IsOverTime())
+        return;
+
+    _BeginPass();
+}
+
+void Defragmenter::Release(Buffer* buffer)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    /* a pass that is not pending has already been ended */
+    if (!passPending)
+        return;
+
+    for (uint32_t i = 0; i < passInfo.moveCount; ++i) {
+        VmaDefragmentationMove& move = passInfo.pMoves[i];
+        
+        if (move.srcAllocation != buffer->allocation)
+            continue;
+
+        /* vmaEndDefragmentationPass still reads the allocation, let it free both sides */
+        move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_DESTROY;
+
+        std::lock_guard<std::mutex> bufferLock(buffer->moveMutex);
+        buffer->allocation = VK_NULL_HANDLE;
+
+        for (auto& pending : moves) {
+            if (pending.buffer != buffer)
+                continue;
+
+            /* the copy may still be reading oldBuffer and writing the new one */
+            pending.buffer = VK_NULL_HANDLE;
+            pending.newBuffer = buffer->buffer;
+            
+            buffer->buffer = VK_NULL_HANDLE;
+            buffer->movingAllocation = VK_NULL_HANDLE;
+            
+            stats.bytesMoved -= buffer->allocateSize;
+            --stats.allocationsMoved;
+            break;
+        }
+        
+        return;
+    }
+}
+
+void Defragmenter::_Begin()
+{
+    VkResult err;
+    
+    if (context != VK_NULL_HANDLE)
+        return;
+
+    VmaDefragmentationInfo defragmentationInfo = {
+        .flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT,
+        .maxBytesPerPass = budget.maxBytesPerFrame,
+        .pfnBreakCallback = [](void* pUserData) -> VkBool32 {
+            return static_cast<Defragmenter*>(pUserData)->_IsOverTime();
+        },
+        .pBreakCallbackUserData = this,
+    };
+
+    err = vmaBeginDefragmentation(allocator, &defragmentationInfo, &context);
+
+    if (err != VK_SUCCESS) {
+        GOGH_LOGGER_WARN("[Vulkan] Failed to begin defragmentation, (VkResult=%d)", err);
+        context = VK_NULL_HANDLE;
+        return;
+    }
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Defragmentation begin, (maxBytesPerFrame=%llu, maxMicrosecondsPerFrame=%u)",
+                      (unsigned long long) budget.maxBytesPerFrame, budget.maxMicrosecondsPerFrame);
+}
+
+bool Defragmenter::_IsFragmented()
+{
+    VkPhysicalDeviceMemoryProperties* properties;
+    vmaGetMemoryProperties(allocator, (const VkPhysicalDeviceMemoryProperties**) &properties);
+
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(allocator, budgets);
+
+    for (uint32_t i = 0; i < properties->memoryHeapCount; ++i) {
+        VkDeviceSize blockBytes = budgets[i].statistics.blockBytes;
+        VkDeviceSize freeBytes = blockBytes - budgets[i].statistics.allocationBytes;
+
+        if (freeBytes >= DEFRAGMENT_AUTO_MIN_FREE_BYTES && (float) freeBytes > autoThreshold * (float) blockBytes) {
+            GOGH_LOGGER_DEBUG("[Vulkan] Heap %u fragmented, (blockBytes=%llu, freeBytes=%llu)",
+                              i, (unsigned long long) blockBytes, (unsigned long long) freeBytes);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Defragmenter::_BeginPass()
+{
+    VkResult err;
+
+    err = vmaBeginDefragmentationPass(allocator, context, &passInfo);
+
+    if (err == VK_SUCCESS) {
+        /* nothing left to move */
+        _End();
+        return;
+    }
+
+    commandList->Reset();
+    commandList->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+    VkCommandBuffer commandBuffer = commandList->GetCommandBuffer();
+
+    /* earlier frames may still write the source buffers */
+    VkMemoryBarrier memoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 1, &memoryBarrier, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+
+    for (uint32_t i = 0; i < passInfo.moveCount; ++i) {
+        VmaDefragmentationMove& move = passInfo.pMoves[i];
+
+        VmaAllocationInfo allocationInfo;
+        vmaGetAllocationInfo(allocator, move.srcAllocation, &allocationInfo);
+        
+        Buffer* buffer = static_cast<Buffer*>(allocationInfo.pUserData);
+
+        /* critical buffers may be referenced by long lived descriptor sets, keep them pinned */
+        if (buffer == VK_NULL_HANDLE || buffer->GetResidencyPriority() == RESIDENCY_PRIORITY_CRITICAL || _IsOverTime()) {
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+            continue;
+        }
+
+        VkBufferCreateInfo bufferCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size = buffer->allocateSize,
+            .usage = buffer->usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        };
+
+        VkBuffer newBuffer;
+        err = vkCreateBuffer(device, &bufferCreateInfo, VK_NULL_HANDLE, &newBuffer);
+        if (err != VK_SUCCESS) {
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+            continue;
+        }
+        
+        err = vmaBindBufferMemory(allocator, move.dstTmpAllocation, newBuffer);
+        if (err != VK_SUCCESS) {
+            vkDestroyBuffer(device, newBuffer, VK_NULL_HANDLE);
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+            continue;
+        }
+
+        std::lock_guard<std::mutex> bufferLock(buffer->moveMutex);
+        
+        void* oldMappedData = buffer->allocationInfo.pMappedData;
+        VmaAllocationInfo newAllocationInfo;
+        vmaGetAllocationInfo(allocator, move.dstTmpAllocation, &newAllocationInfo);
+
+        if (oldMappedData != nullptr && newAllocationInfo.pMappedData != nullptr) {
+            /*
+             * Persistently mapped buffers are copied on the CPU and their mapping switches
+             * right away, a GPU copy would land after writes made through the new pointer
+             * and overwrite them.
+             */
+            vmaInvalidateAllocation(allocator, buffer->allocation, 0, VK_WHOLE_SIZE);
+            memcpy(newAllocationInfo.pMappedData, oldMappedData, buffer->allocateSize);
+            vmaFlushAllocation(allocator, move.dstTmpAllocation, 0, VK_WHOLE_SIZE);
+            buffer->allocationInfo.pMappedData = newAllocationInfo.pMappedData;
+        } else {
+            VkBufferCopy region = {
+                .srcOffset = 0,
+                .dstOffset = 0,
+                .size = buffer->allocateSize,
+            };
+            vkCmdCopyBuffer(commandBuffer, buffer->buffer, newBuffer, 1, &region);
+        }
+
+        /* frames recorded from now on use the new buffer, old one lives until the copy is done */
+        moves.push_back({ buffer, buffer->buffer, oldMappedData });
+        buffer->buffer = newBuffer;
+        buffer->movingAllocation = move.dstTmpAllocation;
+
+        stats.bytesMoved += buffer->allocateSize;
+        ++stats.allocationsMoved;
+    }
+
+    /* make the copies visible to every later submission on the queue */
+    memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         0, 1, &memoryBarrier, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+    
+    commandList->End();
+    
+    if (std::empty(moves)) {
+        _EndPass();
+        return;
+    }
+
+    vkResetFences(device, 1, &fence);
+    err = commandList->Submit(0, VK_NULL_HANDLE, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, fence);
+    
+    if (err != VK_SUCCESS) {
+        GOGH_LOGGER_ERROR("[Vulkan] Failed to submit defragmentation copy, (VkResult=%d)", err);
+
+        /* nothing was copied, put the old buffers back and skip the whole pass */
+        for (const auto& move : moves) {
+            std::lock_guard<std::mutex> bufferLock(move.buffer->moveMutex);
+            
+            vkDestroyBuffer(device, move.buffer->buffer, VK_NULL_HANDLE);
+            move.buffer->buffer = move.oldBuffer;
+            move.buffer->allocationInfo.pMappedData = move.oldMappedData;
+            move.buffer->movingAllocation = VK_NULL_HANDLE;
+            stats.bytesMoved -= move.buffer->allocateSize;
+            --stats.allocationsMoved;
+        }
+        
+        for (uint32_t i = 0; i < passInfo.moveCount; ++i)
+            passInfo.pMoves[i].operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+
+        moves.clear();
+        _EndPass();
+        return;
+    }
+
+    passPending = true;
+    ++stats.passes;
+}
+
+void Defragmenter::_EndPass()
+{
+    VkResult err;
+
+    /* writes from other threads must not land in between the swap and the allocation info refresh */
+    Vector<std::unique_lock<std::mutex>> bufferLocks;
+    
+    for (const auto& move : moves) {
+        vkDestroyBuffer(device, move.oldBuffer, VK_NULL_HANDLE);
+
+        /* released mid-pass, its allocation is freed by vmaEndDefragmentationPass */
+        if (move.buffer == VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, move.newBuffer, VK_NULL_HANDLE);
+            continue;
+        }
+
+        bufferLocks.emplace_back(move.buffer->moveMutex);
+    }
+
+    err = vmaEndDefragmentationPass(allocator, context, &passInfo);
+
+    /* srcAllocation now points at the new memory */
+    for (const auto& move : moves) {
+        if (move.buffer == VK_NULL_HANDLE)
+            continue;
+        
+        move.buffer->movingAllocation = VK_NULL_HANDLE;
+        vmaGetAllocationInfo(allocator, move.buffer->allocation, &move.buffer->allocationInfo);
+    }
+    
+    moves.clear();
+    passPending = false;
+    
+    if (err == VK_SUCCESS)
+        _End();
+}
+
+void Defragmenter::_End()
+{
+    VmaDefragmentationStats defragmentationStats = {};
+    vmaEndDefragmentation(allocator, context, &defragmentationStats);
+    context = VK_NULL_HANDLE;
+
+    stats.bytesFreed += defragmentationStats.bytesFreed;
+    stats.deviceMemoryBlocksFreed += defragmentationStats.deviceMemoryBlocksFreed;
+    ++stats.runs;
+
+    GOGH_LOGGER_INFO("[Vulkan] Defragmentation finished, moved %llu bytes in %u allocations, reclaimed %llu bytes (%u blocks)",
+                     (unsigned long long) defragmentationStats.bytesMoved,
+                     defragmentationStats.allocationsMoved,
+                     (unsigned long long) defragmentationStats.bytesFreed,
+                     defragmentationStats.deviceMemoryBlocksFreed);
+}
+
+bool Defragmenter::_IsOverTime() const
+{
+    auto elapsed = std::chrono::steady_clock::now() - stepStart;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() >= budget.maxMicrosecondsPerFrame;
+}
\ No newline at end of file
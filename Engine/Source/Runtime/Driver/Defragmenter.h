@@ -0,0 +1,113 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "VulkanInclude.h"
+#include "CommandList.h"
+#include "Buffer.h"
+
+// std
+#include <chrono>
+#include <mutex>
+
+/*
+ * Incremental defragmentation of the VMA default pools. Step() is called once per
+ * frame, moves at most maxBytesPerFrame and spends at most maxMicrosecondsPerFrame
+ * on the CPU side, and never blocks on the GPU: each pass is copied with a single
+ * command buffer and finished on a later frame once its fence has signaled.
+ *
+ * Moved buffers keep their Buffer* handle, only the VkBuffer behind it changes.
+ *
+ * Step() runs on the thread that submits frames while buffers are created and
+ * destroyed from any thread, so the pass state is guarded by a mutex and
+ * RenderDevice::DestroyBuffer() hands buffers of an in-flight pass to Release().
+ */
+class Defragmenter
+{
+public:
+    struct Budget {
+        VkDeviceSize maxBytesPerFrame = 32ull * 1024 * 1024;
+        uint32_t maxMicrosecondsPerFrame = 1000;
+    };
+    
+    struct Stats {
+        VkDeviceSize bytesMoved = 0;
+        VkDeviceSize bytesFreed = 0;
+        uint32_t allocationsMoved = 0;
+        uint32_t deviceMemoryBlocksFreed = 0;
+        uint32_t passes = 0;
+        uint32_t runs = 0;
+    };
+    
+public:
+    Defragmenter(VkDevice _device, VmaAllocator _allocator, CommandList* _commandList);
+   ~Defragmenter();
+
+    void SetBudget(const Budget& _budget) { budget = _budget; }
+    
+    /* free block space / block space ratio that starts a run automatically, 0 disable */
+    void SetAutoThreshold(float _threshold) { autoThreshold = _threshold; }
+    
+    void Begin();
+    void Step();
+
+    /* called before a buffer is destroyed, takes over its allocation if the pending pass still moves it */
+    void Release(Buffer* buffer);
+    
+    bool IsActive() const { return context != VK_NULL_HANDLE; }
+    const Stats& GetStats() const { return stats; }
+    
+private:
+    bool _IsFragmented();
+    void _Begin();
+    void _BeginPass();
+    void _EndPass();
+    void _End();
+    bool _IsOverTime() const;
+    
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    VmaAllocator allocator = VK_NULL_HANDLE;
+    CommandList* commandList = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+    std::mutex mutex;
+
+    Budget budget = {};
+    float autoThreshold = 0.25f;
+    uint32_t autoCheckFrame = 0;
+    
+    VmaDefragmentationContext context = VK_NULL_HANDLE;
+    VmaDefragmentationPassMoveInfo passInfo = {};
+    bool passPending = false;
+    std::chrono::steady_clock::time_point stepStart;
+
+    struct MoveVkEXT {
+        Buffer* buffer = VK_NULL_HANDLE;
+        VkBuffer oldBuffer = VK_NULL_HANDLE;
+        void* oldMappedData = nullptr;
+        /* set once the buffer was released mid-pass, destroyed with oldBuffer */
+        VkBuffer newBuffer = VK_NULL_HANDLE;
+    };
+    Vector<MoveVkEXT> moves;
+    
+    Stats stats = {};
+};
\ No newline at end of file
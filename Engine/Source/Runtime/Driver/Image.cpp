@@ -0,0 +1,205 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "Image.h"
+#include "CommandList.h"
+#include "ImageViewCache.h"
+
+#define IMAGE_USAGE_FLAGS(usage) ((usage) | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+
+static VkImageCreateInfo _GetImageCreateInfo(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageUsageFlags usage)
+{
+    return {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = format,
+        .extent = { width, height, 1 },
+        .mipLevels = mipLevels,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = IMAGE_USAGE_FLAGS(usage),
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+}
+
+Image::Image(VmaAllocator _allocator, uint32_t _width, uint32_t _height, uint32_t _mipLevels, VkFormat _format, VkImageUsageFlags _usage, VmaAllocationCreateFlags _allocationFlags)
+    : allocator(_allocator), width(_width), height(_height), mipLevels(_mipLevels), format(_format), usage(_usage)
+{
+    VkResult err;
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Creating image, allocator=%p, size=%ux%u, mips=%u, format=%d (Image: %p)", allocator, width, height, mipLevels, format, this);
+    VkImageCreateInfo imageCreateInfo = _GetImageCreateInfo(width, height, mipLevels, format, usage);
+    
+    VmaAllocationCreateInfo allocationCreateInfo = {
+        .flags = _allocationFlags,
+        .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+    };
+
+    err = vmaCreateImage(allocator, &imageCreateInfo, &allocationCreateInfo, &image, &allocation, &allocationInfo);
+
+    if (err != VK_SUCCESS) {
+        GOGH_LOGGER_ERROR("[Vulkan] Failed to create image, allocator=%p, size=%ux%u, mips=%u, format=%d (Image: %p)", allocator, width, height, mipLevels, format, this);
+        image = VK_NULL_HANDLE;
+        return;
+    }
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Create image successful, allocator=%p, size=%ux%u, mips=%u, format=%d (Image: %p)", allocator, width, height, mipLevels, format, this);
+}
+
+Image::~Image()
+{
+    GOGH_LOGGER_DEBUG("[Vulkan] Destroying image, allocator=%p, size=%ux%u, mips=%u, format=%d (Image: %p)", allocator, width, height, mipLevels, format, this);
+    
+    if (image != VK_NULL_HANDLE)
+        vmaDestroyImage(allocator, image, allocation);
+}
+
+uint32_t Image::FindHeapIndex(VmaAllocator allocator, uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageUsageFlags usage)
+{
+    VkImageCreateInfo imageCreateInfo = _GetImageCreateInfo(width, height, mipLevels, format, usage);
+
+    VmaAllocationCreateInfo allocationCreateInfo = {
+        .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+    };
+
+    uint32_t memoryTypeIndex;
+    if (vmaFindMemoryTypeIndexForImageInfo(allocator, &imageCreateInfo, &allocationCreateInfo, &memoryTypeIndex) != VK_SUCCESS)
+        return UINT32_MAX;
+
+    const VkPhysicalDeviceMemoryProperties* properties;
+    vmaGetMemoryProperties(allocator, &properties);
+    return properties->memoryTypes[memoryTypeIndex].heapIndex;
+}
+
+VkDeviceSize Image::GetMemorySize(VkDevice device, uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageUsageFlags usage)
+{
+    VkImageCreateInfo imageCreateInfo = _GetImageCreateInfo(width, height, mipLevels, format, usage);
+    
+    VkDeviceImageMemoryRequirements deviceImageMemoryRequirements = {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS,
+        .pCreateInfo = &imageCreateInfo,
+    };
+
+    VkMemoryRequirements2 memoryRequirements = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+    };
+
+    vkGetDeviceImageMemoryRequirements(device, &deviceImageMemoryRequirements, &memoryRequirements);
+    return memoryRequirements.memoryRequirements.size;
+}
+
+uint32_t Image::GetResidentHeap() const
+{
+    const VkPhysicalDeviceMemoryProperties* properties;
+    vmaGetMemoryProperties(allocator, &properties);
+    return properties->memoryTypes[allocationInfo.memoryType].heapIndex;
+}
+
+VkDeviceSize Image::Downgrade(CommandList* commandList, ImageViewCache* imageViewCache, Vector<ResidencyRetiredVkEXT>& retired)
+{
+    VkResult err;
+    
+    if (image == VK_NULL_HANDLE || mipLevels <= 1)
+        return 0;
+
+    /* the copy reads SHADER_READ_ONLY_OPTIMAL, anything else has not been uploaded yet */
+    if (layout != VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+        return 0;
+
+    /* descriptors written with a held view would be left pointing at the old image */
+    if (imageViewCache->IsAcquired(image))
+        return 0;
+
+    uint32_t newWidth = std::max(width >> 1, 1u);
+    uint32_t newHeight = std::max(height >> 1, 1u);
+    uint32_t newMipLevels = mipLevels - 1;
+    
+    VkImageCreateInfo imageCreateInfo = _GetImageCreateInfo(newWidth, newHeight, newMipLevels, format, usage);
+
+    VmaAllocationCreateInfo allocationCreateInfo = {
+        .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+    };
+
+    VkImage newImage;
+    VmaAllocation newAllocation;
+    VmaAllocationInfo newAllocationInfo;
+    
+    err = vmaCreateImage(allocator, &imageCreateInfo, &allocationCreateInfo, &newImage, &newAllocation, &newAllocationInfo);
+    if (err != VK_SUCCESS) {
+        GOGH_LOGGER_WARN("[Vulkan] Failed to create downgraded image, size=%ux%u, mips=%u (Image: %p)", newWidth, newHeight, newMipLevels, this);
+        return 0;
+    }
+
+    commandList->ImageBarrier(image,
+                              VK_ACCESS_SHADER_READ_BIT,
+                              VK_ACCESS_TRANSFER_READ_BIT,
+                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                              VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                              VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT);
+    
+    commandList->ImageBarrier(newImage,
+                              0,
+                              VK_ACCESS_TRANSFER_WRITE_BIT,
+                              VK_IMAGE_LAYOUT_UNDEFINED,
+                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    /* mip i + 1 of the old image is mip i of the new one */
+    Vector<VkImageCopy> regions(newMipLevels);
+    for (uint32_t i = 0; i < newMipLevels; ++i) {
+        VkExtent3D extent = { std::max(newWidth >> i, 1u), std::max(newHeight >> i, 1u), 1 };
+        
+        regions[i] = {
+            .srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, i + 1, 0, 1 },
+            .dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1 },
+            .extent = extent,
+        };
+    }
+
+    commandList->CopyImage(image, newImage, (uint32_t) std::size(regions), std::data(regions));
+
+    commandList->ImageBarrier(newImage,
+                              VK_ACCESS_TRANSFER_WRITE_BIT,
+                              VK_ACCESS_SHADER_READ_BIT,
+                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT,
+                              VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    VkDeviceSize freed = allocationInfo.size - std::min(newAllocationInfo.size, allocationInfo.size);
+    retired.push_back({ image, allocation });
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Downgrade image, size=%ux%u -> %ux%u, mips=%u, freed=%llu (Image: %p)",
+                      width, height, newWidth, newHeight, newMipLevels, (unsigned long long) freed, this);
+    
+    image = newImage;
+    allocation = newAllocation;
+    allocationInfo = newAllocationInfo;
+    width = newWidth;
+    height = newHeight;
+    mipLevels = newMipLevels;
+
+    return freed;
+}
@@ -0,0 +1,74 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "VulkanInclude.h"
+#include "ResidencyManager.h"
+
+/*
+ * Optimal tiling 2D image in device local memory, sampled and transfer source and
+ * destination. The allocation carries no user data, so the defragmenter, which only
+ * knows how to move buffers, leaves images where they are.
+ *
+ * Under memory pressure the residency manager downgrades the image to a copy without
+ * its top mip, GetVkImage() returns the smaller image from then on and the old one is
+ * destroyed once the copy finished. Only images that were uploaded (all mips in
+ * SHADER_READ_ONLY_OPTIMAL) and have no view acquired from the image view cache are
+ * downgraded, a held view would keep pointing at the destroyed image.
+ */
+class Image : public ResidentResource
+{
+public:
+    Image(VmaAllocator _allocator, uint32_t _width, uint32_t _height, uint32_t _mipLevels, VkFormat _format, VkImageUsageFlags _usage, VmaAllocationCreateFlags _allocationFlags = 0);
+   ~Image();
+
+    VkImage GetVkImage() const { return image; }
+    VkFormat GetFormat() const { return format; }
+    uint32_t GetWidth() const { return width; }
+    uint32_t GetHeight() const { return height; }
+    uint32_t GetMipLevels() const { return mipLevels; }
+
+    /* layout every mip is left in by the last recorded transition */
+    void SetLayout(VkImageLayout _layout) { layout = _layout; }
+    VkImageLayout GetLayout() const { return layout; }
+
+    static uint32_t FindHeapIndex(VmaAllocator allocator, uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageUsageFlags usage);
+    static VkDeviceSize GetMemorySize(VkDevice device, uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageUsageFlags usage);
+    
+    uint32_t GetResidentHeap() const override;
+    VkDeviceSize GetResidentSize() const override { return allocationInfo.size; }
+    /* the smaller copy ends up in SHADER_READ_ONLY_OPTIMAL too */
+    VkDeviceSize Downgrade(CommandList* commandList, ImageViewCache* imageViewCache, Vector<ResidencyRetiredVkEXT>& retired) override;
+
+private:
+    VmaAllocator allocator = VK_NULL_HANDLE;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipLevels = 0;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkImageUsageFlags usage = 0;
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    
+    VkImage image = VK_NULL_HANDLE;
+    VmaAllocation allocation = VK_NULL_HANDLE;
+    VmaAllocationInfo allocationInfo = {};
+};
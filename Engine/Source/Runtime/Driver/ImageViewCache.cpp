@@ -0,0 +1,158 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "ImageViewCache.h"
+
+ImageViewCache::ImageViewCache(VkDevice _device) : device(_device)
+{
+    GOGH_LOGGER_DEBUG("[Vulkan] Create image view cache successful, (ImageViewCache: %p)", this);
+}
+
+ImageViewCache::~ImageViewCache()
+{
+    if (!std::empty(imageViews))
+        GOGH_LOGGER_WARN("[Vulkan] Image view cache destroyed with %zu views still acquired, (ImageViewCache: %p)", std::size(imageViews), this);
+
+    for (const auto& [key, entry] : imageViews)
+        vkDestroyImageView(device, entry.imageView, VK_NULL_HANDLE);
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Destroying image view cache, %llu creates for %llu acquires, (ImageViewCache: %p)",
+                      (unsigned long long) stats.creates, (unsigned long long) (stats.creates + stats.hits), this);
+}
+
+VkImageView ImageViewCache::Acquire(VkImage image, VkFormat format, VkImageViewType viewType, const VkImageSubresourceRange& range)
+{
+    VkResult err;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    ImageViewKey key = { image, format, viewType, range };
+    Entry& entry = imageViews[key];
+
+    if (entry.imageView != VK_NULL_HANDLE) {
+        ++entry.refCount;
+        ++stats.hits;
+        return entry.imageView;
+    }
+
+    VkImageViewCreateInfo imageViewCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = image,
+        .viewType = viewType,
+        .format = format,
+        .components = {
+            .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .a = VK_COMPONENT_SWIZZLE_IDENTITY,
+        },
+        .subresourceRange = range,
+    };
+
+    err = vkCreateImageView(device, &imageViewCreateInfo, VK_NULL_HANDLE, &entry.imageView);
+
+    if (err != VK_SUCCESS) {
+        GOGH_LOGGER_WARN("[Vulkan] Failed to creating VkImageView, VkImage=%p, VkFormat=%d", image, format);
+        imageViews.erase(key);
+        return VK_NULL_HANDLE;
+    }
+
+    entry.refCount = 1;
+    keys[entry.imageView] = key;
+    imageViewsOfImage[image].push_back(entry.imageView);
+    ++stats.imageViews;
+    ++stats.creates;
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Creating VkImageView successful, (VkImage=%p, VkFormat=%d, VkImageView=%p)", image, format, entry.imageView);
+
+    return entry.imageView;
+}
+
+void ImageViewCache::Release(VkImageView imageView)
+{
+    if (imageView == VK_NULL_HANDLE)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    auto it = keys.find(imageView);
+
+    if (it == keys.end()) {
+        GOGH_LOGGER_WARN("[Vulkan] Release of a VkImageView not owned by the cache, (VkImageView=%p)", imageView);
+        return;
+    }
+
+    Entry& entry = imageViews[it->second];
+    if (--entry.refCount > 0)
+        return;
+
+    ImageViewKey key = it->second;
+    
+    auto views = imageViewsOfImage.find(key.image);
+    views->second.remove(imageView);
+    if (std::empty(views->second))
+        imageViewsOfImage.erase(views);
+
+    _Destroy(imageView, key);
+}
+
+void ImageViewCache::Purge(VkImage image)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    auto views = imageViewsOfImage.find(image);
+
+    if (views == imageViewsOfImage.end())
+        return;
+
+    for (VkImageView imageView : views->second) {
+        ImageViewKey key = keys[imageView];
+        GOGH_LOGGER_WARN("[Vulkan] VkImageView destroyed with its image while still acquired, (VkImage=%p, VkImageView=%p, refCount=%u)",
+                         image, imageView, imageViews[key].refCount);
+        _Destroy(imageView, key);
+    }
+
+    imageViewsOfImage.erase(views);
+}
+
+bool ImageViewCache::IsAcquired(VkImage image)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    /* views are destroyed with their last Release(), every view left is held */
+    return imageViewsOfImage.find(image) != imageViewsOfImage.end();
+}
+
+ImageViewCache::Stats ImageViewCache::GetStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void ImageViewCache::_Destroy(VkImageView imageView, const ImageViewKey& key)
+{
+    GOGH_LOGGER_DEBUG("[Vulkan] Destroying VkImageView %p", imageView);
+    vkDestroyImageView(device, imageView, VK_NULL_HANDLE);
+    
+    imageViews.erase(key);
+    keys.erase(imageView);
+    --stats.imageViews;
+}
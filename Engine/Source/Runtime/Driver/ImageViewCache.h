@@ -0,0 +1,113 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "VulkanInclude.h"
+#include "Core/Hash.h"
+
+#include <HashMap.h>
+#include <Vector.h>
+
+// std
+#include <mutex>
+
+/* identity swizzle views, what a view is for is fully described by these */
+struct ImageViewKey
+{
+    VkImage image;
+    VkFormat format;
+    VkImageViewType viewType;
+    VkImageSubresourceRange range;
+
+    bool operator==(const ImageViewKey& other) const
+      {
+        return image == other.image && format == other.format && viewType == other.viewType &&
+               range.aspectMask == other.range.aspectMask &&
+               range.baseMipLevel == other.range.baseMipLevel && range.levelCount == other.range.levelCount &&
+               range.baseArrayLayer == other.range.baseArrayLayer && range.layerCount == other.range.layerCount;
+      }
+};
+
+template<>
+struct std::hash<ImageViewKey>
+{
+    size_t operator()(const ImageViewKey& key) const
+      {
+        uint64_t hash = (uint64_t) (uintptr_t) key.image;
+        hash = HashCombine(hash, ((uint64_t) key.format << 32) | key.viewType);
+        hash = HashCombine(hash, ((uint64_t) key.range.aspectMask << 32) | key.range.baseMipLevel);
+        hash = HashCombine(hash, ((uint64_t) key.range.levelCount << 32) | key.range.baseArrayLayer);
+        return (size_t) HashCombine(hash, key.range.layerCount);
+      }
+};
+
+/*
+ * Shared VkImageView objects keyed by (image, format, view type, subresource range).
+ * Every material sampling a texture, every pass reading a render target, gets the same
+ * view instead of creating its own. Views are reference counted and destroyed with
+ * the last Release(), Purge() drops what is left of an image before it is destroyed,
+ * so a recycled VkImage handle never finds the views of the image it replaced.
+ *
+ * Thread safe, images are destroyed (and purged) from any thread while the render
+ * thread acquires swapchain views and the residency manager purges downgraded images.
+ */
+class ImageViewCache
+{
+public:
+    struct Stats {
+        uint32_t imageViews = 0;
+        uint64_t creates = 0;
+        uint64_t hits = 0;
+    };
+
+public:
+    ImageViewCache(VkDevice _device);
+   ~ImageViewCache();
+
+    VkImageView Acquire(VkImage image, VkFormat format, VkImageViewType viewType, const VkImageSubresourceRange& range);
+    void Release(VkImageView imageView);
+
+    /* views still acquired are destroyed too and reported, their holders must be done with them */
+    void Purge(VkImage image);
+
+    /* true while any view of the image is acquired */
+    bool IsAcquired(VkImage image);
+
+    Stats GetStats();
+
+private:
+    struct Entry {
+        VkImageView imageView = VK_NULL_HANDLE;
+        uint32_t refCount = 0;
+    };
+
+    /* called with the mutex held */
+    void _Destroy(VkImageView imageView, const ImageViewKey& key);
+    
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    std::mutex mutex;
+    HashMap<ImageViewKey, Entry> imageViews;
+    HashMap<VkImageView, ImageViewKey> keys;
+    HashMap<VkImage, Vector<VkImageView>> imageViewsOfImage;
+    Stats stats = {};
+};
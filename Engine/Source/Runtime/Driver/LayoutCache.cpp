@@ -0,0 +1,215 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "LayoutCache.h"
+
+// std
+#include <algorithm>
+
+LayoutCache::LayoutCache(VkDevice _device) : device(_device)
+{
+    GOGH_LOGGER_DEBUG("[Vulkan] Create layout cache successful, (LayoutCache: %p)", this);
+}
+
+LayoutCache::~LayoutCache()
+{
+    if (!std::empty(pipelineLayouts) || !std::empty(setLayouts))
+        GOGH_LOGGER_WARN("[Vulkan] Layout cache destroyed with %zu pipeline layouts and %zu set layouts still acquired, (LayoutCache: %p)",
+                         std::size(pipelineLayouts), std::size(setLayouts), this);
+
+    for (const auto& [key, entry] : pipelineLayouts)
+        vkDestroyPipelineLayout(device, entry.pipelineLayout, VK_NULL_HANDLE);
+
+    for (const auto& [key, entry] : setLayouts)
+        vkDestroyDescriptorSetLayout(device, entry.setLayout, VK_NULL_HANDLE);
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Destroying layout cache, %llu creates for %llu acquires, (LayoutCache: %p)",
+                      (unsigned long long) stats.creates, (unsigned long long) (stats.creates + stats.hits), this);
+}
+
+VkDescriptorSetLayout LayoutCache::AcquireSetLayout(uint32_t bindingCount, const VkDescriptorSetLayoutBinding* pBindings)
+{
+    VkResult err;
+    
+    DescriptorSetLayoutKey key;
+    key.bindings.assign(pBindings, pBindings + bindingCount);
+
+    for (const VkDescriptorSetLayoutBinding& binding : key.bindings) {
+        if (binding.pImmutableSamplers != VK_NULL_HANDLE) {
+            GOGH_LOGGER_ERROR("[Vulkan] Layout cache does not support immutable samplers, (binding=%u, LayoutCache: %p)", binding.binding, this);
+            return VK_NULL_HANDLE;
+        }
+    }
+    
+    std::sort(key.bindings.begin(), key.bindings.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+        return a.binding < b.binding;
+    });
+
+    std::lock_guard<std::mutex> lock(mutex);
+    SetLayoutEntry& entry = setLayouts[key];
+
+    if (entry.setLayout != VK_NULL_HANDLE) {
+        ++entry.refCount;
+        ++stats.hits;
+        return entry.setLayout;
+    }
+
+    VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = (uint32_t) std::size(key.bindings),
+        .pBindings = std::data(key.bindings),
+    };
+
+    err = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo, VK_NULL_HANDLE, &entry.setLayout);
+
+    if (err != VK_SUCCESS) {
+        GOGH_LOGGER_ERROR("[Vulkan] Failed to create VkDescriptorSetLayout, (VkResult=%d, bindings=%u)", err, bindingCount);
+        setLayouts.erase(key);
+        return VK_NULL_HANDLE;
+    }
+
+    entry.refCount = 1;
+    setLayoutKeys[entry.setLayout] = key;
+    ++stats.setLayouts;
+    ++stats.creates;
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Create VkDescriptorSetLayout successful, (VkDescriptorSetLayout=%p, bindings=%u, setLayouts=%u)",
+                      entry.setLayout, bindingCount, stats.setLayouts);
+
+    return entry.setLayout;
+}
+
+void LayoutCache::ReleaseSetLayout(VkDescriptorSetLayout setLayout)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    _ReleaseSetLayout(setLayout);
+}
+
+VkPipelineLayout LayoutCache::AcquirePipelineLayout(uint32_t setLayoutCount, const VkDescriptorSetLayout* pSetLayouts, const VkPushConstantRange* pPushConstantRange)
+{
+    VkResult err;
+    
+    PipelineLayoutKey key;
+    key.setLayouts.assign(pSetLayouts, pSetLayouts + setLayoutCount);
+    key.pushConstantRange = pPushConstantRange && pPushConstantRange->size > 0 ? *pPushConstantRange : VkPushConstantRange {};
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (VkDescriptorSetLayout setLayout : key.setLayouts) {
+        if (setLayoutKeys.find(setLayout) == setLayoutKeys.end()) {
+            GOGH_LOGGER_ERROR("[Vulkan] Pipeline layout from a VkDescriptorSetLayout not owned by the cache, (VkDescriptorSetLayout=%p)", setLayout);
+            return VK_NULL_HANDLE;
+        }
+    }
+    
+    PipelineLayoutEntry& entry = pipelineLayouts[key];
+
+    if (entry.pipelineLayout != VK_NULL_HANDLE) {
+        ++entry.refCount;
+        ++stats.hits;
+        return entry.pipelineLayout;
+    }
+
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = setLayoutCount,
+        .pSetLayouts = pSetLayouts,
+        .pushConstantRangeCount = key.pushConstantRange.size > 0 ? 1u : 0u,
+        .pPushConstantRanges = &key.pushConstantRange,
+    };
+
+    err = vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, VK_NULL_HANDLE, &entry.pipelineLayout);
+
+    if (err != VK_SUCCESS) {
+        GOGH_LOGGER_ERROR("[Vulkan] Failed to create VkPipelineLayout, (VkResult=%d, setLayouts=%u)", err, setLayoutCount);
+        pipelineLayouts.erase(key);
+        return VK_NULL_HANDLE;
+    }
+
+    /* the key names the set layouts, they must outlive it */
+    for (VkDescriptorSetLayout setLayout : key.setLayouts)
+        ++setLayouts[setLayoutKeys[setLayout]].refCount;
+    
+    entry.refCount = 1;
+    pipelineLayoutKeys[entry.pipelineLayout] = key;
+    ++stats.pipelineLayouts;
+    ++stats.creates;
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Create VkPipelineLayout successful, (VkPipelineLayout=%p, setLayouts=%u, pushConstants=%u, pipelineLayouts=%u)",
+                      entry.pipelineLayout, setLayoutCount, key.pushConstantRange.size, stats.pipelineLayouts);
+
+    return entry.pipelineLayout;
+}
+
+void LayoutCache::ReleasePipelineLayout(VkPipelineLayout pipelineLayout)
+{
+    if (pipelineLayout == VK_NULL_HANDLE)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = pipelineLayoutKeys.find(pipelineLayout);
+
+    if (it == pipelineLayoutKeys.end()) {
+        GOGH_LOGGER_WARN("[Vulkan] Release of a VkPipelineLayout not owned by the cache, (VkPipelineLayout=%p)", pipelineLayout);
+        return;
+    }
+
+    PipelineLayoutEntry& entry = pipelineLayouts[it->second];
+    if (--entry.refCount > 0)
+        return;
+
+    vkDestroyPipelineLayout(device, pipelineLayout, VK_NULL_HANDLE);
+
+    for (VkDescriptorSetLayout setLayout : it->second.setLayouts)
+        _ReleaseSetLayout(setLayout);
+    
+    pipelineLayouts.erase(it->second);
+    pipelineLayoutKeys.erase(it);
+    --stats.pipelineLayouts;
+}
+
+LayoutCache::Stats LayoutCache::GetStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void LayoutCache::_ReleaseSetLayout(VkDescriptorSetLayout setLayout)
+{
+    if (setLayout == VK_NULL_HANDLE)
+        return;
+
+    auto it = setLayoutKeys.find(setLayout);
+
+    if (it == setLayoutKeys.end()) {
+        GOGH_LOGGER_WARN("[Vulkan] Release of a VkDescriptorSetLayout not owned by the cache, (VkDescriptorSetLayout=%p)", setLayout);
+        return;
+    }
+
+    SetLayoutEntry& entry = setLayouts[it->second];
+    if (--entry.refCount > 0)
+        return;
+
+    vkDestroyDescriptorSetLayout(device, setLayout, VK_NULL_HANDLE);
+    setLayouts.erase(it->second);
+    setLayoutKeys.erase(it);
+    --stats.setLayouts;
+}
@@ -0,0 +1,147 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "VulkanInclude.h"
+#include "Core/Hash.h"
+
+#include <HashMap.h>
+#include <Vector.h>
+
+// std
+#include <algorithm>
+#include <mutex>
+
+/* bindings sorted by binding number, immutable samplers are not part of a cached layout */
+struct DescriptorSetLayoutKey
+{
+    Vector<VkDescriptorSetLayoutBinding> bindings;
+
+    bool operator==(const DescriptorSetLayoutKey& other) const
+      {
+        return std::equal(bindings.begin(), bindings.end(), other.bindings.begin(), other.bindings.end(),
+                          [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+                              return a.binding == b.binding && a.descriptorType == b.descriptorType &&
+                                     a.descriptorCount == b.descriptorCount && a.stageFlags == b.stageFlags;
+                          });
+      }
+};
+
+/* set layouts come from the cache, so equal handles mean equal sets */
+struct PipelineLayoutKey
+{
+    Vector<VkDescriptorSetLayout> setLayouts;
+    VkPushConstantRange pushConstantRange;
+
+    bool operator==(const PipelineLayoutKey& other) const
+      {
+        return setLayouts == other.setLayouts &&
+               pushConstantRange.stageFlags == other.pushConstantRange.stageFlags &&
+               pushConstantRange.offset == other.pushConstantRange.offset &&
+               pushConstantRange.size == other.pushConstantRange.size;
+      }
+};
+
+template<>
+struct std::hash<DescriptorSetLayoutKey>
+{
+    size_t operator()(const DescriptorSetLayoutKey& key) const
+      {
+        uint64_t hash = std::size(key.bindings);
+        for (const VkDescriptorSetLayoutBinding& binding : key.bindings) {
+            hash = HashCombine(hash, ((uint64_t) binding.binding << 32) | binding.descriptorType);
+            hash = HashCombine(hash, ((uint64_t) binding.descriptorCount << 32) | binding.stageFlags);
+        }
+        return (size_t) hash;
+      }
+};
+
+template<>
+struct std::hash<PipelineLayoutKey>
+{
+    size_t operator()(const PipelineLayoutKey& key) const
+      {
+        uint64_t hash = ((uint64_t) key.pushConstantRange.stageFlags << 32) | key.pushConstantRange.size;
+        hash = HashCombine(hash, key.pushConstantRange.offset);
+        for (VkDescriptorSetLayout setLayout : key.setLayouts)
+            hash = HashCombine(hash, (uint64_t) (uintptr_t) setLayout);
+        return (size_t) hash;
+      }
+};
+
+/*
+ * Canonical VkDescriptorSetLayout and VkPipelineLayout objects. Pipelines declaring
+ * the same sets and push constants get the same handles, so the layouts are
+ * compatible by identity: descriptor sets and push constants stay bound when the
+ * pipeline changes, and a set allocated for one pipeline can be bound with the
+ * other. Layouts are reference counted, a pipeline layout holds a reference on its
+ * set layouts, so a key never refers to a handle that was destroyed and reused.
+ *
+ * Thread safe, pipelines are built on job workers.
+ */
+class LayoutCache
+{
+public:
+    struct Stats {
+        uint32_t setLayouts = 0;
+        uint32_t pipelineLayouts = 0;
+        uint64_t creates = 0;
+        uint64_t hits = 0;
+    };
+
+public:
+    LayoutCache(VkDevice _device);
+   ~LayoutCache();
+
+    /* bindings in any order, pImmutableSamplers must be null */
+    VkDescriptorSetLayout AcquireSetLayout(uint32_t bindingCount, const VkDescriptorSetLayoutBinding* pBindings);
+    void ReleaseSetLayout(VkDescriptorSetLayout setLayout);
+    
+    /* pSetLayouts must come from AcquireSetLayout(), pPushConstantRange may be null */
+    VkPipelineLayout AcquirePipelineLayout(uint32_t setLayoutCount, const VkDescriptorSetLayout* pSetLayouts, const VkPushConstantRange* pPushConstantRange);
+    void ReleasePipelineLayout(VkPipelineLayout pipelineLayout);
+
+    Stats GetStats();
+
+private:
+    struct SetLayoutEntry {
+        VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+        uint32_t refCount = 0;
+    };
+
+    struct PipelineLayoutEntry {
+        VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+        uint32_t refCount = 0;
+    };
+    
+    /* called with the mutex held */
+    void _ReleaseSetLayout(VkDescriptorSetLayout setLayout);
+    
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    std::mutex mutex;
+    HashMap<DescriptorSetLayoutKey, SetLayoutEntry> setLayouts;
+    HashMap<VkDescriptorSetLayout, DescriptorSetLayoutKey> setLayoutKeys;
+    HashMap<PipelineLayoutKey, PipelineLayoutEntry> pipelineLayouts;
+    HashMap<VkPipelineLayout, PipelineLayoutKey> pipelineLayoutKeys;
+    Stats stats = {};
+};
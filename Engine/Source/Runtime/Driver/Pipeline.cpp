@@ -19,3 +19,430 @@
 /* Create by Red Gogh on 2025/4/22 */
 
 #include "Pipeline.h"
+
+// std
+#include <algorithm>
+#include <mutex>
+#include <stdio.h>
+
+/* sort ids handed out so far and the ones given back, ids stay dense across reloads */
+static std::mutex sortIdMutex;
+static uint32_t sortIdCount = 0;
+static Vector<uint32_t> freeSortIds;
+
+/* byte size of the vertex formats reflection produces, 32 and 64-bit components */
+static uint32_t _GetFormatSize(VkFormat format)
+{
+    switch (format) {
+        case VK_FORMAT_R32_SFLOAT:
+        case VK_FORMAT_R32_SINT:
+        case VK_FORMAT_R32_UINT:
+            return 4;
+        case VK_FORMAT_R32G32_SFLOAT:
+        case VK_FORMAT_R32G32_SINT:
+        case VK_FORMAT_R32G32_UINT:
+        case VK_FORMAT_R64_SFLOAT:
+            return 8;
+        case VK_FORMAT_R32G32B32_SFLOAT:
+        case VK_FORMAT_R32G32B32_SINT:
+        case VK_FORMAT_R32G32B32_UINT:
+            return 12;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+        case VK_FORMAT_R32G32B32A32_SINT:
+        case VK_FORMAT_R32G32B32A32_UINT:
+        case VK_FORMAT_R64G64_SFLOAT:
+            return 16;
+        case VK_FORMAT_R64G64B64_SFLOAT:
+            return 24;
+        case VK_FORMAT_R64G64B64A64_SFLOAT:
+            return 32;
+        default:
+            return 0;
+    }
+}
+
+Pipeline::Pipeline(VkDevice _device, LayoutCache* _layoutCache, const char* path,
+                   uint32_t bindingCount, const VkDescriptorSetLayoutBinding* pBindings, uint32_t pushConstantSize)
+    : device(_device), layoutCache(_layoutCache), bindPoint(VK_PIPELINE_BIND_POINT_COMPUTE)
+{
+    Vector<uint32_t> code;
+    
+    if (!ReadSpirv(path, &code)) {
+        GOGH_LOGGER_ERROR("[Vulkan] Failed to load shader module, (path=%s)", path);
+        return;
+    }
+
+    _CreateCompute(path, std::size(code) * sizeof(uint32_t), std::data(code), bindingCount, pBindings, pushConstantSize, VK_NULL_HANDLE);
+}
+
+Pipeline::Pipeline(VkDevice _device, LayoutCache* _layoutCache, const char* name, size_t codeSize, const uint32_t* pCode,
+                   uint32_t bindingCount, const VkDescriptorSetLayoutBinding* pBindings, uint32_t pushConstantSize,
+                   const VkSpecializationInfo* pSpecializationInfo)
+    : device(_device), layoutCache(_layoutCache), bindPoint(VK_PIPELINE_BIND_POINT_COMPUTE)
+{
+    _CreateCompute(name, codeSize, pCode, bindingCount, pBindings, pushConstantSize, pSpecializationInfo);
+}
+
+Pipeline::Pipeline(VkDevice _device, LayoutCache* _layoutCache, const GraphicsPipelineDesc& desc)
+    : device(_device), layoutCache(_layoutCache), bindPoint(VK_PIPELINE_BIND_POINT_GRAPHICS)
+{
+    _CreateGraphics(desc);
+}
+
+void Pipeline::_CreateCompute(const char* name, size_t codeSize, const uint32_t* pCode,
+                              uint32_t bindingCount, const VkDescriptorSetLayoutBinding* pBindings, uint32_t pushConstantSize,
+                              const VkSpecializationInfo* pSpecializationInfo)
+{
+    VkResult err;
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Creating compute pipeline object, (path=%s, Pipeline: %p)", name, this);
+
+    if (!ShaderReflector::Reflect(codeSize, pCode, &reflection) || reflection.stages != VK_SHADER_STAGE_COMPUTE_BIT) {
+        GOGH_LOGGER_ERROR("[Vulkan] Failed to reflect compute shader, (path=%s, stages=0x%x)", name, reflection.stages);
+        return;
+    }
+
+    if (pBindings) {
+        if (std::empty(reflection.sets))
+            reflection.sets.resize(1);
+        
+        reflection.sets[0].assign(pBindings, pBindings + bindingCount);
+        reflection.pushConstantRange = {
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .offset = 0,
+            .size = pushConstantSize,
+        };
+    }
+    
+    VkShaderModuleCreateInfo shaderModuleCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .codeSize = codeSize,
+        .pCode = pCode,
+    };
+
+    err = vkCreateShaderModule(device, &shaderModuleCreateInfo, VK_NULL_HANDLE, &shaderModule);
+    if (err != VK_SUCCESS) {
+        GOGH_LOGGER_ERROR("[Vulkan] Failed to load shader module, (path=%s, VkResult=%d)", name, err);
+        return;
+    }
+
+    if (!_AcquireLayouts()) {
+        err = VK_ERROR_INITIALIZATION_FAILED;
+        goto TAG_CREATE_PIPELINE_END;
+    }
+
+    {
+        VkComputePipelineCreateInfo computePipelineCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .stage = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = shaderModule,
+                .pName = "main",
+                .pSpecializationInfo = pSpecializationInfo,
+            },
+            .layout = pipelineLayout,
+        };
+
+        err = vkCreateComputePipelines(device, pipelineCache, 1, &computePipelineCreateInfo, VK_NULL_HANDLE, &pipeline);
+    }
+
+TAG_CREATE_PIPELINE_END:
+    vkDestroyShaderModule(device, shaderModule, VK_NULL_HANDLE);
+
+    if (err != VK_SUCCESS) {
+        GOGH_LOGGER_ERROR("[Vulkan] Failed to create compute pipeline, (path=%s, VkResult=%d)", name, err);
+        pipeline = VK_NULL_HANDLE;
+        return;
+    }
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Create compute pipeline successful, (VkPipeline=%p)", pipeline);
+}
+
+void Pipeline::_CreateGraphics(const GraphicsPipelineDesc& desc)
+{
+    VkResult err = VK_ERROR_INITIALIZATION_FAILED;
+    const char* paths[2] = { desc.vertexPath, desc.fragmentPath };
+    const VkShaderStageFlagBits stages[2] = { VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT };
+    VkShaderModule shaderModules[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+    VkPipelineShaderStageCreateInfo shaderStageCreateInfos[2];
+    Vector<VkVertexInputBindingDescription> vertexBindings;
+    Vector<VkVertexInputAttributeDescription> vertexAttributes;
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Creating graphics pipeline object, (vertex=%s, fragment=%s, Pipeline: %p)", desc.vertexPath, desc.fragmentPath, this);
+
+    for (uint32_t i = 0; i < 2; i++) {
+        Vector<uint32_t> code;
+        ShaderReflection stageReflection;
+        
+        if (!ReadSpirv(paths[i], &code)) {
+            GOGH_LOGGER_ERROR("[Vulkan] Failed to load shader module, (path=%s)", paths[i]);
+            goto TAG_CREATE_PIPELINE_END;
+        }
+
+        if (!ShaderReflector::Reflect(std::size(code) * sizeof(uint32_t), std::data(code), &stageReflection) ||
+            stageReflection.stages != stages[i] || !ShaderReflector::Merge(stageReflection, &reflection)) {
+            GOGH_LOGGER_ERROR("[Vulkan] Failed to reflect graphics shader, (path=%s, stages=0x%x)", paths[i], stageReflection.stages);
+            goto TAG_CREATE_PIPELINE_END;
+        }
+
+        VkShaderModuleCreateInfo shaderModuleCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+            .codeSize = std::size(code) * sizeof(uint32_t),
+            .pCode = std::data(code),
+        };
+
+        err = vkCreateShaderModule(device, &shaderModuleCreateInfo, VK_NULL_HANDLE, &shaderModules[i]);
+        if (err != VK_SUCCESS) {
+            GOGH_LOGGER_ERROR("[Vulkan] Failed to load shader module, (path=%s, VkResult=%d)", paths[i], err);
+            goto TAG_CREATE_PIPELINE_END;
+        }
+        
+        shaderStageCreateInfos[i] = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = stages[i],
+            .module = shaderModules[i],
+            .pName = "main",
+        };
+    }
+
+    err = VK_ERROR_INITIALIZATION_FAILED;
+    
+    if (desc.pBindings) {
+        if (std::empty(reflection.sets))
+            reflection.sets.resize(1);
+        
+        reflection.sets[0].assign(desc.pBindings, desc.pBindings + desc.bindingCount);
+    }
+
+    if (!_BuildVertexInput(desc, &vertexBindings, &vertexAttributes) || !_AcquireLayouts())
+        goto TAG_CREATE_PIPELINE_END;
+
+    instanceStream = desc.instanceStride != 0;
+
+    {
+        VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+            .vertexBindingDescriptionCount = (uint32_t) std::size(vertexBindings),
+            .pVertexBindingDescriptions = std::data(vertexBindings),
+            .vertexAttributeDescriptionCount = (uint32_t) std::size(vertexAttributes),
+            .pVertexAttributeDescriptions = std::data(vertexAttributes),
+        };
+
+        VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+            .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+        };
+
+        VkPipelineViewportStateCreateInfo viewportStateCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+            .viewportCount = 1,
+            .scissorCount = 1,
+        };
+
+        VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+            .polygonMode = VK_POLYGON_MODE_FILL,
+            .cullMode = desc.cullMode,
+            .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+            .lineWidth = 1.0f,
+        };
+
+        VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+            .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+        };
+
+        Vector<VkPipelineColorBlendAttachmentState> colorBlendAttachmentStates(desc.colorFormatCount);
+        for (auto& colorBlendAttachmentState : colorBlendAttachmentStates) {
+            colorBlendAttachmentState = {
+                .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+            };
+        }
+
+        VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+            .attachmentCount = desc.colorFormatCount,
+            .pAttachments = std::data(colorBlendAttachmentStates),
+        };
+
+        VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+        VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+            .dynamicStateCount = (uint32_t) std::size(dynamicStates),
+            .pDynamicStates = dynamicStates,
+        };
+
+        VkPipelineRenderingCreateInfo renderingCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+            .colorAttachmentCount = desc.colorFormatCount,
+            .pColorAttachmentFormats = desc.pColorFormats,
+        };
+
+        VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .pNext = &renderingCreateInfo,
+            .stageCount = 2,
+            .pStages = shaderStageCreateInfos,
+            .pVertexInputState = &vertexInputStateCreateInfo,
+            .pInputAssemblyState = &inputAssemblyStateCreateInfo,
+            .pViewportState = &viewportStateCreateInfo,
+            .pRasterizationState = &rasterizationStateCreateInfo,
+            .pMultisampleState = &multisampleStateCreateInfo,
+            .pColorBlendState = &colorBlendStateCreateInfo,
+            .pDynamicState = &dynamicStateCreateInfo,
+            .layout = pipelineLayout,
+        };
+
+        err = vkCreateGraphicsPipelines(device, pipelineCache, 1, &graphicsPipelineCreateInfo, VK_NULL_HANDLE, &pipeline);
+    }
+
+TAG_CREATE_PIPELINE_END:
+    for (VkShaderModule shaderModule : shaderModules) {
+        if (shaderModule != VK_NULL_HANDLE)
+            vkDestroyShaderModule(device, shaderModule, VK_NULL_HANDLE);
+    }
+
+    if (err != VK_SUCCESS) {
+        GOGH_LOGGER_ERROR("[Vulkan] Failed to create graphics pipeline, (vertex=%s, fragment=%s, VkResult=%d)", desc.vertexPath, desc.fragmentPath, err);
+        pipeline = VK_NULL_HANDLE;
+        return;
+    }
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Create graphics pipeline successful, (VkPipeline=%p)", pipeline);
+}
+
+bool Pipeline::_BuildVertexInput(const GraphicsPipelineDesc& desc, Vector<VkVertexInputBindingDescription>* pBindings,
+                                 Vector<VkVertexInputAttributeDescription>* pAttributes) const
+{
+    uint32_t stride = 0;
+    uint32_t instanceSize = 0;
+    bool perVertex = false;
+    
+    for (const VkVertexInputAttributeDescription& input : reflection.vertexInputs) {
+        VkVertexInputAttributeDescription attribute = input;
+        
+        if (desc.instanceStride != 0 && input.location >= desc.firstInstanceLocation) {
+            attribute.binding = 1;
+            attribute.offset = instanceSize;
+            instanceSize += _GetFormatSize(input.format);
+            
+            pAttributes->push_back(attribute);
+            continue;
+        }
+        
+        if (desc.pVertexAttributes) {
+            const VkVertexInputAttributeDescription* end = desc.pVertexAttributes + desc.vertexAttributeCount;
+            const VkVertexInputAttributeDescription* it = std::find_if(desc.pVertexAttributes, end, [&](const VkVertexInputAttributeDescription& a) {
+                return a.location == input.location;
+            });
+
+            if (it == end) {
+                GOGH_LOGGER_ERROR("[Vulkan] Vertex layout misses a shader input, (vertex=%s, location=%u)", desc.vertexPath, input.location);
+                return false;
+            }
+
+            attribute = *it;
+        } else {
+            attribute.offset = stride;
+            stride += _GetFormatSize(input.format);
+        }
+
+        attribute.binding = 0;
+        pAttributes->push_back(attribute);
+        perVertex = true;
+    }
+
+    if (instanceSize > desc.instanceStride) {
+        GOGH_LOGGER_ERROR("[Vulkan] Instance inputs do not fit the instance stride, (vertex=%s, size=%u, stride=%u)",
+                          desc.vertexPath, instanceSize, desc.instanceStride);
+        return false;
+    }
+    
+    if (perVertex) {
+        pBindings->push_back({
+            .binding = 0,
+            .stride = desc.pVertexAttributes ? desc.vertexStride : stride,
+            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+        });
+    }
+
+    if (desc.instanceStride != 0) {
+        pBindings->push_back({
+            .binding = 1,
+            .stride = desc.instanceStride,
+            .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE,
+        });
+    }
+    
+    return true;
+}
+
+Pipeline::~Pipeline()
+{
+    GOGH_LOGGER_DEBUG("[Vulkan] Destroying pipeline object, (Pipeline: %p)", this);
+
+    _ReleaseSortId(sortId);
+    
+    if (pipeline != VK_NULL_HANDLE)
+        vkDestroyPipeline(device, pipeline, VK_NULL_HANDLE);
+
+    layoutCache->ReleasePipelineLayout(pipelineLayout);
+
+    for (VkDescriptorSetLayout descriptorSetLayout : descriptorSetLayouts)
+        layoutCache->ReleaseSetLayout(descriptorSetLayout);
+}
+
+bool Pipeline::_AcquireLayouts()
+{
+    for (const auto& bindings : reflection.sets) {
+        VkDescriptorSetLayout descriptorSetLayout = layoutCache->AcquireSetLayout((uint32_t) std::size(bindings), std::data(bindings));
+        if (descriptorSetLayout == VK_NULL_HANDLE)
+            return false;
+
+        descriptorSetLayouts.push_back(descriptorSetLayout);
+    }
+
+    pipelineLayout = layoutCache->AcquirePipelineLayout((uint32_t) std::size(descriptorSetLayouts), std::data(descriptorSetLayouts), &reflection.pushConstantRange);
+    return pipelineLayout != VK_NULL_HANDLE;
+}
+
+bool Pipeline::ReadSpirv(const char* path, Vector<uint32_t>* pCode)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    /* SPIR-V words, keeps pCode 4 byte aligned */
+    pCode->resize((size + 3) / 4);
+    size_t read = fread(std::data(*pCode), 1, size, file);
+    fclose(file);
+
+    return size > 0 && size % 4 == 0 && read == (size_t) size;
+}
+
+uint32_t Pipeline::_AcquireSortId()
+{
+    std::lock_guard<std::mutex> lock(sortIdMutex);
+
+    if (std::empty(freeSortIds))
+        return sortIdCount++;
+
+    /* lowest first, so a handful of live pipelines keeps small ids whatever was reloaded */
+    auto it = std::min_element(freeSortIds.begin(), freeSortIds.end());
+    uint32_t id = *it;
+    freeSortIds.erase(it);
+    
+    return id;
+}
+
+void Pipeline::_ReleaseSortId(uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(sortIdMutex);
+    freeSortIds.push_back(id);
+}
@@ -21,17 +21,93 @@
 #pragma once
 
 #include "VulkanInclude.h"
+#include "LayoutCache.h"
+#include "ShaderReflection.h"
+
+/* the state a graphics pipeline can not reflect from its shaders */
+struct GraphicsPipelineDesc
+{
+    const char* vertexPath = nullptr;
+    const char* fragmentPath = nullptr;
+    /* dynamic rendering, one color attachment per format and no depth */
+    uint32_t colorFormatCount = 0;
+    const VkFormat* pColorFormats = VK_NULL_HANDLE;
+    /*
+     * Per vertex stream at binding 0. Null packs the reflected inputs in location order
+     * without gaps, which matches Vertex for shaders reading position, texcoord and normal.
+     */
+    uint32_t vertexAttributeCount = 0;
+    const VkVertexInputAttributeDescription* pVertexAttributes = VK_NULL_HANDLE;
+    uint32_t vertexStride = 0;
+    /*
+     * Per instance stream at binding 1, the reflected inputs from firstInstanceLocation on
+     * are packed into it in location order. 0 declares no instance stream.
+     */
+    uint32_t instanceStride = 0;
+    uint32_t firstInstanceLocation = 0;
+    /* non-null replaces set 0, e.g. to share a set layout with compute pipelines */
+    uint32_t bindingCount = 0;
+    const VkDescriptorSetLayoutBinding* pBindings = VK_NULL_HANDLE;
+    VkCullModeFlags cullMode = VK_CULL_MODE_NONE;
+};
 
 class Pipeline
 {
+public:
+    /*
+     * compute pipeline from a SPIR-V file. The layout is reflected from the shader, a
+     * non-null pBindings replaces set 0 and the push constants for bindings reflection
+     * can not express (dynamic buffers). Layouts come from the cache, shared by every
+     * pipeline declaring the same interface.
+     */
+    Pipeline(VkDevice _device, LayoutCache* _layoutCache, const char* path,
+             uint32_t bindingCount, const VkDescriptorSetLayoutBinding* pBindings, uint32_t pushConstantSize);
+    /* same from SPIR-V already in memory, name is only used for logging, pSpecializationInfo may be null */
+    Pipeline(VkDevice _device, LayoutCache* _layoutCache, const char* name, size_t codeSize, const uint32_t* pCode,
+             uint32_t bindingCount, const VkDescriptorSetLayoutBinding* pBindings, uint32_t pushConstantSize,
+             const VkSpecializationInfo* pSpecializationInfo = VK_NULL_HANDLE);
+    /*
+     * graphics pipeline from a vertex and a fragment SPIR-V file, viewport and scissor
+     * are dynamic. The layout is the merged reflection of both stages, push constants
+     * included.
+     */
+    Pipeline(VkDevice _device, LayoutCache* _layoutCache, const GraphicsPipelineDesc& desc);
+   ~Pipeline();
+
+    VkPipeline GetVkPipeline() const { return pipeline; }
+    VkPipelineLayout GetPipelineLayout() const { return pipelineLayout; }
+    VkPipelineBindPoint GetBindPoint() const { return bindPoint; }
+    /* binding 1 is a per instance vertex stream */
+    bool HasInstanceStream() const { return instanceStream; }
+    VkDescriptorSetLayout GetDescriptorSetLayout(uint32_t set = 0) const { return set < std::size(descriptorSetLayouts) ? descriptorSetLayouts[set] : VK_NULL_HANDLE; }
+    const ShaderReflection& GetReflection() const { return reflection; }
+    /* small id, the lowest free one at creation, reused once the pipeline is destroyed; the pipeline field of draw sort keys */
+    uint32_t GetSortId() const { return sortId; }
+    
+    /* whole file as SPIR-V words */
+    static bool ReadSpirv(const char* path, Vector<uint32_t>* pCode);
+    
 private:
+    void _CreateCompute(const char* name, size_t codeSize, const uint32_t* pCode,
+                        uint32_t bindingCount, const VkDescriptorSetLayoutBinding* pBindings, uint32_t pushConstantSize,
+                        const VkSpecializationInfo* pSpecializationInfo);
+    void _CreateGraphics(const GraphicsPipelineDesc& desc);
+    /* an attribute for every reflected vertex input, false when the layout misses one */
+    bool _BuildVertexInput(const GraphicsPipelineDesc& desc, Vector<VkVertexInputBindingDescription>* pBindings,
+                           Vector<VkVertexInputAttributeDescription>* pAttributes) const;
+    bool _AcquireLayouts();
+    static uint32_t _AcquireSortId();
+    static void _ReleaseSortId(uint32_t id);
+    
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    LayoutCache* layoutCache = VK_NULL_HANDLE;
+    ShaderReflection reflection;
+    Vector<VkDescriptorSetLayout> descriptorSetLayouts;
     VkPipeline pipeline = VK_NULL_HANDLE;
     VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
     VkPipelineCache pipelineCache = VK_NULL_HANDLE;
-    
-    struct DescriptorSetInfo {
-        VkDescriptorSetLayout descriptorSetLayout;
-        HashMap<String, VkDescriptorSet> descriptorSet;
-    };
-    
+    VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    bool instanceStream = false;
+    uint32_t sortId = _AcquireSortId();
 };
\ No newline at end of file
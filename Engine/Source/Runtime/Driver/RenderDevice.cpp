@@ -55,10 +55,28 @@ RenderDevice::RenderDevice(Window* pWindow) : window(pWindow)
     _InitVMAAllocator();
     _InitVkCommandPool();
     _InitVkDescriptorPool();
+
+    defragmentCommandList = CreateCommandList();
+    defragmenter = MemoryNew<Defragmenter>(device, allocator, defragmentCommandList);
+    imageViewCache = MemoryNew<ImageViewCache>(device);
+    residencyCommandList = CreateCommandList();
+    residencyManager = MemoryNew<ResidencyManager>(device, allocator, residencyCommandList, imageViewCache);
+    uploadBatcher = MemoryNew<UploadBatcher>(this);
+    samplerCache = MemoryNew<SamplerCache>(device);
+    layoutCache = MemoryNew<LayoutCache>(device);
 }
 
 RenderDevice::~RenderDevice()
 {
+    MemoryDelete(layoutCache);
+    MemoryDelete(samplerCache);
+    MemoryDelete(uploadBatcher);
+    MemoryDelete(residencyManager);
+    DestroyCommandLis(residencyCommandList);
+    MemoryDelete(imageViewCache);
+    MemoryDelete(defragmenter);
+    DestroyCommandLis(defragmentCommandList);
+    
     vkDestroyDescriptorPool(device, descriptorPool, VK_NULL_HANDLE);
     vkDestroyCommandPool(device, commandPool, VK_NULL_HANDLE);
     vmaDestroyAllocator(allocator);
@@ -69,14 +87,84 @@ RenderDevice::~RenderDevice()
 
 Buffer* RenderDevice::CreateBuffer(size_t size, VkBufferUsageFlags usage)
 {
-    return MemoryNew<Buffer>(allocator, size, usage);
+    /* downgrade low priority resources first and only oversubscribe when nothing is left */
+    uint32_t heapIndex = Buffer::FindHeapIndex(allocator, size, usage);
+    if (!residencyManager->MakeRoom(heapIndex, size))
+        GOGH_LOGGER_WARN("[Vulkan] Memory budget exhausted, buffer may oversubscribe heap %u, (size=%zu)", heapIndex, size);
+    
+    Buffer* buffer = MemoryNew<Buffer>(allocator, size, usage, VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT);
+
+    if (buffer->GetVkBuffer() == VK_NULL_HANDLE) {
+        MemoryDelete(buffer);
+        buffer = MemoryNew<Buffer>(allocator, size, usage);
+
+        if (buffer->GetVkBuffer() == VK_NULL_HANDLE) {
+            MemoryDelete(buffer);
+            return VK_NULL_HANDLE;
+        }
+    }
+
+    residencyManager->Register(buffer);
+    return buffer;
 }
 
 void RenderDevice::DestroyBuffer(Buffer* buffer)
 {
+    if (buffer == VK_NULL_HANDLE)
+        return;
+    
+    /* an in-flight defragmentation pass may still reference the allocation */
+    defragmenter->Release(buffer);
+    residencyManager->Unregister(buffer);
     MemoryDelete(buffer);
 }
 
+Image* RenderDevice::CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageUsageFlags usage)
+{
+    uint32_t heapIndex = Image::FindHeapIndex(allocator, width, height, mipLevels, format, usage);
+    VkDeviceSize size = Image::GetMemorySize(device, width, height, mipLevels, format, usage);
+    if (!residencyManager->MakeRoom(heapIndex, size))
+        GOGH_LOGGER_WARN("[Vulkan] Memory budget exhausted, image may oversubscribe heap %u, (size=%llu)", heapIndex, (unsigned long long) size);
+    
+    Image* image = MemoryNew<Image>(allocator, width, height, mipLevels, format, usage, VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT);
+
+    if (image->GetVkImage() == VK_NULL_HANDLE) {
+        MemoryDelete(image);
+        image = MemoryNew<Image>(allocator, width, height, mipLevels, format, usage);
+
+        if (image->GetVkImage() == VK_NULL_HANDLE) {
+            MemoryDelete(image);
+            return VK_NULL_HANDLE;
+        }
+    }
+
+    residencyManager->Register(image);
+    return image;
+}
+
+void RenderDevice::DestroyImage(Image* image)
+{
+    if (image == VK_NULL_HANDLE)
+        return;
+    
+    imageViewCache->Purge(image->GetVkImage());
+    residencyManager->Unregister(image);
+    MemoryDelete(image);
+}
+
+VkImageView RenderDevice::AcquireImageView(Image* image, VkImageViewType viewType, const VkImageSubresourceRange& range)
+{
+    residencyManager->MarkUsed(image);
+    return imageViewCache->Acquire(image->GetVkImage(), image->GetFormat(), viewType, range);
+}
+
+void RenderDevice::ReleaseImageView(Image* image, VkImageView imageView)
+{
+    /* the image may be downgraded from now on, least recently released first */
+    residencyManager->MarkUsed(image);
+    imageViewCache->Release(imageView);
+}
+
 CommandList *RenderDevice::CreateCommandList()
 {
     return MemoryNew<CommandList>(device, commandPool, queue);
@@ -87,46 +175,131 @@ void RenderDevice::DestroyCommandLis(CommandList *commandList)
     MemoryDelete(commandList);
 }
 
+Pipeline* RenderDevice::CreateComputePipeline(const char* path, uint32_t bindingCount, const VkDescriptorSetLayoutBinding* pBindings, uint32_t pushConstantSize)
+{
+    Pipeline* pipeline = MemoryNew<Pipeline>(device, layoutCache, path, bindingCount, pBindings, pushConstantSize);
+
+    if (pipeline->GetVkPipeline() == VK_NULL_HANDLE) {
+        MemoryDelete(pipeline);
+        return VK_NULL_HANDLE;
+    }
+
+    return pipeline;
+}
+
+Pipeline* RenderDevice::CreateComputePipeline(const char* name, size_t codeSize, const uint32_t* pCode,
+                                              uint32_t bindingCount, const VkDescriptorSetLayoutBinding* pBindings, uint32_t pushConstantSize,
+                                              const VkSpecializationInfo* pSpecializationInfo)
+{
+    Pipeline* pipeline = MemoryNew<Pipeline>(device, layoutCache, name, codeSize, pCode, bindingCount, pBindings, pushConstantSize, pSpecializationInfo);
+
+    if (pipeline->GetVkPipeline() == VK_NULL_HANDLE) {
+        MemoryDelete(pipeline);
+        return VK_NULL_HANDLE;
+    }
+
+    return pipeline;
+}
+
+Pipeline* RenderDevice::CreateGraphicsPipeline(const GraphicsPipelineDesc& desc)
+{
+    Pipeline* pipeline = MemoryNew<Pipeline>(device, layoutCache, desc);
+
+    if (pipeline->GetVkPipeline() == VK_NULL_HANDLE) {
+        MemoryDelete(pipeline);
+        return VK_NULL_HANDLE;
+    }
+
+    return pipeline;
+}
+
+void RenderDevice::DestroyPipeline(Pipeline* pipeline)
+{
+    MemoryDelete(pipeline);
+}
+
+VkDescriptorSet RenderDevice::AllocateDescriptorSet(VkDescriptorSetLayout descriptorSetLayout)
+{
+    VkResult err;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    
+    VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = descriptorPool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &descriptorSetLayout,
+    };
+
+    err = vkAllocateDescriptorSets(device, &descriptorSetAllocateInfo, &descriptorSet);
+    if (err != VK_SUCCESS) {
+        GOGH_LOGGER_ERROR("[Vulkan] Failed to allocate descriptor set, (VkResult=%d)", err);
+        return VK_NULL_HANDLE;
+    }
+
+    return descriptorSet;
+}
+
+void RenderDevice::FreeDescriptorSet(VkDescriptorSet descriptorSet)
+{
+    if (descriptorSet != VK_NULL_HANDLE)
+        vkFreeDescriptorSets(device, descriptorPool, 1, &descriptorSet);
+}
+
 RenderDevice::SwapchainVkEXT* RenderDevice::CreateSwapchainEXT(SwapchainVkEXT* oldSwapchainEXT)
 {
     VkResult err;
+    VkSurfaceCapabilitiesKHR capabilities;
     std::vector<VkImage> images;
 
     GOGH_LOGGER_DEBUG("[Vulkan] Creating new swapchain (oldSwapchainEXT: %p)", oldSwapchainEXT);
-    
-    SwapchainVkEXT* swapchain = MemoryNew<SwapchainVkEXT>();
 
-    err = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, &swapchain->capabilities);
+    err = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, &capabilities);
     if (err != VK_SUCCESS) {
         GOGH_LOGGER_ERROR("[Vulkan] Failed to get surface capabilities: %d", err);
-        return VK_NULL_HANDLE;
+        return oldSwapchainEXT;
     }
     
     GOGH_LOGGER_DEBUG("[Vulkan] Surface capabilities retrieved successfully");
+
+    if (capabilities.currentExtent.width == 0 || capabilities.currentExtent.height == 0) {
+        GOGH_LOGGER_DEBUG("[Vulkan] Surface extent is zero, window minimized, skip swapchain creation");
+        return oldSwapchainEXT;
+    }
     
-    uint32_t min = swapchain->capabilities.minImageCount;
-    uint32_t max = swapchain->capabilities.maxImageCount;
-    swapchain->minImageCount = std::clamp(min + 1, min, max);
+    SwapchainVkEXT* swapchain = MemoryNew<SwapchainVkEXT>();
+    swapchain->capabilities = capabilities;
+
+    if (oldSwapchainEXT != VK_NULL_HANDLE) {
+        /* keep the frame count stable so the old sync objects can be taken over */
+        swapchain->minImageCount = oldSwapchainEXT->minImageCount;
+        swapchain->format = oldSwapchainEXT->format;
+        swapchain->colorSpace = oldSwapchainEXT->colorSpace;
+    } else {
+        uint32_t min = capabilities.minImageCount;
+        uint32_t max = capabilities.maxImageCount != 0 ? capabilities.maxImageCount : UINT32_MAX;
+        swapchain->minImageCount = std::clamp(min + 1, min, max);
+
+        GOGH_LOGGER_INFO("[Vulkan] Swapchain image count: min=%u, max=%u, using=%u", min, max, swapchain->minImageCount);
+
+        VkSurfaceFormatKHR surfaceFormat;
+        err = VulkanUtils::PickSurfaceFormat(physicalDevice, surface, &surfaceFormat);
+        if (err != VK_SUCCESS) {
+            GOGH_LOGGER_ERROR("[Vulkan] Failed to pick suitable surface format");
+            MemoryDelete(swapchain);
+            return VK_NULL_HANDLE;
+        }
 
-    GOGH_LOGGER_INFO("[Vulkan] Swapchain image count: min=%u, max=%u, using=%u", min, max, swapchain->minImageCount);
+        GOGH_LOGGER_INFO("[Vulkan] Selected surface format: %d, color space: %d", surfaceFormat.format, surfaceFormat.colorSpace);
 
-    swapchain->width = swapchain->capabilities.currentExtent.width;
-    swapchain->height = swapchain->capabilities.currentExtent.height;
+        swapchain->format = surfaceFormat.format;
+        swapchain->colorSpace = surfaceFormat.colorSpace;
+    }
+
+    swapchain->width = capabilities.currentExtent.width;
+    swapchain->height = capabilities.currentExtent.height;
     swapchain->aspect = (float) swapchain->width / swapchain->height;
 
     GOGH_LOGGER_INFO("[Vulkan] Swapchain extent: %ux, %u (aspect: %.2f)", swapchain->width, swapchain->height, swapchain->aspect);
-    
-    VkSurfaceFormatKHR surfaceFormat;
-    err = VulkanUtils::PickSurfaceFormat(physicalDevice, surface, &surfaceFormat);
-    if (err != VK_SUCCESS) {
-        GOGH_LOGGER_ERROR("[Vulkan] Failed to pick suitable surface format");
-        return VK_NULL_HANDLE;
-    }
-    
-    GOGH_LOGGER_INFO("[Vulkan] Selected surface format: %d, color space: %d", surfaceFormat.format, surfaceFormat.colorSpace);
-    
-    swapchain->format = surfaceFormat.format;
-    swapchain->colorSpace = surfaceFormat.colorSpace;
 
     VkSwapchainCreateInfoKHR swapchainCreateInfoKHR = {
         .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
@@ -134,11 +307,11 @@ RenderDevice::SwapchainVkEXT* RenderDevice::CreateSwapchainEXT(SwapchainVkEXT* o
         .minImageCount = swapchain->minImageCount,
         .imageFormat = swapchain->format,
         .imageColorSpace = swapchain->colorSpace,
-        .imageExtent = swapchain->capabilities.currentExtent,
+        .imageExtent = capabilities.currentExtent,
         .imageArrayLayers = 1,
         .imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
         .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
-        .preTransform = swapchain->capabilities.currentTransform,
+        .preTransform = capabilities.currentTransform,
         .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
         .presentMode = VK_PRESENT_MODE_FIFO_KHR,
         .clipped = VK_TRUE,
@@ -149,14 +322,36 @@ RenderDevice::SwapchainVkEXT* RenderDevice::CreateSwapchainEXT(SwapchainVkEXT* o
 
     if (err != VK_SUCCESS) {
         GOGH_LOGGER_ERROR("[Vulkan] Failed to create swapchain: %d", err);
-        return VK_NULL_HANDLE;
+        MemoryDelete(swapchain);
+        return oldSwapchainEXT;
     }
     
     GOGH_LOGGER_DEBUG("[Vulkan] Swapchain created successfully");
 
-
-    if (oldSwapchainEXT != VK_NULL_HANDLE)
-        DestroySwapchainEXT(oldSwapchainEXT);
+    if (oldSwapchainEXT != VK_NULL_HANDLE) {
+        /*
+         * The old images may still be referenced by frames in flight, so instead of
+         * waiting for the queue to drain they are retired and destroyed once every
+         * fence in flight at this point has signaled.
+         */
+        RetiredSwapchainVkEXT retired = {};
+        retired.vkSwapchainKHR = oldSwapchainEXT->vkSwapchainKHR;
+        for (const auto& resource : oldSwapchainEXT->resources)
+            retired.imageViews.push_back(resource.imageView);
+        retired.fences.assign(oldSwapchainEXT->fence.begin(), oldSwapchainEXT->fence.end());
+        retired.signaled.resize(std::size(retired.fences), false);
+        retiredSwapchains.push_back(std::move(retired));
+
+        swapchain->acquireIndexSemaphore = std::move(oldSwapchainEXT->acquireIndexSemaphore);
+        swapchain->renderFinishSemaphore = std::move(oldSwapchainEXT->renderFinishSemaphore);
+        swapchain->fence = std::move(oldSwapchainEXT->fence);
+        swapchain->commandLists = std::move(oldSwapchainEXT->commandLists);
+        swapchain->frame = oldSwapchainEXT->frame;
+
+        GOGH_LOGGER_DEBUG("[Vulkan] Retired old swapchain %p, reuse %zu frame sync objects", retired.vkSwapchainKHR, std::size(swapchain->fence));
+        
+        MemoryDelete(oldSwapchainEXT);
+    }
     
     uint32_t count;
     vkGetSwapchainImagesKHR(device, swapchain->vkSwapchainKHR, &count, VK_NULL_HANDLE);
@@ -164,24 +359,40 @@ RenderDevice::SwapchainVkEXT* RenderDevice::CreateSwapchainEXT(SwapchainVkEXT* o
     images.resize(count);
     vkGetSwapchainImagesKHR(device, swapchain->vkSwapchainKHR, &count, std::data(images));
 
-    swapchain->resources.resize(swapchain->minImageCount);
-    swapchain->acquireIndexSemaphore.resize(swapchain->minImageCount);
-    swapchain->renderFinishSemaphore.resize(swapchain->minImageCount);
-    swapchain->fence.resize(swapchain->minImageCount);
-    swapchain->commandLists.resize(swapchain->minImageCount);
+    swapchain->imageCount = count;
+    swapchain->resources.resize(count);
 
-    GOGH_LOGGER_DEBUG("[Vulkan] Initializing %u swapchain resources...", swapchain->minImageCount);
-    for (int i = 0; i < swapchain->minImageCount; ++i) {
+    VkImageSubresourceRange subresourceRange = {
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+    };
+    
+    GOGH_LOGGER_DEBUG("[Vulkan] Initializing %u swapchain image views...", count);
+    for (uint32_t i = 0; i < count; ++i) {
         swapchain->resources[i].image = images[i];
+        swapchain->resources[i].imageView = imageViewCache->Acquire(images[i], swapchain->format, VK_IMAGE_VIEW_TYPE_2D, subresourceRange);
+    }
 
-        _CreateImageView(swapchain->resources[i].image, swapchain->format, &(swapchain->resources[i].imageView));
-        _CreateSemaphore(&(swapchain->acquireIndexSemaphore[i]));
-        _CreateSemaphore(&(swapchain->renderFinishSemaphore[i]));
-        _CreateFence(&(swapchain->fence[i]));
+    if (std::size(swapchain->fence) != swapchain->minImageCount) {
+        swapchain->acquireIndexSemaphore.resize(swapchain->minImageCount);
+        swapchain->renderFinishSemaphore.resize(swapchain->minImageCount);
+        swapchain->fence.resize(swapchain->minImageCount);
+        swapchain->commandLists.resize(swapchain->minImageCount);
 
-        swapchain->commandLists[i] = CreateCommandList();
+        GOGH_LOGGER_DEBUG("[Vulkan] Initializing %u swapchain frame resources...", swapchain->minImageCount);
+        for (uint32_t i = 0; i < swapchain->minImageCount; ++i) {
+            _CreateSemaphore(&(swapchain->acquireIndexSemaphore[i]));
+            _CreateSemaphore(&(swapchain->renderFinishSemaphore[i]));
+            /* signaled, the first wait on each frame slot must not block */
+            _CreateFence(&(swapchain->fence[i]), VK_FENCE_CREATE_SIGNALED_BIT);
 
-        GOGH_LOGGER_DEBUG("[Vulkan] Initialized swapchain resource %d/%u", i + 1, swapchain->minImageCount);
+            swapchain->commandLists[i] = CreateCommandList();
+
+            GOGH_LOGGER_DEBUG("[Vulkan] Initialized swapchain resource %u/%u", i + 1, swapchain->minImageCount);
+        }
     }
 
     GOGH_LOGGER_DEBUG("[Vulkan] Swapchain created and initialized successfully");
@@ -194,16 +405,18 @@ void RenderDevice::DestroySwapchainEXT(RenderDevice::SwapchainVkEXT *swapchain)
     if (swapchain == VK_NULL_HANDLE)
         return;
 
+    /* only on teardown, resize goes through CreateSwapchainEXT and never idles the queue */
     vkQueueWaitIdle(queue);
+    _CollectRetiredSwapchainEXT(true);
 
     GOGH_LOGGER_DEBUG("[Vulkan] Destroying SwapchainEXT, (SwapchainEXT=%p)", swapchain);
-    
-    for (int i = 0; i < swapchain->minImageCount; ++i) {
-        auto resource = swapchain->resources[i];
 
+    for (const auto& resource : swapchain->resources) {
         if (resource.imageView != VK_NULL_HANDLE)
-            _DestroyImageView(resource.imageView);
-
+            imageViewCache->Release(resource.imageView);
+    }
+    
+    for (size_t i = 0; i < std::size(swapchain->fence); ++i) {
         if (swapchain->acquireIndexSemaphore[i] != VK_NULL_HANDLE)
             _DestroySemaphore(swapchain->acquireIndexSemaphore[i]);
 
@@ -221,47 +434,75 @@ void RenderDevice::DestroySwapchainEXT(RenderDevice::SwapchainVkEXT *swapchain)
     MemoryDelete(swapchain);
 }
 
-VkResult RenderDevice::_CreateImageView(VkImage image, VkFormat format, VkImageView *pImageView)
+VkResult RenderDevice::AcquireNextImageEXT(SwapchainVkEXT* swapchain)
+{
+    VkResult err;
+
+    _CollectRetiredSwapchainEXT(false);
+
+    err = vkAcquireNextImageKHR(device,
+                                swapchain->vkSwapchainKHR,
+                                UINT64_MAX,
+                                swapchain->acquireIndexSemaphore[swapchain->frame],
+                                VK_NULL_HANDLE,
+                                &swapchain->acquireIndex);
+
+    if (err == VK_ERROR_OUT_OF_DATE_KHR || err == VK_SUBOPTIMAL_KHR) {
+        GOGH_LOGGER_DEBUG("[Vulkan] Swapchain out of date on acquire, (VkResult=%d)", err);
+        swapchain->outOfDate = true;
+    }
+
+    return err;
+}
+
+VkResult RenderDevice::QueuePresentEXT(SwapchainVkEXT* swapchain)
 {
     VkResult err;
     
-    VkImageViewCreateInfo imageViewCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-        .image = image,
-        .viewType = VK_IMAGE_VIEW_TYPE_2D,
-        .format = format,
-        .components = {
-            .r = VK_COMPONENT_SWIZZLE_IDENTITY,
-            .g = VK_COMPONENT_SWIZZLE_IDENTITY,
-            .b = VK_COMPONENT_SWIZZLE_IDENTITY,
-            .a = VK_COMPONENT_SWIZZLE_IDENTITY,
-        },
-        .subresourceRange = {
-            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-            .baseMipLevel = 0,
-            .levelCount = 1,
-            .baseArrayLayer = 0,
-            .layerCount = 1
-        }
+    VkPresentInfoKHR presentInfo = {
+        .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+        .waitSemaphoreCount = 1,
+        .pWaitSemaphores = &swapchain->renderFinishSemaphore[swapchain->frame],
+        .swapchainCount = 1,
+        .pSwapchains = &swapchain->vkSwapchainKHR,
+        .pImageIndices = &swapchain->acquireIndex,
     };
-    
-    err = vkCreateImageView(device, &imageViewCreateInfo, VK_NULL_HANDLE, pImageView);
-    
-    if (err != VK_SUCCESS) {
-        GOGH_LOGGER_WARN("[Vulkan] Failed to creating VkImageView, VkImage=%p, VkFormat=%d", image, format);
-        goto TAG_CREATE_IMAGE_VIEW_END;
+
+    err = vkQueuePresentKHR(queue, &presentInfo);
+
+    if (err == VK_ERROR_OUT_OF_DATE_KHR || err == VK_SUBOPTIMAL_KHR || window->IsFramebufferResized()) {
+        GOGH_LOGGER_DEBUG("[Vulkan] Swapchain out of date on present, (VkResult=%d)", err);
+        swapchain->outOfDate = true;
     }
 
-    GOGH_LOGGER_DEBUG("[Vulkan] Creating VkImageView successful, (VkImage=%p, VkFormat=%d, VkImageView=%p)", image, format, *pImageView);
-    
-TAG_CREATE_IMAGE_VIEW_END:
     return err;
 }
 
-void RenderDevice::_DestroyImageView(VkImageView imageView)
+void RenderDevice::_CollectRetiredSwapchainEXT(bool wait)
 {
-    GOGH_LOGGER_DEBUG("[Vulkan] Destroying VkImageView %p", imageView);
-    vkDestroyImageView(device, imageView, VK_NULL_HANDLE);
+    for (size_t i = 0; i < std::size(retiredSwapchains);) {
+        RetiredSwapchainVkEXT& retired = retiredSwapchains[i];
+
+        bool complete = true;
+        for (size_t j = 0; j < std::size(retired.fences); ++j) {
+            if (!wait && !retired.signaled[j])
+                retired.signaled[j] = vkGetFenceStatus(device, retired.fences[j]) == VK_SUCCESS;
+            complete &= wait || retired.signaled[j];
+        }
+
+        if (!complete) {
+            ++i;
+            continue;
+        }
+
+        GOGH_LOGGER_DEBUG("[Vulkan] Destroying retired swapchain %p", retired.vkSwapchainKHR);
+        
+        for (VkImageView imageView : retired.imageViews)
+            imageViewCache->Release(imageView);
+        vkDestroySwapchainKHR(device, retired.vkSwapchainKHR, VK_NULL_HANDLE);
+
+        retiredSwapchains.erase(retiredSwapchains.begin() + i);
+    }
 }
 
 VkResult RenderDevice::_CreateSemaphore(VkSemaphore *pSemaphore)
@@ -291,12 +532,13 @@ void RenderDevice::_DestroySemaphore(VkSemaphore semaphore)
     vkDestroySemaphore(device, semaphore, VK_NULL_HANDLE);
 }
 
-VkResult RenderDevice::_CreateFence(VkFence *pFence)
+VkResult RenderDevice::_CreateFence(VkFence *pFence, VkFenceCreateFlags flags)
 {
     VkResult err;
     
     VkFenceCreateInfo fenceCreateInfo = {
         .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .flags = flags,
     };
 
     err = vkCreateFence(device, &fenceCreateInfo, VK_NULL_HANDLE, pFence);
@@ -395,9 +637,8 @@ void RenderDevice::_InitVKDevice()
 
     physicalDevice = VulkanUtils::PickDiscreteDevice(devices);
 
-    VkPhysicalDeviceProperties properties;
-    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
-    GOGH_LOGGER_INFO("[Vulkan] Use GPU %s", properties.deviceName);
+    vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+    GOGH_LOGGER_INFO("[Vulkan] Use GPU %s", physicalDeviceProperties.deviceName);
 
     float priorities = 1.0f;
 
@@ -416,9 +657,40 @@ void RenderDevice::_InitVKDevice()
         "VK_EXT_dynamic_rendering_unused_attachments"
     };
 
+    memoryBudgetEXT = VulkanUtils::IsDeviceExtensionSupported(physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (memoryBudgetEXT)
+        extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+    GOGH_LOGGER_INFO("[Vulkan] %s: %s", VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, memoryBudgetEXT ? "enabled" : "not supported");
+
+    VkPhysicalDeviceVulkan12Features supportedVulkan12Features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+    };
+
+    VkPhysicalDeviceFeatures2 supportedFeatures = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext = &supportedVulkan12Features,
+    };
+
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &supportedFeatures);
+
+    drawIndirectCount = supportedVulkan12Features.drawIndirectCount && supportedFeatures.features.drawIndirectFirstInstance;
+    GOGH_LOGGER_INFO("[Vulkan] drawIndirectCount: %s", drawIndirectCount ? "enabled" : "not supported");
+
+    VkPhysicalDeviceFeatures enabledFeatures = {
+        .multiDrawIndirect = supportedFeatures.features.multiDrawIndirect,
+        .drawIndirectFirstInstance = drawIndirectCount ? VK_TRUE : VK_FALSE,
+    };
+    
+    VkPhysicalDeviceVulkan12Features vulkan12Features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .pNext = nullptr,
+        .drawIndirectCount = drawIndirectCount ? VK_TRUE : VK_FALSE,
+    };
+    
     VkPhysicalDeviceDynamicRenderingUnusedAttachmentsFeaturesEXT unusedAttachmentsFeature{
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_UNUSED_ATTACHMENTS_FEATURES_EXT,
-        .pNext = nullptr,
+        .pNext = &vulkan12Features,
         .dynamicRenderingUnusedAttachments = VK_TRUE
     };
 
@@ -435,6 +707,7 @@ void RenderDevice::_InitVKDevice()
         .pQueueCreateInfos = &deviceQueueCreateInfo,
         .enabledExtensionCount = (uint32_t) std::size(extensions),
         .ppEnabledExtensionNames = std::data(extensions),
+        .pEnabledFeatures = &enabledFeatures,
     };
 
     err = vkCreateDevice(physicalDevice, &deviceCreateInfo, VK_NULL_HANDLE, &device);
@@ -461,10 +734,12 @@ void RenderDevice::_InitVMAAllocator()
     };
     
     VmaAllocatorCreateInfo allocatorCreateInfo = {
+        .flags = memoryBudgetEXT ? (VmaAllocatorCreateFlags) VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT : 0u,
         .physicalDevice = physicalDevice,
         .device = device,
         .pVulkanFunctions = &functions,
         .instance = instance,
+        .vulkanApiVersion = std::min(apiVersion, physicalDeviceProperties.apiVersion),
     };
 
     err = vmaCreateAllocator(&allocatorCreateInfo, &allocator);
@@ -25,6 +25,14 @@
 
 #include "CommandList.h"
 #include "Buffer.h"
+#include "Image.h"
+#include "Pipeline.h"
+#include "Defragmenter.h"
+#include "ResidencyManager.h"
+#include "UploadBatcher.h"
+#include "SamplerCache.h"
+#include "ImageViewCache.h"
+#include "LayoutCache.h"
 
 #include <Vector.h>
 
@@ -33,11 +41,40 @@ class RenderDevice
 public:
     RenderDevice(Window* pWindow);
    ~RenderDevice();
+
+    VkDevice GetDevice() const { return device; }
+    VmaAllocator GetAllocator() const { return allocator; }
+    const VkPhysicalDeviceProperties& GetPhysicalDeviceProperties() const { return physicalDeviceProperties; }
     
     Buffer* CreateBuffer(size_t size, VkBufferUsageFlags usage);
     void DestroyBuffer(Buffer* buffer);
+    Image* CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageUsageFlags usage);
+    void DestroyImage(Image* image);
+    /* views of resident images, binding through these stamps the image as used for the residency manager */
+    VkImageView AcquireImageView(Image* image, VkImageViewType viewType, const VkImageSubresourceRange& range);
+    void ReleaseImageView(Image* image, VkImageView imageView);
     CommandList* CreateCommandList();
     void DestroyCommandLis(CommandList* commandList);
+    /* pBindings null takes the whole layout from reflecting the shader */
+    Pipeline* CreateComputePipeline(const char* path, uint32_t bindingCount, const VkDescriptorSetLayoutBinding* pBindings, uint32_t pushConstantSize);
+    /* thread safe, the shader library builds reloaded pipelines on job workers */
+    Pipeline* CreateComputePipeline(const char* name, size_t codeSize, const uint32_t* pCode,
+                                    uint32_t bindingCount, const VkDescriptorSetLayoutBinding* pBindings, uint32_t pushConstantSize,
+                                    const VkSpecializationInfo* pSpecializationInfo = VK_NULL_HANDLE);
+    Pipeline* CreateGraphicsPipeline(const GraphicsPipelineDesc& desc);
+    void DestroyPipeline(Pipeline* pipeline);
+    VkDescriptorSet AllocateDescriptorSet(VkDescriptorSetLayout descriptorSetLayout);
+    void FreeDescriptorSet(VkDescriptorSet descriptorSet);
+
+    /* vkCmdDrawIndexedIndirectCount with firstInstance, required by the GPU driven path */
+    bool IsDrawIndirectCountSupported() const { return drawIndirectCount; }
+
+    Defragmenter* GetDefragmenter() { return defragmenter; }
+    ResidencyManager* GetResidencyManager() { return residencyManager; }
+    UploadBatcher* GetUploadBatcher() { return uploadBatcher; }
+    SamplerCache* GetSamplerCache() { return samplerCache; }
+    ImageViewCache* GetImageViewCache() { return imageViewCache; }
+    LayoutCache* GetLayoutCache() { return layoutCache; }
     
     struct SwapchainVkEXT {
         VkSwapchainKHR vkSwapchainKHR = VK_NULL_HANDLE;
@@ -50,27 +87,39 @@ public:
             VkImageView imageView = VK_NULL_HANDLE;
         };
         Vector<SwapchainResourceVkEXT> resources;
+        uint32_t imageCount = 0;
         uint32_t width = 0;
         uint32_t height = 0;
         uint32_t acquireIndex = 0;
         uint32_t frame = 0;
         float aspect = 0.0f;
+        bool outOfDate = false;
         std::vector<VkSemaphore> acquireIndexSemaphore;
         std::vector<VkSemaphore> renderFinishSemaphore;
         std::vector<VkFence> fence;
         std::vector<CommandList*> commandLists;
     };
 
+    /*
+     * When oldSwapchainEXT is given the new swapchain is created with it as
+     * oldSwapchain, takes over its semaphores, fences and command lists, and the
+     * old images are retired until the in-flight fences signal, so a resize never
+     * idles the queue. Returns oldSwapchainEXT unchanged when the surface has a
+     * zero extent (minimized window).
+     */
     SwapchainVkEXT* CreateSwapchainEXT(SwapchainVkEXT* oldSwapchainEXT);
     void DestroySwapchainEXT(SwapchainVkEXT* swapchain);
 
+    /* Both set swapchain->outOfDate on VK_ERROR_OUT_OF_DATE_KHR / VK_SUBOPTIMAL_KHR or a window resize */
+    VkResult AcquireNextImageEXT(SwapchainVkEXT* swapchain);
+    VkResult QueuePresentEXT(SwapchainVkEXT* swapchain);
+
 private:
-    VkResult _CreateImageView(VkImage image, VkFormat formamt, VkImageView* pImageView);
-    void _DestroyImageView(VkImageView imageView);
     VkResult _CreateSemaphore(VkSemaphore* pSemaphore);
     void _DestroySemaphore(VkSemaphore semaphore);
-    VkResult _CreateFence(VkFence* pFence);
+    VkResult _CreateFence(VkFence* pFence, VkFenceCreateFlags flags = 0);
     void _DestroyFence(VkFence fence);
+    void _CollectRetiredSwapchainEXT(bool wait);
     
 private:
     void _InitVkInstance();
@@ -87,10 +136,29 @@ private:
     VkInstance instance = VK_NULL_HANDLE;
     VkSurfaceKHR surface = VK_NULL_HANDLE;
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkPhysicalDeviceProperties physicalDeviceProperties = {};
+    bool memoryBudgetEXT = false;
+    bool drawIndirectCount = false;
     uint32_t queueFamilyIndex = 0;
     VkQueue queue = VK_NULL_HANDLE;
     VkDevice device = VK_NULL_HANDLE;
     VmaAllocator allocator = VK_NULL_HANDLE;
     VkCommandPool commandPool = VK_NULL_HANDLE;
     VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    CommandList* defragmentCommandList = VK_NULL_HANDLE;
+    Defragmenter* defragmenter = VK_NULL_HANDLE;
+    CommandList* residencyCommandList = VK_NULL_HANDLE;
+    ResidencyManager* residencyManager = VK_NULL_HANDLE;
+    UploadBatcher* uploadBatcher = VK_NULL_HANDLE;
+    SamplerCache* samplerCache = VK_NULL_HANDLE;
+    ImageViewCache* imageViewCache = VK_NULL_HANDLE;
+    LayoutCache* layoutCache = VK_NULL_HANDLE;
+
+    struct RetiredSwapchainVkEXT {
+        VkSwapchainKHR vkSwapchainKHR = VK_NULL_HANDLE;
+        Vector<VkImageView> imageViews;
+        Vector<VkFence> fences;
+        Vector<bool> signaled;
+    };
+    Vector<RetiredSwapchainVkEXT> retiredSwapchains;
 };
\ No newline at end of file
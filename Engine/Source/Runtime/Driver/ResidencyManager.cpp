@@ -0,0 +1,287 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "ResidencyManager.h"
+#include "CommandList.h"
+#include "ImageViewCache.h"
+
+// std
+#include <stdlib.h>
+
+/* start evicting above high, stop below low */
+#define RESIDENCY_HIGH_WATERMARK 0.90f
+#define RESIDENCY_LOW_WATERMARK  0.80f
+
+/* resources used in the last N frames may still be read by the GPU */
+#define RESIDENCY_IN_FLIGHT_FRAMES 4
+
+ResidencyManager::ResidencyManager(VkDevice _device, VmaAllocator _allocator, CommandList* _commandList, ImageViewCache* _imageViewCache)
+    : device(_device), allocator(_allocator), commandList(_commandList), imageViewCache(_imageViewCache)
+{
+    VkResult err;
+    
+    VkFenceCreateInfo fenceCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+    };
+
+    err = vkCreateFence(device, &fenceCreateInfo, VK_NULL_HANDLE, &fence);
+    if (err != VK_SUCCESS)
+        GOGH_LOGGER_WARN("[Vulkan] Failed to create downgrade fence, (ResidencyManager: %p)", this);
+    
+    const VkPhysicalDeviceMemoryProperties* properties;
+    vmaGetMemoryProperties(allocator, &properties);
+    heapCount = properties->memoryHeapCount;
+
+    const char* cap = getenv("GOGH_MEMORY_BUDGET_CAP_MB");
+    if (cap != VK_NULL_HANDLE) {
+        budgetCap = (VkDeviceSize) strtoull(cap, VK_NULL_HANDLE, 10) * 1024 * 1024;
+        GOGH_LOGGER_WARN("[Vulkan] Memory budget capped to %llu bytes per heap", (unsigned long long) budgetCap);
+    }
+
+    _FetchBudgets();
+    
+    GOGH_LOGGER_DEBUG("[Vulkan] Create residency manager successful, (heapCount=%u, ResidencyManager: %p)", heapCount, this);
+}
+
+ResidencyManager::~ResidencyManager()
+{
+    _SubmitDowngrades();
+    _CollectDowngrades(true);
+    
+    vkDestroyFence(device, fence, VK_NULL_HANDLE);
+    GOGH_LOGGER_DEBUG("[Vulkan] Destroying residency manager, (ResidencyManager: %p)", this);
+}
+
+void ResidencyManager::Register(ResidentResource* resource)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    resource->MarkUsed(frameIndex);
+    resources.push_back(resource);
+}
+
+void ResidencyManager::Unregister(ResidentResource* resource)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    resources.remove(resource);
+}
+
+void ResidencyManager::MarkUsed(ResidentResource* resource)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    resource->MarkUsed(frameIndex);
+}
+
+void ResidencyManager::Update()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    _CollectDowngrades(false);
+    
+    ++frameIndex;
+    vmaSetCurrentFrameIndex(allocator, (uint32_t) frameIndex);
+
+    _FetchBudgets();
+
+    bool pressure = false;
+    for (uint32_t i = 0; i < heapCount; ++i) {
+        HeapState& heap = heaps[i];
+        VkDeviceSize excess = heap.requested;
+
+        if ((float) heap.usage > RESIDENCY_HIGH_WATERMARK * (float) heap.budget) {
+            pressure = true;
+            
+            VkDeviceSize target = (VkDeviceSize) (RESIDENCY_LOW_WATERMARK * (float) heap.budget);
+            excess = std::max(excess, heap.usage - target);
+        }
+
+        /* the previous downgrades still hold their old memory, try again once it is freed */
+        if (excess == 0 || downgradesInFlight)
+            continue;
+
+        VkDeviceSize freed = _Evict(i, excess);
+        heap.requested = 0;
+
+        GOGH_LOGGER_DEBUG("[Vulkan] Heap %u over budget, (usage=%llu, budget=%llu, freed=%llu)",
+                          i, (unsigned long long) heap.usage, (unsigned long long) heap.budget, (unsigned long long) freed);
+    }
+
+    if (pressure)
+        ++stats.pressureFrames;
+
+    _SubmitDowngrades();
+}
+
+bool ResidencyManager::MakeRoom(uint32_t heapIndex, VkDeviceSize size)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    bool fits = true;
+
+    _FetchBudgets();
+    
+    for (uint32_t i = 0; i < heapCount; ++i) {
+        if (heapIndex != UINT32_MAX && heapIndex != i)
+            continue;
+
+        HeapState& heap = heaps[i];
+        if (heap.usage + size <= heap.budget)
+            continue;
+
+        /* downgrades are recorded and submitted on the frame thread */
+        heap.requested = std::max(heap.requested, heap.usage + size - heap.budget);
+        fits = false;
+    }
+
+    return fits;
+}
+
+ResidencyManager::HeapState ResidencyManager::GetHeapState(uint32_t heapIndex)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return heaps[heapIndex];
+}
+
+ResidencyManager::Stats ResidencyManager::GetStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void ResidencyManager::_FetchBudgets()
+{
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(allocator, budgets);
+
+    for (uint32_t i = 0; i < heapCount; ++i) {
+        heaps[i].usage = budgets[i].usage;
+        heaps[i].budget = budgetCap != 0 ? std::min(budgets[i].budget, budgetCap) : budgets[i].budget;
+    }
+}
+
+VkDeviceSize ResidencyManager::_Evict(uint32_t heapIndex, VkDeviceSize target)
+{
+    VkDeviceSize freed = 0;
+
+    candidates.clear();
+    for (ResidentResource* resource : resources) {
+        if (resource->GetResidentHeap() != heapIndex)
+            continue;
+
+        if (resource->GetResidencyPriority() == RESIDENCY_PRIORITY_CRITICAL)
+            continue;
+
+        if (resource->GetLastUsedFrame() + RESIDENCY_IN_FLIGHT_FRAMES > frameIndex)
+            continue;
+
+        candidates.push_back(resource);
+    }
+
+    /* lowest priority first, least recently used first within the same priority */
+    std::sort(candidates.begin(), candidates.end(), [](const ResidentResource* a, const ResidentResource* b) {
+        if (a->GetResidencyPriority() != b->GetResidencyPriority())
+            return a->GetResidencyPriority() < b->GetResidencyPriority();
+        return a->GetLastUsedFrame() < b->GetLastUsedFrame();
+    });
+
+    /* one level per resource and round, so high mips go before anything is dropped completely */
+    if (!std::empty(candidates) && !recording) {
+        commandList->Reset();
+        commandList->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        recording = true;
+    }
+    
+    bool progress = true;
+    while (freed < target && progress) {
+        progress = false;
+        
+        for (ResidentResource* resource : candidates) {
+            VkDeviceSize bytes = resource->Downgrade(commandList, imageViewCache, recordedRetired);
+            if (bytes == 0)
+                continue;
+
+            freed += bytes;
+            progress = true;
+            ++stats.downgrades;
+
+            if (freed >= target)
+                break;
+        }
+    }
+
+    stats.bytesEvicted += freed;
+    heaps[heapIndex].usage -= std::min(freed, heaps[heapIndex].usage);
+
+    return freed;
+}
+
+void ResidencyManager::_SubmitDowngrades()
+{
+    VkResult err;
+    
+    if (!recording)
+        return;
+
+    commandList->End();
+    recording = false;
+
+    if (std::empty(recordedRetired))
+        return;
+
+    vkResetFences(device, 1, &fence);
+    err = commandList->Submit(0, VK_NULL_HANDLE, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, fence);
+
+    if (err != VK_SUCCESS) {
+        /* nothing reads the old memory, only the smaller copies stay undefined */
+        GOGH_LOGGER_ERROR("[Vulkan] Failed to submit downgrade copies, (VkResult=%d, resources=%zu)", err, std::size(recordedRetired));
+        
+        for (const auto& retired : recordedRetired) {
+            imageViewCache->Purge(retired.image);
+            vmaDestroyImage(allocator, retired.image, retired.allocation);
+        }
+        
+        recordedRetired.clear();
+        return;
+    }
+
+    inFlightRetired = std::move(recordedRetired);
+    recordedRetired.clear();
+    downgradesInFlight = true;
+}
+
+void ResidencyManager::_CollectDowngrades(bool wait)
+{
+    if (!downgradesInFlight)
+        return;
+
+    if (wait)
+        vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+    else if (vkGetFenceStatus(device, fence) != VK_SUCCESS)
+        return;
+
+    for (const auto& retired : inFlightRetired) {
+        imageViewCache->Purge(retired.image);
+        vmaDestroyImage(allocator, retired.image, retired.allocation);
+    }
+
+    inFlightRetired.clear();
+    downgradesInFlight = false;
+}
\ No newline at end of file
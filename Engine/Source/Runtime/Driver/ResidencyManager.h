@@ -0,0 +1,162 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "VulkanInclude.h"
+
+// std
+#include <mutex>
+#include <stdint.h>
+
+enum ResidencyPriority : uint8_t
+{
+    RESIDENCY_PRIORITY_STREAMING = 0,
+    RESIDENCY_PRIORITY_NORMAL = 128,
+    RESIDENCY_PRIORITY_CRITICAL = 255,
+};
+
+class CommandList;
+class ImageViewCache;
+
+/* memory a downgrade replaced, freed once the GPU finished the downgrade copies */
+struct ResidencyRetiredVkEXT
+{
+    VkImage image = VK_NULL_HANDLE;
+    VmaAllocation allocation = VK_NULL_HANDLE;
+};
+
+/*
+ * Everything the residency manager can see. Resources are sorted by priority and
+ * last used frame under memory pressure, Downgrade() is then called to drop the
+ * least important part of the resource (e.g. the top mip of a texture).
+ */
+class ResidentResource
+{
+public:
+    virtual ~ResidentResource() = default;
+
+    virtual uint32_t GetResidentHeap() const = 0;
+    virtual VkDeviceSize GetResidentSize() const = 0;
+
+    /*
+     * Records the copies that move the resource into smaller memory into commandList and
+     * appends the memory they replace to retired. Returns the freed bytes, 0 when the
+     * resource can not be downgraded any more or is pinned by views held in imageViewCache.
+     */
+    virtual VkDeviceSize Downgrade(CommandList*, ImageViewCache*, Vector<ResidencyRetiredVkEXT>&) { return 0; }
+
+    void SetResidencyPriority(uint8_t priority) { residencyPriority = priority; }
+    uint8_t GetResidencyPriority() const { return residencyPriority; }
+
+    void MarkUsed(uint64_t frame) { lastUsedFrame = frame; }
+    uint64_t GetLastUsedFrame() const { return lastUsedFrame; }
+
+private:
+    uint8_t residencyPriority = RESIDENCY_PRIORITY_NORMAL;
+    uint64_t lastUsedFrame = 0;
+};
+
+/*
+ * Tracks VMA heap budgets (VK_EXT_memory_budget when available) once per frame and
+ * downgrades low priority resources before the heap runs over its budget. Downgrade
+ * copies are submitted by Update() with one fence, the replaced memory is freed on a
+ * later Update() once the fence signaled, so nothing waits on the GPU. Budgets
+ * can be capped artificially with SetBudgetCap() or GOGH_MEMORY_BUDGET_CAP_MB to
+ * exercise the eviction path on large GPUs.
+ *
+ * Resources are registered from whatever thread creates them (streaming callbacks on
+ * the main thread) while Update() runs on the thread that submits frames, so the
+ * resource list is guarded by a mutex.
+ */
+class ResidencyManager
+{
+public:
+    struct HeapState {
+        VkDeviceSize budget = 0;
+        VkDeviceSize usage = 0;
+        /* bytes MakeRoom() asked for, evicted by the next Update() */
+        VkDeviceSize requested = 0;
+    };
+
+    struct Stats {
+        uint64_t pressureFrames = 0;
+        uint64_t downgrades = 0;
+        VkDeviceSize bytesEvicted = 0;
+    };
+    
+public:
+    ResidencyManager(VkDevice _device, VmaAllocator _allocator, CommandList* _commandList, ImageViewCache* _imageViewCache);
+   ~ResidencyManager();
+
+    void Register(ResidentResource* resource);
+    void Unregister(ResidentResource* resource);
+
+    /* any thread, stamps the current frame on the resource so it is evicted last */
+    void MarkUsed(ResidentResource* resource);
+
+    /* once per frame on the thread that submits frames, refresh heap budgets and relieve pressure */
+    void Update();
+
+    /*
+     * Any thread, false when size bytes do not fit into heap (UINT32_MAX for every heap)
+     * right now. What is missing is evicted by the next Update().
+     */
+    bool MakeRoom(uint32_t heapIndex, VkDeviceSize size);
+    
+    void SetBudgetCap(VkDeviceSize cap) { budgetCap = cap; }
+    
+    uint64_t GetFrameIndex() const { return frameIndex; }
+    uint32_t GetHeapCount() const { return heapCount; }
+    HeapState GetHeapState(uint32_t heapIndex);
+    Stats GetStats();
+    
+private:
+    void _FetchBudgets();
+    VkDeviceSize _Evict(uint32_t heapIndex, VkDeviceSize target);
+    void _SubmitDowngrades();
+    /* frees the memory of the submitted downgrades once their fence signaled */
+    void _CollectDowngrades(bool wait);
+    
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    VmaAllocator allocator = VK_NULL_HANDLE;
+    CommandList* commandList = VK_NULL_HANDLE;
+    ImageViewCache* imageViewCache = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+    std::mutex mutex;
+    uint32_t heapCount = 0;
+    HeapState heaps[VK_MAX_MEMORY_HEAPS] = {};
+    VkDeviceSize budgetCap = 0;
+    uint64_t frameIndex = 0;
+
+    Vector<ResidentResource*> resources;
+    Vector<ResidentResource*> candidates;
+
+    /* commandList is open and holds downgrades not submitted yet */
+    bool recording = false;
+    /* a downgrade submission is waiting for its fence, no new one is recorded meanwhile */
+    bool downgradesInFlight = false;
+    Vector<ResidencyRetiredVkEXT> recordedRetired;
+    Vector<ResidencyRetiredVkEXT> inFlightRetired;
+    
+    Stats stats = {};
+};
\ No newline at end of file
@@ -0,0 +1,131 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "SamplerCache.h"
+
+static SamplerKey _MakeKey(const VkSamplerCreateInfo& createInfo)
+{
+    return {
+        .flags = createInfo.flags,
+        .magFilter = createInfo.magFilter,
+        .minFilter = createInfo.minFilter,
+        .mipmapMode = createInfo.mipmapMode,
+        .addressModeU = createInfo.addressModeU,
+        .addressModeV = createInfo.addressModeV,
+        .addressModeW = createInfo.addressModeW,
+        .mipLodBias = createInfo.mipLodBias,
+        .anisotropyEnable = createInfo.anisotropyEnable,
+        /* ignored by the driver without anisotropy, must not split the key either */
+        .maxAnisotropy = createInfo.anisotropyEnable ? createInfo.maxAnisotropy : 1.0f,
+        .compareEnable = createInfo.compareEnable,
+        .compareOp = createInfo.compareEnable ? createInfo.compareOp : VK_COMPARE_OP_NEVER,
+        .minLod = createInfo.minLod,
+        .maxLod = createInfo.maxLod,
+        .borderColor = createInfo.borderColor,
+        .unnormalizedCoordinates = createInfo.unnormalizedCoordinates,
+    };
+}
+
+SamplerCache::SamplerCache(VkDevice _device) : device(_device)
+{
+    GOGH_LOGGER_DEBUG("[Vulkan] Create sampler cache successful, (SamplerCache: %p)", this);
+}
+
+SamplerCache::~SamplerCache()
+{
+    if (!std::empty(samplers))
+        GOGH_LOGGER_WARN("[Vulkan] Sampler cache destroyed with %zu samplers still acquired, (SamplerCache: %p)", std::size(samplers), this);
+
+    for (const auto& [key, entry] : samplers)
+        vkDestroySampler(device, entry.sampler, VK_NULL_HANDLE);
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Destroying sampler cache, %llu creates for %llu acquires, (SamplerCache: %p)",
+                      (unsigned long long) stats.creates, (unsigned long long) (stats.creates + stats.hits), this);
+}
+
+VkSampler SamplerCache::Acquire(const VkSamplerCreateInfo& createInfo)
+{
+    VkResult err;
+
+    if (createInfo.pNext != VK_NULL_HANDLE) {
+        GOGH_LOGGER_ERROR("[Vulkan] Sampler cache does not support VkSamplerCreateInfo::pNext, (SamplerCache: %p)", this);
+        return VK_NULL_HANDLE;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    SamplerKey key = _MakeKey(createInfo);
+    Entry& entry = samplers[key];
+
+    if (entry.sampler != VK_NULL_HANDLE) {
+        ++entry.refCount;
+        ++stats.hits;
+        return entry.sampler;
+    }
+
+    err = vkCreateSampler(device, &createInfo, VK_NULL_HANDLE, &entry.sampler);
+
+    if (err != VK_SUCCESS) {
+        GOGH_LOGGER_ERROR("[Vulkan] Failed to create VkSampler, (VkResult=%d, samplers=%u)", err, stats.samplers);
+        samplers.erase(key);
+        return VK_NULL_HANDLE;
+    }
+
+    entry.refCount = 1;
+    keys[entry.sampler] = key;
+    ++stats.samplers;
+    ++stats.creates;
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Create VkSampler successful, (VkSampler=%p, filter=%d/%d, addressMode=%d, samplers=%u)",
+                      entry.sampler, createInfo.magFilter, createInfo.minFilter, createInfo.addressModeU, stats.samplers);
+
+    return entry.sampler;
+}
+
+void SamplerCache::Release(VkSampler sampler)
+{
+    if (sampler == VK_NULL_HANDLE)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    auto it = keys.find(sampler);
+
+    if (it == keys.end()) {
+        GOGH_LOGGER_WARN("[Vulkan] Release of a VkSampler not owned by the cache, (VkSampler=%p)", sampler);
+        return;
+    }
+
+    Entry& entry = samplers[it->second];
+    if (--entry.refCount > 0)
+        return;
+
+    vkDestroySampler(device, sampler, VK_NULL_HANDLE);
+    samplers.erase(it->second);
+    keys.erase(it);
+    --stats.samplers;
+}
+
+SamplerCache::Stats SamplerCache::GetStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
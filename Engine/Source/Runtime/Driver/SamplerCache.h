@@ -0,0 +1,107 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "VulkanInclude.h"
+#include "Core/Hash.h"
+
+#include <HashMap.h>
+
+// std
+#include <mutex>
+#include <string.h>
+
+/* every VkSamplerCreateInfo field but sType and pNext, 32 bit each so the bytes are the key */
+struct SamplerKey
+{
+    VkSamplerCreateFlags flags;
+    VkFilter magFilter;
+    VkFilter minFilter;
+    VkSamplerMipmapMode mipmapMode;
+    VkSamplerAddressMode addressModeU;
+    VkSamplerAddressMode addressModeV;
+    VkSamplerAddressMode addressModeW;
+    float mipLodBias;
+    VkBool32 anisotropyEnable;
+    float maxAnisotropy;
+    VkBool32 compareEnable;
+    VkCompareOp compareOp;
+    float minLod;
+    float maxLod;
+    VkBorderColor borderColor;
+    VkBool32 unnormalizedCoordinates;
+
+    bool operator==(const SamplerKey& other) const { return memcmp(this, &other, sizeof(SamplerKey)) == 0; }
+};
+
+static_assert(sizeof(SamplerKey) == 64, "SamplerKey must not have padding");
+
+template<>
+struct std::hash<SamplerKey>
+{
+    size_t operator()(const SamplerKey& key) const
+      {
+        return (size_t) Hash64(&key, sizeof(SamplerKey));
+      }
+};
+
+/*
+ * Shared VkSampler objects. Textures ask for the sampler state they need and get the
+ * one sampler already created for it, so a scene with thousands of textures holds a
+ * handful of samplers, well under maxSamplerAllocationCount, and pays one create per
+ * distinct state. Samplers are reference counted and destroyed with the last Release(),
+ * which like any destroy must wait until the GPU no longer uses them.
+ *
+ * Thread safe, materials acquire samplers from loader threads.
+ */
+class SamplerCache
+{
+public:
+    struct Stats {
+        uint32_t samplers = 0;
+        uint64_t creates = 0;
+        uint64_t hits = 0;
+    };
+
+public:
+    SamplerCache(VkDevice _device);
+   ~SamplerCache();
+
+    /* pNext chains (reduction mode, custom border color) are not supported */
+    VkSampler Acquire(const VkSamplerCreateInfo& createInfo);
+    void Release(VkSampler sampler);
+
+    Stats GetStats();
+
+private:
+    struct Entry {
+        VkSampler sampler = VK_NULL_HANDLE;
+        uint32_t refCount = 0;
+    };
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    std::mutex mutex;
+    HashMap<SamplerKey, Entry> samplers;
+    HashMap<VkSampler, SamplerKey> keys;
+    Stats stats = {};
+};
@@ -0,0 +1,488 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "ShaderReflection.h"
+
+// std
+#include <algorithm>
+
+#define SPIRV_MAGIC 0x07230203
+#define SPIRV_HEADER_WORDS 5
+
+/* the part of the SPIR-V grammar the interface is declared with, values from the unified specification */
+enum SpirvOp
+{
+    SPIRV_OP_ENTRY_POINT = 15,
+    SPIRV_OP_TYPE_INT = 21,
+    SPIRV_OP_TYPE_FLOAT = 22,
+    SPIRV_OP_TYPE_VECTOR = 23,
+    SPIRV_OP_TYPE_MATRIX = 24,
+    SPIRV_OP_TYPE_IMAGE = 25,
+    SPIRV_OP_TYPE_SAMPLER = 26,
+    SPIRV_OP_TYPE_SAMPLED_IMAGE = 27,
+    SPIRV_OP_TYPE_ARRAY = 28,
+    SPIRV_OP_TYPE_RUNTIME_ARRAY = 29,
+    SPIRV_OP_TYPE_STRUCT = 30,
+    SPIRV_OP_TYPE_POINTER = 32,
+    SPIRV_OP_CONSTANT = 43,
+    SPIRV_OP_SPEC_CONSTANT = 50,
+    SPIRV_OP_VARIABLE = 59,
+    SPIRV_OP_DECORATE = 71,
+    SPIRV_OP_MEMBER_DECORATE = 72,
+    SPIRV_OP_TYPE_ACCELERATION_STRUCTURE = 5341,
+};
+
+enum SpirvDecoration
+{
+    SPIRV_DECORATION_BLOCK = 2,
+    SPIRV_DECORATION_BUFFER_BLOCK = 3,
+    SPIRV_DECORATION_ARRAY_STRIDE = 6,
+    SPIRV_DECORATION_MATRIX_STRIDE = 7,
+    SPIRV_DECORATION_BUILT_IN = 11,
+    SPIRV_DECORATION_LOCATION = 30,
+    SPIRV_DECORATION_BINDING = 33,
+    SPIRV_DECORATION_DESCRIPTOR_SET = 34,
+    SPIRV_DECORATION_OFFSET = 35,
+};
+
+enum SpirvStorageClass
+{
+    SPIRV_STORAGE_CLASS_UNIFORM_CONSTANT = 0,
+    SPIRV_STORAGE_CLASS_INPUT = 1,
+    SPIRV_STORAGE_CLASS_UNIFORM = 2,
+    SPIRV_STORAGE_CLASS_PUSH_CONSTANT = 9,
+    SPIRV_STORAGE_CLASS_STORAGE_BUFFER = 12,
+};
+
+#define SPIRV_DIM_BUFFER 5
+#define SPIRV_DIM_SUBPASS_DATA 6
+
+/* unset decorations read as this */
+#define SPIRV_NONE UINT32_MAX
+
+struct SpirvMember
+{
+    uint32_t offset = SPIRV_NONE;
+    uint32_t matrixStride = 0;
+};
+
+struct SpirvId
+{
+    const uint32_t* pInstruction = nullptr;     /* the type, constant or variable declaring the id */
+    uint32_t set = SPIRV_NONE;
+    uint32_t binding = SPIRV_NONE;
+    uint32_t location = SPIRV_NONE;
+    uint32_t arrayStride = 0;
+    bool builtIn = false;
+    bool block = false;
+    bool bufferBlock = false;
+    Vector<SpirvMember> members;
+};
+
+static uint16_t _GetOp(const uint32_t* pInstruction) { return (uint16_t) (pInstruction[0] & 0xffff); }
+static uint16_t _GetWordCount(const uint32_t* pInstruction) { return (uint16_t) (pInstruction[0] >> 16); }
+
+/* operands read from a type instruction, shorter ones are ignored as malformed */
+static uint16_t _GetMinimumWordCount(uint16_t op)
+{
+    switch (op) {
+        case SPIRV_OP_TYPE_FLOAT: return 3;
+        case SPIRV_OP_TYPE_INT: return 4;
+        case SPIRV_OP_TYPE_VECTOR: return 4;
+        case SPIRV_OP_TYPE_MATRIX: return 4;
+        case SPIRV_OP_TYPE_IMAGE: return 9;
+        case SPIRV_OP_TYPE_ARRAY: return 4;
+        case SPIRV_OP_TYPE_POINTER: return 4;
+        default: return 2;
+    }
+}
+
+static VkShaderStageFlagBits _GetStage(uint32_t executionModel)
+{
+    switch (executionModel) {
+        case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+        case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+        case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+        case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+        case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+        case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+        case 5364: return VK_SHADER_STAGE_TASK_BIT_EXT;
+        case 5365: return VK_SHADER_STAGE_MESH_BIT_EXT;
+        default: return (VkShaderStageFlagBits) 0;
+    }
+}
+
+static const SpirvId* _Find(const Vector<SpirvId>& ids, uint32_t id)
+{
+    return id < std::size(ids) && ids[id].pInstruction ? &ids[id] : nullptr;
+}
+
+/* byte size of a type as laid out in a block, matrixStride comes from the member holding it */
+static uint32_t _GetSize(const Vector<SpirvId>& ids, uint32_t typeId, uint32_t matrixStride)
+{
+    const SpirvId* type = _Find(ids, typeId);
+    if (!type)
+        return 0;
+
+    const uint32_t* p = type->pInstruction;
+    
+    switch (_GetOp(p)) {
+        case SPIRV_OP_TYPE_INT:
+        case SPIRV_OP_TYPE_FLOAT:
+            return p[2] / 8;
+        case SPIRV_OP_TYPE_VECTOR:
+            return p[3] * _GetSize(ids, p[2], 0);
+        case SPIRV_OP_TYPE_MATRIX:
+            return p[3] * (matrixStride ? matrixStride : _GetSize(ids, p[2], 0));
+        case SPIRV_OP_TYPE_ARRAY: {
+            const SpirvId* length = _Find(ids, p[3]);
+            uint32_t count = length ? length->pInstruction[3] : 0;
+            return count * (type->arrayStride ? type->arrayStride : _GetSize(ids, p[2], matrixStride));
+        }
+        case SPIRV_OP_TYPE_STRUCT: {
+            uint32_t size = 0;
+            for (uint32_t i = 0; i < _GetWordCount(p) - 2u && i < std::size(type->members); i++) {
+                const SpirvMember& member = type->members[i];
+                if (member.offset != SPIRV_NONE)
+                    size = std::max(size, member.offset + _GetSize(ids, p[2 + i], member.matrixStride));
+            }
+            return size;
+        }
+        default:
+            return 0;
+    }
+}
+
+static VkFormat _GetVertexFormat(const Vector<SpirvId>& ids, uint32_t typeId)
+{
+    static const VkFormat floats[2][4] = {
+        { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT },
+        { VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT },
+    };
+    static const VkFormat ints[2][4] = {
+        { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT },
+        { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT },
+    };
+    
+    const SpirvId* type = _Find(ids, typeId);
+    uint32_t componentCount = 1;
+
+    if (type && _GetOp(type->pInstruction) == SPIRV_OP_TYPE_VECTOR) {
+        componentCount = type->pInstruction[3];
+        type = _Find(ids, type->pInstruction[2]);
+    }
+
+    if (!type || componentCount < 1 || componentCount > 4)
+        return VK_FORMAT_UNDEFINED;
+
+    const uint32_t* p = type->pInstruction;
+    
+    if (_GetOp(p) == SPIRV_OP_TYPE_FLOAT && (p[2] == 32 || p[2] == 64))
+        return floats[p[2] == 64][componentCount - 1];
+    if (_GetOp(p) == SPIRV_OP_TYPE_INT && p[2] == 32)
+        return ints[p[3] != 0][componentCount - 1];
+
+    return VK_FORMAT_UNDEFINED;
+}
+
+/* descriptor type and count of a uniform variable, false when the type can not be bound */
+static bool _GetDescriptor(const Vector<SpirvId>& ids, uint32_t storageClass, uint32_t typeId, VkDescriptorType* pType, uint32_t* pCount)
+{
+    const SpirvId* type = _Find(ids, typeId);
+    *pCount = 1;
+
+    if (type && _GetOp(type->pInstruction) == SPIRV_OP_TYPE_ARRAY) {
+        const SpirvId* length = _Find(ids, type->pInstruction[3]);
+        if (!length || (_GetOp(length->pInstruction) != SPIRV_OP_CONSTANT && _GetOp(length->pInstruction) != SPIRV_OP_SPEC_CONSTANT))
+            return false;
+        
+        *pCount = length->pInstruction[3];
+        type = _Find(ids, type->pInstruction[2]);
+    }
+
+    /* unbounded arrays need descriptor indexing, which the layouts here are not created for */
+    if (!type || _GetOp(type->pInstruction) == SPIRV_OP_TYPE_RUNTIME_ARRAY)
+        return false;
+
+    const uint32_t* p = type->pInstruction;
+    
+    switch (_GetOp(p)) {
+        case SPIRV_OP_TYPE_SAMPLER:
+            *pType = VK_DESCRIPTOR_TYPE_SAMPLER;
+            return true;
+        case SPIRV_OP_TYPE_SAMPLED_IMAGE:
+            *pType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            return true;
+        case SPIRV_OP_TYPE_IMAGE:
+            /* Sampled operand: 1 sampled, 2 storage */
+            if (p[3] == SPIRV_DIM_SUBPASS_DATA)
+                *pType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+            else if (p[3] == SPIRV_DIM_BUFFER)
+                *pType = p[7] == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+            else
+                *pType = p[7] == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            return true;
+        case SPIRV_OP_TYPE_ACCELERATION_STRUCTURE:
+            *pType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+            return true;
+        case SPIRV_OP_TYPE_STRUCT:
+            /* BufferBlock is how storage buffers were declared before SPIR-V 1.3 */
+            if (storageClass == SPIRV_STORAGE_CLASS_STORAGE_BUFFER || type->bufferBlock)
+                *pType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            else if (type->block)
+                *pType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            else
+                return false;
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool ShaderReflector::Reflect(size_t codeSize, const uint32_t* pCode, ShaderReflection* pReflection)
+{
+    size_t wordCount = codeSize / sizeof(uint32_t);
+    
+    if (wordCount < SPIRV_HEADER_WORDS || pCode[0] != SPIRV_MAGIC) {
+        GOGH_LOGGER_ERROR("[Vulkan] Reflect failed, not a SPIR-V module, (codeSize=%zu)", codeSize);
+        return false;
+    }
+
+    /* the id bound of the header, every id is below it */
+    uint32_t bound = pCode[3];
+    if (bound > wordCount) {
+        GOGH_LOGGER_ERROR("[Vulkan] Reflect failed, id bound %u out of range, (codeSize=%zu)", bound, codeSize);
+        return false;
+    }
+    
+    Vector<SpirvId> ids(bound);
+    Vector<const uint32_t*> variables;
+    VkShaderStageFlags stages = 0;
+
+    for (size_t offset = SPIRV_HEADER_WORDS; offset < wordCount; ) {
+        const uint32_t* p = pCode + offset;
+        uint16_t count = _GetWordCount(p);
+        
+        if (count == 0 || offset + count > wordCount) {
+            GOGH_LOGGER_ERROR("[Vulkan] Reflect failed, truncated instruction at word %zu", offset);
+            return false;
+        }
+        
+        offset += count;
+
+        switch (_GetOp(p)) {
+            case SPIRV_OP_ENTRY_POINT:
+                stages |= _GetStage(p[1]);
+                break;
+            case SPIRV_OP_DECORATE: {
+                if (count < 3 || p[1] >= bound)
+                    break;
+                
+                SpirvId& id = ids[p[1]];
+                uint32_t value = count > 3 ? p[3] : 0;
+                
+                switch (p[2]) {
+                    case SPIRV_DECORATION_BLOCK: id.block = true; break;
+                    case SPIRV_DECORATION_BUFFER_BLOCK: id.bufferBlock = true; break;
+                    case SPIRV_DECORATION_ARRAY_STRIDE: id.arrayStride = value; break;
+                    case SPIRV_DECORATION_BUILT_IN: id.builtIn = true; break;
+                    case SPIRV_DECORATION_LOCATION: id.location = value; break;
+                    case SPIRV_DECORATION_BINDING: id.binding = value; break;
+                    case SPIRV_DECORATION_DESCRIPTOR_SET: id.set = value; break;
+                    default: break;
+                }
+                break;
+            }
+            case SPIRV_OP_MEMBER_DECORATE: {
+                if (count < 5 || p[1] >= bound || p[2] > UINT16_MAX)
+                    break;
+
+                SpirvId& id = ids[p[1]];
+                if (std::size(id.members) <= p[2])
+                    id.members.resize(p[2] + 1);
+                
+                if (p[3] == SPIRV_DECORATION_OFFSET)
+                    id.members[p[2]].offset = p[4];
+                else if (p[3] == SPIRV_DECORATION_MATRIX_STRIDE)
+                    id.members[p[2]].matrixStride = p[4];
+                break;
+            }
+            case SPIRV_OP_TYPE_INT:
+            case SPIRV_OP_TYPE_FLOAT:
+            case SPIRV_OP_TYPE_VECTOR:
+            case SPIRV_OP_TYPE_MATRIX:
+            case SPIRV_OP_TYPE_IMAGE:
+            case SPIRV_OP_TYPE_SAMPLER:
+            case SPIRV_OP_TYPE_SAMPLED_IMAGE:
+            case SPIRV_OP_TYPE_ARRAY:
+            case SPIRV_OP_TYPE_RUNTIME_ARRAY:
+            case SPIRV_OP_TYPE_STRUCT:
+            case SPIRV_OP_TYPE_POINTER:
+            case SPIRV_OP_TYPE_ACCELERATION_STRUCTURE:
+                if (count >= _GetMinimumWordCount(_GetOp(p)) && p[1] < bound)
+                    ids[p[1]].pInstruction = p;
+                break;
+            case SPIRV_OP_CONSTANT:
+            case SPIRV_OP_SPEC_CONSTANT:
+                /* result type, id, value: only the low word, array sizes are small */
+                if (count >= 4 && p[2] < bound)
+                    ids[p[2]].pInstruction = p;
+                break;
+            case SPIRV_OP_VARIABLE:
+                if (count >= 4 && p[2] < bound) {
+                    ids[p[2]].pInstruction = p;
+                    variables.push_back(p);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    ShaderReflection reflection;
+    reflection.stages = stages;
+
+    for (const uint32_t* p : variables) {
+        const SpirvId& variable = ids[p[2]];
+        uint32_t storageClass = p[3];
+
+        const SpirvId* pointer = _Find(ids, p[1]);
+        if (!pointer || _GetOp(pointer->pInstruction) != SPIRV_OP_TYPE_POINTER || _GetWordCount(pointer->pInstruction) < 4)
+            continue;
+
+        uint32_t typeId = pointer->pInstruction[3];
+        
+        switch (storageClass) {
+            case SPIRV_STORAGE_CLASS_UNIFORM_CONSTANT:
+            case SPIRV_STORAGE_CLASS_UNIFORM:
+            case SPIRV_STORAGE_CLASS_STORAGE_BUFFER: {
+                if (variable.binding == SPIRV_NONE)
+                    continue;
+
+                uint32_t set = variable.set == SPIRV_NONE ? 0 : variable.set;
+                if (set >= SHADER_REFLECTION_MAX_DESCRIPTOR_SETS) {
+                    GOGH_LOGGER_ERROR("[Vulkan] Reflect failed, descriptor set %u out of range, (binding=%u)", set, variable.binding);
+                    return false;
+                }
+                
+                VkDescriptorSetLayoutBinding binding = {
+                    .binding = variable.binding,
+                    .stageFlags = stages,
+                };
+                
+                if (!_GetDescriptor(ids, storageClass, typeId, &binding.descriptorType, &binding.descriptorCount)) {
+                    GOGH_LOGGER_ERROR("[Vulkan] Reflect failed, unsupported descriptor type, (set=%u, binding=%u)", set, variable.binding);
+                    return false;
+                }
+
+                if (std::size(reflection.sets) <= set)
+                    reflection.sets.resize(set + 1);
+
+                reflection.sets[set].push_back(binding);
+                break;
+            }
+            case SPIRV_STORAGE_CLASS_PUSH_CONSTANT:
+                reflection.pushConstantRange = {
+                    .stageFlags = stages,
+                    .offset = 0,
+                    .size = _GetSize(ids, typeId, 0),
+                };
+                break;
+            case SPIRV_STORAGE_CLASS_INPUT: {
+                if (!(stages & VK_SHADER_STAGE_VERTEX_BIT) || variable.builtIn || variable.location == SPIRV_NONE)
+                    continue;
+
+                /* a matrix takes one location per column */
+                uint32_t columnCount = 1;
+                const SpirvId* type = _Find(ids, typeId);
+                if (type && _GetOp(type->pInstruction) == SPIRV_OP_TYPE_MATRIX) {
+                    columnCount = type->pInstruction[3];
+                    typeId = type->pInstruction[2];
+                }
+                
+                VkFormat format = _GetVertexFormat(ids, typeId);
+                if (format == VK_FORMAT_UNDEFINED) {
+                    GOGH_LOGGER_ERROR("[Vulkan] Reflect failed, unsupported vertex input type, (location=%u)", variable.location);
+                    return false;
+                }
+
+                for (uint32_t column = 0; column < columnCount; column++)
+                    reflection.vertexInputs.push_back({ .location = variable.location + column, .format = format });
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    for (auto& bindings : reflection.sets) {
+        std::sort(bindings.begin(), bindings.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+            return a.binding < b.binding;
+        });
+    }
+    
+    std::sort(reflection.vertexInputs.begin(), reflection.vertexInputs.end(), [](const VkVertexInputAttributeDescription& a, const VkVertexInputAttributeDescription& b) {
+        return a.location < b.location;
+    });
+    
+    *pReflection = std::move(reflection);
+    return true;
+}
+
+bool ShaderReflector::Merge(const ShaderReflection& reflection, ShaderReflection* pMerged)
+{
+    if (std::size(pMerged->sets) < std::size(reflection.sets))
+        pMerged->sets.resize(std::size(reflection.sets));
+
+    for (uint32_t set = 0; set < std::size(reflection.sets); set++) {
+        Vector<VkDescriptorSetLayoutBinding>& merged = pMerged->sets[set];
+        
+        for (const VkDescriptorSetLayoutBinding& binding : reflection.sets[set]) {
+            auto it = std::lower_bound(merged.begin(), merged.end(), binding, [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+                return a.binding < b.binding;
+            });
+
+            if (it == merged.end() || it->binding != binding.binding) {
+                merged.insert(it, binding);
+                continue;
+            }
+            
+            if (it->descriptorType != binding.descriptorType || it->descriptorCount != binding.descriptorCount) {
+                GOGH_LOGGER_ERROR("[Vulkan] Merge failed, stages disagree on a binding, (set=%u, binding=%u, type=%d/%d, count=%u/%u)",
+                                  set, binding.binding, it->descriptorType, binding.descriptorType, it->descriptorCount, binding.descriptorCount);
+                return false;
+            }
+
+            it->stageFlags |= binding.stageFlags;
+        }
+    }
+
+    if (reflection.pushConstantRange.size > 0) {
+        pMerged->pushConstantRange.stageFlags |= reflection.pushConstantRange.stageFlags;
+        pMerged->pushConstantRange.size = std::max(pMerged->pushConstantRange.size, reflection.pushConstantRange.size);
+    }
+
+    if (reflection.stages & VK_SHADER_STAGE_VERTEX_BIT)
+        pMerged->vertexInputs = reflection.vertexInputs;
+    
+    pMerged->stages |= reflection.stages;
+    return true;
+}
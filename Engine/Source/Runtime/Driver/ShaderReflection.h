@@ -0,0 +1,56 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "VulkanInclude.h"
+
+/* set indices past this are rejected as malformed, far above any maxBoundDescriptorSets */
+#define SHADER_REFLECTION_MAX_DESCRIPTOR_SETS 32
+
+/* what a pipeline layout and vertex input state need to know about the shaders */
+struct ShaderReflection
+{
+    VkShaderStageFlags stages = 0;
+    /* indexed by set number, bindings sorted by binding number, a set the shaders skip is empty */
+    Vector<Vector<VkDescriptorSetLayoutBinding>> sets;
+    /* one range from offset 0 over every stage using push constants, size 0 when unused */
+    VkPushConstantRange pushConstantRange = {};
+    /* vertex stage inputs sorted by location, binding and offset are left to the vertex layout */
+    Vector<VkVertexInputAttributeDescription> vertexInputs;
+};
+
+/*
+ * Reads the interface of a SPIR-V module: the descriptor bindings with their type and
+ * array size, the push constant block size and the vertex inputs. Only the
+ * instructions that declare the interface are looked at, no SPIR-V library needed.
+ *
+ * Dynamic buffers can not be told apart from plain ones in SPIR-V, pipelines that
+ * want them pass their bindings by hand.
+ */
+class ShaderReflector
+{
+public:
+    static bool Reflect(size_t codeSize, const uint32_t* pCode, ShaderReflection* pReflection);
+    
+    /* adds the stages of reflection to pMerged, false when both declare a binding differently */
+    static bool Merge(const ShaderReflection& reflection, ShaderReflection* pMerged);
+};
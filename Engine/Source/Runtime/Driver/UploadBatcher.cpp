@@ -0,0 +1,336 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "UploadBatcher.h"
+#include "RenderDevice.h"
+
+#include <Error.h>
+
+static VkDeviceSize _Align(VkDeviceSize value)
+{
+    return (value + UPLOAD_BATCHER_STAGING_ALIGNMENT - 1) & ~(VkDeviceSize) (UPLOAD_BATCHER_STAGING_ALIGNMENT - 1);
+}
+
+UploadBatcher::UploadBatcher(RenderDevice* pDevice) : device(pDevice), vkDevice(pDevice->GetDevice())
+{
+    GOGH_LOGGER_DEBUG("[Vulkan] Create upload batcher successful, (UploadBatcher: %p)", this);
+}
+
+UploadBatcher::~UploadBatcher()
+{
+    if (pendingStaging != 0)
+        GOGH_LOGGER_WARN("[Vulkan] Upload batcher destroyed with %u staging reservations never consumed, (UploadBatcher: %p)", pendingStaging, this);
+    
+    if (!std::empty(copies))
+        GOGH_LOGGER_WARN("[Vulkan] Upload batcher destroyed with %zu image uploads never submitted, (UploadBatcher: %p)", std::size(copies), this);
+
+    for (auto& batch : inFlight) {
+        vkWaitForFences(vkDevice, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+        _Recycle(batch);
+    }
+
+    for (auto& batch : freeBatches) {
+        vkDestroyFence(vkDevice, batch.fence, VK_NULL_HANDLE);
+        device->DestroyCommandLis(batch.commandList);
+    }
+
+    for (Buffer* block : stagingBlocks)
+        device->DestroyBuffer(block);
+
+    for (Buffer* block : freeBlocks)
+        device->DestroyBuffer(block);
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Destroying upload batcher, (UploadBatcher: %p)", this);
+}
+
+bool UploadBatcher::AllocateStaging(VkDeviceSize size, UploadStaging* pStaging)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    VkDeviceSize offset = _Align(stagingOffset);
+    Buffer* block = std::empty(stagingBlocks) ? VK_NULL_HANDLE : stagingBlocks.back();
+
+    if (size > UPLOAD_BATCHER_STAGING_BLOCK_SIZE) {
+        /* a block of its own, the shared block in use keeps filling up */
+        block = _AcquireStagingBlock(size);
+        if (block == VK_NULL_HANDLE)
+            return false;
+        
+        stagingBlocks.insert(stagingBlocks.begin(), block);
+        offset = 0;
+    } else {
+        if (block == VK_NULL_HANDLE || offset + size > block->GetSize()) {
+            block = _AcquireStagingBlock(size);
+            if (block == VK_NULL_HANDLE)
+                return false;
+
+            stagingBlocks.push_back(block);
+            offset = 0;
+        }
+        
+        stagingOffset = offset + size;
+    }
+
+    pStaging->buffer = block;
+    pStaging->offset = offset;
+    pStaging->pData = static_cast<uint8_t*>(block->GetMappedData()) + offset;
+
+    ++pendingStaging;
+    stats.bytes += size;
+    return true;
+}
+
+UploadToken UploadBatcher::CopyToImage(const UploadStaging& staging, Image* image, uint32_t regionCount, const VkBufferImageCopy* pRegions)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    GOGH_ASSERT(pendingStaging > 0 && "CopyToImage() without a staging reservation");
+    --pendingStaging;
+    
+    copies.push_back({ image, staging.buffer->GetVkBuffer(), (uint32_t) std::size(regions), regionCount });
+
+    for (uint32_t i = 0; i < regionCount; i++) {
+        VkBufferImageCopy region = pRegions[i];
+        region.bufferOffset += staging.offset;
+        regions.push_back(region);
+    }
+
+    return nextToken;
+}
+
+void UploadBatcher::CancelStaging(const UploadStaging&)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    GOGH_ASSERT(pendingStaging > 0 && "CancelStaging() without a staging reservation");
+    --pendingStaging;
+}
+
+UploadToken UploadBatcher::Submit()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return _Submit();
+}
+
+bool UploadBatcher::IsComplete(UploadToken token)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return _IsComplete(token);
+}
+
+void UploadBatcher::Wait(UploadToken token)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    
+    /* waiting for the batch being collected submits it */
+    if (token >= nextToken)
+        _Submit();
+    
+    while (!_IsComplete(token) && !std::empty(inFlight)) {
+        VkFence fence = inFlight.front().fence;
+        
+        lock.unlock();
+        vkWaitForFences(vkDevice, 1, &fence, VK_TRUE, UINT64_MAX);
+        lock.lock();
+    }
+}
+
+UploadBatcher::Stats UploadBatcher::GetStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+UploadToken UploadBatcher::_Submit()
+{
+    VkResult err;
+    
+    _Collect();
+    
+    if (std::empty(copies))
+        return nextToken - 1;
+
+    BatchVkEXT batch;
+    
+    if (!std::empty(freeBatches)) {
+        batch = std::move(freeBatches.back());
+        freeBatches.pop_back();
+    } else {
+        VkFenceCreateInfo fenceCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        };
+
+        err = vkCreateFence(vkDevice, &fenceCreateInfo, VK_NULL_HANDLE, &batch.fence);
+        if (err != VK_SUCCESS) {
+            GOGH_LOGGER_ERROR("[Vulkan] Failed to create upload fence, (VkResult=%d)", err);
+            return nextToken - 1;
+        }
+        
+        batch.commandList = device->CreateCommandList();
+    }
+
+    batch.token = nextToken++;
+
+    /*
+     * A reservation still being written pins the blocks being collected, they go with a
+     * later batch, which completes after this one, so the copies recorded here are safe too.
+     */
+    if (pendingStaging == 0) {
+        batch.stagingBlocks = std::move(stagingBlocks);
+        stagingBlocks.clear();
+        stagingOffset = 0;
+    }
+
+    CommandList* commandList = batch.commandList;
+    commandList->Reset();
+    commandList->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+    /* one barrier for every image into TRANSFER_DST, the copies, one barrier for every image out */
+    barriers.clear();
+    for (const auto& copy : copies) {
+        barriers.push_back({
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = copy.image->GetVkImage(),
+            .subresourceRange = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = 0,
+                .levelCount = VK_REMAINING_MIP_LEVELS,
+                .baseArrayLayer = 0,
+                .layerCount = VK_REMAINING_ARRAY_LAYERS,
+            },
+        });
+    }
+    
+    commandList->ImageBarriers((uint32_t) std::size(barriers), std::data(barriers),
+                               VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                               VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    for (const auto& copy : copies)
+        commandList->CopyBufferToImage(copy.buffer, copy.image->GetVkImage(), copy.regionCount, &regions[copy.firstRegion]);
+
+    for (auto& barrier : barriers) {
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    }
+    
+    commandList->ImageBarriers((uint32_t) std::size(barriers), std::data(barriers),
+                               VK_PIPELINE_STAGE_TRANSFER_BIT,
+                               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    /* downgrade copies go to the same queue later, they see the layout set here */
+    for (const auto& copy : copies)
+        copy.image->SetLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    commandList->End();
+    
+    size_t imageCount = std::size(copies);
+    copies.clear();
+    regions.clear();
+    
+    vkResetFences(vkDevice, 1, &batch.fence);
+    err = commandList->Submit(0, VK_NULL_HANDLE, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, batch.fence);
+
+    UploadToken token = batch.token;
+    
+    if (err != VK_SUCCESS) {
+        GOGH_LOGGER_ERROR("[Vulkan] Failed to submit upload batch, (VkResult=%d, images=%zu)", err, imageCount);
+        _Recycle(batch);
+        return token;
+    }
+
+    GOGH_LOGGER_DEBUG("[Vulkan] Submit upload batch, (token=%llu, images=%zu, stagingBlocks=%zu)",
+                      (unsigned long long) batch.token, imageCount, std::size(batch.stagingBlocks));
+
+    stats.images += imageCount;
+    ++stats.batches;
+    
+    inFlight.push_back(std::move(batch));
+    
+    return token;
+}
+
+bool UploadBatcher::_IsComplete(UploadToken token)
+{
+    _Collect();
+
+    /* failed batches never enter the in flight list, they complete with their predecessors */
+    if (std::empty(inFlight))
+        return token < nextToken;
+    
+    return token < inFlight.front().token;
+}
+
+void UploadBatcher::_Collect()
+{
+    size_t count = 0;
+    
+    while (count < std::size(inFlight) && vkGetFenceStatus(vkDevice, inFlight[count].fence) == VK_SUCCESS)
+        _Recycle(inFlight[count++]);
+
+    inFlight.erase(inFlight.begin(), inFlight.begin() + count);
+}
+
+void UploadBatcher::_Recycle(BatchVkEXT& batch)
+{
+    for (Buffer* block : batch.stagingBlocks)
+        _ReleaseStagingBlock(block);
+    
+    batch.stagingBlocks.clear();
+    freeBatches.push_back(std::move(batch));
+}
+
+Buffer* UploadBatcher::_AcquireStagingBlock(VkDeviceSize size)
+{
+    if (size <= UPLOAD_BATCHER_STAGING_BLOCK_SIZE && !std::empty(freeBlocks)) {
+        Buffer* block = freeBlocks.back();
+        freeBlocks.pop_back();
+        return block;
+    }
+
+    Buffer* block = device->CreateBuffer(std::max(size, (VkDeviceSize) UPLOAD_BATCHER_STAGING_BLOCK_SIZE), VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+    
+    if (block == VK_NULL_HANDLE) {
+        GOGH_LOGGER_ERROR("[Vulkan] Failed to create upload staging block, (size=%llu)", (unsigned long long) size);
+        return VK_NULL_HANDLE;
+    }
+
+    /* written through the persistent mapping and copied from by recorded batches, never move it */
+    block->SetResidencyPriority(RESIDENCY_PRIORITY_CRITICAL);
+    return block;
+}
+
+void UploadBatcher::_ReleaseStagingBlock(Buffer* block)
+{
+    if (block->GetSize() == UPLOAD_BATCHER_STAGING_BLOCK_SIZE && std::size(freeBlocks) < UPLOAD_BATCHER_MAX_FREE_BLOCKS) {
+        freeBlocks.push_back(block);
+        return;
+    }
+
+    device->DestroyBuffer(block);
+}
@@ -0,0 +1,161 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "VulkanInclude.h"
+#include "CommandList.h"
+#include "Buffer.h"
+#include "Image.h"
+
+#include <Vector.h>
+
+// std
+#include <mutex>
+
+/* staging memory is carved out of blocks this large, bigger uploads get a block of their own */
+#define UPLOAD_BATCHER_STAGING_BLOCK_SIZE (64ull << 20)
+
+/* offset of every staging allocation, a multiple of every texel block size and of 4 */
+#define UPLOAD_BATCHER_STAGING_ALIGNMENT 16
+
+/* idle staging blocks kept for the next batches, the rest go back to VMA */
+#define UPLOAD_BATCHER_MAX_FREE_BLOCKS 4
+
+class RenderDevice;
+
+/* GPU completion of one submitted batch, increases with every Submit(), 0 is always complete */
+typedef uint64_t UploadToken;
+
+struct UploadStaging
+{
+    Buffer* buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    uint8_t* pData = nullptr;
+};
+
+/*
+ * Collects image uploads and records them into one command buffer: a single barrier
+ * moves every image to TRANSFER_DST, the copies follow and a single barrier moves them
+ * all to SHADER_READ_ONLY, then the batch is submitted once with one fence. Loading a
+ * level's worth of textures is one GPU round trip instead of one per texture.
+ *
+ * Like the defragmenter nothing here waits on the GPU: Submit() hands back a token,
+ * IsComplete() polls it and the staging memory of a finished batch is recycled on a
+ * later Submit(). Later submissions on the queue see the uploaded images, so a frame
+ * recorded after Submit() may sample them without waiting for the token.
+ *
+ * Uploads may be queued and tokens polled from any thread, the streaming callbacks run
+ * on the main thread while the render thread submits. Submit() uses the queue and so
+ * belongs to the thread that submits frames.
+ */
+class UploadBatcher
+{
+public:
+    struct Stats {
+        uint64_t batches = 0;
+        uint64_t images = 0;
+        VkDeviceSize bytes = 0;
+    };
+
+public:
+    UploadBatcher(RenderDevice* pDevice);
+   ~UploadBatcher();
+
+    UploadBatcher(const UploadBatcher&) = delete;
+    UploadBatcher& operator=(const UploadBatcher&) = delete;
+
+    /*
+     * Mapped staging memory for size bytes. The allocation is a reservation: its block
+     * stays out of every submitted batch, and so is never recycled, until the reservation
+     * is consumed by CopyToImage() or given up with CancelStaging().
+     */
+    bool AllocateStaging(VkDeviceSize size, UploadStaging* pStaging);
+
+    /*
+     * Consumes the reservation of staging and queues the copy of a freshly created image,
+     * its contents are undefined until then. Region buffer offsets are relative to the
+     * staging allocation, the image ends in SHADER_READ_ONLY_OPTIMAL with every mip level
+     * written by the regions. Returns the token of the batch the copy lands in.
+     */
+    UploadToken CopyToImage(const UploadStaging& staging, Image* image, uint32_t regionCount, const VkBufferImageCopy* pRegions);
+
+    /* gives up the reservation of staging without a copy, its range stays unused */
+    void CancelStaging(const UploadStaging& staging);
+
+    /*
+     * Records and submits everything queued since the last call, once per frame is
+     * enough. Returns the batch token, the last one when nothing was queued. A failed
+     * submission is logged, its images stay undefined and its token reads as complete.
+     */
+    UploadToken Submit();
+
+    bool IsComplete(UploadToken token);
+    /* blocks, for shutdown and tools, submits the pending batch when token is its token */
+    void Wait(UploadToken token);
+
+    Stats GetStats();
+
+private:
+    struct BatchVkEXT {
+        UploadToken token = 0;
+        CommandList* commandList = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        Vector<Buffer*> stagingBlocks;
+    };
+
+    struct ImageCopyVkEXT {
+        Image* image = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        uint32_t firstRegion = 0;
+        uint32_t regionCount = 0;
+    };
+
+    UploadToken _Submit();
+    bool _IsComplete(UploadToken token);
+    /* recycles batches whose fence has signaled, oldest first, so tokens complete in order */
+    void _Collect();
+    void _Recycle(BatchVkEXT& batch);
+    Buffer* _AcquireStagingBlock(VkDeviceSize size);
+    void _ReleaseStagingBlock(Buffer* block);
+
+private:
+    RenderDevice* device = VK_NULL_HANDLE;
+    VkDevice vkDevice = VK_NULL_HANDLE;
+    std::mutex mutex;
+
+    /* batch being collected */
+    Vector<ImageCopyVkEXT> copies;
+    Vector<VkBufferImageCopy> regions;
+    Vector<Buffer*> stagingBlocks;
+    VkDeviceSize stagingOffset = 0;
+    /* staging allocations not consumed yet, the blocks being collected stay pinned while non zero */
+    uint32_t pendingStaging = 0;
+
+    Vector<BatchVkEXT> inFlight;
+    Vector<BatchVkEXT> freeBatches;
+    Vector<Buffer*> freeBlocks;
+    Vector<VkImageMemoryBarrier> barriers;
+
+    UploadToken nextToken = 1;
+
+    Stats stats = {};
+};
@@ -36,6 +36,22 @@ namespace VulkanUtils
         return devices[0];
     }
 
+    bool IsDeviceExtensionSupported(VkPhysicalDevice device, const char* name)
+    {
+        uint32_t count;
+        vkEnumerateDeviceExtensionProperties(device, VK_NULL_HANDLE, &count, VK_NULL_HANDLE);
+
+        std::vector<VkExtensionProperties> properties(count);
+        vkEnumerateDeviceExtensionProperties(device, VK_NULL_HANDLE, &count, std::data(properties));
+
+        for (const auto &property: properties) {
+            if (strcmp(property.extensionName, name) == 0)
+                return true;
+        }
+
+        return false;
+    }
+
     void FindQueueIndex(VkPhysicalDevice device, VkSurfaceKHR surface, uint32_t *p_index)
     {
         uint32_t count;
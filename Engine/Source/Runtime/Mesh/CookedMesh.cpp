@@ -0,0 +1,281 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "CookedMesh.h"
+
+#include <Logger.h>
+
+// std
+#include <stdio.h>
+#include <string.h>
+
+static_assert(sizeof(VertexDecodeParams) == 48, "VertexDecodeParams layout changed, bump COOKED_MESH_VERSION");
+static_assert(sizeof(Submesh) == 12, "Submesh layout changed, bump COOKED_MESH_VERSION");
+static_assert(sizeof(MeshLod) == 12, "MeshLod layout changed, bump COOKED_MESH_VERSION");
+static_assert(sizeof(Meshlet) == 52, "Meshlet layout changed, bump COOKED_MESH_VERSION");
+
+/* vertices and indices depend on the header, _Validate() checks them against it */
+static const size_t COOKED_MESH_ELEMENT_SIZES[COOKED_MESH_SECTION_MAX_ENUM] = {
+    sizeof(uint8_t),
+    sizeof(uint8_t),
+    sizeof(Submesh),
+    sizeof(MeshLod),
+    sizeof(Meshlet),
+    sizeof(uint32_t),
+    sizeof(uint8_t),
+};
+
+static uint64_t _Align(uint64_t value)
+{
+    return (value + COOKED_MESH_ALIGNMENT - 1) & ~((uint64_t) COOKED_MESH_ALIGNMENT - 1);
+}
+
+CookedMesh::CookedMesh(const char* path) : file(path)
+{
+    if (!file.IsValid())
+        return;
+
+    if (!_Validate(path))
+        return;
+
+    header = reinterpret_cast<const CookedMeshHeader*>(file.GetData());
+    
+    GOGH_LOGGER_DEBUG("[Mesh] Map cooked mesh successful, (path=%s, vertices=%u, indices=%u, lods=%u, meshlets=%u)",
+                      path, GetVertexCount(), GetIndexCount(), GetLodCount(), GetMeshletCount());
+}
+
+bool CookedMesh::_Validate(const char* path) const
+{
+    if (file.GetSize() < sizeof(CookedMeshHeader)) {
+        GOGH_LOGGER_ERROR("[Mesh] Cooked mesh is truncated, (path=%s, size=%zu)", path, file.GetSize());
+        return false;
+    }
+
+    const CookedMeshHeader* fileHeader = reinterpret_cast<const CookedMeshHeader*>(file.GetData());
+    
+    if (fileHeader->magic != COOKED_MESH_MAGIC || fileHeader->version != COOKED_MESH_VERSION) {
+        GOGH_LOGGER_ERROR("[Mesh] Cooked mesh has a foreign magic or version, recook it, (path=%s, version=%u)", path, fileHeader->version);
+        return false;
+    }
+
+    if (fileHeader->fileSize != file.GetSize()) {
+        GOGH_LOGGER_ERROR("[Mesh] Cooked mesh size mismatch, (path=%s, expected=%llu, actual=%zu)",
+                          path, (unsigned long long) fileHeader->fileSize, file.GetSize());
+        return false;
+    }
+
+    VertexFormat format = {
+        .position = (VertexPositionEncoding) fileHeader->positionEncoding,
+        .normal = (VertexNormalEncoding) fileHeader->normalEncoding,
+        .texcoord = (VertexTexcoordEncoding) fileHeader->texcoordEncoding,
+    };
+    
+    if (fileHeader->positionEncoding > VERTEX_POSITION_ENCODING_UNORM16 || fileHeader->normalEncoding > VERTEX_NORMAL_ENCODING_OCTAHEDRAL16 ||
+        fileHeader->texcoordEncoding > VERTEX_TEXCOORD_ENCODING_UNORM16 || fileHeader->vertexStride != VertexFormatEncoder::GetStride(format) ||
+        (fileHeader->indexType != VK_INDEX_TYPE_UINT16 && fileHeader->indexType != VK_INDEX_TYPE_UINT32)) {
+        GOGH_LOGGER_ERROR("[Mesh] Cooked mesh has an unknown vertex format, (path=%s, stride=%u, indexType=%u)",
+                          path, fileHeader->vertexStride, fileHeader->indexType);
+        return false;
+    }
+
+    if (fileHeader->sections[COOKED_MESH_SECTION_VERTICES].size % fileHeader->vertexStride != 0 ||
+        fileHeader->sections[COOKED_MESH_SECTION_INDICES].size % _GetIndexSize(fileHeader->indexType) != 0) {
+        GOGH_LOGGER_ERROR("[Mesh] Cooked mesh vertex or index section is truncated, (path=%s)", path);
+        return false;
+    }
+    
+    for (uint32_t i = 0; i < COOKED_MESH_SECTION_MAX_ENUM; i++) {
+        const CookedMeshSection& section = fileHeader->sections[i];
+        
+        if (section.offset % COOKED_MESH_ALIGNMENT != 0 || section.offset > fileHeader->fileSize ||
+            section.size > fileHeader->fileSize - section.offset || section.size % COOKED_MESH_ELEMENT_SIZES[i] != 0) {
+            GOGH_LOGGER_ERROR("[Mesh] Cooked mesh section %u is out of bounds, (path=%s)", i, path);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+VertexFormat CookedMesh::GetVertexFormat() const
+{
+    return {
+        .position = (VertexPositionEncoding) header->positionEncoding,
+        .normal = (VertexNormalEncoding) header->normalEncoding,
+        .texcoord = (VertexTexcoordEncoding) header->texcoordEncoding,
+        .allowIndex16 = header->indexType == VK_INDEX_TYPE_UINT16,
+    };
+}
+
+void CookedMesh::GetMeshData(MeshData* pMesh) const
+{
+    pMesh->vertices.resize(GetVertexCount());
+    VertexFormatEncoder::Decode(GetVertexFormat(), GetDecodeParams(), GetVertexCount(), GetVertices(), std::data(pMesh->vertices));
+
+    if (GetIndexType() == VK_INDEX_TYPE_UINT16) {
+        const uint16_t* indices = reinterpret_cast<const uint16_t*>(GetIndices());
+        pMesh->indices.assign(indices, indices + GetIndexCount());
+    } else {
+        const uint32_t* indices = reinterpret_cast<const uint32_t*>(GetIndices());
+        pMesh->indices.assign(indices, indices + GetIndexCount());
+    }
+    
+    pMesh->submeshes.assign(GetSubmeshes(), GetSubmeshes() + GetSubmeshCount());
+    pMesh->lods.assign(GetLods(), GetLods() + GetLodCount());
+}
+
+void CookedMesh::GetMeshletData(MeshletData* pMeshlets) const
+{
+    const Meshlet* meshlets = _Section<Meshlet>(COOKED_MESH_SECTION_MESHLETS);
+    const uint32_t* vertices = _Section<uint32_t>(COOKED_MESH_SECTION_MESHLET_VERTICES);
+    const uint8_t* triangles = _Section<uint8_t>(COOKED_MESH_SECTION_MESHLET_TRIANGLES);
+    
+    pMeshlets->meshlets.assign(meshlets, meshlets + GetMeshletCount());
+    pMeshlets->vertices.assign(vertices, vertices + _Count<uint32_t>(COOKED_MESH_SECTION_MESHLET_VERTICES));
+    pMeshlets->triangles.assign(triangles, triangles + _Count<uint8_t>(COOKED_MESH_SECTION_MESHLET_TRIANGLES));
+}
+
+bool CookedMesh::Upload(RenderDevice* device, VkBufferUsageFlags usage, Buffer** ppVertexBuffer, Buffer** ppIndexBuffer) const
+{
+    size_t vertexSize = header->sections[COOKED_MESH_SECTION_VERTICES].size;
+    size_t indexSize = header->sections[COOKED_MESH_SECTION_INDICES].size;
+
+    *ppVertexBuffer = *ppIndexBuffer = VK_NULL_HANDLE;
+    
+    if (vertexSize == 0 || indexSize == 0)
+        return false;
+    
+    Buffer* vertexBuffer = device->CreateBuffer(vertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | usage);
+    Buffer* indexBuffer = device->CreateBuffer(indexSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | usage);
+
+    if (!vertexBuffer || !indexBuffer) {
+        if (vertexBuffer)
+            device->DestroyBuffer(vertexBuffer);
+        if (indexBuffer)
+            device->DestroyBuffer(indexBuffer);
+        
+        GOGH_LOGGER_ERROR("[Mesh] Failed to create cooked mesh buffers, (vertexSize=%zu, indexSize=%zu)", vertexSize, indexSize);
+        return false;
+    }
+
+    /* the only copy, page faults of the mapping stream the file in as it goes */
+    vertexBuffer->Write(0, vertexSize, GetVertices());
+    indexBuffer->Write(0, indexSize, GetIndices());
+
+    *ppVertexBuffer = vertexBuffer;
+    *ppIndexBuffer = indexBuffer;
+    
+    return true;
+}
+
+bool CookedMesh::Write(const char* path, const MeshData& mesh, const MeshletData* pMeshlets, const VertexFormat& format)
+{
+    static const uint8_t padding[COOKED_MESH_ALIGNMENT] = {};
+    CookedMeshHeader header = {};
+    QuantizedMesh quantized;
+
+    VertexFormatEncoder::Encode(mesh, format, &quantized);
+    header.positionEncoding = format.position;
+    header.normalEncoding = format.normal;
+    header.texcoordEncoding = format.texcoord;
+    header.vertexStride = quantized.stride;
+    header.indexType = quantized.indexType;
+    header.decodeParams = quantized.decodeParams;
+
+    if (!std::empty(mesh.vertices)) {
+        header.boundsMin = header.boundsMax = mesh.vertices[0].position;
+        for (const Vertex& vertex : mesh.vertices) {
+            header.boundsMin = glm::min(header.boundsMin, vertex.position);
+            header.boundsMax = glm::max(header.boundsMax, vertex.position);
+        }
+
+        glm::vec3 center = (header.boundsMin + header.boundsMax) * 0.5f;
+        float radius = 0.0f;
+        for (const Vertex& vertex : mesh.vertices)
+            radius = glm::max(radius, glm::length(vertex.position - center));
+        
+        header.boundingSphere = glm::vec4(center, radius);
+    }
+
+    Submesh wholeMesh = {};
+    wholeMesh.indexCount = std::empty(mesh.lods) ? (uint32_t) std::size(mesh.indices) : mesh.lods[0].indexCount;
+    bool hasSubmeshes = !std::empty(mesh.submeshes);
+    
+    const void* data[COOKED_MESH_SECTION_MAX_ENUM] = {
+        std::data(quantized.vertices),
+        std::data(quantized.indices),
+        hasSubmeshes ? (const void*) std::data(mesh.submeshes) : &wholeMesh,
+        std::data(mesh.lods),
+        pMeshlets ? std::data(pMeshlets->meshlets) : nullptr,
+        pMeshlets ? std::data(pMeshlets->vertices) : nullptr,
+        pMeshlets ? std::data(pMeshlets->triangles) : nullptr,
+    };
+
+    size_t counts[COOKED_MESH_SECTION_MAX_ENUM] = {
+        std::size(quantized.vertices),
+        std::size(quantized.indices),
+        hasSubmeshes ? std::size(mesh.submeshes) : 1,
+        std::size(mesh.lods),
+        pMeshlets ? std::size(pMeshlets->meshlets) : 0,
+        pMeshlets ? std::size(pMeshlets->vertices) : 0,
+        pMeshlets ? std::size(pMeshlets->triangles) : 0,
+    };
+
+    uint64_t offset = _Align(sizeof(CookedMeshHeader));
+    for (uint32_t i = 0; i < COOKED_MESH_SECTION_MAX_ENUM; i++) {
+        header.sections[i].offset = offset;
+        header.sections[i].size = counts[i] * COOKED_MESH_ELEMENT_SIZES[i];
+        offset = _Align(offset + header.sections[i].size);
+    }
+
+    header.fileSize = offset;
+    
+    FILE* fp = fopen(path, "wb");
+    if (!fp) {
+        GOGH_LOGGER_ERROR("[Mesh] Failed to open cooked mesh for writing, (path=%s)", path);
+        return false;
+    }
+
+    bool written = fwrite(&header, sizeof(header), 1, fp) == 1;
+    uint64_t position = sizeof(header);
+    
+    for (uint32_t i = 0; i < COOKED_MESH_SECTION_MAX_ENUM && written; i++) {
+        const CookedMeshSection& section = header.sections[i];
+        written = fwrite(padding, 1, section.offset - position, fp) == section.offset - position &&
+                  (section.size == 0 || fwrite(data[i], section.size, 1, fp) == 1);
+        position = section.offset + section.size;
+    }
+
+    if (written)
+        written = fwrite(padding, 1, header.fileSize - position, fp) == header.fileSize - position;
+    
+    written = fclose(fp) == 0 && written;
+    
+    if (!written) {
+        GOGH_LOGGER_ERROR("[Mesh] Failed to write cooked mesh, (path=%s)", path);
+        remove(path);
+        return false;
+    }
+    
+    VertexFormatEncoder::LogReport(path, mesh, quantized);
+    GOGH_LOGGER_INFO("[Mesh] Write cooked mesh successful, (path=%s, size=%.1f MiB)", path, (double) header.fileSize / (1024.0 * 1024.0));
+    return true;
+}
@@ -0,0 +1,137 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Mesh.h"
+#include "Meshlet.h"
+#include "VertexFormat.h"
+#include "Core/MappedFile.h"
+#include "Driver/RenderDevice.h"
+
+#define COOKED_MESH_MAGIC 0x4853454d /* "MESH" */
+#define COOKED_MESH_VERSION 2
+
+/* every section starts on a cache line, the vertex and index data can be copied as is */
+#define COOKED_MESH_ALIGNMENT 64
+
+enum CookedMeshSectionType
+{
+    COOKED_MESH_SECTION_VERTICES = 0,       /* VertexFormatEncoder output, vertexStride bytes each */
+    COOKED_MESH_SECTION_INDICES,            /* uint16_t[] or uint32_t[] per indexType, LOD 0 first then every coarser LOD */
+    COOKED_MESH_SECTION_SUBMESHES,          /* Submesh[] */
+    COOKED_MESH_SECTION_LODS,               /* MeshLod[] */
+    COOKED_MESH_SECTION_MESHLETS,           /* Meshlet[] */
+    COOKED_MESH_SECTION_MESHLET_VERTICES,   /* uint32_t[] */
+    COOKED_MESH_SECTION_MESHLET_TRIANGLES,  /* uint8_t[] */
+    COOKED_MESH_SECTION_MAX_ENUM,
+};
+
+struct CookedMeshSection
+{
+    uint64_t offset = 0;
+    uint64_t size = 0;
+};
+
+struct CookedMeshHeader
+{
+    uint32_t magic = COOKED_MESH_MAGIC;
+    uint32_t version = COOKED_MESH_VERSION;
+    uint64_t fileSize = 0;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    glm::vec4 boundingSphere = glm::vec4(0.0f);
+    /* VertexFormat of the vertex and index sections */
+    uint32_t positionEncoding = VERTEX_POSITION_ENCODING_FLOAT3;
+    uint32_t normalEncoding = VERTEX_NORMAL_ENCODING_FLOAT3;
+    uint32_t texcoordEncoding = VERTEX_TEXCOORD_ENCODING_FLOAT2;
+    uint32_t vertexStride = sizeof(Vertex);
+    uint32_t indexType = VK_INDEX_TYPE_UINT32;
+    VertexDecodeParams decodeParams;
+    CookedMeshSection sections[COOKED_MESH_SECTION_MAX_ENUM];
+};
+
+/*
+ * Binary mesh container written by the cooker. The runtime maps the file and only
+ * validates the header, every accessor points into the mapping and Upload() copies
+ * the vertex and index sections from the mapping straight into the device buffers,
+ * so loading costs one read of the file and nothing else.
+ *
+ * Sections hold the in memory structs as they are, the layouts are pinned with
+ * static_asserts and any change has to bump COOKED_MESH_VERSION. Vertices and
+ * indices are stored as VertexFormatEncoder produced them, the header carries the
+ * format and the decode parameters the vertex shader needs.
+ */
+class CookedMesh
+{
+public:
+    CookedMesh(const char* path);
+   ~CookedMesh() = default;
+
+    bool IsValid() const { return header != nullptr; }
+    const CookedMeshHeader& GetHeader() const { return *header; }
+
+    uint32_t GetVertexCount() const { return (uint32_t) (header->sections[COOKED_MESH_SECTION_VERTICES].size / header->vertexStride); }
+    uint32_t GetIndexCount() const { return (uint32_t) (header->sections[COOKED_MESH_SECTION_INDICES].size / _GetIndexSize(header->indexType)); }
+    uint32_t GetSubmeshCount() const { return _Count<Submesh>(COOKED_MESH_SECTION_SUBMESHES); }
+    uint32_t GetLodCount() const { return _Count<MeshLod>(COOKED_MESH_SECTION_LODS); }
+    uint32_t GetMeshletCount() const { return _Count<Meshlet>(COOKED_MESH_SECTION_MESHLETS); }
+    
+    VertexFormat GetVertexFormat() const;
+    VkIndexType GetIndexType() const { return (VkIndexType) header->indexType; }
+    const VertexDecodeParams& GetDecodeParams() const { return header->decodeParams; }
+    
+    /* encoded, GetIndexType() decides between uint16_t and uint32_t indices */
+    const uint8_t* GetVertices() const { return _Section<uint8_t>(COOKED_MESH_SECTION_VERTICES); }
+    const uint8_t* GetIndices() const { return _Section<uint8_t>(COOKED_MESH_SECTION_INDICES); }
+    const Submesh* GetSubmeshes() const { return _Section<Submesh>(COOKED_MESH_SECTION_SUBMESHES); }
+    const MeshLod* GetLods() const { return _Section<MeshLod>(COOKED_MESH_SECTION_LODS); }
+
+    /* copies out of the mapping decoded to full precision, for the CPU side tools */
+    void GetMeshData(MeshData* pMesh) const;
+    void GetMeshletData(MeshletData* pMeshlets) const;
+    
+    /* new vertex and index buffers filled directly from the mapped sections */
+    bool Upload(RenderDevice* device, VkBufferUsageFlags usage, Buffer** ppVertexBuffer, Buffer** ppIndexBuffer) const;
+    
+    /* pMeshlets may be null, vertices and indices are encoded with format */
+    static bool Write(const char* path, const MeshData& mesh, const MeshletData* pMeshlets, const VertexFormat& format = {});
+    
+private:
+    template<typename T>
+    const T* _Section(CookedMeshSectionType type) const
+      {
+        return reinterpret_cast<const T*>(file.GetData() + header->sections[type].offset);
+      }
+
+    template<typename T>
+    uint32_t _Count(CookedMeshSectionType type) const
+      {
+        return (uint32_t) (header->sections[type].size / sizeof(T));
+      }
+
+    static uint32_t _GetIndexSize(uint32_t indexType) { return indexType == VK_INDEX_TYPE_UINT16 ? 2 : 4; }
+    bool _Validate(const char* path) const;
+    
+private:
+    MappedFile file;
+    const CookedMeshHeader* header = nullptr;
+};
@@ -0,0 +1,69 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include <Vector.h>
+
+// std
+#include <stdint.h>
+
+// glm
+#include <glm/glm.hpp>
+
+/* 32 byte full precision vertex, the layout every importer produces */
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec2 texcoord;
+    glm::vec3 normal;
+
+    bool operator==(const Vertex& other) const
+      {
+        return position == other.position && texcoord == other.texcoord && normal == other.normal;
+      }
+};
+
+/* index range drawn with one material, relative to the LOD 0 range */
+struct Submesh
+{
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    uint32_t material = 0;
+};
+
+/* index range of one level of detail, every LOD shares the vertex buffer */
+struct MeshLod
+{
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    float error = 0.0f; /* object space distance to the full mesh */
+};
+
+struct MeshData
+{
+    Vector<Vertex> vertices;
+    Vector<uint32_t> indices;
+    /* empty means one submesh over the whole LOD 0 range */
+    Vector<Submesh> submeshes;
+    /* empty, or lods[0] is the full mesh and the chain gets coarser */
+    Vector<MeshLod> lods;
+};
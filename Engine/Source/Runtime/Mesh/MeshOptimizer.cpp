@@ -0,0 +1,378 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "MeshOptimizer.h"
+
+#include <Logger.h>
+
+// std
+#include <algorithm>
+
+/* vertex fetch is simulated as a 4 KiB FIFO of 64 byte lines */
+#define MESH_OPTIMIZER_FETCH_LINE_SIZE 64
+#define MESH_OPTIMIZER_FETCH_LINE_COUNT 64
+
+/*
+ * Exact FIFO cache over integer keys, an entry is cached while fewer than cacheSize
+ * misses happened since it was inserted.
+ */
+namespace {
+class FifoCache
+{
+public:
+    FifoCache(size_t keyCount, uint32_t _cacheSize) : stamps(keyCount, 0), cacheSize(_cacheSize), time(_cacheSize + 1) {}
+
+    /* true on a miss */
+    bool Access(uint32_t key)
+      {
+        if (time - stamps[key] <= cacheSize)
+            return false;
+        stamps[key] = ++time;
+        return true;
+      }
+
+    void Reset() { time += cacheSize + 1; }
+    
+private:
+    Vector<uint32_t> stamps;
+    uint32_t cacheSize;
+    uint32_t time;
+};
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* pIndices, size_t indexCount, size_t vertexCount, Vector<uint32_t>* pClusters)
+{
+    const uint32_t cacheSize = MESH_OPTIMIZER_CACHE_SIZE;
+    size_t triangleCount = indexCount / 3;
+
+    /* triangles around every vertex */
+    Vector<uint32_t> liveCount(vertexCount, 0);
+    Vector<uint32_t> offsets(vertexCount + 1, 0);
+    Vector<uint32_t> adjacency(indexCount);
+
+    for (size_t i = 0; i < indexCount; i++)
+        liveCount[pIndices[i]]++;
+
+    for (size_t v = 0; v < vertexCount; v++)
+        offsets[v + 1] = offsets[v] + liveCount[v];
+
+    Vector<uint32_t> cursors(std::begin(offsets), std::end(offsets) - 1);
+    for (size_t i = 0; i < indexCount; i++)
+        adjacency[cursors[pIndices[i]]++] = (uint32_t) (i / 3);
+
+    Vector<uint32_t> cacheTime(vertexCount, 0);
+    Vector<bool> emitted(triangleCount, false);
+    Vector<uint32_t> deadEnd;
+    Vector<uint32_t> candidates;
+    Vector<uint32_t> output;
+    output.reserve(indexCount);
+    
+    uint32_t timestamp = cacheSize + 1;
+    uint32_t cursor = 0;
+    uint32_t fanning = UINT32_MAX;
+
+    while (cursor < vertexCount && liveCount[cursor] == 0)
+        cursor++;
+    
+    if (cursor < vertexCount)
+        fanning = cursor;
+
+    if (pClusters) {
+        pClusters->clear();
+        pClusters->push_back(0);
+    }
+    
+    while (fanning != UINT32_MAX) {
+        candidates.clear();
+
+        for (uint32_t k = offsets[fanning]; k < offsets[fanning + 1]; k++) {
+            uint32_t triangle = adjacency[k];
+            if (emitted[triangle])
+                continue;
+            
+            for (uint32_t j = 0; j < 3; j++) {
+                uint32_t v = pIndices[3 * triangle + j];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveCount[v]--;
+
+                if (timestamp - cacheTime[v] > cacheSize)
+                    cacheTime[v] = timestamp++;
+            }
+
+            emitted[triangle] = true;
+        }
+
+        /* prefer the candidate that stays in cache the longest while all its triangles are emitted */
+        uint32_t next = UINT32_MAX;
+        int64_t bestPriority = -1;
+        
+        for (uint32_t v : candidates) {
+            if (liveCount[v] == 0)
+                continue;
+
+            int64_t priority = 0;
+            if (timestamp - cacheTime[v] + 2 * liveCount[v] <= cacheSize)
+                priority = timestamp - cacheTime[v];
+
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = v;
+            }
+        }
+
+        if (next == UINT32_MAX) {
+            while (!std::empty(deadEnd)) {
+                uint32_t v = deadEnd.back();
+                deadEnd.pop_back();
+                if (liveCount[v] > 0) {
+                    next = v;
+                    break;
+                }
+            }
+
+            while (next == UINT32_MAX && cursor < vertexCount) {
+                if (liveCount[cursor] > 0)
+                    next = cursor;
+                else
+                    cursor++;
+            }
+
+            /* fan could not continue, the cache content is unrelated from here on */
+            if (pClusters && next != UINT32_MAX)
+                pClusters->push_back((uint32_t) (std::size(output) / 3));
+        }
+
+        fanning = next;
+    }
+
+    std::copy(std::begin(output), std::end(output), pIndices);
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint32_t* pIndices, size_t indexCount, const Vertex* pVertices, size_t vertexCount,
+                                     const Vector<uint32_t>& clusters, float threshold)
+{
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0 || std::empty(clusters))
+        return;
+
+    FifoCache cache(vertexCount, MESH_OPTIMIZER_CACHE_SIZE);
+    Vector<uint32_t> boundaries;
+
+    /* split hard clusters further wherever the prefix already has a good enough ACMR */
+    for (size_t c = 0; c < std::size(clusters); c++) {
+        uint32_t begin = clusters[c];
+        uint32_t end = c + 1 < std::size(clusters) ? clusters[c + 1] : (uint32_t) triangleCount;
+
+        cache.Reset();
+        uint32_t clusterMisses = 0;
+        for (uint32_t t = begin; t < end; t++) {
+            for (uint32_t j = 0; j < 3; j++)
+                clusterMisses += cache.Access(pIndices[3 * t + j]);
+        }
+        
+        float clusterAcmr = (float) clusterMisses / (float) (end - begin);
+        
+        boundaries.push_back(begin);
+        cache.Reset();
+        
+        uint32_t start = begin;
+        uint32_t misses = 0;
+        for (uint32_t t = begin; t < end; t++) {
+            for (uint32_t j = 0; j < 3; j++)
+                misses += cache.Access(pIndices[3 * t + j]);
+
+            if (t + 1 < end && (float) misses / (float) (t + 1 - start) <= clusterAcmr * threshold) {
+                boundaries.push_back(t + 1);
+                cache.Reset();
+                start = t + 1;
+                misses = 0;
+            }
+        }
+    }
+    
+    /* mesh centroid and per cluster area weighted centroid and normal */
+    glm::vec3 meshCentroid = glm::vec3(0.0f);
+    float meshArea = 0.0f;
+    
+    size_t clusterCount = std::size(boundaries);
+    Vector<float> sortKeys(clusterCount);
+    Vector<glm::vec3> clusterCentroids(clusterCount);
+    Vector<glm::vec3> clusterNormals(clusterCount);
+    
+    for (size_t c = 0; c < clusterCount; c++) {
+        uint32_t begin = boundaries[c];
+        uint32_t end = c + 1 < clusterCount ? boundaries[c + 1] : (uint32_t) triangleCount;
+
+        glm::vec3 centroid = glm::vec3(0.0f);
+        glm::vec3 normal = glm::vec3(0.0f);
+        float area = 0.0f;
+        
+        for (uint32_t t = begin; t < end; t++) {
+            const glm::vec3& p0 = pVertices[pIndices[3 * t + 0]].position;
+            const glm::vec3& p1 = pVertices[pIndices[3 * t + 1]].position;
+            const glm::vec3& p2 = pVertices[pIndices[3 * t + 2]].position;
+            
+            glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+            float triangleArea = glm::length(cross) * 0.5f;
+            
+            centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            normal += cross;
+            area += triangleArea;
+        }
+
+        meshCentroid += centroid;
+        meshArea += area;
+        
+        clusterCentroids[c] = area > 0.0f ? centroid / area : pVertices[pIndices[3 * begin]].position;
+        clusterNormals[c] = glm::length(normal) > 0.0f ? glm::normalize(normal) : glm::vec3(0.0f);
+    }
+
+    if (meshArea > 0.0f)
+        meshCentroid /= meshArea;
+
+    /* clusters facing away from the center are likely occluders of the ones behind them */
+    Vector<uint32_t> order(clusterCount);
+    for (uint32_t c = 0; c < clusterCount; c++) {
+        order[c] = c;
+        sortKeys[c] = glm::dot(clusterCentroids[c] - meshCentroid, clusterNormals[c]);
+    }
+
+    std::stable_sort(std::begin(order), std::end(order), [&](uint32_t a, uint32_t b) {
+        return sortKeys[a] > sortKeys[b];
+    });
+
+    Vector<uint32_t> output;
+    output.reserve(indexCount);
+    
+    for (uint32_t c : order) {
+        uint32_t begin = boundaries[c];
+        uint32_t end = c + 1 < clusterCount ? boundaries[c + 1] : (uint32_t) triangleCount;
+        output.insert(std::end(output), pIndices + 3 * begin, pIndices + 3 * end);
+    }
+
+    std::copy(std::begin(output), std::end(output), pIndices);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(Vertex* pVertices, size_t vertexCount, uint32_t* pIndices, size_t indexCount)
+{
+    Vector<uint32_t> remap(vertexCount, UINT32_MAX);
+    uint32_t next = 0;
+
+    for (size_t i = 0; i < indexCount; i++) {
+        uint32_t& index = pIndices[i];
+        if (remap[index] == UINT32_MAX)
+            remap[index] = next++;
+        index = remap[index];
+    }
+
+    /* unreferenced vertices keep their relative order at the end */
+    for (size_t v = 0; v < vertexCount; v++) {
+        if (remap[v] == UINT32_MAX)
+            remap[v] = next++;
+    }
+
+    Vector<Vertex> vertices(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+        vertices[remap[v]] = pVertices[v];
+
+    std::copy(std::begin(vertices), std::end(vertices), pVertices);
+}
+
+MeshOptimizer::VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t* pIndices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+    VertexCacheStats stats = {};
+    if (indexCount == 0 || vertexCount == 0)
+        return stats;
+    
+    FifoCache cache(vertexCount, cacheSize);
+    for (size_t i = 0; i < indexCount; i++)
+        stats.transformedVertices += cache.Access(pIndices[i]);
+
+    stats.acmr = (float) stats.transformedVertices / (float) (indexCount / 3);
+    stats.atvr = (float) stats.transformedVertices / (float) vertexCount;
+    
+    return stats;
+}
+
+MeshOptimizer::VertexFetchStats MeshOptimizer::AnalyzeVertexFetch(const uint32_t* pIndices, size_t indexCount, size_t vertexCount, size_t vertexSize)
+{
+    VertexFetchStats stats = {};
+    if (indexCount == 0 || vertexCount == 0)
+        return stats;
+
+    size_t lineCount = (vertexCount * vertexSize + MESH_OPTIMIZER_FETCH_LINE_SIZE - 1) / MESH_OPTIMIZER_FETCH_LINE_SIZE;
+    FifoCache cache(lineCount, MESH_OPTIMIZER_FETCH_LINE_COUNT);
+
+    for (size_t i = 0; i < indexCount; i++) {
+        size_t first = pIndices[i] * vertexSize / MESH_OPTIMIZER_FETCH_LINE_SIZE;
+        size_t last = (pIndices[i] * vertexSize + vertexSize - 1) / MESH_OPTIMIZER_FETCH_LINE_SIZE;
+
+        for (size_t line = first; line <= last; line++) {
+            if (cache.Access((uint32_t) line))
+                stats.bytesFetched += MESH_OPTIMIZER_FETCH_LINE_SIZE;
+        }
+    }
+
+    stats.overfetch = (float) stats.bytesFetched / (float) (vertexCount * vertexSize);
+    
+    return stats;
+}
+
+static void _LogMeshStats(const char* pass, const MeshData* pMesh)
+{
+    size_t indexCount = std::size(pMesh->indices);
+    size_t vertexCount = std::size(pMesh->vertices);
+    
+    MeshOptimizer::VertexCacheStats cacheStats = MeshOptimizer::AnalyzeVertexCache(std::data(pMesh->indices), indexCount, vertexCount, MESH_OPTIMIZER_CACHE_SIZE);
+    MeshOptimizer::VertexFetchStats fetchStats = MeshOptimizer::AnalyzeVertexFetch(std::data(pMesh->indices), indexCount, vertexCount, sizeof(Vertex));
+
+    GOGH_LOGGER_INFO("[Mesh] %-12s ACMR=%.3f, ATVR=%.3f, overfetch=%.3f", pass, cacheStats.acmr, cacheStats.atvr, fetchStats.overfetch);
+}
+
+void MeshOptimizer::Optimize(MeshData* pMesh)
+{
+    uint32_t* pIndices = std::data(pMesh->indices);
+    size_t indexCount = std::size(pMesh->indices);
+    size_t vertexCount = std::size(pMesh->vertices);
+
+    GOGH_LOGGER_INFO("[Mesh] Optimizing mesh, (vertices=%zu, triangles=%zu)", vertexCount, indexCount / 3);
+    _LogMeshStats("input", pMesh);
+
+    /* every LOD range is reordered on its own, triangles never move between them */
+    Vector<MeshLod> ranges = pMesh->lods;
+    if (std::empty(ranges))
+        ranges.push_back({ 0, (uint32_t) indexCount, 0.0f });
+
+    Vector<Vector<uint32_t>> clusters(std::size(ranges));
+    for (size_t i = 0; i < std::size(ranges); i++)
+        OptimizeVertexCache(pIndices + ranges[i].firstIndex, ranges[i].indexCount, vertexCount, &clusters[i]);
+    _LogMeshStats("vertexCache", pMesh);
+
+    for (size_t i = 0; i < std::size(ranges); i++)
+        OptimizeOverdraw(pIndices + ranges[i].firstIndex, ranges[i].indexCount, std::data(pMesh->vertices), vertexCount,
+                         clusters[i], MESH_OPTIMIZER_OVERDRAW_THRESHOLD);
+    _LogMeshStats("overdraw", pMesh);
+
+    OptimizeVertexFetch(std::data(pMesh->vertices), vertexCount, pIndices, indexCount);
+    _LogMeshStats("vertexFetch", pMesh);
+}
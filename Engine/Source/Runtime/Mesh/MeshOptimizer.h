@@ -0,0 +1,67 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Mesh.h"
+
+/* FIFO post transform cache the metrics are simulated with */
+#define MESH_OPTIMIZER_CACHE_SIZE 16
+
+/* overdraw pass may raise the ACMR of a cluster by at most this factor */
+#define MESH_OPTIMIZER_OVERDRAW_THRESHOLD 1.05f
+
+/*
+ * Import time index and vertex reordering, three passes run in this order:
+ *
+ *   OptimizeVertexCache()  Tipsify, triangles fan around recently used vertices
+ *   OptimizeOverdraw()     sorts Tipsify clusters so outward facing ones draw first
+ *   OptimizeVertexFetch()  reorders vertices by first use and remaps the indices
+ *
+ * Everything runs on the CPU, the Analyze*() functions give the numbers to judge
+ * each pass without a GPU.
+ */
+class MeshOptimizer
+{
+public:
+    struct VertexCacheStats {
+        uint32_t transformedVertices = 0;
+        float acmr = 0.0f; /* transformed vertices per triangle, 0.5 best, 3.0 worst */
+        float atvr = 0.0f; /* transformed vertices per vertex, 1.0 best */
+    };
+
+    struct VertexFetchStats {
+        size_t bytesFetched = 0;
+        float overfetch = 0.0f; /* fetched bytes / vertex buffer bytes, 1.0 best */
+    };
+
+    /* pClusters receives the first triangle of every hard cluster, may be null */
+    static void OptimizeVertexCache(uint32_t* pIndices, size_t indexCount, size_t vertexCount, Vector<uint32_t>* pClusters);
+    static void OptimizeOverdraw(uint32_t* pIndices, size_t indexCount, const Vertex* pVertices, size_t vertexCount,
+                                 const Vector<uint32_t>& clusters, float threshold);
+    static void OptimizeVertexFetch(Vertex* pVertices, size_t vertexCount, uint32_t* pIndices, size_t indexCount);
+
+    static VertexCacheStats AnalyzeVertexCache(const uint32_t* pIndices, size_t indexCount, size_t vertexCount, uint32_t cacheSize);
+    static VertexFetchStats AnalyzeVertexFetch(const uint32_t* pIndices, size_t indexCount, size_t vertexCount, size_t vertexSize);
+
+    /* all three passes with the metrics logged before and after each one, LOD ranges are kept apart */
+    static void Optimize(MeshData* pMesh);
+};
@@ -0,0 +1,424 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "MeshSimplifier.h"
+
+#include <Logger.h>
+
+// std
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+/* edge plane quadrics of open borders weigh this much more than the face planes */
+#define MESH_SIMPLIFIER_BORDER_WEIGHT 10.0f
+
+/* squared normal and texcoord distance to relative squared error */
+#define MESH_SIMPLIFIER_ATTRIBUTE_WEIGHT 0.01f
+
+/* LOD chain stops when a level keeps more than this fraction of the previous one */
+#define MESH_SIMPLIFIER_MIN_REDUCTION 0.9f
+
+namespace {
+enum VertexKind : uint8_t
+{
+    VERTEX_KIND_MANIFOLD = 0,
+    VERTEX_KIND_BORDER,
+    VERTEX_KIND_LOCKED,
+};
+
+/* symmetric 4x4 plane quadric, error(p) = p^T A p + 2 b^T p + c */
+struct Quadric
+{
+    float a00 = 0.0f, a01 = 0.0f, a02 = 0.0f, a11 = 0.0f, a12 = 0.0f, a22 = 0.0f;
+    float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+    float c = 0.0f;
+    float weight = 0.0f;
+
+    void AddPlane(const glm::vec3& n, float d, float w)
+      {
+        a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z;
+        a11 += w * n.y * n.y; a12 += w * n.y * n.z; a22 += w * n.z * n.z;
+        b0 += w * n.x * d; b1 += w * n.y * d; b2 += w * n.z * d;
+        c += w * d * d;
+      }
+
+    void Add(const Quadric& q)
+      {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02;
+        a11 += q.a11; a12 += q.a12; a22 += q.a22;
+        b0 += q.b0; b1 += q.b1; b2 += q.b2;
+        c += q.c;
+        weight += q.weight;
+      }
+
+    float Evaluate(const glm::vec3& p) const
+      {
+        float rx = a00 * p.x + a01 * p.y + a02 * p.z + 2.0f * b0;
+        float ry = a01 * p.x + a11 * p.y + a12 * p.z + 2.0f * b1;
+        float rz = a02 * p.x + a12 * p.y + a22 * p.z + 2.0f * b2;
+        return fabsf(rx * p.x + ry * p.y + rz * p.z + c);
+      }
+};
+
+struct Collapse
+{
+    uint32_t from;
+    uint32_t to;
+    float cost;
+};
+}
+
+static uint64_t _EdgeKey(uint32_t a, uint32_t b)
+{
+    return ((uint64_t) a << 32) | b;
+}
+
+static bool _HasEdge(const Vector<uint64_t>& edges, uint32_t a, uint32_t b)
+{
+    return std::binary_search(std::begin(edges), std::end(edges), _EdgeKey(a, b));
+}
+
+/* remap[v] is the first vertex sharing the exact position of v */
+static void _BuildPositionRemap(const Vertex* pVertices, size_t vertexCount, Vector<uint32_t>* pRemap)
+{
+    Vector<uint32_t> order(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; i++)
+        order[i] = i;
+
+    auto less = [&](uint32_t a, uint32_t b) {
+        int cmp = memcmp(&pVertices[a].position, &pVertices[b].position, sizeof(glm::vec3));
+        return cmp != 0 ? cmp < 0 : a < b;
+    };
+    std::sort(std::begin(order), std::end(order), less);
+
+    pRemap->resize(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++) {
+        uint32_t v = order[i];
+        bool same = i > 0 && memcmp(&pVertices[order[i - 1]].position, &pVertices[v].position, sizeof(glm::vec3)) == 0;
+        (*pRemap)[v] = same ? (*pRemap)[order[i - 1]] : v;
+    }
+}
+
+/* directed edges between position representatives, sorted for lookup */
+static void _BuildEdges(const uint32_t* pIndices, size_t indexCount, const Vector<uint32_t>& remap, Vector<uint64_t>* pEdges)
+{
+    pEdges->clear();
+    for (size_t i = 0; i < indexCount; i += 3) {
+        for (uint32_t e = 0; e < 3; e++) {
+            uint32_t a = remap[pIndices[i + e]];
+            uint32_t b = remap[pIndices[i + (e + 1) % 3]];
+            pEdges->push_back(_EdgeKey(a, b));
+        }
+    }
+    
+    std::sort(std::begin(*pEdges), std::end(*pEdges));
+}
+
+static glm::vec3 _TriangleNormal(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2)
+{
+    return glm::cross(p1 - p0, p2 - p0);
+}
+
+size_t MeshSimplifier::Simplify(const Vertex* pVertices, size_t vertexCount, const uint32_t* pIndices, size_t indexCount,
+                                size_t targetIndexCount, float targetError, uint32_t* pDestination, float* pResultError)
+{
+    memcpy(pDestination, pIndices, sizeof(uint32_t) * indexCount);
+    *pResultError = 0.0f;
+
+    if (indexCount == 0 || targetIndexCount >= indexCount)
+        return indexCount;
+    
+    /* positions normalized to the unit cube so errors are relative to the extent */
+    glm::vec3 minimum = pVertices[0].position;
+    glm::vec3 maximum = minimum;
+    for (size_t i = 1; i < vertexCount; i++) {
+        minimum = glm::min(minimum, pVertices[i].position);
+        maximum = glm::max(maximum, pVertices[i].position);
+    }
+
+    float extent = glm::max(maximum.x - minimum.x, glm::max(maximum.y - minimum.y, maximum.z - minimum.z));
+    float inverseExtent = extent > 0.0f ? 1.0f / extent : 0.0f;
+    
+    Vector<glm::vec3> positions(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++)
+        positions[i] = (pVertices[i].position - minimum) * inverseExtent;
+
+    Vector<uint32_t> remap;
+    _BuildPositionRemap(pVertices, vertexCount, &remap);
+
+    Vector<uint64_t> edges;
+    _BuildEdges(pIndices, indexCount, remap, &edges);
+
+    /* open edge count per position, and how many distinct vertices share it */
+    Vector<uint32_t> openEdges(vertexCount, 0);
+    Vector<uint32_t> wedges(vertexCount, 0);
+    
+    for (size_t i = 0; i < vertexCount; i++)
+        wedges[remap[i]]++;
+    
+    for (uint64_t edge : edges) {
+        uint32_t a = (uint32_t) (edge >> 32);
+        uint32_t b = (uint32_t) edge;
+        if (!_HasEdge(edges, b, a)) {
+            openEdges[a]++;
+            openEdges[b]++;
+        }
+    }
+
+    Vector<VertexKind> kinds(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++) {
+        uint32_t r = remap[i];
+        if (wedges[r] > 1 || (openEdges[r] != 0 && openEdges[r] != 2))
+            kinds[i] = VERTEX_KIND_LOCKED;
+        else
+            kinds[i] = openEdges[r] == 2 ? VERTEX_KIND_BORDER : VERTEX_KIND_MANIFOLD;
+    }
+
+    Vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < indexCount; i += 3) {
+        const uint32_t* triangle = &pIndices[i];
+        const glm::vec3& p0 = positions[triangle[0]];
+        glm::vec3 normal = _TriangleNormal(p0, positions[triangle[1]], positions[triangle[2]]);
+        float length = glm::length(normal);
+        if (length == 0.0f)
+            continue;
+
+        normal /= length;
+        float area = 0.5f * length;
+        
+        for (uint32_t e = 0; e < 3; e++) {
+            Quadric& quadric = quadrics[triangle[e]];
+            quadric.AddPlane(normal, -glm::dot(normal, p0), area);
+            quadric.weight += area;
+        }
+
+        /* a plane through the open edge perpendicular to the face keeps the outline */
+        for (uint32_t e = 0; e < 3; e++) {
+            uint32_t a = triangle[e];
+            uint32_t b = triangle[(e + 1) % 3];
+            if (_HasEdge(edges, remap[b], remap[a]))
+                continue;
+
+            glm::vec3 edge = positions[b] - positions[a];
+            glm::vec3 edgeNormal = glm::cross(edge, normal);
+            float edgeLength = glm::length(edgeNormal);
+            if (edgeLength == 0.0f)
+                continue;
+
+            edgeNormal /= edgeLength;
+            float weight = MESH_SIMPLIFIER_BORDER_WEIGHT * glm::dot(edge, edge);
+            quadrics[a].AddPlane(edgeNormal, -glm::dot(edgeNormal, positions[a]), weight);
+            quadrics[b].AddPlane(edgeNormal, -glm::dot(edgeNormal, positions[a]), weight);
+        }
+    }
+
+    auto collapseCost = [&](uint32_t from, uint32_t to) {
+        Quadric quadric = quadrics[from];
+        quadric.Add(quadrics[to]);
+        
+        const glm::vec3& p = positions[to];
+        float error = quadric.weight > 0.0f ? quadric.Evaluate(p) / quadric.weight : quadric.Evaluate(p);
+        
+        glm::vec3 normal = pVertices[from].normal - pVertices[to].normal;
+        glm::vec2 texcoord = pVertices[from].texcoord - pVertices[to].texcoord;
+        return error + MESH_SIMPLIFIER_ATTRIBUTE_WEIGHT * (glm::dot(normal, normal) + glm::dot(texcoord, texcoord));
+    };
+
+    auto canCollapse = [&](uint32_t from, uint32_t to) {
+        if (kinds[from] == VERTEX_KIND_MANIFOLD)
+            return true;
+        /* a border vertex may only slide along the open edge it shares with the target */
+        return kinds[from] == VERTEX_KIND_BORDER &&
+               (!_HasEdge(edges, remap[to], remap[from]) || !_HasEdge(edges, remap[from], remap[to]));
+    };
+
+    size_t currentCount = indexCount;
+    float targetCost = targetError * targetError;
+    float resultCost = 0.0f;
+
+    Vector<uint32_t> offsets(vertexCount + 1);
+    Vector<uint32_t> adjacency;
+    Vector<Collapse> collapses;
+    Vector<uint32_t> collapseTarget(vertexCount);
+    Vector<uint8_t> touched(vertexCount);
+    
+    while (currentCount > targetIndexCount) {
+        _BuildEdges(pDestination, currentCount, remap, &edges);
+        
+        /* triangles around every vertex */
+        std::fill(std::begin(offsets), std::end(offsets), 0);
+        for (size_t i = 0; i < currentCount; i++)
+            offsets[pDestination[i] + 1]++;
+        for (size_t v = 0; v < vertexCount; v++)
+            offsets[v + 1] += offsets[v];
+
+        adjacency.resize(currentCount);
+        Vector<uint32_t> cursors(std::begin(offsets), std::end(offsets) - 1);
+        for (size_t i = 0; i < currentCount; i++)
+            adjacency[cursors[pDestination[i]]++] = (uint32_t) (i / 3);
+
+        /* cheapest legal direction of every edge */
+        collapses.clear();
+        for (size_t i = 0; i < currentCount; i += 3) {
+            for (uint32_t e = 0; e < 3; e++) {
+                uint32_t a = pDestination[i + e];
+                uint32_t b = pDestination[i + (e + 1) % 3];
+                
+                bool ab = canCollapse(a, b);
+                bool ba = canCollapse(b, a);
+                if (!ab && !ba)
+                    continue;
+
+                float costAB = ab ? collapseCost(a, b) : FLT_MAX;
+                float costBA = ba ? collapseCost(b, a) : FLT_MAX;
+                collapses.push_back(costAB <= costBA ? Collapse{ a, b, costAB } : Collapse{ b, a, costBA });
+            }
+        }
+
+        std::sort(std::begin(collapses), std::end(collapses), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+        for (uint32_t v = 0; v < vertexCount; v++)
+            collapseTarget[v] = v;
+        std::fill(std::begin(touched), std::end(touched), 0);
+
+        size_t trianglesToRemove = (currentCount - targetIndexCount) / 3;
+        size_t removed = 0;
+        
+        for (const Collapse& collapse : collapses) {
+            if (collapse.cost > targetCost || removed >= trianglesToRemove)
+                break;
+            
+            if (touched[collapse.from] || touched[collapse.to])
+                continue;
+
+            /* the collapse must not flip a surviving triangle */
+            bool flips = false;
+            uint32_t degenerate = 0;
+            
+            for (uint32_t j = offsets[collapse.from]; j < offsets[collapse.from + 1] && !flips; j++) {
+                const uint32_t* triangle = &pDestination[3 * adjacency[j]];
+                if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) {
+                    degenerate++;
+                    continue;
+                }
+
+                glm::vec3 p[3], q[3];
+                for (uint32_t k = 0; k < 3; k++) {
+                    p[k] = positions[triangle[k]];
+                    q[k] = triangle[k] == collapse.from ? positions[collapse.to] : p[k];
+                }
+
+                flips = glm::dot(_TriangleNormal(p[0], p[1], p[2]), _TriangleNormal(q[0], q[1], q[2])) <= 0.0f;
+            }
+
+            if (flips)
+                continue;
+
+            collapseTarget[collapse.from] = collapse.to;
+            quadrics[collapse.to].Add(quadrics[collapse.from]);
+            resultCost = glm::max(resultCost, collapse.cost);
+            removed += degenerate;
+
+            /* the neighbourhood changed, later collapses of this pass would use stale costs */
+            for (uint32_t j = offsets[collapse.from]; j < offsets[collapse.from + 1]; j++) {
+                const uint32_t* triangle = &pDestination[3 * adjacency[j]];
+                touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+            }
+        }
+
+        if (removed == 0)
+            break;
+
+        size_t writeCount = 0;
+        for (size_t i = 0; i < currentCount; i += 3) {
+            uint32_t a = collapseTarget[pDestination[i + 0]];
+            uint32_t b = collapseTarget[pDestination[i + 1]];
+            uint32_t c = collapseTarget[pDestination[i + 2]];
+            if (a == b || b == c || c == a)
+                continue;
+
+            pDestination[writeCount++] = a;
+            pDestination[writeCount++] = b;
+            pDestination[writeCount++] = c;
+        }
+
+        currentCount = writeCount;
+    }
+
+    *pResultError = sqrtf(resultCost);
+    return currentCount;
+}
+
+void MeshSimplifier::GenerateLods(MeshData* pMesh, uint32_t maxLodCount, float reduction, float maxError)
+{
+    const Vertex* pVertices = std::data(pMesh->vertices);
+    size_t vertexCount = std::size(pMesh->vertices);
+    size_t indexCount = !std::empty(pMesh->lods) ? pMesh->lods[0].indexCount : std::size(pMesh->indices);
+
+    /* drop a previous chain, LOD 0 always starts the index buffer */
+    pMesh->indices.resize(indexCount);
+    pMesh->lods.clear();
+    pMesh->lods.push_back({ 0, (uint32_t) indexCount, 0.0f });
+
+    if (indexCount == 0)
+        return;
+    
+    glm::vec3 minimum = pVertices[0].position;
+    glm::vec3 maximum = minimum;
+    for (size_t i = 1; i < vertexCount; i++) {
+        minimum = glm::min(minimum, pVertices[i].position);
+        maximum = glm::max(maximum, pVertices[i].position);
+    }
+
+    float extent = glm::max(maximum.x - minimum.x, glm::max(maximum.y - minimum.y, maximum.z - minimum.z));
+    
+    Vector<uint32_t> lodIndices(indexCount);
+    size_t previousCount = indexCount;
+
+    GOGH_LOGGER_INFO("[Mesh] Generating LODs, (triangles=%zu)", indexCount / 3);
+    
+    while (std::size(pMesh->lods) < maxLodCount) {
+        size_t targetCount = (size_t) ((float) previousCount * reduction) / 3 * 3;
+        
+        float error = 0.0f;
+        size_t lodCount = Simplify(pVertices, vertexCount, std::data(pMesh->indices), indexCount,
+                                   targetCount, maxError, std::data(lodIndices), &error);
+
+        /* error budget exhausted, a new level would cost memory without saving much */
+        if (lodCount == 0 || (float) lodCount > (float) previousCount * MESH_SIMPLIFIER_MIN_REDUCTION)
+            break;
+
+        MeshLod lod = {};
+        lod.firstIndex = (uint32_t) std::size(pMesh->indices);
+        lod.indexCount = (uint32_t) lodCount;
+        lod.error = error * extent;
+        
+        pMesh->indices.insert(std::end(pMesh->indices), std::begin(lodIndices), std::begin(lodIndices) + lodCount);
+        pMesh->lods.push_back(lod);
+
+        GOGH_LOGGER_INFO("[Mesh] LOD %zu triangles=%zu (%.1f%%), error=%f",
+                         std::size(pMesh->lods) - 1, lodCount / 3, 100.0 * lodCount / indexCount, lod.error);
+        
+        previousCount = lodCount;
+    }
+}
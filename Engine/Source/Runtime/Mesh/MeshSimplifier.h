@@ -0,0 +1,67 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Mesh.h"
+
+/* length of the LOD chain GenerateLods() builds, the full mesh included */
+#define MESH_SIMPLIFIER_MAX_LODS 6
+
+/* each LOD targets this fraction of the previous one's triangles */
+#define MESH_SIMPLIFIER_LOD_REDUCTION 0.5f
+
+/* relative error (fraction of the mesh extent) no LOD may exceed */
+#define MESH_SIMPLIFIER_MAX_ERROR 0.05f
+
+/*
+ * Quadric error metric edge collapse (Garland-Heckbert). Vertices only collapse onto
+ * a neighbour, so every LOD is a new index list over the untouched vertex buffer.
+ *
+ *   - border vertices only slide along their border edge and carry extra edge plane
+ *     quadrics, so open boundaries keep their outline
+ *   - vertices split by an attribute seam (same position, different normal or uv)
+ *     stay locked
+ *   - normal and texcoord differences add to the collapse cost, flat regions with a
+ *     uv or shading gradient lose detail later than geometric error alone would allow
+ *   - a collapse that flips any remaining triangle is rejected
+ *
+ * Collapses run in passes ordered by cost, every pass touches a vertex neighbourhood
+ * at most once so costs stay exact without a priority queue.
+ */
+class MeshSimplifier
+{
+public:
+    /*
+     * Simplifies towards targetIndexCount without going past targetError (relative to
+     * the mesh extent), pDestination must hold indexCount indices. Returns the new
+     * index count, pResultError receives the relative error reached.
+     */
+    static size_t Simplify(const Vertex* pVertices, size_t vertexCount, const uint32_t* pIndices, size_t indexCount,
+                           size_t targetIndexCount, float targetError, uint32_t* pDestination, float* pResultError);
+    
+    /*
+     * Replaces pMesh->lods with the full mesh plus up to maxLodCount - 1 coarser levels,
+     * appended to pMesh->indices. Every level is simplified from the full mesh so its
+     * error is measured against the original. Run MeshOptimizer::Optimize() afterwards.
+     */
+    static void GenerateLods(MeshData* pMesh, uint32_t maxLodCount, float reduction, float maxError);
+};
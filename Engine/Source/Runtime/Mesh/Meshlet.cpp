@@ -0,0 +1,151 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "Meshlet.h"
+
+#include <Logger.h>
+
+/* below this the triangle normals spread too far for a cone test to ever cull */
+#define MESHLET_CONE_MIN_COSINE 0.1f
+
+void MeshletBuilder::Build(const MeshData& mesh, uint32_t maxVertices, uint32_t maxTriangles, MeshletData* pMeshlets)
+{
+    /* meshlets cover the full detail LOD only */
+    size_t triangleCount = (std::empty(mesh.lods) ? std::size(mesh.indices) : mesh.lods[0].indexCount) / 3;
+    
+    pMeshlets->meshlets.clear();
+    pMeshlets->vertices.clear();
+    pMeshlets->triangles.clear();
+
+    /* local index of every vertex in the meshlet being built, UINT8_MAX when absent */
+    Vector<uint8_t> localIndex(std::size(mesh.vertices), UINT8_MAX);
+    Meshlet meshlet = {};
+
+    auto flush = [&]() {
+        if (meshlet.triangleCount == 0)
+            return;
+
+        for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+            localIndex[pMeshlets->vertices[meshlet.vertexOffset + i]] = UINT8_MAX;
+        
+        _ComputeBounds(mesh, *pMeshlets, &meshlet);
+        pMeshlets->meshlets.push_back(meshlet);
+
+        meshlet = {};
+        meshlet.vertexOffset = (uint32_t) std::size(pMeshlets->vertices);
+        meshlet.triangleOffset = (uint32_t) std::size(pMeshlets->triangles);
+    };
+    
+    for (size_t t = 0; t < triangleCount; t++) {
+        const uint32_t* triangle = &mesh.indices[3 * t];
+
+        uint32_t newVertices = 0;
+        for (uint32_t j = 0; j < 3; j++)
+            newVertices += localIndex[triangle[j]] == UINT8_MAX;
+
+        if (meshlet.vertexCount + newVertices > maxVertices || meshlet.triangleCount + 1 > maxTriangles)
+            flush();
+
+        if (meshlet.triangleCount == 0)
+            meshlet.firstIndex = (uint32_t) (3 * t);
+        
+        for (uint32_t j = 0; j < 3; j++) {
+            uint32_t v = triangle[j];
+            if (localIndex[v] == UINT8_MAX) {
+                localIndex[v] = (uint8_t) meshlet.vertexCount++;
+                pMeshlets->vertices.push_back(v);
+            }
+            pMeshlets->triangles.push_back(localIndex[v]);
+        }
+
+        meshlet.triangleCount++;
+    }
+
+    flush();
+
+    GOGH_LOGGER_DEBUG("[Mesh] Build meshlets, (triangles=%zu, meshlets=%zu, avgVertices=%.1f, avgTriangles=%.1f)",
+                      triangleCount, std::size(pMeshlets->meshlets),
+                      std::empty(pMeshlets->meshlets) ? 0.0 : (double) std::size(pMeshlets->vertices) / std::size(pMeshlets->meshlets),
+                      std::empty(pMeshlets->meshlets) ? 0.0 : (double) triangleCount / std::size(pMeshlets->meshlets));
+}
+
+void MeshletBuilder::_ComputeBounds(const MeshData& mesh, const MeshletData& meshlets, Meshlet* pMeshlet)
+{
+    const uint32_t* vertices = &meshlets.vertices[pMeshlet->vertexOffset];
+    const uint8_t* triangles = &meshlets.triangles[pMeshlet->triangleOffset];
+
+    /* Ritter sphere, start from the two points farthest apart along x */
+    glm::vec3 minX = mesh.vertices[vertices[0]].position;
+    glm::vec3 maxX = minX;
+    for (uint32_t i = 1; i < pMeshlet->vertexCount; i++) {
+        const glm::vec3& p = mesh.vertices[vertices[i]].position;
+        if (p.x < minX.x) minX = p;
+        if (p.x > maxX.x) maxX = p;
+    }
+
+    glm::vec3 center = (minX + maxX) * 0.5f;
+    float radius = glm::length(maxX - minX) * 0.5f;
+    
+    for (uint32_t i = 0; i < pMeshlet->vertexCount; i++) {
+        const glm::vec3& p = mesh.vertices[vertices[i]].position;
+        float distance = glm::length(p - center);
+        if (distance > radius) {
+            float newRadius = (radius + distance) * 0.5f;
+            center += (p - center) * ((newRadius - radius) / distance);
+            radius = newRadius;
+        }
+    }
+
+    pMeshlet->boundingSphere = glm::vec4(center, radius);
+
+    /* normal cone from the face normals */
+    Vector<glm::vec3> normals;
+    glm::vec3 axis = glm::vec3(0.0f);
+    
+    for (uint32_t t = 0; t < pMeshlet->triangleCount; t++) {
+        const glm::vec3& p0 = mesh.vertices[vertices[triangles[3 * t + 0]]].position;
+        const glm::vec3& p1 = mesh.vertices[vertices[triangles[3 * t + 1]]].position;
+        const glm::vec3& p2 = mesh.vertices[vertices[triangles[3 * t + 2]]].position;
+        
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        float length = glm::length(normal);
+        if (length <= 0.0f)
+            continue;
+        
+        normals.push_back(normal / length);
+        axis += normal / length;
+    }
+
+    float axisLength = glm::length(axis);
+    if (std::empty(normals) || axisLength <= 0.0f)
+        return;
+    
+    axis /= axisLength;
+    
+    float minCosine = 1.0f;
+    for (const glm::vec3& normal : normals)
+        minCosine = glm::min(minCosine, glm::dot(axis, normal));
+
+    if (minCosine <= MESHLET_CONE_MIN_COSINE)
+        return;
+
+    pMeshlet->cone = glm::vec4(axis, glm::sqrt(1.0f - minCosine * minCosine));
+}
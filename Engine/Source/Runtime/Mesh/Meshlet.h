@@ -0,0 +1,62 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Mesh.h"
+
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
+
+/*
+ * A cluster of consecutive triangles of the index buffer. Triangles stay where they
+ * are in the source index buffer (firstIndex / triangleCount), the local vertex list
+ * and uint8 triangle list are the layout a mesh shader consumes directly.
+ */
+struct Meshlet
+{
+    uint32_t firstIndex = 0;
+    uint32_t triangleCount = 0;
+    uint32_t vertexOffset = 0;  /* into MeshletData::vertices */
+    uint32_t vertexCount = 0;
+    uint32_t triangleOffset = 0; /* into MeshletData::triangles, 3 bytes per triangle */
+    
+    glm::vec4 boundingSphere = glm::vec4(0.0f);
+    /* xyz axis, w = sin of the cone half angle, 1.0 means the cone never culls */
+    glm::vec4 cone = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+};
+
+struct MeshletData
+{
+    Vector<Meshlet> meshlets;
+    Vector<uint32_t> vertices;
+    Vector<uint8_t> triangles;
+};
+
+class MeshletBuilder
+{
+public:
+    /* run after MeshOptimizer, the builder only cuts the index stream where a limit is reached */
+    static void Build(const MeshData& mesh, uint32_t maxVertices, uint32_t maxTriangles, MeshletData* pMeshlets);
+
+private:
+    static void _ComputeBounds(const MeshData& mesh, const MeshletData& meshlets, Meshlet* pMeshlet);
+};
@@ -0,0 +1,408 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "ObjImporter.h"
+
+#include "Core/JobSystem.h"
+#include "Core/MappedFile.h"
+
+#include <Logger.h>
+
+// std
+#include <charconv>
+#include <chrono>
+#include <string.h>
+
+#define OBJ_CORNER_RELATIVE_POSITION 0x1
+#define OBJ_CORNER_RELATIVE_TEXCOORD 0x2
+#define OBJ_CORNER_RELATIVE_NORMAL 0x4
+
+namespace {
+/* 0-based attribute indices, -1 when absent, relative ones still miss the chunk base */
+struct Corner
+{
+    int32_t position = -1;
+    int32_t texcoord = -1;
+    int32_t normal = -1;
+    uint32_t relativeMask = 0;
+};
+
+struct Chunk
+{
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    
+    Vector<glm::vec3> positions;
+    Vector<glm::vec2> texcoords;
+    Vector<glm::vec3> normals;
+    Vector<Corner> corners;
+    uint32_t errors = 0;
+
+    /* attribute and corner bases of this chunk in the merged arrays */
+    size_t positionBase = 0;
+    size_t texcoordBase = 0;
+    size_t normalBase = 0;
+    size_t cornerBase = 0;
+};
+}
+
+static const char* _SkipSpaces(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+    return p;
+}
+
+static bool _ParseFloat(const char** pp, const char* end, float* pValue)
+{
+    const char* p = _SkipSpaces(*pp, end);
+    if (p < end && *p == '+')
+        p++;
+    
+    std::from_chars_result result = std::from_chars(p, end, *pValue);
+    if (result.ec != std::errc())
+        return false;
+    
+    *pp = result.ptr;
+    return true;
+}
+
+static bool _ParseInt(const char** pp, const char* end, int32_t* pValue)
+{
+    const char* p = *pp;
+    bool negative = p < end && *p == '-';
+    if (negative || (p < end && *p == '+'))
+        p++;
+
+    if (p >= end || *p < '0' || *p > '9')
+        return false;
+    
+    int64_t value = 0;
+    while (p < end && *p >= '0' && *p <= '9' && value <= INT32_MAX)
+        value = value * 10 + (*p++ - '0');
+
+    *pValue = (int32_t) (negative ? -value : value);
+    *pp = p;
+    return true;
+}
+
+/* 1-based or negative OBJ index to a 0-based one, relative when counted from the end */
+static bool _ResolveIndex(int32_t index, size_t localCount, uint32_t relativeBit, int32_t* pIndex, uint32_t* pRelativeMask)
+{
+    if (index > 0) {
+        *pIndex = index - 1;
+        return true;
+    }
+
+    if (index < 0) {
+        *pIndex = (int32_t) localCount + index;
+        *pRelativeMask |= relativeBit;
+        return true;
+    }
+
+    return false;
+}
+
+static bool _ParseCorner(const char** pp, const char* end, const Chunk& chunk, Corner* pCorner)
+{
+    const char* p = *pp;
+    int32_t index;
+
+    *pCorner = {};
+    
+    if (!_ParseInt(&p, end, &index) ||
+        !_ResolveIndex(index, std::size(chunk.positions), OBJ_CORNER_RELATIVE_POSITION, &pCorner->position, &pCorner->relativeMask))
+        return false;
+
+    if (p < end && *p == '/') {
+        p++;
+        
+        if (p < end && *p != '/') {
+            if (!_ParseInt(&p, end, &index) ||
+                !_ResolveIndex(index, std::size(chunk.texcoords), OBJ_CORNER_RELATIVE_TEXCOORD, &pCorner->texcoord, &pCorner->relativeMask))
+                return false;
+        }
+
+        if (p < end && *p == '/') {
+            p++;
+            if (!_ParseInt(&p, end, &index) ||
+                !_ResolveIndex(index, std::size(chunk.normals), OBJ_CORNER_RELATIVE_NORMAL, &pCorner->normal, &pCorner->relativeMask))
+                return false;
+        }
+    }
+
+    *pp = p;
+    return true;
+}
+
+static void _ParseChunk(Chunk* pChunk)
+{
+    const char* p = pChunk->begin;
+    const char* end = pChunk->end;
+
+    while (p < end) {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!lineEnd)
+            lineEnd = end;
+
+        p = _SkipSpaces(p, lineEnd);
+        
+        if (lineEnd - p >= 2 && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+            glm::vec3& position = pChunk->positions.emplace_back();
+            p += 2;
+            if (!_ParseFloat(&p, lineEnd, &position.x) || !_ParseFloat(&p, lineEnd, &position.y) || !_ParseFloat(&p, lineEnd, &position.z))
+                pChunk->errors++;
+        } else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t')) {
+            glm::vec2& texcoord = pChunk->texcoords.emplace_back();
+            p += 3;
+            if (!_ParseFloat(&p, lineEnd, &texcoord.x) || !_ParseFloat(&p, lineEnd, &texcoord.y))
+                pChunk->errors++;
+        } else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 'n' && (p[2] == ' ' || p[2] == '\t')) {
+            glm::vec3& normal = pChunk->normals.emplace_back();
+            p += 3;
+            if (!_ParseFloat(&p, lineEnd, &normal.x) || !_ParseFloat(&p, lineEnd, &normal.y) || !_ParseFloat(&p, lineEnd, &normal.z))
+                pChunk->errors++;
+        } else if (lineEnd - p >= 2 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+            Corner first, previous, corner;
+            uint32_t count = 0;
+            
+            p = _SkipSpaces(p + 2, lineEnd);
+            while (p < lineEnd) {
+                if (!_ParseCorner(&p, lineEnd, *pChunk, &corner)) {
+                    pChunk->errors++;
+                    break;
+                }
+
+                /* fan triangulation */
+                if (count == 0) {
+                    first = corner;
+                } else if (count >= 2) {
+                    pChunk->corners.push_back(first);
+                    pChunk->corners.push_back(previous);
+                    pChunk->corners.push_back(corner);
+                }
+
+                previous = corner;
+                count++;
+                p = _SkipSpaces(p, lineEnd);
+            }
+        }
+
+        p = lineEnd + 1;
+    }
+}
+
+static uint64_t _Mix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+/* every bit of the 32 byte vertex reaches every bit of the hash */
+static uint64_t _HashVertex(const Vertex& vertex)
+{
+    uint64_t words[4];
+    memcpy(words, &vertex, sizeof(words));
+
+    uint64_t hash = 0x9e3779b97f4a7c15ull;
+    for (uint64_t word : words)
+        hash = _Mix(hash ^ word) + 0x9e3779b97f4a7c15ull;
+    
+    return hash;
+}
+
+static bool _ResolveCorner(Corner* pCorner, const Chunk& chunk, size_t positionCount, size_t texcoordCount, size_t normalCount)
+{
+    if (pCorner->relativeMask & OBJ_CORNER_RELATIVE_POSITION)
+        pCorner->position += (int32_t) chunk.positionBase;
+    if (pCorner->relativeMask & OBJ_CORNER_RELATIVE_TEXCOORD)
+        pCorner->texcoord += (int32_t) chunk.texcoordBase;
+    if (pCorner->relativeMask & OBJ_CORNER_RELATIVE_NORMAL)
+        pCorner->normal += (int32_t) chunk.normalBase;
+
+    return pCorner->position >= 0 && (size_t) pCorner->position < positionCount &&
+           pCorner->texcoord >= -1 && (pCorner->texcoord == -1 || (size_t) pCorner->texcoord < texcoordCount) &&
+           pCorner->normal >= -1 && (pCorner->normal == -1 || (size_t) pCorner->normal < normalCount);
+}
+
+bool ObjImporter::Import(const char* path, JobSystem* pJobSystem, MeshData* pMesh)
+{
+    MappedFile file(path);
+    if (!file.IsValid())
+        return false;
+
+    GOGH_LOGGER_INFO("[Mesh] Importing OBJ, (path=%s, size=%.1f MiB)", path, (double) file.GetSize() / (1024.0 * 1024.0));
+    return ImportFromMemory(reinterpret_cast<const char*>(file.GetData()), file.GetSize(), pJobSystem, pMesh);
+}
+
+bool ObjImporter::ImportFromMemory(const char* pText, size_t size, JobSystem* pJobSystem, MeshData* pMesh)
+{
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+
+    pMesh->vertices.clear();
+    pMesh->indices.clear();
+    pMesh->submeshes.clear();
+    pMesh->lods.clear();
+
+    uint32_t threadCount = pJobSystem ? pJobSystem->GetThreadCount() : 1;
+    size_t chunkSize = std::max(size / (threadCount * OBJ_IMPORTER_CHUNKS_PER_THREAD), (size_t) OBJ_IMPORTER_MIN_CHUNK_SIZE);
+
+    /* cut after a newline so no line spans two chunks */
+    Vector<Chunk> chunks;
+    const char* end = pText + size;
+    for (const char* p = pText; p < end;) {
+        const char* chunkEnd = p + std::min(chunkSize, (size_t) (end - p));
+        if (chunkEnd < end) {
+            const char* newline = static_cast<const char*>(memchr(chunkEnd, '\n', end - chunkEnd));
+            chunkEnd = newline ? newline + 1 : end;
+        }
+
+        Chunk& chunk = chunks.emplace_back();
+        chunk.begin = p;
+        chunk.end = chunkEnd;
+        p = chunkEnd;
+    }
+
+    auto forEachChunk = [&](const std::function<void(uint32_t)>& job) {
+        if (pJobSystem)
+            pJobSystem->Dispatch((uint32_t) std::size(chunks), job);
+        else
+            for (uint32_t i = 0; i < std::size(chunks); i++)
+                job(i);
+    };
+
+    forEachChunk([&](uint32_t i) { _ParseChunk(&chunks[i]); });
+
+    /* chunk bases are prefix sums of what the chunks before them declared */
+    size_t positionCount = 0, texcoordCount = 0, normalCount = 0, cornerCount = 0;
+    uint32_t errors = 0;
+    
+    for (Chunk& chunk : chunks) {
+        chunk.positionBase = positionCount;
+        chunk.texcoordBase = texcoordCount;
+        chunk.normalBase = normalCount;
+        chunk.cornerBase = cornerCount;
+        
+        positionCount += std::size(chunk.positions);
+        texcoordCount += std::size(chunk.texcoords);
+        normalCount += std::size(chunk.normals);
+        cornerCount += std::size(chunk.corners);
+        errors += chunk.errors;
+    }
+
+    if (errors > 0)
+        GOGH_LOGGER_WARN("[Mesh] OBJ has %u malformed lines, they are skipped", errors);
+    
+    Vector<glm::vec3> positions(positionCount);
+    Vector<glm::vec2> texcoords(texcoordCount);
+    Vector<glm::vec3> normals(normalCount);
+    Vector<uint64_t> hashes(cornerCount);
+    std::atomic<uint32_t> invalidCorners = 0;
+
+    forEachChunk([&](uint32_t i) {
+        Chunk& chunk = chunks[i];
+        std::copy(std::begin(chunk.positions), std::end(chunk.positions), std::begin(positions) + chunk.positionBase);
+        std::copy(std::begin(chunk.texcoords), std::end(chunk.texcoords), std::begin(texcoords) + chunk.texcoordBase);
+        std::copy(std::begin(chunk.normals), std::end(chunk.normals), std::begin(normals) + chunk.normalBase);
+    });
+    
+    forEachChunk([&](uint32_t i) {
+        Chunk& chunk = chunks[i];
+        uint32_t invalid = 0;
+        
+        for (size_t c = 0; c < std::size(chunk.corners); c++) {
+            Corner& corner = chunk.corners[c];
+            if (!_ResolveCorner(&corner, chunk, positionCount, texcoordCount, normalCount)) {
+                invalid++;
+                continue;
+            }
+
+            /* + 0.0f folds -0.0 into 0.0, the hash sees bits while operator== sees values */
+            Vertex vertex = {};
+            vertex.position = positions[corner.position] + 0.0f;
+            vertex.texcoord = corner.texcoord >= 0 ? texcoords[corner.texcoord] + 0.0f : glm::vec2(0.0f);
+            vertex.normal = corner.normal >= 0 ? normals[corner.normal] + 0.0f : glm::vec3(0.0f);
+            hashes[chunk.cornerBase + c] = _HashVertex(vertex);
+        }
+
+        invalidCorners.fetch_add(invalid, std::memory_order_relaxed);
+    });
+
+    if (invalidCorners > 0) {
+        GOGH_LOGGER_ERROR("[Mesh] OBJ face references a missing vertex, (corners=%u)", invalidCorners.load());
+        return false;
+    }
+    
+    Clock::time_point parsed = Clock::now();
+
+    /* open addressing with linear probing, at most half full */
+    size_t tableSize = 1;
+    while (tableSize < 2 * cornerCount)
+        tableSize <<= 1;
+    
+    Vector<uint32_t> table(tableSize, UINT32_MAX);
+    Vector<uint64_t> vertexHashes;
+    size_t mask = tableSize - 1;
+
+    pMesh->indices.resize(cornerCount);
+    
+    for (const Chunk& chunk : chunks) {
+        for (size_t c = 0; c < std::size(chunk.corners); c++) {
+            const Corner& corner = chunk.corners[c];
+            uint64_t hash = hashes[chunk.cornerBase + c];
+            
+            Vertex vertex = {};
+            vertex.position = positions[corner.position] + 0.0f;
+            vertex.texcoord = corner.texcoord >= 0 ? texcoords[corner.texcoord] + 0.0f : glm::vec2(0.0f);
+            vertex.normal = corner.normal >= 0 ? normals[corner.normal] + 0.0f : glm::vec3(0.0f);
+            
+            size_t slot = hash & mask;
+            while (table[slot] != UINT32_MAX) {
+                uint32_t candidate = table[slot];
+                if (vertexHashes[candidate] == hash && pMesh->vertices[candidate] == vertex)
+                    break;
+                slot = (slot + 1) & mask;
+            }
+
+            if (table[slot] == UINT32_MAX) {
+                table[slot] = (uint32_t) std::size(pMesh->vertices);
+                pMesh->vertices.push_back(vertex);
+                vertexHashes.push_back(hash);
+            }
+
+            pMesh->indices[chunk.cornerBase + c] = table[slot];
+        }
+    }
+
+    Clock::time_point merged = Clock::now();
+    
+    GOGH_LOGGER_INFO("[Mesh] Import OBJ successful, (chunks=%zu, vertices=%zu, triangles=%zu, parse=%.1f ms, dedup=%.1f ms)",
+                     std::size(chunks), std::size(pMesh->vertices), cornerCount / 3,
+                     std::chrono::duration<double, std::milli>(parsed - start).count(),
+                     std::chrono::duration<double, std::milli>(merged - parsed).count());
+    
+    return true;
+}
@@ -0,0 +1,48 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Mesh.h"
+
+class JobSystem;
+
+/* chunks per job system thread, more than one evens out lines of different cost */
+#define OBJ_IMPORTER_CHUNKS_PER_THREAD 4
+#define OBJ_IMPORTER_MIN_CHUNK_SIZE (1 << 20)
+
+/*
+ * Wavefront OBJ to MeshData. The file is memory mapped and cut into chunks at line
+ * boundaries, every chunk is parsed by a job (std::from_chars for floats), then the
+ * face corners are resolved against the global attribute arrays and identical
+ * vertices are merged through an open addressing table keyed by a 64-bit hash of
+ * the whole vertex.
+ *
+ * Only v / vt / vn / f are read, polygons are fan triangulated, groups, objects and
+ * materials are ignored so the file becomes one mesh.
+ */
+class ObjImporter
+{
+public:
+    /* pJobSystem may be null to parse on the calling thread */
+    static bool Import(const char* path, JobSystem* pJobSystem, MeshData* pMesh);
+    static bool ImportFromMemory(const char* pText, size_t size, JobSystem* pJobSystem, MeshData* pMesh);
+};
@@ -0,0 +1,325 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "VertexFormat.h"
+
+#include <Logger.h>
+
+// std
+#include <float.h>
+#include <stdio.h>
+#include <string.h>
+
+// glm
+#include <glm/gtc/packing.hpp>
+
+static glm::vec2 _SignNotZero(glm::vec2 v)
+{
+    return glm::vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+}
+
+static glm::vec2 _OctahedralEncode(glm::vec3 n)
+{
+    n /= glm::abs(n.x) + glm::abs(n.y) + glm::abs(n.z);
+    glm::vec2 p = glm::vec2(n.x, n.y);
+    if (n.z < 0.0f)
+        p = (1.0f - glm::abs(glm::vec2(p.y, p.x))) * _SignNotZero(p);
+    return p;
+}
+
+static glm::vec3 _OctahedralDecode(glm::vec2 e)
+{
+    glm::vec3 n = glm::vec3(e.x, e.y, 1.0f - glm::abs(e.x) - glm::abs(e.y));
+    float t = glm::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+static uint16_t _QuantizeUnorm16(float v)
+{
+    return (uint16_t) glm::round(glm::clamp(v, 0.0f, 1.0f) * 65535.0f);
+}
+
+static float _DequantizeUnorm16(uint16_t v)
+{
+    return (float) v / 65535.0f;
+}
+
+uint32_t VertexFormatEncoder::GetStride(const VertexFormat& format)
+{
+    uint32_t stride = 0;
+    stride += format.position == VERTEX_POSITION_ENCODING_FLOAT3 ? 12 : 8;
+    stride += format.texcoord == VERTEX_TEXCOORD_ENCODING_FLOAT2 ? 8 : 4;
+    stride += format.normal == VERTEX_NORMAL_ENCODING_FLOAT3 ? 12 : 4;
+    return stride;
+}
+
+void VertexFormatEncoder::Encode(const MeshData& mesh, const VertexFormat& format, QuantizedMesh* pQuantized)
+{
+    QuantizedMesh& quantized = *pQuantized;
+    size_t vertexCount = std::size(mesh.vertices);
+
+    quantized = {};
+    quantized.format = format;
+    quantized.stride = GetStride(format);
+    quantized.vertexCount = (uint32_t) vertexCount;
+    quantized.indexCount = (uint32_t) std::size(mesh.indices);
+    quantized.vertices.resize(vertexCount * quantized.stride);
+
+    /* bounds for the relative encodings, a flat axis gets a FLT_MIN scale so it encodes as 0 without dividing by zero */
+    glm::vec3 positionMin = glm::vec3(FLT_MAX), positionMax = glm::vec3(-FLT_MAX);
+    glm::vec2 texcoordMin = glm::vec2(FLT_MAX), texcoordMax = glm::vec2(-FLT_MAX);
+    
+    for (const Vertex& vertex : mesh.vertices) {
+        positionMin = glm::min(positionMin, vertex.position);
+        positionMax = glm::max(positionMax, vertex.position);
+        texcoordMin = glm::min(texcoordMin, vertex.texcoord);
+        texcoordMax = glm::max(texcoordMax, vertex.texcoord);
+    }
+
+    glm::vec3 positionScale = glm::vec3(1.0f);
+    glm::vec2 texcoordScale = glm::vec2(1.0f);
+    
+    if (vertexCount > 0) {
+        positionScale = glm::max(positionMax - positionMin, glm::vec3(FLT_MIN));
+        texcoordScale = glm::max(texcoordMax - texcoordMin, glm::vec2(FLT_MIN));
+    } else {
+        positionMin = glm::vec3(0.0f);
+        texcoordMin = glm::vec2(0.0f);
+    }
+    
+    if (format.position == VERTEX_POSITION_ENCODING_UNORM16) {
+        quantized.decodeParams.positionScale = glm::vec4(positionScale, 1.0f);
+        quantized.decodeParams.positionOffset = glm::vec4(positionMin, 0.0f);
+    }
+
+    if (format.texcoord == VERTEX_TEXCOORD_ENCODING_UNORM16)
+        quantized.decodeParams.texcoordScaleOffset = glm::vec4(texcoordScale, texcoordMin);
+
+    QuantizedMesh::Precision& precision = quantized.precision;
+    
+    for (size_t i = 0; i < vertexCount; i++) {
+        const Vertex& vertex = mesh.vertices[i];
+        uint8_t* dst = std::data(quantized.vertices) + i * quantized.stride;
+
+        glm::vec3 position;
+        switch (format.position) {
+            case VERTEX_POSITION_ENCODING_FLOAT3: {
+                memcpy(dst, &vertex.position, 12);
+                position = vertex.position;
+                dst += 12;
+                break;
+            }
+            case VERTEX_POSITION_ENCODING_HALF4: {
+                glm::uint64 packed = glm::packHalf4x16(glm::vec4(vertex.position, 1.0f));
+                memcpy(dst, &packed, 8);
+                position = glm::vec3(glm::unpackHalf4x16(packed));
+                dst += 8;
+                break;
+            }
+            case VERTEX_POSITION_ENCODING_UNORM16: {
+                glm::vec3 t = (vertex.position - positionMin) / positionScale;
+                uint16_t packed[4] = { _QuantizeUnorm16(t.x), _QuantizeUnorm16(t.y), _QuantizeUnorm16(t.z), 0 };
+                memcpy(dst, packed, 8);
+                position = glm::vec3(_DequantizeUnorm16(packed[0]), _DequantizeUnorm16(packed[1]), _DequantizeUnorm16(packed[2])) * positionScale + positionMin;
+                dst += 8;
+                break;
+            }
+        }
+
+        glm::vec2 texcoord;
+        if (format.texcoord == VERTEX_TEXCOORD_ENCODING_FLOAT2) {
+            memcpy(dst, &vertex.texcoord, 8);
+            texcoord = vertex.texcoord;
+            dst += 8;
+        } else {
+            glm::vec2 t = (vertex.texcoord - texcoordMin) / texcoordScale;
+            uint16_t packed[2] = { _QuantizeUnorm16(t.x), _QuantizeUnorm16(t.y) };
+            memcpy(dst, packed, 4);
+            texcoord = glm::vec2(_DequantizeUnorm16(packed[0]), _DequantizeUnorm16(packed[1])) * texcoordScale + texcoordMin;
+            dst += 4;
+        }
+
+        glm::vec3 normal;
+        if (format.normal == VERTEX_NORMAL_ENCODING_FLOAT3) {
+            memcpy(dst, &vertex.normal, 12);
+            normal = vertex.normal;
+        } else {
+            /* missing normals encode as +Z */
+            glm::vec3 n = glm::length(vertex.normal) > 0.0f ? glm::normalize(vertex.normal) : glm::vec3(0.0f, 0.0f, 1.0f);
+            glm::uint32 packed = glm::packSnorm2x16(_OctahedralEncode(n));
+            memcpy(dst, &packed, 4);
+            normal = _OctahedralDecode(glm::unpackSnorm2x16(packed));
+
+            float cosine = glm::clamp(glm::dot(normal, n), -1.0f, 1.0f);
+            precision.maxNormalErrorDegrees = glm::max(precision.maxNormalErrorDegrees, glm::degrees(glm::acos(cosine)));
+        }
+
+        precision.maxPositionError = glm::max(precision.maxPositionError, glm::length(position - vertex.position));
+        precision.maxTexcoordError = glm::max(precision.maxTexcoordError, glm::length(texcoord - vertex.texcoord));
+    }
+
+    /* 0xFFFF is the primitive restart index of 16-bit index buffers, it never names a vertex */
+    if (format.allowIndex16 && vertexCount < UINT16_MAX) {
+        quantized.indexType = VK_INDEX_TYPE_UINT16;
+        quantized.indices.resize(std::size(mesh.indices) * sizeof(uint16_t));
+        
+        uint16_t* dst = reinterpret_cast<uint16_t*>(std::data(quantized.indices));
+        for (size_t i = 0; i < std::size(mesh.indices); i++)
+            dst[i] = (uint16_t) mesh.indices[i];
+    } else {
+        quantized.indexType = VK_INDEX_TYPE_UINT32;
+        quantized.indices.resize(std::size(mesh.indices) * sizeof(uint32_t));
+        memcpy(std::data(quantized.indices), std::data(mesh.indices), std::size(quantized.indices));
+    }
+}
+
+void VertexFormatEncoder::Decode(const VertexFormat& format, const VertexDecodeParams& params, uint32_t vertexCount, const void* pVertices, Vertex* pDecoded)
+{
+    uint32_t stride = GetStride(format);
+    glm::vec3 positionScale = glm::vec3(params.positionScale);
+    glm::vec3 positionOffset = glm::vec3(params.positionOffset);
+    glm::vec2 texcoordScale = glm::vec2(params.texcoordScaleOffset.x, params.texcoordScaleOffset.y);
+    glm::vec2 texcoordOffset = glm::vec2(params.texcoordScaleOffset.z, params.texcoordScaleOffset.w);
+    
+    for (uint32_t i = 0; i < vertexCount; i++) {
+        const uint8_t* src = static_cast<const uint8_t*>(pVertices) + (size_t) i * stride;
+        Vertex& vertex = pDecoded[i];
+
+        switch (format.position) {
+            case VERTEX_POSITION_ENCODING_FLOAT3: {
+                memcpy(&vertex.position, src, 12);
+                src += 12;
+                break;
+            }
+            case VERTEX_POSITION_ENCODING_HALF4: {
+                glm::uint64 packed;
+                memcpy(&packed, src, 8);
+                vertex.position = glm::vec3(glm::unpackHalf4x16(packed));
+                src += 8;
+                break;
+            }
+            case VERTEX_POSITION_ENCODING_UNORM16: {
+                uint16_t packed[4];
+                memcpy(packed, src, 8);
+                vertex.position = glm::vec3(_DequantizeUnorm16(packed[0]), _DequantizeUnorm16(packed[1]), _DequantizeUnorm16(packed[2])) * positionScale + positionOffset;
+                src += 8;
+                break;
+            }
+        }
+
+        if (format.texcoord == VERTEX_TEXCOORD_ENCODING_FLOAT2) {
+            memcpy(&vertex.texcoord, src, 8);
+            src += 8;
+        } else {
+            uint16_t packed[2];
+            memcpy(packed, src, 4);
+            vertex.texcoord = glm::vec2(_DequantizeUnorm16(packed[0]), _DequantizeUnorm16(packed[1])) * texcoordScale + texcoordOffset;
+            src += 4;
+        }
+
+        if (format.normal == VERTEX_NORMAL_ENCODING_FLOAT3) {
+            memcpy(&vertex.normal, src, 12);
+        } else {
+            glm::uint32 packed;
+            memcpy(&packed, src, 4);
+            vertex.normal = _OctahedralDecode(glm::unpackSnorm2x16(packed));
+        }
+    }
+}
+
+void VertexFormatEncoder::GetVertexInputDescription(const VertexFormat& format,
+                                                    VkVertexInputBindingDescription* pBinding,
+                                                    Vector<VkVertexInputAttributeDescription>* pAttributes)
+{
+    *pBinding = {
+        .binding = 0,
+        .stride = GetStride(format),
+        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+    };
+
+    static const VkFormat positionFormats[] = {
+        VK_FORMAT_R32G32B32_SFLOAT,
+        VK_FORMAT_R16G16B16A16_SFLOAT,
+        VK_FORMAT_R16G16B16A16_UNORM,
+    };
+
+    uint32_t offset = 0;
+    pAttributes->clear();
+    
+    pAttributes->push_back({ 0, 0, positionFormats[format.position], offset });
+    offset += format.position == VERTEX_POSITION_ENCODING_FLOAT3 ? 12 : 8;
+    
+    pAttributes->push_back({ 1, 0, format.texcoord == VERTEX_TEXCOORD_ENCODING_FLOAT2 ? VK_FORMAT_R32G32_SFLOAT : VK_FORMAT_R16G16_UNORM, offset });
+    offset += format.texcoord == VERTEX_TEXCOORD_ENCODING_FLOAT2 ? 8 : 4;
+    
+    pAttributes->push_back({ 2, 0, format.normal == VERTEX_NORMAL_ENCODING_FLOAT3 ? VK_FORMAT_R32G32B32_SFLOAT : VK_FORMAT_R16G16_SNORM, offset });
+}
+
+String VertexFormatEncoder::GenerateShaderDecode(const VertexFormat& format, uint32_t set, uint32_t binding)
+{
+    char block[128];
+    snprintf(block, sizeof(block), "layout(set = %u, binding = %u) uniform VertexDecodeParams {\n", set, binding);
+    
+    String source;
+    
+    source += format.position == VERTEX_POSITION_ENCODING_FLOAT3 ? "layout(location = 0) in vec3 inPos;\n" : "layout(location = 0) in vec4 inPos;\n";
+    source += "layout(location = 1) in vec2 inTexCoord;\n";
+    source += format.normal == VERTEX_NORMAL_ENCODING_FLOAT3 ? "layout(location = 2) in vec3 inNormal;\n" : "layout(location = 2) in vec2 inNormal;\n";
+    source += "\n";
+    
+    source += block;
+    source += "    vec4 positionScale;\n";
+    source += "    vec4 positionOffset;\n";
+    source += "    vec4 texcoordScaleOffset;\n";
+    source += "} decode;\n\n";
+
+    source += "vec3 DecodePosition()\n{\n";
+    source += "    return inPos.xyz * decode.positionScale.xyz + decode.positionOffset.xyz;\n}\n\n";
+    
+    source += "vec2 DecodeTexCoord()\n{\n";
+    source += "    return inTexCoord * decode.texcoordScaleOffset.xy + decode.texcoordScaleOffset.zw;\n}\n\n";
+
+    source += "vec3 DecodeNormal()\n{\n";
+    if (format.normal == VERTEX_NORMAL_ENCODING_FLOAT3) {
+        source += "    return inNormal;\n}\n";
+    } else {
+        source += "    vec3 n = vec3(inNormal, 1.0f - abs(inNormal.x) - abs(inNormal.y));\n";
+        source += "    float t = max(-n.z, 0.0f);\n";
+        source += "    n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0.0f)));\n";
+        source += "    return normalize(n);\n}\n";
+    }
+
+    return source;
+}
+
+void VertexFormatEncoder::LogReport(const char* name, const MeshData& mesh, const QuantizedMesh& quantized)
+{
+    size_t sourceBytes = std::size(mesh.vertices) * sizeof(Vertex) + std::size(mesh.indices) * sizeof(uint32_t);
+    size_t encodedBytes = std::size(quantized.vertices) + std::size(quantized.indices);
+    
+    GOGH_LOGGER_INFO("[Mesh] %s quantized, (stride=%u -> %u, bytes=%zu -> %zu, index%s)",
+                     name, (uint32_t) sizeof(Vertex), quantized.stride, sourceBytes, encodedBytes,
+                     quantized.indexType == VK_INDEX_TYPE_UINT16 ? "16" : "32");
+    GOGH_LOGGER_INFO("[Mesh] %s precision, (position=%g, normal=%.4f deg, texcoord=%g)",
+                     name, quantized.precision.maxPositionError, quantized.precision.maxNormalErrorDegrees, quantized.precision.maxTexcoordError);
+}
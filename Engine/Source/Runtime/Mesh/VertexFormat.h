@@ -0,0 +1,115 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Mesh.h"
+#include "Driver/VulkanInclude.h"
+
+#include <String.h>
+
+/* where GenerateShaderDecode() puts the VertexDecodeParams block of the engine's mesh shaders */
+#define VERTEX_DECODE_SET 1
+#define VERTEX_DECODE_BINDING 0
+
+/* include name of the generated decode functions, written by the cooker */
+#define VERTEX_DECODE_INCLUDE "vertex_decode.glsl"
+
+enum VertexPositionEncoding
+{
+    VERTEX_POSITION_ENCODING_FLOAT3 = 0,    /* 12 bytes */
+    VERTEX_POSITION_ENCODING_HALF4,         /*  8 bytes, w unused */
+    VERTEX_POSITION_ENCODING_UNORM16,       /*  8 bytes, relative to the mesh bounds, w unused */
+};
+
+enum VertexNormalEncoding
+{
+    VERTEX_NORMAL_ENCODING_FLOAT3 = 0,      /* 12 bytes */
+    VERTEX_NORMAL_ENCODING_OCTAHEDRAL16,    /*  4 bytes, snorm16 octahedral map */
+};
+
+enum VertexTexcoordEncoding
+{
+    VERTEX_TEXCOORD_ENCODING_FLOAT2 = 0,    /*  8 bytes */
+    VERTEX_TEXCOORD_ENCODING_UNORM16,       /*  4 bytes, relative to the texcoord bounds */
+};
+
+/* the defaults are what the cooker writes and the engine's mesh pipelines read */
+struct VertexFormat
+{
+    VertexPositionEncoding position = VERTEX_POSITION_ENCODING_UNORM16;
+    VertexNormalEncoding normal = VERTEX_NORMAL_ENCODING_OCTAHEDRAL16;
+    VertexTexcoordEncoding texcoord = VERTEX_TEXCOORD_ENCODING_UNORM16;
+    /* use 16-bit indices whenever the vertex count allows */
+    bool allowIndex16 = true;
+};
+
+/* std140 block the decode snippet reads, position = encoded * scale + offset */
+struct VertexDecodeParams
+{
+    glm::vec4 positionScale = glm::vec4(1.0f);
+    glm::vec4 positionOffset = glm::vec4(0.0f);
+    glm::vec4 texcoordScaleOffset = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+};
+
+struct QuantizedMesh
+{
+    VertexFormat format;
+    uint32_t stride = 0;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+    Vector<uint8_t> vertices;
+    Vector<uint8_t> indices;
+    VertexDecodeParams decodeParams;
+
+    /* worst case loss against the float input */
+    struct Precision {
+        float maxPositionError = 0.0f;     /* object space units */
+        float maxNormalErrorDegrees = 0.0f;
+        float maxTexcoordError = 0.0f;
+    } precision;
+};
+
+/*
+ * Per attribute vertex compression. Encode() packs a MeshData into the chosen
+ * format, the Vulkan vertex input description and the GLSL decode functions are
+ * generated from the same VertexFormat so they can not drift apart.
+ */
+class VertexFormatEncoder
+{
+public:
+    static uint32_t GetStride(const VertexFormat& format);
+
+    static void Encode(const MeshData& mesh, const VertexFormat& format, QuantizedMesh* pQuantized);
+    /* back to full precision vertices, for the CPU side tools */
+    static void Decode(const VertexFormat& format, const VertexDecodeParams& params, uint32_t vertexCount, const void* pVertices, Vertex* pDecoded);
+    
+    /* pAttributes receives locations 0 position, 1 texcoord, 2 normal, all on binding 0 */
+    static void GetVertexInputDescription(const VertexFormat& format,
+                                          VkVertexInputBindingDescription* pBinding,
+                                          Vector<VkVertexInputAttributeDescription>* pAttributes);
+
+    /* inputs, the VertexDecodeParams block at (set, binding) and Decode*() functions */
+    static String GenerateShaderDecode(const VertexFormat& format, uint32_t set, uint32_t binding);
+
+    static void LogReport(const char* name, const MeshData& mesh, const QuantizedMesh& quantized);
+};
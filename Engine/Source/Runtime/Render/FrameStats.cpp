@@ -0,0 +1,101 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "FrameStats.h"
+
+// std
+#include <algorithm>
+
+FrameStats::FrameStats()
+{
+    samples.resize(FRAME_STATS_WINDOW_SIZE);
+    gpuSamples.resize(FRAME_STATS_WINDOW_SIZE);
+    scratch.reserve(FRAME_STATS_WINDOW_SIZE);
+}
+
+void FrameStats::Record(double cpuFrameTime, double waitOnGpuTime, double presentInterval)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Sample& sample = samples[frameCount % FRAME_STATS_WINDOW_SIZE];
+    sample.cpuFrameTime = cpuFrameTime;
+    sample.waitOnGpuTime = waitOnGpuTime;
+    sample.presentInterval = presentInterval;
+    ++frameCount;
+}
+
+void FrameStats::RecordGpu(double gpuFrameTime)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    gpuSamples[gpuFrameCount % FRAME_STATS_WINDOW_SIZE] = gpuFrameTime;
+    ++gpuFrameCount;
+}
+
+void FrameStats::Resolve(GoghFrameStats* pStats)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    *pStats = {};
+    pStats->frameCount = frameCount;
+    
+    size_t count = std::min<uint64_t>(frameCount, FRAME_STATS_WINDOW_SIZE);
+    if (count == 0)
+        return;
+
+    for (size_t i = 0; i < count; ++i) {
+        pStats->cpuFrameTime += samples[i].cpuFrameTime;
+        pStats->waitOnGpuTime += samples[i].waitOnGpuTime;
+        pStats->presentInterval += samples[i].presentInterval;
+    }
+    
+    pStats->cpuFrameTime /= (double) count;
+    pStats->waitOnGpuTime /= (double) count;
+    pStats->presentInterval /= (double) count;
+
+    size_t gpuCount = std::min<uint64_t>(gpuFrameCount, FRAME_STATS_WINDOW_SIZE);
+    for (size_t i = 0; i < gpuCount; ++i)
+        pStats->gpuFrameTime += gpuSamples[i];
+    if (gpuCount != 0)
+        pStats->gpuFrameTime /= (double) gpuCount;
+
+    pStats->low1PercentFrameTime = _Low(0.01);
+    pStats->low01PercentFrameTime = _Low(0.001);
+}
+
+double FrameStats::_Low(double fraction)
+{
+    size_t count = std::min<uint64_t>(frameCount, FRAME_STATS_WINDOW_SIZE);
+
+    scratch.clear();
+    for (size_t i = 0; i < count; ++i)
+        scratch.push_back(samples[i].presentInterval);
+
+    /* mean of the slowest fraction of frames, at least one frame */
+    size_t worst = std::max<size_t>(1, (size_t) ((double) count * fraction));
+    std::nth_element(scratch.begin(), scratch.begin() + (worst - 1), scratch.end(), std::greater<double>());
+
+    double sum = 0.0;
+    for (size_t i = 0; i < worst; ++i)
+        sum += scratch[i];
+    
+    return sum / (double) worst;
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include <Engine/Engine.h>
+#include <Vector.h>
+
+// std
+#include <mutex>
+#include <stdint.h>
+
+/* frames kept in the sliding window, enough samples for a 0.1% low */
+#define FRAME_STATS_WINDOW_SIZE 2048
+
+/* recorded on the render thread, resolved from any thread */
+class FrameStats
+{
+public:
+    FrameStats();
+   ~FrameStats() = default;
+
+    /* all times in milliseconds */
+    void Record(double cpuFrameTime, double waitOnGpuTime, double presentInterval);
+
+    /* GPU time arrives K frames late, once the frame fence has been waited */
+    void RecordGpu(double gpuFrameTime);
+
+    void Resolve(GoghFrameStats* pStats);
+
+private:
+    struct Sample {
+        double cpuFrameTime = 0.0;
+        double waitOnGpuTime = 0.0;
+        double presentInterval = 0.0;
+    };
+
+    double _Low(double fraction);
+    
+private:
+    Vector<Sample> samples;
+    Vector<double> gpuSamples;
+    Vector<double> scratch;
+    std::mutex mutex;
+    uint64_t frameCount = 0;
+    uint64_t gpuFrameCount = 0;
+};
\ No newline at end of file
@@ -0,0 +1,722 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "GPUScene.h"
+
+#include <Logger.h>
+#include <Error.h>
+
+// std
+#include <chrono>
+#include <string.h>
+
+/* local_size_x of gpu_cull_compute.glsl and gpu_cluster_cull_compute.glsl */
+#define GPU_SCENE_CULL_GROUP_SIZE 64
+
+enum GPUSceneBinding
+{
+    GPU_SCENE_BINDING_OBJECTS = 0,
+    GPU_SCENE_BINDING_MESHES,
+    GPU_SCENE_BINDING_BUCKETS,
+    GPU_SCENE_BINDING_COMMANDS,
+    GPU_SCENE_BINDING_COUNTS,
+    GPU_SCENE_BINDING_MESHLETS,
+    GPU_SCENE_BINDING_CLUSTERS,
+    GPU_SCENE_BINDING_LODS,
+    GPU_SCENE_BINDING_LOD_STATS,
+    GPU_SCENE_BINDING_OBJECT_LODS,
+    GPU_SCENE_BINDING_MAX_ENUM,
+};
+
+struct CullPushConstants
+{
+    glm::vec4 frustumPlanes[6];
+    glm::vec4 cameraPosition; /* w = lodScale */
+    uint32_t objectCount;
+    uint32_t clusterCount;
+    uint32_t frameSlot;
+    float lodThreshold;
+};
+
+static const VkShaderStageFlags GPU_SCENE_STAGES = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+
+static const VkDescriptorSetLayoutBinding GPU_SCENE_BINDINGS[GPU_SCENE_BINDING_MAX_ENUM] = {
+    { GPU_SCENE_BINDING_OBJECTS, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, GPU_SCENE_STAGES, VK_NULL_HANDLE },
+    { GPU_SCENE_BINDING_MESHES, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, GPU_SCENE_STAGES, VK_NULL_HANDLE },
+    { GPU_SCENE_BINDING_BUCKETS, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, GPU_SCENE_STAGES, VK_NULL_HANDLE },
+    { GPU_SCENE_BINDING_COMMANDS, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, GPU_SCENE_STAGES, VK_NULL_HANDLE },
+    { GPU_SCENE_BINDING_COUNTS, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, GPU_SCENE_STAGES, VK_NULL_HANDLE },
+    { GPU_SCENE_BINDING_MESHLETS, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, GPU_SCENE_STAGES, VK_NULL_HANDLE },
+    { GPU_SCENE_BINDING_CLUSTERS, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, GPU_SCENE_STAGES, VK_NULL_HANDLE },
+    { GPU_SCENE_BINDING_LODS, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, GPU_SCENE_STAGES, VK_NULL_HANDLE },
+    { GPU_SCENE_BINDING_LOD_STATS, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, GPU_SCENE_STAGES, VK_NULL_HANDLE },
+    { GPU_SCENE_BINDING_OBJECT_LODS, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, GPU_SCENE_STAGES, VK_NULL_HANDLE },
+};
+
+/* Gribb-Hartmann planes of a [0, 1] depth clip space, normals point inside */
+static void _ExtractFrustumPlanes(const glm::mat4& m, glm::vec4 planes[6])
+{
+    glm::vec4 row0 = glm::vec4(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1 = glm::vec4(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2 = glm::vec4(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3 = glm::vec4(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    planes[0] = row3 + row0;
+    planes[1] = row3 - row0;
+    planes[2] = row3 + row1;
+    planes[3] = row3 - row1;
+    planes[4] = row2;
+    planes[5] = row3 - row2;
+
+    for (uint32_t i = 0; i < 6; i++)
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+}
+
+static float _MaxScale(const glm::mat4& transform)
+{
+    return glm::max(glm::length(glm::vec3(transform[0])),
+                    glm::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+}
+
+static bool _IsSphereVisible(const glm::vec3& center, float radius, const glm::vec4 planes[6])
+{
+    for (uint32_t i = 0; i < 6; i++) {
+        if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius)
+            return false;
+    }
+
+    return true;
+}
+
+/* true when every triangle of the meshlet faces away from the camera */
+static bool _IsConeBackfacing(const glm::vec3& center, float radius, const glm::vec3& axis, float cutoff, const glm::vec3& cameraPosition)
+{
+    glm::vec3 direction = center - cameraPosition;
+    return glm::dot(direction, axis) >= cutoff * glm::length(direction) + radius;
+}
+
+GPUScene::GPUScene(RenderDevice* _device, VkFormat colorFormat) : device(_device)
+{
+    /* the same layout handle as set 0 of the cull pipelines */
+    descriptorSetLayout = device->GetLayoutCache()->AcquireSetLayout(GPU_SCENE_BINDING_MAX_ENUM, GPU_SCENE_BINDINGS);
+    GOGH_ASSERT(descriptorSetLayout && "AcquireSetLayout(...)");
+    
+    meshBuffer = device->CreateBuffer(sizeof(GPUMesh) * GPU_SCENE_MAX_MESHES, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    meshletBuffer = device->CreateBuffer(sizeof(GPUMeshlet) * GPU_SCENE_MAX_MESHLETS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    lodBuffer = device->CreateBuffer(sizeof(GPUMeshLod) * GPU_SCENE_MAX_LODS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    lodStatsBuffer = device->CreateBuffer(sizeof(uint32_t) * 2 * GPU_SCENE_MAX_FRAME_SLOTS,
+                                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    objectLodBuffer = device->CreateBuffer(sizeof(uint32_t) * GPU_SCENE_MAX_OBJECTS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    commandBuffer = device->CreateBuffer(sizeof(VkDrawIndexedIndirectCommand) * GPU_SCENE_MAX_DRAWS,
+                                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+    countBuffer = device->CreateBuffer(sizeof(uint32_t) * GPU_SCENE_MAX_BUCKETS,
+                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+    
+    GOGH_ASSERT(meshBuffer && meshletBuffer && lodBuffer && lodStatsBuffer && objectLodBuffer &&
+                commandBuffer && countBuffer && "CreateBuffer(...)");
+
+    for (Buffer* buffer : { meshBuffer, meshletBuffer, lodBuffer, lodStatsBuffer, objectLodBuffer, commandBuffer, countBuffer })
+        buffer->SetResidencyPriority(RESIDENCY_PRIORITY_CRITICAL);
+
+    /* slots are read back before their first cull */
+    uint32_t zeroStats[2 * GPU_SCENE_MAX_FRAME_SLOTS] = {};
+    lodStatsBuffer->Write(0, sizeof(zeroStats), zeroStats);
+
+    /* objects are never reused, every one starts at LOD 0 */
+    Vector<uint32_t> zeroLods(GPU_SCENE_MAX_OBJECTS, 0);
+    objectLodBuffer->Write(0, sizeof(uint32_t) * std::size(zeroLods), std::data(zeroLods));
+    
+    frameSlots.resize(GPU_SCENE_MAX_FRAME_SLOTS);
+
+    if (device->IsDrawIndirectCountSupported()) {
+        cullPipeline = device->CreateComputePipeline(GPU_SCENE_CULL_SHADER_PATH, GPU_SCENE_BINDING_MAX_ENUM, GPU_SCENE_BINDINGS, sizeof(CullPushConstants));
+        clusterCullPipeline = device->CreateComputePipeline(GPU_SCENE_CLUSTER_CULL_SHADER_PATH, GPU_SCENE_BINDING_MAX_ENUM, GPU_SCENE_BINDINGS, sizeof(CullPushConstants));
+    }
+
+    /* both passes fill the same command buffer, one without the other would drop objects */
+    if (!cullPipeline || !clusterCullPipeline) {
+        GOGH_LOGGER_WARN("[Renderer] GPU driven rendering unavailable, fall back to CPU culling");
+        
+        if (cullPipeline)
+            device->DestroyPipeline(cullPipeline);
+        if (clusterCullPipeline)
+            device->DestroyPipeline(clusterCullPipeline);
+        
+        cullPipeline = clusterCullPipeline = VK_NULL_HANDLE;
+    }
+
+    /* cooked meshes come in the default vertex format, the shader decodes it */
+    VkVertexInputBindingDescription vertexBinding;
+    Vector<VkVertexInputAttributeDescription> vertexAttributes;
+    VertexFormatEncoder::GetVertexInputDescription(VertexFormat(), &vertexBinding, &vertexAttributes);
+    
+    GraphicsPipelineDesc drawPipelineDesc = {
+        .vertexPath = GPU_SCENE_DRAW_VERTEX_SHADER_PATH,
+        .fragmentPath = GPU_SCENE_DRAW_FRAGMENT_SHADER_PATH,
+        .colorFormatCount = 1,
+        .pColorFormats = &colorFormat,
+        .vertexAttributeCount = (uint32_t) std::size(vertexAttributes),
+        .pVertexAttributes = std::data(vertexAttributes),
+        .vertexStride = vertexBinding.stride,
+        .bindingCount = GPU_SCENE_BINDING_MAX_ENUM,
+        .pBindings = GPU_SCENE_BINDINGS,
+    };
+
+    drawPipeline = device->CreateGraphicsPipeline(drawPipelineDesc);
+    if (!drawPipeline)
+        GOGH_LOGGER_WARN("[Renderer] Failed to create GPU scene draw pipeline, buckets need a pipeline of their own");
+    
+    GOGH_LOGGER_DEBUG("[Renderer] Create GPU scene successful, (gpuDriven=%d, GPUScene: %p)", IsGPUDriven(), this);
+}
+
+GPUScene::~GPUScene()
+{
+    GOGH_LOGGER_DEBUG("[Renderer] Destroying GPU scene, (GPUScene: %p)", this);
+
+    if (cullPipeline)
+        device->DestroyPipeline(cullPipeline);
+
+    if (clusterCullPipeline)
+        device->DestroyPipeline(clusterCullPipeline);
+
+    if (drawPipeline)
+        device->DestroyPipeline(drawPipeline);
+    
+    for (const FrameSlot& slot : frameSlots) {
+        for (Buffer* buffer : { slot.objectBuffer, slot.bucketBuffer, slot.clusterBuffer }) {
+            if (buffer)
+                device->DestroyBuffer(buffer);
+        }
+
+        if (slot.descriptorSet)
+            device->FreeDescriptorSet(slot.descriptorSet);
+    }
+    
+    for (Buffer* buffer : { meshBuffer, meshletBuffer, lodBuffer, lodStatsBuffer, objectLodBuffer, commandBuffer, countBuffer })
+        device->DestroyBuffer(buffer);
+    
+    device->GetLayoutCache()->ReleaseSetLayout(descriptorSetLayout);
+}
+
+uint32_t GPUScene::AddMesh(uint32_t indexCount, uint32_t firstIndex, int32_t vertexOffset, const MeshletData* pMeshlets, const Vector<MeshLod>* pLods)
+{
+    size_t meshletCount = pMeshlets ? std::size(pMeshlets->meshlets) : 0;
+    size_t lodCount = pLods && meshletCount == 0 ? std::size(*pLods) : 0;
+    
+    if (std::size(meshes) >= GPU_SCENE_MAX_MESHES || std::size(meshlets) + meshletCount > GPU_SCENE_MAX_MESHLETS ||
+        std::size(lods) + lodCount > GPU_SCENE_MAX_LODS)
+        return UINT32_MAX;
+    
+    uint32_t index = (uint32_t) std::size(meshes);
+    GPUMesh& mesh = meshes.emplace_back();
+    mesh.indexCount = indexCount;
+    mesh.firstIndex = firstIndex;
+    mesh.vertexOffset = vertexOffset;
+    mesh.meshletOffset = (uint32_t) std::size(meshlets);
+    mesh.meshletCount = (uint32_t) meshletCount;
+    mesh.lodOffset = (uint32_t) std::size(lods);
+    mesh.lodCount = (uint32_t) lodCount;
+
+    for (size_t i = 0; i < meshletCount; i++) {
+        const Meshlet& meshlet = pMeshlets->meshlets[i];
+        GPUMeshlet& gpuMeshlet = meshlets.emplace_back();
+        gpuMeshlet.boundingSphere = meshlet.boundingSphere;
+        gpuMeshlet.cone = meshlet.cone;
+        gpuMeshlet.firstIndex = firstIndex + meshlet.firstIndex;
+        gpuMeshlet.indexCount = 3 * meshlet.triangleCount;
+    }
+
+    for (size_t i = 0; i < lodCount; i++) {
+        const MeshLod& lod = (*pLods)[i];
+        GPUMeshLod& gpuLod = lods.emplace_back();
+        gpuLod.firstIndex = firstIndex + lod.firstIndex;
+        gpuLod.indexCount = lod.indexCount;
+        gpuLod.error = lod.error;
+    }
+
+    meshBuffer->Write(sizeof(GPUMesh) * index, sizeof(GPUMesh), &mesh);
+    
+    if (meshletCount > 0)
+        meshletBuffer->Write(sizeof(GPUMeshlet) * mesh.meshletOffset, sizeof(GPUMeshlet) * meshletCount, &meshlets[mesh.meshletOffset]);
+
+    if (lodCount > 0)
+        lodBuffer->Write(sizeof(GPUMeshLod) * mesh.lodOffset, sizeof(GPUMeshLod) * lodCount, &lods[mesh.lodOffset]);
+    
+    return index;
+}
+
+uint32_t GPUScene::AddBucket(Buffer* vertexBuffer, Buffer* indexBuffer, VkIndexType indexType, VkDescriptorSet geometry, Pipeline* pipeline)
+{
+    if (std::size(buckets) >= GPU_SCENE_MAX_BUCKETS)
+        return UINT32_MAX;
+
+    if (!pipeline)
+        pipeline = drawPipeline;
+
+    /* the draw binds the scene set at 0 with the pipeline's layout, the set layouts must be the same handle */
+    if (!pipeline || pipeline->GetBindPoint() != VK_PIPELINE_BIND_POINT_GRAPHICS || pipeline->GetDescriptorSetLayout(0) != descriptorSetLayout) {
+        GOGH_LOGGER_ERROR("[Renderer] GPU scene bucket needs a graphics pipeline sharing set 0, (Pipeline: %p)", pipeline);
+        return UINT32_MAX;
+    }
+
+    uint32_t index = (uint32_t) std::size(buckets);
+    buckets.push_back({ pipeline, vertexBuffer, indexBuffer, indexType, geometry, 0, 0 });
+    visibleDraws.resize(std::size(buckets));
+    layoutDirty = true;
+    
+    return index;
+}
+
+uint32_t GPUScene::AddObject(const glm::mat4& transform, const glm::vec4& boundingSphere, uint32_t mesh, uint32_t bucket)
+{
+    if (std::size(objects) >= GPU_SCENE_MAX_OBJECTS || mesh >= std::size(meshes) || bucket >= std::size(buckets))
+        return UINT32_MAX;
+
+    uint32_t index = (uint32_t) std::size(objects);
+    GPUObject& object = objects.emplace_back();
+    object.transform = transform;
+    object.boundingSphere = boundingSphere;
+    object.mesh = mesh;
+    object.bucket = bucket;
+    objectLods.push_back(0);
+
+    _MarkObjectsDirty(index, index + 1);
+    layoutDirty = true;
+    
+    return index;
+}
+
+void GPUScene::UpdateObject(uint32_t object, const glm::mat4& transform)
+{
+    objects[object].transform = transform;
+    _MarkObjectsDirty(object, object + 1);
+}
+
+void GPUScene::RemoveObject(uint32_t object)
+{
+    GPUObject& removed = objects[object];
+    if (removed.bucket == UINT32_MAX)
+        return;
+
+    /* the index stays reserved, culling skips objects without a bucket */
+    removed.bucket = UINT32_MAX;
+    _MarkObjectsDirty(object, object + 1);
+    layoutDirty = true;
+}
+
+uint32_t GPUScene::GetBindings(const VkDescriptorSetLayoutBinding** ppBindings)
+{
+    *ppBindings = GPU_SCENE_BINDINGS;
+    return GPU_SCENE_BINDING_MAX_ENUM;
+}
+
+void GPUScene::Cull(CommandList* commandList, const GPUSceneView& _view)
+{
+    VkCommandBuffer vkCommandBuffer = commandList->GetCommandBuffer();
+
+    GOGH_ASSERT(_view.frameSlot < GPU_SCENE_MAX_FRAME_SLOTS && "Too many frame slots");
+    
+    view = _view;
+    _ExtractFrustumPlanes(view.viewProjection, frustumPlanes);
+    
+    if (layoutDirty)
+        _UpdateDrawLayout();
+
+    /* the CPU fallback draws from the slot copy as well */
+    FrameSlot* slot = _SyncFrameSlot(view.frameSlot);
+    
+    if (!slot || !IsGPUDriven() || std::empty(objects))
+        return;
+
+    /* the previous frame may still read the indirect buffers on this queue */
+    commandList->BufferBarrier(countBuffer->GetVkBuffer(),
+                               VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+                               VK_ACCESS_TRANSFER_WRITE_BIT,
+                               VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                               VK_PIPELINE_STAGE_TRANSFER_BIT);
+    
+    vkCmdFillBuffer(vkCommandBuffer, countBuffer->GetVkBuffer(), 0, VK_WHOLE_SIZE, 0);
+    vkCmdFillBuffer(vkCommandBuffer, lodStatsBuffer->GetVkBuffer(), sizeof(uint32_t) * 2 * view.frameSlot, sizeof(uint32_t) * 2, 0);
+
+    commandList->BufferBarrier(countBuffer->GetVkBuffer(),
+                               VK_ACCESS_TRANSFER_WRITE_BIT,
+                               VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                               VK_PIPELINE_STAGE_TRANSFER_BIT,
+                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    commandList->BufferBarrier(lodStatsBuffer->GetVkBuffer(),
+                               VK_ACCESS_TRANSFER_WRITE_BIT,
+                               VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                               VK_PIPELINE_STAGE_TRANSFER_BIT,
+                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    
+    commandList->BufferBarrier(commandBuffer->GetVkBuffer(),
+                               VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+                               VK_ACCESS_SHADER_WRITE_BIT,
+                               VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    /* the LODs are carried over from the previous cull, whatever slot recorded it */
+    commandList->BufferBarrier(objectLodBuffer->GetVkBuffer(),
+                               VK_ACCESS_SHADER_WRITE_BIT,
+                               VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    CullPushConstants pushConstants = {};
+    memcpy(pushConstants.frustumPlanes, frustumPlanes, sizeof(frustumPlanes));
+    pushConstants.cameraPosition = glm::vec4(view.cameraPosition, view.lodScale);
+    pushConstants.objectCount = (uint32_t) std::size(objects);
+    pushConstants.clusterCount = (uint32_t) std::size(clusters);
+    pushConstants.frameSlot = view.frameSlot;
+    pushConstants.lodThreshold = lodThreshold;
+
+    /* both passes append to the same per bucket counters, the atomics keep them apart */
+    VkPipelineLayout pipelineLayout = cullPipeline->GetPipelineLayout();
+    vkCmdBindDescriptorSets(vkCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &slot->descriptorSet, 0, VK_NULL_HANDLE);
+    vkCmdPushConstants(vkCommandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+    
+    vkCmdBindPipeline(vkCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline->GetVkPipeline());
+    vkCmdDispatch(vkCommandBuffer, (pushConstants.objectCount + GPU_SCENE_CULL_GROUP_SIZE - 1) / GPU_SCENE_CULL_GROUP_SIZE, 1, 1);
+
+    if (pushConstants.clusterCount > 0) {
+        vkCmdBindPipeline(vkCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, clusterCullPipeline->GetVkPipeline());
+        vkCmdDispatch(vkCommandBuffer, (pushConstants.clusterCount + GPU_SCENE_CULL_GROUP_SIZE - 1) / GPU_SCENE_CULL_GROUP_SIZE, 1, 1);
+    }
+    
+    commandList->BufferBarrier(commandBuffer->GetVkBuffer(),
+                               VK_ACCESS_SHADER_WRITE_BIT,
+                               VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                               VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+    
+    commandList->BufferBarrier(countBuffer->GetVkBuffer(),
+                               VK_ACCESS_SHADER_WRITE_BIT,
+                               VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                               VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+
+    commandList->BufferBarrier(lodStatsBuffer->GetVkBuffer(),
+                               VK_ACCESS_SHADER_WRITE_BIT,
+                               VK_ACCESS_HOST_READ_BIT,
+                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                               VK_PIPELINE_STAGE_HOST_BIT);
+}
+
+void GPUScene::Draw(CommandList* commandList, const glm::mat4& viewProjection, uint64_t frameIndex)
+{
+    auto start = std::chrono::steady_clock::now();
+    VkCommandBuffer vkCommandBuffer = commandList->GetCommandBuffer();
+
+    stats = {};
+    stats.objects = (uint32_t) std::size(objects);
+    stats.clusters = (uint32_t) std::size(clusters);
+    stats.buckets = (uint32_t) std::size(buckets);
+
+    /* Cull() of this frame created and synced the slot */
+    VkDescriptorSet descriptorSet = frameSlots[view.frameSlot].descriptorSet;
+    
+    if (std::empty(objects) || descriptorSet == VK_NULL_HANDLE)
+        return;
+    
+    if (!IsGPUDriven()) {
+        _CullOnCPU(commandList, viewProjection, descriptorSet);
+    } else {
+        /* the slot fence was waited before this frame, its counters are complete */
+        uint32_t counters[2];
+        lodStatsBuffer->ReadBack(sizeof(counters) * view.frameSlot, sizeof(counters), counters);
+        stats.triangles = counters[1];
+        stats.lodSavedTriangles = counters[0] - counters[1];
+        
+        for (uint32_t i = 0; i < std::size(buckets); i++) {
+            const Bucket& bucket = buckets[i];
+            if (bucket.objectCount == 0)
+                continue;
+
+            VkPipelineLayout pipelineLayout = bucket.pipeline->GetPipelineLayout();
+            VkBuffer vertexBuffer = bucket.vertexBuffer->GetVkBuffer();
+            VkDeviceSize offset = 0;
+            
+            vkCmdBindPipeline(vkCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bucket.pipeline->GetVkPipeline());
+            vkCmdBindDescriptorSets(vkCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, VK_NULL_HANDLE);
+            vkCmdPushConstants(vkCommandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(viewProjection), &viewProjection);
+            vkCmdBindVertexBuffers(vkCommandBuffer, 0, 1, &vertexBuffer, &offset);
+            vkCmdBindIndexBuffer(vkCommandBuffer, bucket.indexBuffer->GetVkBuffer(), 0, bucket.indexType);
+
+            if (bucket.geometry != VK_NULL_HANDLE)
+                vkCmdBindDescriptorSets(vkCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, VERTEX_DECODE_SET, 1, &bucket.geometry, 0, VK_NULL_HANDLE);
+            
+            vkCmdDrawIndexedIndirectCount(vkCommandBuffer,
+                                          commandBuffer->GetVkBuffer(), sizeof(VkDrawIndexedIndirectCommand) * bucket.firstCommand,
+                                          countBuffer->GetVkBuffer(), sizeof(uint32_t) * i,
+                                          bucket.objectCount, sizeof(VkDrawIndexedIndirectCommand));
+            
+            stats.drawCalls++;
+        }
+    }
+
+    for (const Bucket& bucket : buckets) {
+        if (bucket.objectCount == 0)
+            continue;
+        bucket.vertexBuffer->MarkUsed(frameIndex);
+        bucket.indexBuffer->MarkUsed(frameIndex);
+    }
+    
+    stats.recordMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+/* bucket objectCount is the command capacity, one per whole mesh object or one per meshlet */
+void GPUScene::_UpdateDrawLayout()
+{
+    for (Bucket& bucket : buckets)
+        bucket.objectCount = 0;
+    
+    clusters.clear();
+    
+    for (uint32_t i = 0; i < std::size(objects); i++) {
+        const GPUObject& object = objects[i];
+        if (object.bucket == UINT32_MAX)
+            continue;
+
+        const GPUMesh& mesh = meshes[object.mesh];
+        if (mesh.meshletCount == 0) {
+            buckets[object.bucket].objectCount++;
+            continue;
+        }
+
+        if (std::size(clusters) + mesh.meshletCount > GPU_SCENE_MAX_DRAWS) {
+            GOGH_LOGGER_WARN("[Renderer] GPU scene cluster limit reached, object %u dropped", i);
+            continue;
+        }
+        
+        for (uint32_t m = 0; m < mesh.meshletCount; m++)
+            clusters.push_back(glm::uvec2(i, mesh.meshletOffset + m));
+        
+        buckets[object.bucket].objectCount += mesh.meshletCount;
+    }
+
+    firstCommands.resize(std::size(buckets));
+    uint32_t firstCommand = 0;
+    
+    for (uint32_t i = 0; i < std::size(buckets); i++) {
+        buckets[i].firstCommand = firstCommand;
+        firstCommands[i] = firstCommand;
+        firstCommand += buckets[i].objectCount;
+    }
+
+    layoutVersion++;
+    layoutDirty = false;
+}
+
+void GPUScene::_MarkObjectsDirty(uint32_t begin, uint32_t end)
+{
+    for (FrameSlot& slot : frameSlots) {
+        if (slot.dirtyBegin == slot.dirtyEnd) {
+            slot.dirtyBegin = begin;
+            slot.dirtyEnd = end;
+        } else {
+            slot.dirtyBegin = glm::min(slot.dirtyBegin, begin);
+            slot.dirtyEnd = glm::max(slot.dirtyEnd, end);
+        }
+    }
+}
+
+GPUScene::FrameSlot* GPUScene::_SyncFrameSlot(uint32_t frameSlot)
+{
+    FrameSlot& slot = frameSlots[frameSlot];
+
+    if (slot.descriptorSet == VK_NULL_HANDLE) {
+        slot.objectBuffer = device->CreateBuffer(sizeof(GPUObject) * GPU_SCENE_MAX_OBJECTS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        slot.bucketBuffer = device->CreateBuffer(sizeof(uint32_t) * GPU_SCENE_MAX_BUCKETS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        slot.clusterBuffer = device->CreateBuffer(sizeof(glm::uvec2) * GPU_SCENE_MAX_DRAWS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        slot.descriptorSet = device->AllocateDescriptorSet(descriptorSetLayout);
+
+        if (!slot.objectBuffer || !slot.bucketBuffer || !slot.clusterBuffer || !slot.descriptorSet) {
+            GOGH_LOGGER_ERROR("[Renderer] Failed to create GPU scene frame slot, (frameSlot=%u, GPUScene: %p)", frameSlot, this);
+            
+            for (Buffer* buffer : { slot.objectBuffer, slot.bucketBuffer, slot.clusterBuffer }) {
+                if (buffer)
+                    device->DestroyBuffer(buffer);
+            }
+            
+            if (slot.descriptorSet)
+                device->FreeDescriptorSet(slot.descriptorSet);
+            
+            slot = {};
+            return VK_NULL_HANDLE;
+        }
+
+        for (Buffer* buffer : { slot.objectBuffer, slot.bucketBuffer, slot.clusterBuffer })
+            buffer->SetResidencyPriority(RESIDENCY_PRIORITY_CRITICAL);
+        
+        _WriteDescriptorSet(slot);
+
+        /* a new copy holds nothing yet */
+        slot.dirtyBegin = 0;
+        slot.dirtyEnd = (uint32_t) std::size(objects);
+        slot.layoutVersion = 0;
+    }
+
+    if (slot.dirtyBegin < slot.dirtyEnd) {
+        slot.objectBuffer->Write(sizeof(GPUObject) * slot.dirtyBegin, sizeof(GPUObject) * (slot.dirtyEnd - slot.dirtyBegin), &objects[slot.dirtyBegin]);
+        slot.dirtyBegin = slot.dirtyEnd = 0;
+    }
+
+    if (slot.layoutVersion != layoutVersion) {
+        if (!std::empty(firstCommands))
+            slot.bucketBuffer->Write(0, sizeof(uint32_t) * std::size(firstCommands), std::data(firstCommands));
+        
+        if (!std::empty(clusters))
+            slot.clusterBuffer->Write(0, sizeof(glm::uvec2) * std::size(clusters), std::data(clusters));
+        
+        slot.layoutVersion = layoutVersion;
+    }
+    
+    return &slot;
+}
+
+void GPUScene::_WriteDescriptorSet(const FrameSlot& slot)
+{
+    Buffer* buffers[GPU_SCENE_BINDING_MAX_ENUM] = {
+        slot.objectBuffer, meshBuffer, slot.bucketBuffer, commandBuffer, countBuffer, meshletBuffer, slot.clusterBuffer,
+        lodBuffer, lodStatsBuffer, objectLodBuffer
+    };
+    VkDescriptorBufferInfo descriptorBufferInfos[GPU_SCENE_BINDING_MAX_ENUM];
+    VkWriteDescriptorSet writeDescriptorSets[GPU_SCENE_BINDING_MAX_ENUM];
+
+    for (uint32_t i = 0; i < GPU_SCENE_BINDING_MAX_ENUM; i++) {
+        descriptorBufferInfos[i] = {
+            .buffer = buffers[i]->GetVkBuffer(),
+            .offset = 0,
+            .range = VK_WHOLE_SIZE,
+        };
+        
+        writeDescriptorSets[i] = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = slot.descriptorSet,
+            .dstBinding = i,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo = &descriptorBufferInfos[i],
+        };
+    }
+
+    vkUpdateDescriptorSets(device->GetDevice(), GPU_SCENE_BINDING_MAX_ENUM, writeDescriptorSets, 0, VK_NULL_HANDLE);
+}
+
+/* coarsest LOD under the threshold, the current one is kept inside the hysteresis band */
+uint32_t GPUScene::_SelectLod(const GPUMesh& mesh, uint32_t currentLod, const glm::vec3& center, float radius, float scale) const
+{
+    if (mesh.lodCount <= 1)
+        return 0;
+
+    float distance = glm::length(center - view.cameraPosition) - radius;
+    if (distance <= 0.0f)
+        return 0;
+
+    float pixelsPerUnit = scale * view.lodScale / distance;
+    const GPUMeshLod* chain = &lods[mesh.lodOffset];
+    uint32_t lod = glm::min(currentLod, mesh.lodCount - 1);
+
+    while (lod + 1 < mesh.lodCount && chain[lod + 1].error * pixelsPerUnit <= lodThreshold * GPU_SCENE_LOD_HYSTERESIS)
+        lod++;
+    while (lod > 0 && chain[lod].error * pixelsPerUnit > lodThreshold)
+        lod--;
+    
+    return lod;
+}
+
+void GPUScene::_CullOnCPU(CommandList* commandList, const glm::mat4& viewProjection, VkDescriptorSet descriptorSet)
+{
+    VkCommandBuffer vkCommandBuffer = commandList->GetCommandBuffer();
+
+    for (Vector<VkDrawIndexedIndirectCommand>& draws : visibleDraws)
+        draws.clear();
+    
+    for (uint32_t i = 0; i < std::size(objects); i++) {
+        const GPUObject& object = objects[i];
+        if (object.bucket == UINT32_MAX)
+            continue;
+
+        const GPUMesh& mesh = meshes[object.mesh];
+        float scale = _MaxScale(object.transform);
+        float radius = object.boundingSphere.w * scale;
+        glm::vec3 center = glm::vec3(object.transform * glm::vec4(glm::vec3(object.boundingSphere), 1.0f));
+        
+        if (!_IsSphereVisible(center, radius, frustumPlanes))
+            continue;
+
+        if (mesh.meshletCount == 0) {
+            uint32_t indexCount = mesh.indexCount;
+            uint32_t firstIndex = mesh.firstIndex;
+            
+            if (mesh.lodCount > 0) {
+                uint32_t lod = objectLods[i] = _SelectLod(mesh, objectLods[i], center, radius, scale);
+                indexCount = lods[mesh.lodOffset + lod].indexCount;
+                firstIndex = lods[mesh.lodOffset + lod].firstIndex;
+            }
+
+            stats.triangles += indexCount / 3;
+            stats.lodSavedTriangles += (mesh.indexCount - indexCount) / 3;
+            visibleDraws[object.bucket].push_back({ indexCount, 1, firstIndex, mesh.vertexOffset, i });
+            continue;
+        }
+        
+        for (uint32_t m = 0; m < mesh.meshletCount; m++) {
+            const GPUMeshlet& meshlet = meshlets[mesh.meshletOffset + m];
+            glm::vec3 meshletCenter = glm::vec3(object.transform * glm::vec4(glm::vec3(meshlet.boundingSphere), 1.0f));
+            float meshletRadius = meshlet.boundingSphere.w * scale;
+            glm::vec3 axis = glm::normalize(glm::mat3(object.transform) * glm::vec3(meshlet.cone));
+            
+            if (!_IsSphereVisible(meshletCenter, meshletRadius, frustumPlanes) ||
+                _IsConeBackfacing(meshletCenter, meshletRadius, axis, meshlet.cone.w, view.cameraPosition))
+                continue;
+
+            stats.triangles += meshlet.indexCount / 3;
+            visibleDraws[object.bucket].push_back({ meshlet.indexCount, 1, meshlet.firstIndex, mesh.vertexOffset, i });
+        }
+    }
+
+    for (uint32_t i = 0; i < std::size(buckets); i++) {
+        const Bucket& bucket = buckets[i];
+        if (std::empty(visibleDraws[i]))
+            continue;
+
+        VkPipelineLayout pipelineLayout = bucket.pipeline->GetPipelineLayout();
+        VkBuffer vertexBuffer = bucket.vertexBuffer->GetVkBuffer();
+        VkDeviceSize offset = 0;
+        
+        vkCmdBindPipeline(vkCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bucket.pipeline->GetVkPipeline());
+        vkCmdBindDescriptorSets(vkCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, VK_NULL_HANDLE);
+        vkCmdPushConstants(vkCommandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(viewProjection), &viewProjection);
+        vkCmdBindVertexBuffers(vkCommandBuffer, 0, 1, &vertexBuffer, &offset);
+        vkCmdBindIndexBuffer(vkCommandBuffer, bucket.indexBuffer->GetVkBuffer(), 0, bucket.indexType);
+
+        if (bucket.geometry != VK_NULL_HANDLE)
+            vkCmdBindDescriptorSets(vkCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, VERTEX_DECODE_SET, 1, &bucket.geometry, 0, VK_NULL_HANDLE);
+
+        /* firstInstance carries the object index like the indirect path */
+        for (const VkDrawIndexedIndirectCommand& draw : visibleDraws[i]) {
+            vkCmdDrawIndexed(vkCommandBuffer, draw.indexCount, 1, draw.firstIndex, draw.vertexOffset, draw.firstInstance);
+            stats.drawCalls++;
+        }
+    }
+}
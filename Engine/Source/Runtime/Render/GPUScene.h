@@ -0,0 +1,249 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Driver/RenderDevice.h"
+#include "Mesh/Meshlet.h"
+#include "Mesh/VertexFormat.h"
+
+// std
+#include <stdint.h>
+
+// glm
+#include <glm/glm.hpp>
+
+#define GPU_SCENE_CULL_SHADER_PATH "shaders/spir-v/gpu_cull_compute.spv"
+#define GPU_SCENE_CLUSTER_CULL_SHADER_PATH "shaders/spir-v/gpu_cluster_cull_compute.spv"
+/* default bucket pipeline, reads its object through gl_InstanceIndex */
+#define GPU_SCENE_DRAW_VERTEX_SHADER_PATH "shaders/spir-v/gpu_driven_vertex.spv"
+#define GPU_SCENE_DRAW_FRAGMENT_SHADER_PATH "shaders/spir-v/mesh_fragment.spv"
+#define GPU_SCENE_MAX_OBJECTS 65536
+#define GPU_SCENE_MAX_MESHES 4096
+#define GPU_SCENE_MAX_MESHLETS 65536
+#define GPU_SCENE_MAX_LODS 32768
+#define GPU_SCENE_MAX_BUCKETS 64
+/* indirect commands per frame, one per whole mesh object or per meshlet of a clustered one */
+#define GPU_SCENE_MAX_DRAWS 262144
+/* object copies and triangle counters are kept per frame slot (RENDERER_MAX_FRAME_SLOTS), touched once the slot fence passed */
+#define GPU_SCENE_MAX_FRAME_SLOTS 8
+
+/* projected LOD error in pixels, a coarser LOD is only taken below threshold * hysteresis */
+#define GPU_SCENE_LOD_THRESHOLD 1.0f
+#define GPU_SCENE_LOD_HYSTERESIS 0.75f
+
+/* std430 layouts shared with gpu_cull_compute.glsl, gpu_cluster_cull_compute.glsl and gpu_driven_vertex.glsl */
+struct GPUObject
+{
+    glm::mat4 transform = glm::mat4(1.0f);
+    glm::vec4 boundingSphere = glm::vec4(0.0f);
+    uint32_t mesh = 0;
+    uint32_t bucket = 0;
+    uint32_t padding[2] = {};
+};
+
+struct GPUMesh
+{
+    uint32_t indexCount = 0;
+    uint32_t firstIndex = 0;
+    int32_t vertexOffset = 0;
+    uint32_t meshletOffset = 0;
+    uint32_t meshletCount = 0;
+    uint32_t lodOffset = 0;
+    uint32_t lodCount = 0;
+    uint32_t padding = 0;
+};
+
+struct GPUMeshLod
+{
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    float error = 0.0f;
+    uint32_t padding = 0;
+};
+
+struct GPUMeshlet
+{
+    glm::vec4 boundingSphere = glm::vec4(0.0f);
+    glm::vec4 cone = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    uint32_t padding[2] = {};
+};
+
+/* camera input of one Cull() */
+struct GPUSceneView
+{
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    glm::vec3 cameraPosition = glm::vec3(0.0f);
+    /* |projection[1][1]| * viewport height / 2, object space error at distance 1 to pixels */
+    float lodScale = 0.0f;
+    uint32_t frameSlot = 0;
+};
+
+/*
+ * GPU driven path for large object counts. Transforms and bounds live in a persistent
+ * storage buffer, Cull() frustum culls every object in a compute pass and compacts the
+ * survivors into per bucket indirect commands, Draw() then records one
+ * vkCmdDrawIndexedIndirectCount per bucket, so the CPU cost no longer grows with the
+ * object count.
+ *
+ * Meshes added with meshlets are culled per cluster instead (frustum and normal cone)
+ * by a second compute pass over every (object, meshlet) pair, each visible meshlet
+ * becomes one indirect command of the object's bucket.
+ *
+ * Meshes added with a LOD chain draw the coarsest LOD whose error, projected to the
+ * screen at the object's distance, stays below the LOD threshold. Every object keeps
+ * its current LOD and only coarsens once the error falls well below the threshold,
+ * so objects near the switch distance do not pop back and forth. The current LODs live
+ * in a buffer only the cull pass touches.
+ *
+ * Objects, bucket offsets and clusters are copied per frame slot. Add/Update/Remove
+ * only change the CPU mirror, Cull() brings the copy of its frame slot up to date once
+ * the slot fence passed, so frames in flight keep reading what they were recorded
+ * with. Meshes, meshlets and LODs are append only and shared by every slot.
+ *
+ * A bucket is one graphics pipeline plus its vertex and index buffer. Buckets without a
+ * pipeline of their own draw with the default one (gpu_driven_vertex and mesh_fragment),
+ * others must be graphics pipelines created with GetBindings() as set 0 and a mat4 view
+ * projection push constant, the vertex shader finds its object through gl_InstanceIndex.
+ * The geometry set of a bucket is bound at VERTEX_DECODE_SET, the decode parameters
+ * of its vertex buffer.
+ *
+ * Without drawIndirectCount or the cull shader the same data is culled on the CPU and
+ * drawn with one vkCmdDrawIndexed per visible object or meshlet.
+ */
+class GPUScene
+{
+public:
+    struct Stats {
+        uint32_t objects = 0;
+        uint32_t buckets = 0;
+        uint32_t clusters = 0;
+        uint32_t drawCalls = 0;
+        /* the GPU driven path reads these back one frame slot cycle late */
+        uint32_t triangles = 0;
+        uint32_t lodSavedTriangles = 0;
+        double recordMicroseconds = 0.0;
+    };
+    
+public:
+    /* colorFormat is the attachment the default bucket pipeline renders to */
+    GPUScene(RenderDevice* _device, VkFormat colorFormat);
+   ~GPUScene();
+
+    bool IsGPUDriven() const { return cullPipeline != VK_NULL_HANDLE; }
+    
+    /*
+     * pMeshlets and pLods index ranges are relative to firstIndex, clustered meshes always
+     * draw their meshlets and ignore pLods. Returns UINT32_MAX when full.
+     */
+    uint32_t AddMesh(uint32_t indexCount, uint32_t firstIndex, int32_t vertexOffset,
+                     const MeshletData* pMeshlets = VK_NULL_HANDLE, const Vector<MeshLod>* pLods = VK_NULL_HANDLE);
+    /* pipeline null takes the default one, returns UINT32_MAX when full or the pipeline does not share set 0 */
+    uint32_t AddBucket(Buffer* vertexBuffer, Buffer* indexBuffer, VkIndexType indexType, VkDescriptorSet geometry,
+                       Pipeline* pipeline = VK_NULL_HANDLE);
+
+    /* boundingSphere is xyz center and w radius in object space, returns UINT32_MAX when full */
+    uint32_t AddObject(const glm::mat4& transform, const glm::vec4& boundingSphere, uint32_t mesh, uint32_t bucket);
+    void UpdateObject(uint32_t object, const glm::mat4& transform);
+    void RemoveObject(uint32_t object);
+
+    void SetLodThreshold(float pixels) { lodThreshold = pixels; }
+    
+    /* record outside of rendering, before Draw() of the same frame */
+    void Cull(CommandList* commandList, const GPUSceneView& view);
+    void Draw(CommandList* commandList, const glm::mat4& viewProjection, uint64_t frameIndex);
+
+    const Stats& GetStats() const { return stats; }
+
+    /* set 0 of the cull passes, bucket pipelines pass it as GraphicsPipelineDesc::pBindings */
+    static uint32_t GetBindings(const VkDescriptorSetLayoutBinding** ppBindings);
+    
+private:
+    struct FrameSlot {
+        Buffer* objectBuffer = VK_NULL_HANDLE;
+        Buffer* bucketBuffer = VK_NULL_HANDLE;
+        Buffer* clusterBuffer = VK_NULL_HANDLE;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        /* objects changed since the slot was synced, [dirtyBegin, dirtyEnd) */
+        uint32_t dirtyBegin = 0;
+        uint32_t dirtyEnd = 0;
+        uint64_t layoutVersion = 0;
+    };
+    
+    struct Bucket {
+        Pipeline* pipeline = VK_NULL_HANDLE;
+        Buffer* vertexBuffer = VK_NULL_HANDLE;
+        Buffer* indexBuffer = VK_NULL_HANDLE;
+        VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+        VkDescriptorSet geometry = VK_NULL_HANDLE;
+        uint32_t objectCount = 0;
+        uint32_t firstCommand = 0;
+    };
+
+    void _UpdateDrawLayout();
+    void _MarkObjectsDirty(uint32_t begin, uint32_t end);
+    /* creates the slot on first use, null when that failed */
+    FrameSlot* _SyncFrameSlot(uint32_t frameSlot);
+    void _WriteDescriptorSet(const FrameSlot& slot);
+    void _CullOnCPU(CommandList* commandList, const glm::mat4& viewProjection, VkDescriptorSet descriptorSet);
+    uint32_t _SelectLod(const GPUMesh& mesh, uint32_t currentLod, const glm::vec3& center, float radius, float scale) const;
+    
+private:
+    RenderDevice* device = VK_NULL_HANDLE;
+    Pipeline* cullPipeline = VK_NULL_HANDLE;
+    Pipeline* clusterCullPipeline = VK_NULL_HANDLE;
+    Pipeline* drawPipeline = VK_NULL_HANDLE;
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+
+    Buffer* meshBuffer = VK_NULL_HANDLE;
+    Buffer* meshletBuffer = VK_NULL_HANDLE;
+    Buffer* lodBuffer = VK_NULL_HANDLE;
+    Buffer* lodStatsBuffer = VK_NULL_HANDLE;
+    Buffer* objectLodBuffer = VK_NULL_HANDLE;
+    Buffer* commandBuffer = VK_NULL_HANDLE;
+    Buffer* countBuffer = VK_NULL_HANDLE;
+    Vector<FrameSlot> frameSlots;
+
+    /* per bucket visible draws of the CPU fallback, kept to reuse their storage */
+    Vector<Vector<VkDrawIndexedIndirectCommand>> visibleDraws;
+
+    /* CPU mirror of the device buffers */
+    Vector<GPUObject> objects;
+    Vector<GPUMesh> meshes;
+    Vector<GPUMeshlet> meshlets;
+    Vector<GPUMeshLod> lods;
+    Vector<Bucket> buckets;
+    Vector<uint32_t> firstCommands;
+    bool layoutDirty = false;
+    uint64_t layoutVersion = 0;
+
+    /* (object, meshlet) pairs culled by the cluster pass */
+    Vector<glm::uvec2> clusters;
+    /* current LOD per object of the CPU fallback */
+    Vector<uint32_t> objectLods;
+
+    glm::vec4 frustumPlanes[6] = {};
+    GPUSceneView view;
+    float lodThreshold = GPU_SCENE_LOD_THRESHOLD;
+    Stats stats;
+};
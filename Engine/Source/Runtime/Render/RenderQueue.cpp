@@ -0,0 +1,245 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "RenderQueue.h"
+
+// std
+#include <chrono>
+#include <string.h>
+
+/* 8 passes of 8 bits over the 64-bit key */
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES (64 / RADIX_BITS)
+
+static double _ElapsedMicroseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+RenderQueue::RenderQueue(uint32_t bucketCount)
+{
+    buckets.resize(bucketCount);
+}
+
+void RenderQueue::Reset()
+{
+    for (CommandBucket& bucket : buckets)
+        bucket.Clear();
+    
+    sorted.clear();
+}
+
+void RenderQueue::Sort()
+{
+    auto start = std::chrono::steady_clock::now();
+    
+    sorted.clear();
+    for (uint32_t i = 0; i < std::size(buckets); i++) {
+        const Vector<DrawPacket>& packets = buckets[i].GetPackets();
+        for (uint32_t j = 0; j < std::size(packets); j++)
+            sorted.push_back({ packets[j].key, i, j });
+    }
+
+    size_t count = std::size(sorted);
+    scratch.resize(count);
+
+    /* histogram every digit in one sweep, then stable LSD scatter per digit */
+    uint32_t histograms[RADIX_PASSES][RADIX_BUCKETS];
+    memset(histograms, 0, sizeof(histograms));
+    
+    for (const SortEntry& entry : sorted) {
+        for (uint32_t pass = 0; pass < RADIX_PASSES; pass++)
+            histograms[pass][(entry.key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+    }
+
+    SortEntry* src = std::data(sorted);
+    SortEntry* dst = std::data(scratch);
+    
+    for (uint32_t pass = 0; pass < RADIX_PASSES; pass++) {
+        uint32_t* histogram = histograms[pass];
+        uint32_t shift = pass * RADIX_BITS;
+
+        /* all keys share this digit, the pass would be an identity copy */
+        if (count == 0 || histogram[(src[0].key >> shift) & (RADIX_BUCKETS - 1)] == count)
+            continue;
+
+        uint32_t offset = 0;
+        for (uint32_t digit = 0; digit < RADIX_BUCKETS; digit++) {
+            uint32_t n = histogram[digit];
+            histogram[digit] = offset;
+            offset += n;
+        }
+
+        for (size_t i = 0; i < count; i++)
+            dst[histogram[(src[i].key >> shift) & (RADIX_BUCKETS - 1)]++] = src[i];
+
+        std::swap(src, dst);
+    }
+
+    if (src != std::data(sorted))
+        sorted.swap(scratch);
+
+    sortMicroseconds = _ElapsedMicroseconds(start);
+}
+
+void RenderQueue::Translate(CommandList* commandList, const glm::mat4& viewProjection, uint64_t frameIndex,
+                            Buffer* instanceBuffer, Vector<InstanceData>* pInstances, Stats* pStats) const
+{
+    auto start = std::chrono::steady_clock::now();
+    VkCommandBuffer commandBuffer = commandList->GetCommandBuffer();
+    
+    Stats stats = {};
+    const Pipeline* boundPipeline = VK_NULL_HANDLE;
+    VkPipelineLayout boundLayout = VK_NULL_HANDLE;
+    VkDescriptorSet boundMaterial = VK_NULL_HANDLE;
+    VkDescriptorSet boundGeometry = VK_NULL_HANDLE;
+    const Buffer* boundVertexBuffer = VK_NULL_HANDLE;
+    const Buffer* boundIndexBuffer = VK_NULL_HANDLE;
+    bool instanceBufferBound = false;
+    /* the push constant holds the view projection, not the last packet's model view projection */
+    bool viewProjectionPushed = false;
+
+    if (std::empty(sorted))
+        goto TAG_TRANSLATE_END;
+    
+    /* instance data of the whole frame is known before recording, upload it in one write */
+    if (instanceBuffer != VK_NULL_HANDLE) {
+        pInstances->clear();
+        for (const SortEntry& entry : sorted) {
+            const DrawPacket& packet = _Packet(entry);
+            pInstances->push_back({ packet.transform, packet.materialIndex, {} });
+        }
+
+        instanceBuffer->Write(0, sizeof(InstanceData) * std::size(*pInstances), std::data(*pInstances));
+        instanceBuffer->MarkUsed(frameIndex);
+    }
+    
+    for (uint32_t first = 0, count = 0; first < std::size(sorted); first += count) {
+        const DrawPacket& packet = _Packet(sorted[first]);
+
+        /* the stream is sorted by pipeline, material and mesh, so instances are adjacent */
+        count = 1;
+        while (first + count < std::size(sorted) && _IsInstanceOf(packet, _Packet(sorted[first + count])))
+            count++;
+
+        stats.packets += count;
+        
+        if (!packet.pipeline || !packet.vertexBuffer || !packet.indexBuffer || packet.pipeline->GetBindPoint() != VK_PIPELINE_BIND_POINT_GRAPHICS)
+            continue;
+
+        bool instanced = packet.pipeline->HasInstanceStream();
+        if (instanced && instanceBuffer == VK_NULL_HANDLE)
+            continue;
+        
+        VkPipelineLayout pipelineLayout = packet.pipeline->GetPipelineLayout();
+        
+        if (packet.pipeline != boundPipeline) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, packet.pipeline->GetVkPipeline());
+            boundPipeline = packet.pipeline;
+            stats.pipelineBinds++;
+
+            /* layouts are canonical, the same handle keeps push constants and set 0 bound */
+            if (pipelineLayout != boundLayout) {
+                boundLayout = pipelineLayout;
+                boundMaterial = VK_NULL_HANDLE;
+                boundGeometry = VK_NULL_HANDLE;
+                viewProjectionPushed = false;
+            }
+        }
+
+        if (packet.material != VK_NULL_HANDLE && packet.material != boundMaterial) {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &packet.material, 0, VK_NULL_HANDLE);
+            boundMaterial = packet.material;
+            stats.descriptorBinds++;
+        }
+
+        if (packet.geometry != VK_NULL_HANDLE && packet.geometry != boundGeometry) {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, VERTEX_DECODE_SET, 1, &packet.geometry, 0, VK_NULL_HANDLE);
+            boundGeometry = packet.geometry;
+            stats.descriptorBinds++;
+        }
+
+        if (packet.vertexBuffer != boundVertexBuffer) {
+            VkBuffer vertexBuffer = packet.vertexBuffer->GetVkBuffer();
+            VkDeviceSize offset = 0;
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+            boundVertexBuffer = packet.vertexBuffer;
+            stats.vertexBufferBinds++;
+        }
+
+        if (packet.indexBuffer != boundIndexBuffer) {
+            vkCmdBindIndexBuffer(commandBuffer, packet.indexBuffer->GetVkBuffer(), 0, packet.indexType);
+            boundIndexBuffer = packet.indexBuffer;
+            stats.indexBufferBinds++;
+        }
+
+        if (instanced) {
+            if (!instanceBufferBound) {
+                VkBuffer vkInstanceBuffer = instanceBuffer->GetVkBuffer();
+                VkDeviceSize instanceOffset = 0;
+                vkCmdBindVertexBuffers(commandBuffer, 1, 1, &vkInstanceBuffer, &instanceOffset);
+                instanceBufferBound = true;
+            }
+
+            if (!viewProjectionPushed) {
+                vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(viewProjection), &viewProjection);
+                viewProjectionPushed = true;
+            }
+            
+            /* firstInstance addresses the group inside the instance buffer */
+            vkCmdDrawIndexed(commandBuffer, packet.indexCount, count, packet.firstIndex, packet.vertexOffset, first);
+            stats.drawCalls++;
+        } else {
+            /* no instance stream, one draw per packet with its model view projection pushed */
+            for (uint32_t i = 0; i < count; i++) {
+                glm::mat4 modelViewProjection = viewProjection * _Packet(sorted[first + i]).transform;
+                vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(modelViewProjection), &modelViewProjection);
+                vkCmdDrawIndexed(commandBuffer, packet.indexCount, 1, packet.firstIndex, packet.vertexOffset, 0);
+                stats.drawCalls++;
+            }
+
+            viewProjectionPushed = false;
+        }
+
+        packet.vertexBuffer->MarkUsed(frameIndex);
+        packet.indexBuffer->MarkUsed(frameIndex);
+    }
+
+TAG_TRANSLATE_END:
+    stats.sortMicroseconds = sortMicroseconds;
+    stats.translateMicroseconds = _ElapsedMicroseconds(start);
+    
+    if (pStats)
+        *pStats = stats;
+}
+
+bool RenderQueue::_IsInstanceOf(const DrawPacket& a, const DrawPacket& b)
+{
+    return a.pipeline == b.pipeline &&
+           a.material == b.material &&
+           a.geometry == b.geometry &&
+           a.vertexBuffer == b.vertexBuffer &&
+           a.indexBuffer == b.indexBuffer &&
+           a.indexCount == b.indexCount &&
+           a.firstIndex == b.firstIndex &&
+           a.vertexOffset == b.vertexOffset;
+}
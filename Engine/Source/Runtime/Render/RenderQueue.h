@@ -0,0 +1,192 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Driver/Pipeline.h"
+#include "Driver/Buffer.h"
+#include "Driver/CommandList.h"
+#include "Mesh/VertexFormat.h"
+
+// std
+#include <stdint.h>
+
+// glm
+#include <glm/glm.hpp>
+
+/*
+ * 64-bit draw sort key, most significant first:
+ *
+ *   | layer 4 | pass 4 | pipeline 12 | material 16 | mesh 12 | depth 16 |
+ *
+ * Sorting by key groups draws by pass, then by state cost, and front to back
+ * inside the same state. Translucent layers pass an inverted depth.
+ */
+namespace SortKey
+{
+    constexpr uint32_t LAYER_BITS    = 4;
+    constexpr uint32_t PASS_BITS     = 4;
+    constexpr uint32_t PIPELINE_BITS = 12;
+    constexpr uint32_t MATERIAL_BITS = 16;
+    constexpr uint32_t MESH_BITS     = 12;
+    constexpr uint32_t DEPTH_BITS    = 16;
+
+    constexpr uint32_t DEPTH_SHIFT    = 0;
+    constexpr uint32_t MESH_SHIFT     = DEPTH_SHIFT + DEPTH_BITS;
+    constexpr uint32_t MATERIAL_SHIFT = MESH_SHIFT + MESH_BITS;
+    constexpr uint32_t PIPELINE_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+    constexpr uint32_t PASS_SHIFT     = PIPELINE_SHIFT + PIPELINE_BITS;
+    constexpr uint32_t LAYER_SHIFT    = PASS_SHIFT + PASS_BITS;
+
+    constexpr uint64_t Field(uint64_t value, uint32_t bits, uint32_t shift)
+      {
+        return (value & ((1ull << bits) - 1)) << shift;
+      }
+
+    /* Make() masks every field, values that do not fit alias others of the same field */
+    constexpr bool Fits(uint32_t value, uint32_t bits)
+      {
+        return value < (1u << bits);
+      }
+
+    constexpr uint64_t Make(uint32_t layer, uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth)
+      {
+        return Field(layer, LAYER_BITS, LAYER_SHIFT) |
+               Field(pass, PASS_BITS, PASS_SHIFT) |
+               Field(pipeline, PIPELINE_BITS, PIPELINE_SHIFT) |
+               Field(material, MATERIAL_BITS, MATERIAL_SHIFT) |
+               Field(mesh, MESH_BITS, MESH_SHIFT) |
+               Field(depth, DEPTH_BITS, DEPTH_SHIFT);
+      }
+
+    /* view depth to [0, 2^16), linear between near and far */
+    inline uint32_t QuantizeDepth(float depth, float near, float far)
+      {
+        float t = (depth - near) / (far - near);
+        t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+        return (uint32_t) (t * (float) ((1u << DEPTH_BITS) - 1));
+      }
+}
+
+struct DrawPacket
+{
+    uint64_t key = 0;
+    Pipeline* pipeline = VK_NULL_HANDLE;
+    VkDescriptorSet material = VK_NULL_HANDLE;
+    /* per mesh set bound at VERTEX_DECODE_SET, the VertexDecodeParams of the vertex buffer */
+    VkDescriptorSet geometry = VK_NULL_HANDLE;
+    Buffer* vertexBuffer = VK_NULL_HANDLE;
+    Buffer* indexBuffer = VK_NULL_HANDLE;
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+    uint32_t indexCount = 0;
+    uint32_t firstIndex = 0;
+    int32_t vertexOffset = 0;
+    uint32_t materialIndex = 0;
+    glm::mat4 transform = glm::mat4(1.0f);
+};
+
+/* first vertex input location of InstanceData in the queue's shaders */
+#define RENDER_QUEUE_INSTANCE_LOCATION 3
+
+/*
+ * Per instance vertex stream, bound at binding 1 with VK_VERTEX_INPUT_RATE_INSTANCE
+ * (locations 3..6 transform columns, 7 material), see instanced_vertex.glsl. Pipelines
+ * of queued packets declare it with instanceStride = sizeof(InstanceData) and
+ * firstInstanceLocation = RENDER_QUEUE_INSTANCE_LOCATION.
+ */
+struct InstanceData
+{
+    glm::mat4 transform;
+    uint32_t materialIndex;
+    uint32_t padding[3];
+};
+
+/* one per recording thread, never shared while packets are emitted */
+class CommandBucket
+{
+public:
+    void Submit(const DrawPacket& packet) { packets.push_back(packet); }
+    void Clear() { packets.clear(); }
+
+    const Vector<DrawPacket>& GetPackets() const { return packets; }
+    
+private:
+    Vector<DrawPacket> packets;
+};
+
+#define RENDER_QUEUE_MAX_BUCKETS 16
+
+/*
+ * Per-frame draw stream. Threads emit packets into their own bucket, Sort() merges
+ * the buckets and radix sorts by key, Translate() turns the sorted stream into
+ * Vulkan commands and drops every bind that would not change state. For pipelines
+ * declaring the instance stream, adjacent packets sharing pipeline, material, buffers
+ * and index range are merged into one instanced draw and their transforms are read
+ * from the per frame instance buffer at binding 1. Other pipelines draw each packet
+ * on its own with the model view projection in the push constant.
+ */
+class RenderQueue
+{
+public:
+    struct Stats {
+        uint32_t packets = 0;
+        uint32_t drawCalls = 0;
+        uint32_t pipelineBinds = 0;
+        uint32_t descriptorBinds = 0;
+        uint32_t vertexBufferBinds = 0;
+        uint32_t indexBufferBinds = 0;
+        double sortMicroseconds = 0.0;
+        double translateMicroseconds = 0.0;
+    };
+    
+public:
+    RenderQueue(uint32_t bucketCount = RENDER_QUEUE_MAX_BUCKETS);
+   ~RenderQueue() = default;
+
+    CommandBucket* GetBucket(uint32_t threadIndex) { return &buckets[threadIndex]; }
+    uint32_t GetBucketCount() const { return (uint32_t) std::size(buckets); }
+    
+    void Reset();
+    void Sort();
+    /* instanceBuffer must hold GetPacketCount() instances, pInstances is staging reused across frames,
+       without instanceBuffer only pipelines lacking the instance stream are drawn */
+    void Translate(CommandList* commandList, const glm::mat4& viewProjection, uint64_t frameIndex,
+                   Buffer* instanceBuffer, Vector<InstanceData>* pInstances, Stats* pStats) const;
+
+    uint32_t GetPacketCount() const { return (uint32_t) std::size(sorted); }
+    double GetSortMicroseconds() const { return sortMicroseconds; }
+    
+private:
+    struct SortEntry {
+        uint64_t key;
+        uint32_t bucket;
+        uint32_t index;
+    };
+
+    const DrawPacket& _Packet(const SortEntry& entry) const { return buckets[entry.bucket].GetPackets()[entry.index]; }
+    static bool _IsInstanceOf(const DrawPacket& a, const DrawPacket& b);
+    
+private:
+    Vector<CommandBucket> buckets;
+    Vector<SortEntry> sorted;
+    Vector<SortEntry> scratch;
+    double sortMicroseconds = 0.0;
+};
@@ -0,0 +1,79 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include <Vector.h>
+#include "RenderQueue.h"
+
+// std
+#include <atomic>
+#include <stdint.h>
+
+// glm
+#include <glm/glm.hpp>
+
+/*
+ * Lock free triple buffer, one producer and one consumer. The producer always has
+ * a slot to write, the consumer always has a complete slot to read, and the third
+ * slot is handed over with a single atomic exchange.
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+    T& GetWriteBuffer() { return slots[writeIndex]; }
+    const T& GetReadBuffer() const { return slots[readIndex]; }
+
+    void Publish()
+      {
+        writeIndex = middle.exchange(writeIndex | TRIPLE_BUFFER_DIRTY_BIT, std::memory_order_acq_rel) & TRIPLE_BUFFER_INDEX_MASK;
+      }
+
+    /* true when a newer slot was published since the last call */
+    bool Acquire()
+      {
+        if (!(middle.load(std::memory_order_relaxed) & TRIPLE_BUFFER_DIRTY_BIT))
+            return false;
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & TRIPLE_BUFFER_INDEX_MASK;
+        return true;
+      }
+
+private:
+    static constexpr uint32_t TRIPLE_BUFFER_INDEX_MASK = 0x3;
+    static constexpr uint32_t TRIPLE_BUFFER_DIRTY_BIT = 0x4;
+    
+    T slots[3] = {};
+    uint32_t writeIndex = 0;
+    uint32_t readIndex = 1;
+    std::atomic<uint32_t> middle = 2;
+};
+
+/* everything the render thread needs from one simulation step, immutable once published */
+struct RenderSnapshot
+{
+    uint64_t simulationFrame = 0;
+    double simulationTime = 0.0;
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    /* sorted before publish, translated by the render thread */
+    RenderQueue queue;
+};
\ No newline at end of file
@@ -0,0 +1,75 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "RenderThread.h"
+
+#include <Logger.h>
+
+RenderThread::RenderThread(RenderDevice* _device, Renderer* _renderer, TripleBuffer<RenderSnapshot>* _snapshots)
+    : device(_device), renderer(_renderer), snapshots(_snapshots)
+{
+}
+
+RenderThread::~RenderThread()
+{
+    Stop();
+}
+
+void RenderThread::Start()
+{
+    if (running.exchange(true))
+        return;
+
+    thread = std::thread(&RenderThread::_Run, this);
+    GOGH_LOGGER_DEBUG("[Renderer] Render thread started");
+}
+
+void RenderThread::Stop()
+{
+    if (!running.exchange(false))
+        return;
+
+    thread.join();
+    GOGH_LOGGER_DEBUG("[Renderer] Render thread stopped");
+}
+
+void RenderThread::_Run()
+{
+    while (running.load(std::memory_order_relaxed)) {
+        /* no new snapshot means the simulation is slower than the display, draw the last one again */
+        snapshots->Acquire();
+        const RenderSnapshot& snapshot = snapshots->GetReadBuffer();
+
+        device->GetResidencyManager()->Update();
+        /* uploads queued since the last frame, ahead of the frame that samples them */
+        device->GetUploadBatcher()->Submit();
+
+        if (renderer->BeginFrame()) {
+            renderer->SetSnapshot(&snapshot);
+            renderer->EndFrame();
+        } else {
+            /* nothing to present (minimized), do not spin */
+            std::this_thread::yield();
+        }
+
+        device->GetDefragmenter()->Step();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Renderer.h"
+#include "RenderSnapshot.h"
+
+// std
+#include <atomic>
+#include <thread>
+
+/*
+ * Dedicated render thread. Records and presents frames from the latest published
+ * RenderSnapshot while the main thread simulates the next one, the only state
+ * shared on the hot path is the snapshot triple buffer.
+ */
+class RenderThread
+{
+public:
+    RenderThread(RenderDevice* _device, Renderer* _renderer, TripleBuffer<RenderSnapshot>* _snapshots);
+   ~RenderThread();
+
+    void Start();
+    void Stop();
+    
+private:
+    void _Run();
+    
+private:
+    RenderDevice* device = VK_NULL_HANDLE;
+    Renderer* renderer = VK_NULL_HANDLE;
+    
+    TripleBuffer<RenderSnapshot>* snapshots = VK_NULL_HANDLE;
+    std::atomic<bool> running = false;
+    std::thread thread;
+};
\ No newline at end of file
@@ -0,0 +1,287 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "Renderer.h"
+
+#include <Logger.h>
+#include <Error.h>
+#include <MM.h>
+
+/* query pool is sized for the largest frame count any swapchain may use */
+#define RENDERER_MAX_FRAME_SLOTS 8
+
+/* initial per slot instance buffer capacity, grows by doubling */
+#define RENDERER_MIN_INSTANCES 4096
+
+/* shaders of the queue pipeline, compiled from Document/Miscs/shaders/glsl */
+#define RENDERER_QUEUE_VERTEX_SHADER_PATH "shaders/spir-v/instanced_vertex.spv"
+#define RENDERER_QUEUE_FRAGMENT_SHADER_PATH "shaders/spir-v/mesh_fragment.spv"
+
+static double _ElapsedMilliseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+Renderer::Renderer(RenderDevice* _device) : device(_device)
+{
+    VkResult err;
+    
+    swapchain = device->CreateSwapchainEXT(VK_NULL_HANDLE);
+    GOGH_ASSERT(swapchain && "CreateSwapchainEXT(...)");
+    GOGH_ASSERT(swapchain->minImageCount <= RENDERER_MAX_FRAME_SLOTS && "Too many frame slots");
+
+    VkQueryPoolCreateInfo queryPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = 2 * RENDERER_MAX_FRAME_SLOTS,
+    };
+
+    err = vkCreateQueryPool(device->GetDevice(), &queryPoolCreateInfo, VK_NULL_HANDLE, &queryPool);
+    if (err != VK_SUCCESS) {
+        GOGH_LOGGER_WARN("[Renderer] Failed to create timestamp query pool, GPU frame time disabled");
+        queryPool = VK_NULL_HANDLE;
+    }
+    
+    queryWritten.resize(RENDERER_MAX_FRAME_SLOTS, false);
+    timestampPeriod = device->GetPhysicalDeviceProperties().limits.timestampPeriod;
+
+    gpuScene = MemoryNew<GPUScene>(device, swapchain->format);
+    instanceBuffers.resize(RENDERER_MAX_FRAME_SLOTS, VK_NULL_HANDLE);
+
+    /* cooked meshes come in the default vertex format, the shaders decode it */
+    VkVertexInputBindingDescription vertexBinding;
+    Vector<VkVertexInputAttributeDescription> vertexAttributes;
+    VertexFormatEncoder::GetVertexInputDescription(VertexFormat(), &vertexBinding, &vertexAttributes);
+    
+    GraphicsPipelineDesc queuePipelineDesc = {
+        .vertexPath = RENDERER_QUEUE_VERTEX_SHADER_PATH,
+        .fragmentPath = RENDERER_QUEUE_FRAGMENT_SHADER_PATH,
+        .colorFormatCount = 1,
+        .pColorFormats = &swapchain->format,
+        .vertexAttributeCount = (uint32_t) std::size(vertexAttributes),
+        .pVertexAttributes = std::data(vertexAttributes),
+        .vertexStride = vertexBinding.stride,
+        .instanceStride = sizeof(InstanceData),
+        .firstInstanceLocation = RENDER_QUEUE_INSTANCE_LOCATION,
+    };
+
+    queuePipeline = device->CreateGraphicsPipeline(queuePipelineDesc);
+    if (!queuePipeline)
+        GOGH_LOGGER_WARN("[Renderer] Failed to create queue pipeline, queued draws are dropped");
+
+    frameStart = lastPresent = std::chrono::steady_clock::now();
+    
+    GOGH_LOGGER_DEBUG("[Renderer] Create renderer successful, (frameSlots=%u, Renderer: %p)", swapchain->minImageCount, this);
+}
+
+Renderer::~Renderer()
+{
+    GOGH_LOGGER_DEBUG("[Renderer] Destroying renderer, (Renderer: %p)", this);
+    
+    for (Buffer* instanceBuffer : instanceBuffers) {
+        if (instanceBuffer)
+            device->DestroyBuffer(instanceBuffer);
+    }
+    
+    if (queuePipeline)
+        device->DestroyPipeline(queuePipeline);
+    
+    MemoryDelete(gpuScene);
+    device->DestroySwapchainEXT(swapchain);
+    
+    if (queryPool != VK_NULL_HANDLE)
+        vkDestroyQueryPool(device->GetDevice(), queryPool, VK_NULL_HANDLE);
+}
+
+bool Renderer::BeginFrame()
+{
+    VkResult err;
+    VkDevice vkDevice = device->GetDevice();
+
+    frameStart = std::chrono::steady_clock::now();
+    
+    if (swapchain->outOfDate && !_RecreateSwapchain())
+        return false;
+
+    uint32_t slot = swapchain->frame;
+    VkFence fence = swapchain->fence[slot];
+
+    /* frame N-K must be done before its slot is reused, the only place the CPU waits on the GPU */
+    auto waitStart = std::chrono::steady_clock::now();
+    vkWaitForFences(vkDevice, 1, &fence, VK_TRUE, UINT64_MAX);
+    waitOnGpuTime = _ElapsedMilliseconds(waitStart, std::chrono::steady_clock::now());
+
+    _ResolveGpuTime(slot);
+
+    err = device->AcquireNextImageEXT(swapchain);
+    if (err == VK_ERROR_OUT_OF_DATE_KHR) {
+        if (!_RecreateSwapchain())
+            return false;
+        
+        err = device->AcquireNextImageEXT(swapchain);
+    }
+
+    if (err != VK_SUCCESS && err != VK_SUBOPTIMAL_KHR) {
+        GOGH_LOGGER_WARN("[Renderer] Failed to acquire swapchain image, (VkResult=%d)", err);
+        return false;
+    }
+
+    /* only reset once the slot is certain to be submitted again */
+    vkResetFences(vkDevice, 1, &fence);
+
+    /* before recording, the whole frame binds the same pipelines */
+    if (shaders)
+        shaders->Update();
+
+    commandList = swapchain->commandLists[slot];
+    commandList->Reset();
+    commandList->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+    VkCommandBuffer commandBuffer = commandList->GetCommandBuffer();
+    
+    if (queryPool != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(commandBuffer, queryPool, 2 * slot, 2);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 2 * slot);
+    }
+
+    return true;
+}
+
+void Renderer::EndFrame()
+{
+    VkResult err;
+    uint32_t slot = swapchain->frame;
+    VkCommandBuffer commandBuffer = commandList->GetCommandBuffer();
+    uint64_t frameIndex = device->GetResidencyManager()->GetFrameIndex();
+    glm::mat4 viewProjection = snapshot ? snapshot->projection * snapshot->view : glm::mat4(1.0f);
+
+    GPUSceneView sceneView = {};
+    sceneView.viewProjection = viewProjection;
+    sceneView.cameraPosition = snapshot ? glm::vec3(glm::inverse(snapshot->view)[3]) : glm::vec3(0.0f);
+    sceneView.lodScale = glm::abs(snapshot ? snapshot->projection[1][1] : 1.0f) * 0.5f * (float) swapchain->height;
+    sceneView.frameSlot = slot;
+
+    /* compute work has to be recorded before rendering begins */
+    gpuScene->Cull(commandList, sceneView);
+
+    VkImage image = swapchain->resources[swapchain->acquireIndex].image;
+    commandList->ImageBarrier(image,
+                              VK_ACCESS_NONE,
+                              VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                              VK_IMAGE_LAYOUT_UNDEFINED,
+                              VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                              VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                              VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+    VkClearColorValue clearColor = {{ 0.0f, 0.0f, 0.0f, 1.0f }};
+    commandList->BeginRendering(swapchain->resources[swapchain->acquireIndex].imageView, swapchain->width, swapchain->height, clearColor);
+
+    gpuScene->Draw(commandList, viewProjection, frameIndex);
+    
+    if (snapshot) {
+        Buffer* instanceBuffer = _ReserveInstanceBuffer(slot, snapshot->queue.GetPacketCount()) ? instanceBuffers[slot] : VK_NULL_HANDLE;
+        snapshot->queue.Translate(commandList, viewProjection, frameIndex, instanceBuffer, &instanceStaging, &queueStats);
+    }
+    
+    commandList->EndRendering();
+
+    commandList->ImageBarrier(image,
+                              VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                              VK_ACCESS_NONE,
+                              VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                              VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                              VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                              VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+    if (queryPool != VK_NULL_HANDLE) {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 2 * slot + 1);
+        queryWritten[slot] = true;
+    }
+    
+    commandList->End();
+
+    VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    err = commandList->Submit(1, &swapchain->acquireIndexSemaphore[slot], &waitStageMask,
+                              1, &swapchain->renderFinishSemaphore[slot], swapchain->fence[slot]);
+    
+    if (err != VK_SUCCESS)
+        GOGH_LOGGER_ERROR("[Renderer] Failed to submit frame, (VkResult=%d)", err);
+
+    device->QueuePresentEXT(swapchain);
+    
+    auto now = std::chrono::steady_clock::now();
+    double presentInterval = _ElapsedMilliseconds(lastPresent, now);
+    lastPresent = now;
+
+    swapchain->frame = (slot + 1) % swapchain->minImageCount;
+
+    double cpuFrameTime = _ElapsedMilliseconds(frameStart, now) - waitOnGpuTime;
+    frameStats.Record(cpuFrameTime, waitOnGpuTime, presentInterval);
+}
+
+bool Renderer::_RecreateSwapchain()
+{
+    swapchain = device->CreateSwapchainEXT(swapchain);
+
+    /* still out of date when the surface has no area, try again next frame */
+    return !swapchain->outOfDate;
+}
+
+void Renderer::_ResolveGpuTime(uint32_t slot)
+{
+    if (queryPool == VK_NULL_HANDLE || !queryWritten[slot])
+        return;
+
+    uint64_t timestamps[2];
+    VkResult err = vkGetQueryPoolResults(device->GetDevice(), queryPool, 2 * slot, 2, sizeof(timestamps),
+                                         timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    queryWritten[slot] = false;
+    
+    if (err != VK_SUCCESS)
+        return;
+
+    frameStats.RecordGpu((double) (timestamps[1] - timestamps[0]) * timestampPeriod / 1e6);
+}
+
+bool Renderer::_ReserveInstanceBuffer(uint32_t slot, uint32_t instanceCount)
+{
+    Buffer* instanceBuffer = instanceBuffers[slot];
+    size_t size = sizeof(InstanceData) * instanceCount;
+    
+    if (instanceBuffer && instanceBuffer->GetSize() >= size)
+        return true;
+
+    /* the slot fence was waited in BeginFrame, the old buffer is no longer read */
+    if (instanceBuffer)
+        device->DestroyBuffer(instanceBuffer);
+
+    size = std::max(size * 2, sizeof(InstanceData) * RENDERER_MIN_INSTANCES);
+    instanceBuffer = device->CreateBuffer(size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+    instanceBuffers[slot] = instanceBuffer;
+
+    if (!instanceBuffer) {
+        GOGH_LOGGER_ERROR("[Renderer] Failed to create instance buffer, (size=%zu)", size);
+        return false;
+    }
+
+    instanceBuffer->SetResidencyPriority(RESIDENCY_PRIORITY_CRITICAL);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Driver/RenderDevice.h"
+#include "FrameStats.h"
+#include "RenderSnapshot.h"
+#include "GPUScene.h"
+#include "Shader/ShaderLibrary.h"
+
+// std
+#include <chrono>
+
+/*
+ * Pipelined frame loop on top of the swapchain, frame N waits only on the fence of
+ * frame N-K (K = swapchain frame count) so CPU recording overlaps GPU execution.
+ */
+class Renderer
+{
+public:
+    Renderer(RenderDevice* _device);
+   ~Renderer();
+
+    /* false when no image could be acquired (e.g. minimized), skip recording and EndFrame */
+    bool BeginFrame();
+    void EndFrame();
+
+    /* render data of the current frame, read by the passes until EndFrame */
+    void SetSnapshot(const RenderSnapshot* _snapshot) { snapshot = _snapshot; }
+    /* reloaded shaders are swapped in at the start of each frame, may be null */
+    void SetShaderLibrary(ShaderLibrary* _shaders) { shaders = _shaders; }
+
+    CommandList* GetCommandList() { return commandList; }
+    GPUScene* GetGPUScene() { return gpuScene; }
+    /* draws mesh packets of the render queue, null when its shaders failed to load */
+    Pipeline* GetQueuePipeline() { return queuePipeline; }
+    RenderDevice::SwapchainVkEXT* GetSwapchain() { return swapchain; }
+    uint32_t GetFrameSlot() const { return swapchain->frame; }
+    uint32_t GetFrameSlotCount() const { return swapchain->minImageCount; }
+
+    void GetFrameStats(GoghFrameStats* pStats) { frameStats.Resolve(pStats); }
+    const RenderQueue::Stats& GetQueueStats() const { return queueStats; }
+    
+private:
+    bool _RecreateSwapchain();
+    void _ResolveGpuTime(uint32_t slot);
+    bool _ReserveInstanceBuffer(uint32_t slot, uint32_t instanceCount);
+    
+private:
+    RenderDevice* device = VK_NULL_HANDLE;
+    RenderDevice::SwapchainVkEXT* swapchain = VK_NULL_HANDLE;
+    CommandList* commandList = VK_NULL_HANDLE;
+    const RenderSnapshot* snapshot = VK_NULL_HANDLE;
+    GPUScene* gpuScene = VK_NULL_HANDLE;
+    ShaderLibrary* shaders = VK_NULL_HANDLE;
+    Pipeline* queuePipeline = VK_NULL_HANDLE;
+
+    /* one per frame slot, written by the render queue every frame */
+    Vector<Buffer*> instanceBuffers;
+    Vector<InstanceData> instanceStaging;
+
+    /* two timestamps per frame slot */
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+    Vector<bool> queryWritten;
+    double timestampPeriod = 0.0;
+    
+    FrameStats frameStats;
+    RenderQueue::Stats queueStats;
+    std::chrono::steady_clock::time_point frameStart;
+    std::chrono::steady_clock::time_point lastPresent;
+    double waitOnGpuTime = 0.0;
+};
\ No newline at end of file
@@ -18,4 +18,389 @@
 
 /* Create by Red Gogh on 2025/4/22 */
 
-#include "Scene.h"
\ No newline at end of file
+#include "Scene.h"
+
+#include <MM.h>
+
+// std
+#include <algorithm>
+#include <format>
+#include <new>
+
+struct ComponentType
+{
+    uint32_t size;
+    uint32_t alignment;
+};
+
+static std::mutex componentMutex;
+static ComponentType componentTypes[SCENE_MAX_COMPONENT_TYPES];
+static uint32_t componentTypeCount = 0;
+
+static uint32_t _AlignUp(uint32_t value, uint32_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/* chunk bytes used by capacity entities, offsets receives the start of each array */
+static uint32_t _LayoutChunk(const Vector<uint32_t>& components, uint32_t capacity, uint32_t* offsets)
+{
+    uint32_t offset = capacity * sizeof(Entity);
+
+    for (uint32_t id : components) {
+        offset = _AlignUp(offset, std::max(ComponentRegistry::GetAlignment(id), (uint32_t) SCENE_CHUNK_ALIGNMENT));
+        offsets[id] = offset;
+        offset += capacity * ComponentRegistry::GetSize(id);
+    }
+
+    return offset;
+}
+
+static SceneChunk _AllocateChunk()
+{
+    return { (uint8_t*) ::operator new(SCENE_CHUNK_SIZE, std::align_val_t(SCENE_CHUNK_ALIGNMENT)), 0 };
+}
+
+static void _FreeChunk(SceneChunk& chunk)
+{
+    ::operator delete(chunk.data, std::align_val_t(SCENE_CHUNK_ALIGNMENT));
+    chunk.data = nullptr;
+}
+
+uint32_t ComponentRegistry::GetSize(uint32_t id)
+{
+    return componentTypes[id].size;
+}
+
+uint32_t ComponentRegistry::GetAlignment(uint32_t id)
+{
+    return componentTypes[id].alignment;
+}
+
+uint32_t ComponentRegistry::_Register(uint32_t size, uint32_t alignment)
+{
+    std::unique_lock<std::mutex> lock(componentMutex);
+
+    if (componentTypeCount >= SCENE_MAX_COMPONENT_TYPES)
+        GOGH_ERROR("More than {} component types", SCENE_MAX_COMPONENT_TYPES);
+
+    componentTypes[componentTypeCount] = { size, alignment };
+    return componentTypeCount++;
+}
+
+Scene::~Scene()
+{
+    for (Archetype* archetype : archetypeList) {
+        for (SceneChunk& chunk : archetype->chunks)
+            _FreeChunk(chunk);
+
+        MemoryDelete(archetype);
+    }
+}
+
+void Scene::Destroy(Entity entity)
+{
+    GOGH_ASSERT(!iterating && "Structural change inside a query, record it in a SceneCommandBuffer");
+
+    if (!IsAlive(entity))
+        return;
+
+    EntityRecord& record = records[entity.index];
+    _Free(record.archetype, record.chunk, record.row);
+
+    record.archetype = nullptr;
+    record.generation++;
+    freeIndices.push_back(entity.index);
+    entityCount--;
+}
+
+bool Scene::IsAlive(Entity entity) const
+{
+    return entity.index < std::size(records) && records[entity.index].archetype && records[entity.index].generation == entity.generation;
+}
+
+uint32_t Scene::GetChunkCount() const
+{
+    uint32_t count = 0;
+
+    for (Archetype* archetype : archetypeList)
+        count += (uint32_t) std::size(archetype->chunks);
+
+    return count;
+}
+
+Entity Scene::_Create(ComponentMask mask)
+{
+    GOGH_ASSERT(!iterating && "Structural change inside a query, record it in a SceneCommandBuffer");
+
+    Entity entity;
+
+    if (!std::empty(freeIndices)) {
+        entity.index = freeIndices.back();
+        freeIndices.pop_back();
+    } else {
+        entity.index = (uint32_t) std::size(records);
+        GOGH_ASSERT(entity.index < SCENE_COMMAND_PENDING_BIT && "Too many entities");
+        records.emplace_back();
+    }
+
+    entity.generation = records[entity.index].generation;
+    _Allocate(_GetArchetype(mask), entity);
+    entityCount++;
+
+    return entity;
+}
+
+void Scene::_Add(Entity entity, uint32_t id, const void* pData)
+{
+    GOGH_ASSERT(!iterating && "Structural change inside a query, record it in a SceneCommandBuffer");
+
+    if (!IsAlive(entity))
+        return;
+
+    ComponentMask mask = records[entity.index].archetype->mask;
+    if (!(mask & (ComponentMask(1) << id)))
+        _Move(entity, mask | (ComponentMask(1) << id));
+
+    _Write(entity, id, pData);
+}
+
+void Scene::_Remove(Entity entity, uint32_t id)
+{
+    GOGH_ASSERT(!iterating && "Structural change inside a query, record it in a SceneCommandBuffer");
+
+    if (!IsAlive(entity))
+        return;
+
+    ComponentMask mask = records[entity.index].archetype->mask;
+    if (mask & (ComponentMask(1) << id))
+        _Move(entity, mask & ~(ComponentMask(1) << id));
+}
+
+void* Scene::_Get(Entity entity, uint32_t id) const
+{
+    if (!IsAlive(entity))
+        return nullptr;
+
+    const EntityRecord& record = records[entity.index];
+    if (!(record.archetype->mask & (ComponentMask(1) << id)))
+        return nullptr;
+
+    return (uint8_t*) record.archetype->GetArray(record.chunk, id) + (size_t) record.row * ComponentRegistry::GetSize(id);
+}
+
+void Scene::_Write(Entity entity, uint32_t id, const void* pData)
+{
+    const EntityRecord& record = records[entity.index];
+    uint32_t size = ComponentRegistry::GetSize(id);
+
+    memcpy((uint8_t*) record.archetype->GetArray(record.chunk, id) + (size_t) record.row * size, pData, size);
+}
+
+Archetype* Scene::_GetArchetype(ComponentMask mask)
+{
+    auto it = archetypes.find(mask);
+    if (it != archetypes.end())
+        return it->second;
+
+    Archetype* archetype = MemoryNew<Archetype>();
+    archetype->mask = mask;
+
+    for (uint32_t id = 0; id < SCENE_MAX_COMPONENT_TYPES; id++) {
+        if (mask & (ComponentMask(1) << id))
+            archetype->components.push_back(id);
+    }
+
+    /* start from the unpadded estimate and back off until the aligned arrays fit */
+    uint32_t stride = sizeof(Entity);
+    for (uint32_t id : archetype->components)
+        stride += ComponentRegistry::GetSize(id);
+
+    uint32_t capacity = SCENE_CHUNK_SIZE / stride;
+    while (capacity > 0 && _LayoutChunk(archetype->components, capacity, archetype->offsets) > SCENE_CHUNK_SIZE)
+        capacity--;
+
+    if (capacity == 0)
+        GOGH_ERROR("Components of archetype 0x{:x} do not fit in a {} byte chunk", mask, SCENE_CHUNK_SIZE);
+
+    archetype->capacity = capacity;
+
+    archetypes[mask] = archetype;
+    archetypeList.push_back(archetype);
+
+    return archetype;
+}
+
+void Scene::_Allocate(Archetype* archetype, Entity entity)
+{
+    if (std::empty(archetype->chunks) || archetype->chunks.back().count == archetype->capacity)
+        archetype->chunks.push_back(_AllocateChunk());
+
+    uint32_t chunk = (uint32_t) std::size(archetype->chunks) - 1;
+    uint32_t row = archetype->chunks[chunk].count++;
+    archetype->GetEntities(chunk)[row] = entity;
+    archetype->entityCount++;
+
+    EntityRecord& record = records[entity.index];
+    record.archetype = archetype;
+    record.chunk = chunk;
+    record.row = row;
+}
+
+void Scene::_Free(Archetype* archetype, uint32_t chunk, uint32_t row)
+{
+    uint32_t lastChunk = (uint32_t) std::size(archetype->chunks) - 1;
+    uint32_t lastRow = archetype->chunks[lastChunk].count - 1;
+
+    if (chunk != lastChunk || row != lastRow) {
+        Entity moved = archetype->GetEntities(lastChunk)[lastRow];
+        archetype->GetEntities(chunk)[row] = moved;
+
+        for (uint32_t id : archetype->components) {
+            uint32_t size = ComponentRegistry::GetSize(id);
+            memcpy((uint8_t*) archetype->GetArray(chunk, id) + (size_t) row * size,
+                   (uint8_t*) archetype->GetArray(lastChunk, id) + (size_t) lastRow * size, size);
+        }
+
+        records[moved.index].chunk = chunk;
+        records[moved.index].row = row;
+    }
+
+    if (--archetype->chunks[lastChunk].count == 0) {
+        _FreeChunk(archetype->chunks[lastChunk]);
+        archetype->chunks.pop_back();
+    }
+
+    archetype->entityCount--;
+}
+
+void Scene::_Move(Entity entity, ComponentMask mask)
+{
+    EntityRecord& record = records[entity.index];
+    Archetype* source = record.archetype;
+    uint32_t sourceChunk = record.chunk;
+    uint32_t sourceRow = record.row;
+
+    Archetype* target = _GetArchetype(mask);
+    _Allocate(target, entity);
+
+    for (uint32_t id : target->components) {
+        if (!(source->mask & (ComponentMask(1) << id)))
+            continue;
+
+        uint32_t size = ComponentRegistry::GetSize(id);
+        memcpy((uint8_t*) target->GetArray(record.chunk, id) + (size_t) record.row * size,
+               (uint8_t*) source->GetArray(sourceChunk, id) + (size_t) sourceRow * size, size);
+    }
+
+    _Free(source, sourceChunk, sourceRow);
+}
+
+void Scene::_GatherChunks(ComponentMask mask, Vector<ChunkRef>& refs) const
+{
+    for (Archetype* archetype : archetypeList) {
+        if ((archetype->mask & mask) != mask)
+            continue;
+
+        for (uint32_t chunk = 0; chunk < std::size(archetype->chunks); chunk++)
+            refs.push_back({ archetype, chunk });
+    }
+}
+
+void SceneCommandBuffer::Destroy(Entity entity)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    _Record(SCENE_COMMAND_DESTROY, entity, 0, nullptr, nullptr);
+}
+
+void SceneCommandBuffer::Playback(Scene* scene)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    /* scene entities of the placeholders, in Create() order */
+    Vector<Entity> created(pendingCount);
+
+    auto resolve = [&](Entity entity) {
+        return (entity.index & SCENE_COMMAND_PENDING_BIT) ? created[entity.index & ~SCENE_COMMAND_PENDING_BIT] : entity;
+    };
+
+    size_t cursor = 0;
+    while (cursor < std::size(stream)) {
+        CommandHeader header;
+        memcpy(&header, std::data(stream) + cursor, sizeof(header));
+        cursor += sizeof(header);
+
+        const uint8_t* ids = std::data(stream) + cursor;
+        cursor += header.componentCount * sizeof(uint32_t);
+
+        Entity entity = resolve(header.entity);
+
+        switch (header.type) {
+            case SCENE_COMMAND_CREATE: {
+                ComponentMask mask = 0;
+                for (uint32_t i = 0; i < header.componentCount; i++) {
+                    uint32_t id;
+                    memcpy(&id, ids + i * sizeof(uint32_t), sizeof(id));
+                    mask |= ComponentMask(1) << id;
+                }
+
+                entity = scene->_Create(mask);
+                created[header.entity.index & ~SCENE_COMMAND_PENDING_BIT] = entity;
+
+                for (uint32_t i = 0; i < header.componentCount; i++) {
+                    uint32_t id;
+                    memcpy(&id, ids + i * sizeof(uint32_t), sizeof(id));
+                    scene->_Write(entity, id, std::data(stream) + cursor);
+                    cursor += ComponentRegistry::GetSize(id);
+                }
+                break;
+            }
+            case SCENE_COMMAND_DESTROY: {
+                scene->Destroy(entity);
+                break;
+            }
+            case SCENE_COMMAND_ADD: {
+                uint32_t id;
+                memcpy(&id, ids, sizeof(id));
+                scene->_Add(entity, id, std::data(stream) + cursor);
+                cursor += ComponentRegistry::GetSize(id);
+                break;
+            }
+            case SCENE_COMMAND_REMOVE: {
+                uint32_t id;
+                memcpy(&id, ids, sizeof(id));
+                scene->_Remove(entity, id);
+                break;
+            }
+        }
+    }
+
+    stream.clear();
+    pendingCount = 0;
+}
+
+void SceneCommandBuffer::Clear()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    stream.clear();
+    pendingCount = 0;
+}
+
+void SceneCommandBuffer::_Record(CommandType type, Entity entity, uint32_t componentCount, const uint32_t* ids, const void* const* datas)
+{
+    CommandHeader header = { type, componentCount, entity };
+    _Append(&header, sizeof(header));
+    _Append(ids, componentCount * sizeof(uint32_t));
+
+    if (!datas)
+        return;
+
+    for (uint32_t i = 0; i < componentCount; i++)
+        _Append(datas[i], ComponentRegistry::GetSize(ids[i]));
+}
+
+void SceneCommandBuffer::_Append(const void* pData, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*) pData;
+    stream.insert(stream.end(), bytes, bytes + size);
+}
\ No newline at end of file
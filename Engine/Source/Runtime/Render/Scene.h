@@ -20,4 +20,389 @@
 
 #pragma once
 
-#include "Driver/RenderDevice.h"
\ No newline at end of file
+#include "Core/JobSystem.h"
+
+#include <Error.h>
+#include <Vector.h>
+#include <HashMap.h>
+
+// std
+#include <mutex>
+#include <type_traits>
+#include <stdint.h>
+#include <string.h>
+
+/* bytes of one chunk, an archetype packs as many entities as its arrays fit in it */
+#define SCENE_CHUNK_SIZE (16 << 10)
+
+/* arrays inside a chunk start on a cache line */
+#define SCENE_CHUNK_ALIGNMENT 64
+
+/* component types of a process, each is one bit of a ComponentMask */
+#define SCENE_MAX_COMPONENT_TYPES 64
+
+/* index bit of the placeholder entities a SceneCommandBuffer hands out, scene indices stay below it */
+#define SCENE_COMMAND_PENDING_BIT 0x80000000u
+
+/* parallel queries hand each thread this many chunk ranges to balance uneven chunks */
+#define SCENE_JOBS_PER_THREAD 4
+
+using ComponentMask = uint64_t;
+
+struct Entity
+{
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool IsNull() const
+      {
+        return index == UINT32_MAX;
+      }
+
+    bool operator==(const Entity& other) const
+      {
+        return index == other.index && generation == other.generation;
+      }
+};
+
+/*
+ * Process wide ids of component types, assigned the first time a type is used. Components
+ * are plain data: chunks move them with memcpy and never run constructors or destructors.
+ */
+class ComponentRegistry
+{
+public:
+    template<typename T>
+    static uint32_t GetId()
+      {
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "Components must be plain data");
+        static const uint32_t id = _Register(sizeof(T), alignof(T));
+        return id;
+      }
+
+    template<typename... Ts>
+    static ComponentMask GetMask()
+      {
+        return (ComponentMask(0) | ... | (ComponentMask(1) << GetId<Ts>()));
+      }
+
+    static uint32_t GetSize(uint32_t id);
+    static uint32_t GetAlignment(uint32_t id);
+
+private:
+    static uint32_t _Register(uint32_t size, uint32_t alignment);
+};
+
+struct SceneChunk
+{
+    uint8_t* data = nullptr;
+    uint32_t count = 0;
+};
+
+/*
+ * Every entity with exactly the same set of components. They live in 16 KB chunks, each
+ * one an Entity array followed by one array per component (struct of arrays), so a query
+ * reads every array it touches front to back. Chunks stay dense: removing an entity moves
+ * the last one of the archetype into its row.
+ */
+class Archetype
+{
+public:
+    ComponentMask GetMask() const { return mask; }
+    uint32_t GetCapacity() const { return capacity; }
+    uint32_t GetChunkCount() const { return (uint32_t) std::size(chunks); }
+    uint32_t GetEntityCount() const { return entityCount; }
+    uint32_t GetCount(uint32_t chunk) const { return chunks[chunk].count; }
+
+    Entity* GetEntities(uint32_t chunk) const
+      {
+        return (Entity*) chunks[chunk].data;
+      }
+
+    /* the array of component id in a chunk, the archetype must contain it */
+    void* GetArray(uint32_t chunk, uint32_t id) const
+      {
+        return chunks[chunk].data + offsets[id];
+      }
+
+    template<typename T>
+    T* GetArray(uint32_t chunk) const
+      {
+        return (T*) GetArray(chunk, ComponentRegistry::GetId<T>());
+      }
+
+private:
+    friend class Scene;
+
+    ComponentMask mask = 0;
+    uint32_t capacity = 0;
+    uint32_t entityCount = 0;
+    /* component ids of the mask in ascending order */
+    Vector<uint32_t> components;
+    /* byte offset of each component array in a chunk, indexed by component id */
+    uint32_t offsets[SCENE_MAX_COMPONENT_TYPES] = {};
+    Vector<SceneChunk> chunks;
+};
+
+/*
+ * Entity storage grouped by archetype. Entities are handles with a generation, a destroyed
+ * entity's handle stays invalid after its index is reused.
+ *
+ * Adding or removing a component moves the entity to another archetype, which reorders
+ * chunks, so structural changes are not allowed while a query runs. Record them in a
+ * SceneCommandBuffer instead and play it back after the query.
+ */
+class Scene
+{
+public:
+    Scene() = default;
+   ~Scene();
+
+    Scene(const Scene&) = delete;
+    Scene& operator=(const Scene&) = delete;
+
+    template<typename... Ts>
+    Entity Create(const Ts&... components)
+      {
+        Entity entity = _Create(ComponentRegistry::GetMask<Ts...>());
+        (_Write(entity, ComponentRegistry::GetId<Ts>(), &components), ...);
+        return entity;
+      }
+
+    void Destroy(Entity entity);
+    bool IsAlive(Entity entity) const;
+
+    /* overwrites the component when the entity already has it */
+    template<typename T>
+    void Add(Entity entity, const T& component = {})
+      {
+        _Add(entity, ComponentRegistry::GetId<T>(), &component);
+      }
+
+    template<typename T>
+    void Remove(Entity entity)
+      {
+        _Remove(entity, ComponentRegistry::GetId<T>());
+      }
+
+    /* null when the entity is dead or has no T, valid until the next structural change */
+    template<typename T>
+    T* Get(Entity entity) const
+      {
+        return (T*) _Get(entity, ComponentRegistry::GetId<T>());
+      }
+
+    template<typename T>
+    bool Has(Entity entity) const
+      {
+        return _Get(entity, ComponentRegistry::GetId<T>()) != nullptr;
+      }
+
+    /*
+     * fn(Ts&...) or fn(Entity, Ts&...) for every entity with at least the components Ts,
+     * chunk by chunk.
+     */
+    template<typename... Ts, typename Fn>
+    void ForEach(Fn&& fn)
+      {
+        ComponentMask mask = ComponentRegistry::GetMask<Ts...>();
+
+        iterating++;
+        for (Archetype* archetype : archetypeList) {
+            if ((archetype->mask & mask) != mask)
+                continue;
+
+            for (uint32_t chunk = 0; chunk < std::size(archetype->chunks); chunk++)
+                _ForEachInChunk<Ts...>(archetype, chunk, fn);
+        }
+        iterating--;
+      }
+
+    /*
+     * fn(count, Entity*, Ts*...) once per chunk with the raw arrays, for loops that want
+     * to vectorize over a chunk.
+     */
+    template<typename... Ts, typename Fn>
+    void ForEachChunk(Fn&& fn)
+      {
+        ComponentMask mask = ComponentRegistry::GetMask<Ts...>();
+
+        iterating++;
+        for (Archetype* archetype : archetypeList) {
+            if ((archetype->mask & mask) != mask)
+                continue;
+
+            for (uint32_t chunk = 0; chunk < std::size(archetype->chunks); chunk++)
+                fn(archetype->chunks[chunk].count, archetype->GetEntities(chunk), archetype->template GetArray<Ts>(chunk)...);
+        }
+        iterating--;
+      }
+
+    /*
+     * ForEach() spread over the job system in runs of whole chunks, returns when every
+     * entity was visited. fn runs concurrently, so it may only write the components it
+     * is given; structural changes go through a SceneCommandBuffer.
+     */
+    template<typename... Ts, typename Fn>
+    void ForEachParallel(JobSystem* jobSystem, Fn&& fn)
+      {
+        Vector<ChunkRef> refs;
+        _GatherChunks(ComponentRegistry::GetMask<Ts...>(), refs);
+
+        if (std::empty(refs))
+            return;
+
+        uint32_t jobCount = std::min((uint32_t) std::size(refs), jobSystem->GetThreadCount() * SCENE_JOBS_PER_THREAD);
+        uint32_t chunksPerJob = ((uint32_t) std::size(refs) + jobCount - 1) / jobCount;
+        jobCount = ((uint32_t) std::size(refs) + chunksPerJob - 1) / chunksPerJob;
+
+        iterating++;
+        jobSystem->Dispatch(jobCount, [&](uint32_t job) {
+            uint32_t end = std::min((job + 1) * chunksPerJob, (uint32_t) std::size(refs));
+            for (uint32_t i = job * chunksPerJob; i < end; i++)
+                _ForEachInChunk<Ts...>(refs[i].archetype, refs[i].chunk, fn);
+        });
+        iterating--;
+      }
+
+    uint32_t GetEntityCount() const { return entityCount; }
+    uint32_t GetArchetypeCount() const { return (uint32_t) std::size(archetypeList); }
+    uint32_t GetChunkCount() const;
+
+private:
+    friend class SceneCommandBuffer;
+
+    struct EntityRecord
+    {
+        Archetype* archetype = nullptr;
+        uint32_t chunk = 0;
+        uint32_t row = 0;
+        uint32_t generation = 0;
+    };
+
+    struct ChunkRef
+    {
+        Archetype* archetype;
+        uint32_t chunk;
+    };
+
+    template<typename... Ts, typename Fn>
+    static void _ForEachInChunk(Archetype* archetype, uint32_t chunk, Fn& fn)
+      {
+        uint32_t count = archetype->chunks[chunk].count;
+        Entity* entities = archetype->GetEntities(chunk);
+
+        auto run = [&](Ts*... arrays) {
+            for (uint32_t i = 0; i < count; i++) {
+                if constexpr (std::is_invocable_v<Fn&, Entity, Ts&...>)
+                    fn(entities[i], arrays[i]...);
+                else
+                    fn(arrays[i]...);
+            }
+        };
+
+        run(archetype->template GetArray<Ts>(chunk)...);
+      }
+
+    /* a new entity in the archetype of mask, its components are left uninitialized */
+    Entity _Create(ComponentMask mask);
+    void _Add(Entity entity, uint32_t id, const void* pData);
+    void _Remove(Entity entity, uint32_t id);
+    void* _Get(Entity entity, uint32_t id) const;
+    void _Write(Entity entity, uint32_t id, const void* pData);
+
+    Archetype* _GetArchetype(ComponentMask mask);
+    /* appends a row for entity to the archetype and points its record there */
+    void _Allocate(Archetype* archetype, Entity entity);
+    /* fills the row with the last entity of the archetype, frees the chunk that became empty */
+    void _Free(Archetype* archetype, uint32_t chunk, uint32_t row);
+    /* moves entity to the archetype of mask, keeps the components both have */
+    void _Move(Entity entity, ComponentMask mask);
+    void _GatherChunks(ComponentMask mask, Vector<ChunkRef>& refs) const;
+
+private:
+    Vector<EntityRecord> records;
+    Vector<uint32_t> freeIndices;
+    HashMap<ComponentMask, Archetype*> archetypes;
+    /* archetypes in creation order, queries walk this instead of the hash map */
+    Vector<Archetype*> archetypeList;
+    uint32_t entityCount = 0;
+    uint32_t iterating = 0;
+};
+
+/*
+ * Structural changes recorded while a query runs and applied by Playback() in order.
+ * Recording is thread safe, so jobs of ForEachParallel() can share one buffer. Entities
+ * from Create() are placeholders until playback, but later commands of the same buffer
+ * may use them.
+ */
+class SceneCommandBuffer
+{
+public:
+    SceneCommandBuffer() = default;
+   ~SceneCommandBuffer() = default;
+
+    template<typename... Ts>
+    Entity Create(const Ts&... components)
+      {
+        uint32_t ids[] = { ComponentRegistry::GetId<Ts>()..., 0 };
+        const void* datas[] = { &components..., nullptr };
+
+        std::unique_lock<std::mutex> lock(mutex);
+        Entity entity = { SCENE_COMMAND_PENDING_BIT | pendingCount++, 0 };
+        _Record(SCENE_COMMAND_CREATE, entity, sizeof...(Ts), ids, datas);
+        return entity;
+      }
+
+    void Destroy(Entity entity);
+
+    template<typename T>
+    void Add(Entity entity, const T& component = {})
+      {
+        uint32_t id = ComponentRegistry::GetId<T>();
+        const void* data = &component;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        _Record(SCENE_COMMAND_ADD, entity, 1, &id, &data);
+      }
+
+    template<typename T>
+    void Remove(Entity entity)
+      {
+        uint32_t id = ComponentRegistry::GetId<T>();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        _Record(SCENE_COMMAND_REMOVE, entity, 1, &id, nullptr);
+      }
+
+    bool IsEmpty() const { return std::empty(stream); }
+
+    /* applies the commands, commands on entities that are gone by then are skipped */
+    void Playback(Scene* scene);
+    void Clear();
+
+private:
+    enum CommandType : uint32_t
+    {
+        SCENE_COMMAND_CREATE = 0,
+        SCENE_COMMAND_DESTROY,
+        SCENE_COMMAND_ADD,
+        SCENE_COMMAND_REMOVE,
+    };
+
+    struct CommandHeader
+    {
+        CommandType type;
+        uint32_t componentCount;
+        Entity entity;
+    };
+
+    /* header, component ids, then the component values when datas is not null */
+    void _Record(CommandType type, Entity entity, uint32_t componentCount, const uint32_t* ids, const void* const* datas);
+    void _Append(const void* pData, size_t size);
+
+private:
+    std::mutex mutex;
+    Vector<uint8_t> stream;
+    uint32_t pendingCount = 0;
+};
\ No newline at end of file
@@ -0,0 +1,417 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "TransformHierarchy.h"
+
+#include <Error.h>
+#include <Logger.h>
+
+// std
+#include <atomic>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#  define TRANSFORM_HIERARCHY_SSE2
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#  define TRANSFORM_HIERARCHY_NEON
+#  include <arm_neon.h>
+#endif
+
+/* column major T * R * S, the same matrix as translate(t) * mat4_cast(q) * scale(s) */
+static void _ComposeLocal(const glm::vec3& t, const glm::quat& q, const glm::vec3& s, float* m)
+{
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    m[0]  = (1.0f - 2.0f * (yy + zz)) * s.x;
+    m[1]  = 2.0f * (xy + wz) * s.x;
+    m[2]  = 2.0f * (xz - wy) * s.x;
+    m[3]  = 0.0f;
+
+    m[4]  = 2.0f * (xy - wz) * s.y;
+    m[5]  = (1.0f - 2.0f * (xx + zz)) * s.y;
+    m[6]  = 2.0f * (yz + wx) * s.y;
+    m[7]  = 0.0f;
+
+    m[8]  = 2.0f * (xz + wy) * s.z;
+    m[9]  = 2.0f * (yz - wx) * s.z;
+    m[10] = (1.0f - 2.0f * (xx + yy)) * s.z;
+    m[11] = 0.0f;
+
+    m[12] = t.x;
+    m[13] = t.y;
+    m[14] = t.z;
+    m[15] = 1.0f;
+}
+
+/* result = parent * local, one result column per 4-wide multiply-add chain. local is affine,
+   its bottom row (0, 0, 0, 1) drops a term from the first three columns */
+static void _MultiplyAffine(const float* parent, const float* local, float* result)
+{
+#if defined(TRANSFORM_HIERARCHY_SSE2)
+    __m128 p0 = _mm_loadu_ps(parent + 0);
+    __m128 p1 = _mm_loadu_ps(parent + 4);
+    __m128 p2 = _mm_loadu_ps(parent + 8);
+    __m128 p3 = _mm_loadu_ps(parent + 12);
+
+    for (uint32_t c = 0; c < 4; c++) {
+        const float* l = local + c * 4;
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p0, _mm_set1_ps(l[0])), _mm_mul_ps(p1, _mm_set1_ps(l[1]))),
+                              _mm_mul_ps(p2, _mm_set1_ps(l[2])));
+        _mm_storeu_ps(result + c * 4, c == 3 ? _mm_add_ps(r, p3) : r);
+    }
+#elif defined(TRANSFORM_HIERARCHY_NEON)
+    float32x4_t p0 = vld1q_f32(parent + 0);
+    float32x4_t p1 = vld1q_f32(parent + 4);
+    float32x4_t p2 = vld1q_f32(parent + 8);
+    float32x4_t p3 = vld1q_f32(parent + 12);
+
+    for (uint32_t c = 0; c < 4; c++) {
+        const float* l = local + c * 4;
+        float32x4_t r = vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(p0, l[0]), p1, l[1]), p2, l[2]);
+        vst1q_f32(result + c * 4, c == 3 ? vaddq_f32(r, p3) : r);
+    }
+#else
+    for (uint32_t c = 0; c < 4; c++) {
+        const float* l = local + c * 4;
+        for (uint32_t r = 0; r < 4; r++)
+            result[c * 4 + r] = parent[r] * l[0] + parent[4 + r] * l[1] + parent[8 + r] * l[2] + (c == 3 ? parent[12 + r] : 0.0f);
+    }
+#endif
+}
+
+template<typename T>
+static void _Permute(Vector<T>& values, const Vector<uint32_t>& order)
+{
+    Vector<T> sorted(std::size(order));
+
+    for (uint32_t i = 0; i < std::size(order); i++)
+        sorted[i] = values[order[i]];
+
+    values.swap(sorted);
+}
+
+TransformHierarchy::TransformHierarchy(JobSystem* _jobSystem)
+    : jobSystem(_jobSystem)
+{
+    /* VOID */
+}
+
+TransformNode TransformHierarchy::Create(TransformNode parent)
+{
+    GOGH_ASSERT((parent == TRANSFORM_NULL_NODE || !(flags[_GetSlot(parent)] & TRANSFORM_FLAG_DEAD)) && "Parent destroyed");
+
+    TransformNode node;
+
+    if (!std::empty(freeNodes)) {
+        node = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        node = (TransformNode) std::size(slotOfNode);
+        slotOfNode.push_back(UINT32_MAX);
+    }
+
+    slotOfNode[node] = (uint32_t) std::size(nodes);
+
+    positions.push_back(glm::vec3(0.0f));
+    rotations.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+    scales.push_back(glm::vec3(1.0f));
+    worlds.push_back(glm::mat4(1.0f));
+    parents.push_back(parent);
+    parentSlots.push_back(UINT32_MAX);
+    depths.push_back(0);
+    nodes.push_back(node);
+    flags.push_back(TRANSFORM_FLAG_DIRTY);
+
+    nodeCount++;
+    stale = true;
+
+    return node;
+}
+
+void TransformHierarchy::Destroy(TransformNode node)
+{
+    uint32_t slot = _GetSlot(node);
+
+    if (flags[slot] & TRANSFORM_FLAG_DEAD)
+        return;
+
+    flags[slot] |= TRANSFORM_FLAG_DEAD;
+    deadNodes.push_back(node);
+
+    nodeCount--;
+    stale = true;
+}
+
+bool TransformHierarchy::SetParent(TransformNode node, TransformNode parent)
+{
+    uint32_t slot = _GetSlot(node);
+
+    for (TransformNode ancestor = parent; ancestor != TRANSFORM_NULL_NODE; ancestor = parents[_GetSlot(ancestor)]) {
+        if (ancestor == node) {
+            GOGH_LOGGER_WARN("[Transform] Refused to parent a node under itself, (node=%u, parent=%u)", node, parent);
+            return false;
+        }
+    }
+
+    if (parents[slot] == parent)
+        return true;
+
+    parents[slot] = parent;
+    _MarkDirty(slot);
+    stale = true;
+
+    return true;
+}
+
+TransformNode TransformHierarchy::GetParent(TransformNode node) const
+{
+    return parents[_GetSlot(node)];
+}
+
+void TransformHierarchy::SetLocal(TransformNode node, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+    uint32_t slot = _GetSlot(node);
+    positions[slot] = position;
+    rotations[slot] = rotation;
+    scales[slot] = scale;
+    _MarkDirty(slot);
+}
+
+void TransformHierarchy::SetPosition(TransformNode node, const glm::vec3& position)
+{
+    uint32_t slot = _GetSlot(node);
+    positions[slot] = position;
+    _MarkDirty(slot);
+}
+
+void TransformHierarchy::SetRotation(TransformNode node, const glm::quat& rotation)
+{
+    uint32_t slot = _GetSlot(node);
+    rotations[slot] = rotation;
+    _MarkDirty(slot);
+}
+
+void TransformHierarchy::SetScale(TransformNode node, const glm::vec3& scale)
+{
+    uint32_t slot = _GetSlot(node);
+    scales[slot] = scale;
+    _MarkDirty(slot);
+}
+
+bool TransformHierarchy::IsChanged(TransformNode node) const
+{
+    return flags[_GetSlot(node)] & TRANSFORM_FLAG_CHANGED;
+}
+
+void TransformHierarchy::Update()
+{
+    if (stale)
+        _Rebuild();
+
+    uint32_t levelCount = (uint32_t) std::size(levelDirtyCounts);
+    uint32_t parentChanged = 0;
+
+    stats.updatedNodes = 0;
+    stats.levels = levelCount;
+
+    for (uint32_t level = 0; level < levelCount; level++) {
+        uint32_t begin = levelStarts[level];
+        uint32_t end = levelStarts[level + 1];
+
+        /* nothing above changed and nothing here is dirty, only last update's marks to clear */
+        if (!parentChanged && !levelDirtyCounts[level]) {
+            if (levelChangedCounts[level]) {
+                for (uint32_t i = begin; i < end; i++)
+                    flags[i] &= ~TRANSFORM_FLAG_CHANGED;
+                levelChangedCounts[level] = 0;
+            }
+            continue;
+        }
+
+        uint32_t changed = 0;
+
+        if (!jobSystem || end - begin <= TRANSFORM_HIERARCHY_BATCH_SIZE) {
+            changed = _UpdateRange(begin, end);
+        } else {
+            std::atomic<uint32_t> counter = 0;
+            uint32_t batchCount = (end - begin + TRANSFORM_HIERARCHY_BATCH_SIZE - 1) / TRANSFORM_HIERARCHY_BATCH_SIZE;
+
+            jobSystem->Dispatch(batchCount, [&](uint32_t batch) {
+                uint32_t batchBegin = begin + batch * TRANSFORM_HIERARCHY_BATCH_SIZE;
+                uint32_t batchEnd = std::min(batchBegin + TRANSFORM_HIERARCHY_BATCH_SIZE, end);
+                counter += _UpdateRange(batchBegin, batchEnd);
+            });
+
+            changed = counter;
+        }
+
+        levelDirtyCounts[level] = 0;
+        levelChangedCounts[level] = changed;
+        parentChanged = changed;
+        stats.updatedNodes += changed;
+    }
+}
+
+uint32_t TransformHierarchy::_GetSlot(TransformNode node) const
+{
+    GOGH_ASSERT(node < std::size(slotOfNode) && slotOfNode[node] != UINT32_MAX && "Invalid transform node");
+    return slotOfNode[node];
+}
+
+void TransformHierarchy::_MarkDirty(uint32_t slot)
+{
+    if (flags[slot] & TRANSFORM_FLAG_DIRTY)
+        return;
+
+    flags[slot] |= TRANSFORM_FLAG_DIRTY;
+
+    /* a stale order recounts the levels when it is rebuilt */
+    if (!stale)
+        levelDirtyCounts[depths[slot]]++;
+}
+
+void TransformHierarchy::_Rebuild()
+{
+    uint32_t slotCount = (uint32_t) std::size(nodes);
+
+    /* orphans of destroyed nodes become roots */
+    for (uint32_t slot = 0; slot < slotCount; slot++) {
+        if (parents[slot] != TRANSFORM_NULL_NODE && (flags[slotOfNode[parents[slot]]] & TRANSFORM_FLAG_DEAD)) {
+            parents[slot] = TRANSFORM_NULL_NODE;
+            flags[slot] |= TRANSFORM_FLAG_DIRTY;
+        }
+    }
+
+    /* children of every slot in one array, grouped by parent */
+    Vector<uint32_t> childStarts(slotCount + 1, 0);
+    for (uint32_t slot = 0; slot < slotCount; slot++) {
+        if (!(flags[slot] & TRANSFORM_FLAG_DEAD) && parents[slot] != TRANSFORM_NULL_NODE)
+            childStarts[slotOfNode[parents[slot]] + 1]++;
+    }
+
+    for (uint32_t slot = 0; slot < slotCount; slot++)
+        childStarts[slot + 1] += childStarts[slot];
+
+    Vector<uint32_t> children(childStarts[slotCount]);
+    Vector<uint32_t> cursors(std::begin(childStarts), std::end(childStarts) - 1);
+
+    for (uint32_t slot = 0; slot < slotCount; slot++) {
+        if (!(flags[slot] & TRANSFORM_FLAG_DEAD) && parents[slot] != TRANSFORM_NULL_NODE)
+            children[cursors[slotOfNode[parents[slot]]]++] = slot;
+    }
+
+    /* breadth first from the roots gives one level after the other, and inside a level the
+       children of a parent side by side in the order of their parents, so an update reads
+       the parent world matrices front to back instead of at random */
+    Vector<uint32_t> order;
+    order.reserve(nodeCount);
+    levelStarts.clear();
+
+    for (uint32_t slot = 0; slot < slotCount; slot++) {
+        if (!(flags[slot] & TRANSFORM_FLAG_DEAD) && parents[slot] == TRANSFORM_NULL_NODE)
+            order.push_back(slot);
+    }
+
+    for (uint32_t begin = 0; begin < std::size(order);) {
+        uint32_t end = (uint32_t) std::size(order);
+        levelStarts.push_back(begin);
+
+        for (uint32_t i = begin; i < end; i++) {
+            for (uint32_t child = childStarts[order[i]]; child < childStarts[order[i] + 1]; child++)
+                order.push_back(children[child]);
+        }
+
+        begin = end;
+    }
+
+    GOGH_ASSERT(std::size(order) == nodeCount && "Transform hierarchy has a cycle");
+
+    uint32_t levelCount = (uint32_t) std::size(levelStarts);
+    levelStarts.push_back(nodeCount);
+
+    _Permute(positions, order);
+    _Permute(rotations, order);
+    _Permute(scales, order);
+    _Permute(worlds, order);
+    _Permute(parents, order);
+    _Permute(nodes, order);
+    _Permute(flags, order);
+    parentSlots.resize(nodeCount);
+    depths.resize(nodeCount);
+
+    for (uint32_t level = 0; level < levelCount; level++) {
+        for (uint32_t slot = levelStarts[level]; slot < levelStarts[level + 1]; slot++)
+            depths[slot] = level;
+    }
+
+    for (TransformNode node : deadNodes)
+        slotOfNode[node] = UINT32_MAX;
+
+    for (uint32_t slot = 0; slot < nodeCount; slot++)
+        slotOfNode[nodes[slot]] = slot;
+
+    levelDirtyCounts.assign(levelCount, 0);
+    levelChangedCounts.assign(levelCount, 0);
+
+    for (uint32_t slot = 0; slot < nodeCount; slot++) {
+        parentSlots[slot] = parents[slot] == TRANSFORM_NULL_NODE ? UINT32_MAX : slotOfNode[parents[slot]];
+        levelDirtyCounts[depths[slot]] += (flags[slot] & TRANSFORM_FLAG_DIRTY) ? 1 : 0;
+        levelChangedCounts[depths[slot]] += (flags[slot] & TRANSFORM_FLAG_CHANGED) ? 1 : 0;
+    }
+
+    freeNodes.insert(std::end(freeNodes), std::begin(deadNodes), std::end(deadNodes));
+    deadNodes.clear();
+
+    stale = false;
+    stats.rebuilds++;
+}
+
+uint32_t TransformHierarchy::_UpdateRange(uint32_t begin, uint32_t end)
+{
+    uint32_t changed = 0;
+
+    for (uint32_t slot = begin; slot < end; slot++) {
+        uint8_t flag = flags[slot];
+        uint32_t parent = parentSlots[slot];
+
+        if (!(flag & TRANSFORM_FLAG_DIRTY) && (parent == UINT32_MAX || !(flags[parent] & TRANSFORM_FLAG_CHANGED))) {
+            if (flag & TRANSFORM_FLAG_CHANGED)
+                flags[slot] = flag & ~TRANSFORM_FLAG_CHANGED;
+            continue;
+        }
+
+        if (parent == UINT32_MAX) {
+            _ComposeLocal(positions[slot], rotations[slot], scales[slot], &worlds[slot][0][0]);
+        } else {
+            float local[16];
+            _ComposeLocal(positions[slot], rotations[slot], scales[slot], local);
+            _MultiplyAffine(&worlds[parent][0][0], local, &worlds[slot][0][0]);
+        }
+
+        flags[slot] = TRANSFORM_FLAG_CHANGED;
+        changed++;
+    }
+
+    return changed;
+}
@@ -0,0 +1,142 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Core/JobSystem.h"
+
+#include <Vector.h>
+
+// std
+#include <stdint.h>
+
+// glm
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#define TRANSFORM_NULL_NODE UINT32_MAX
+
+/* nodes per job when a level is spread over the job system, smaller levels update inline */
+#define TRANSFORM_HIERARCHY_BATCH_SIZE 4096
+
+using TransformNode = uint32_t;
+
+/*
+ * Local translation, rotation and scale of every node plus the world matrix derived from
+ * them, stored as parallel arrays (struct of arrays) sorted by depth: each level of the
+ * hierarchy is one contiguous range and every parent sits in an earlier level. Update()
+ * walks the levels top down, so a node's parent world matrix is final by the time the
+ * node is reached, and the nodes of one level run in parallel.
+ *
+ * Only dirty subtrees are recomputed. Setting a local transform marks the node, and a
+ * node is recomputed when it is marked or its parent was recomputed this update. Levels
+ * above the first change are not touched.
+ *
+ * Create(), Destroy() and SetParent() only mark the order stale, the arrays are sorted
+ * again at the start of the next Update().
+ */
+class TransformHierarchy
+{
+public:
+    struct Stats {
+        uint32_t updatedNodes = 0;
+        uint32_t levels = 0;
+        uint64_t rebuilds = 0;
+    };
+
+public:
+    /* jobSystem null updates every level on the calling thread */
+    TransformHierarchy(JobSystem* _jobSystem);
+   ~TransformHierarchy() = default;
+
+    TransformNode Create(TransformNode parent = TRANSFORM_NULL_NODE);
+
+    /* children of the node become roots and keep their local transform */
+    void Destroy(TransformNode node);
+
+    /* keeps the local transform, refused when parent is node or one of its descendants */
+    bool SetParent(TransformNode node, TransformNode parent);
+    TransformNode GetParent(TransformNode node) const;
+
+    void SetLocal(TransformNode node, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+    void SetPosition(TransformNode node, const glm::vec3& position);
+    void SetRotation(TransformNode node, const glm::quat& rotation);
+    void SetScale(TransformNode node, const glm::vec3& scale);
+
+    const glm::vec3& GetPosition(TransformNode node) const { return positions[_GetSlot(node)]; }
+    const glm::quat& GetRotation(TransformNode node) const { return rotations[_GetSlot(node)]; }
+    const glm::vec3& GetScale(TransformNode node) const { return scales[_GetSlot(node)]; }
+
+    /* as of the last Update() */
+    const glm::mat4& GetWorld(TransformNode node) const { return worlds[_GetSlot(node)]; }
+
+    /* true when the last Update() recomputed the world matrix of node */
+    bool IsChanged(TransformNode node) const;
+
+    void Update();
+
+    uint32_t GetNodeCount() const { return nodeCount; }
+    const Stats& GetStats() const { return stats; }
+
+private:
+    enum TransformFlags : uint8_t
+    {
+        TRANSFORM_FLAG_DIRTY   = 1 << 0,
+        TRANSFORM_FLAG_CHANGED = 1 << 1,
+        TRANSFORM_FLAG_DEAD    = 1 << 2,
+    };
+
+    uint32_t _GetSlot(TransformNode node) const;
+    void _MarkDirty(uint32_t slot);
+    /* drops dead nodes, sorts the arrays by depth and rebuilds the levels */
+    void _Rebuild();
+    /* recomputes the nodes of a level that need it, returns how many did */
+    uint32_t _UpdateRange(uint32_t begin, uint32_t end);
+
+private:
+    JobSystem* jobSystem = nullptr;
+
+    /* per slot, in depth order once rebuilt */
+    Vector<glm::vec3> positions;
+    Vector<glm::quat> rotations;
+    Vector<glm::vec3> scales;
+    Vector<glm::mat4> worlds;
+    Vector<TransformNode> parents;
+    Vector<uint32_t> parentSlots;
+    Vector<uint32_t> depths;
+    Vector<TransformNode> nodes;
+    Vector<uint8_t> flags;
+
+    Vector<uint32_t> slotOfNode;
+    Vector<TransformNode> freeNodes;
+    /* nodes destroyed since the last rebuild, reused only after it so no parent refers to them */
+    Vector<TransformNode> deadNodes;
+
+    /* first slot of each level, one more entry than levels */
+    Vector<uint32_t> levelStarts;
+    /* dirty nodes per level, and the nodes each level recomputed in the last Update() */
+    Vector<uint32_t> levelDirtyCounts;
+    Vector<uint32_t> levelChangedCounts;
+
+    uint32_t nodeCount = 0;
+    bool stale = false;
+    Stats stats;
+};
@@ -0,0 +1,272 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "ShaderCompiler.h"
+#include "Core/Hash.h"
+#include "Core/MappedFile.h"
+#include "Core/Process.h"
+
+#include <Logger.h>
+
+// std
+#include <filesystem>
+#include <format>
+#include <string.h>
+
+static bool _EndsWith(const String& value, const char* suffix)
+{
+    size_t length = strlen(suffix);
+    return std::size(value) >= length && value.compare(std::size(value) - length, length, suffix) == 0;
+}
+
+static uint64_t _HashString(uint64_t hash, const String& value)
+{
+    return HashCombine(hash, Hash64(std::data(value), std::size(value)));
+}
+
+static const char* _GetStageName(VkShaderStageFlagBits stage)
+{
+    switch (stage) {
+        case VK_SHADER_STAGE_VERTEX_BIT: return "vert";
+        case VK_SHADER_STAGE_FRAGMENT_BIT: return "frag";
+        case VK_SHADER_STAGE_COMPUTE_BIT: return "comp";
+        default: return nullptr;
+    }
+}
+
+ShaderCompiler::ShaderCompiler(const char* cacheDirectory, const ShaderCompileSettings& settings)
+    : cache(cacheDirectory), settings(settings)
+{
+    settingsHash = _HashString(SHADER_COMPILER_VERSION, settings.compiler);
+    settingsHash = _HashString(settingsHash, settings.flags);
+    
+    for (const auto& directory : settings.includeDirectories)
+        settingsHash = _HashString(settingsHash, directory);
+}
+
+bool ShaderCompiler::Compile(const char* path, const Vector<ShaderDefine>& defines, Vector<uint32_t>* pCode, Vector<String>* pDependencies)
+{
+    VkShaderStageFlagBits stage = GetStage(path);
+    
+    if (_GetStageName(stage) == nullptr) {
+        GOGH_LOGGER_ERROR("[Shader] Unknown shader stage, (path=%s)", path);
+        ++failed;
+        return false;
+    }
+
+    uint64_t key;
+    Vector<String> files;
+    bool scanned = GetKey(path, defines, &key, &files);
+    
+    if (pDependencies)
+        pDependencies->insert(pDependencies->end(), files.begin(), files.end());
+
+    if (!scanned) {
+        ++failed;
+        return false;
+    }
+
+    String entry = cache.GetPath(key, ".spv");
+    
+    if (cache.Contains(key, ".spv") && _ReadCode(entry.c_str(), pCode)) {
+        ++cached;
+        return true;
+    }
+
+    String temp = cache.GetTempPath(key, ".spv");
+    
+    if (!_Invoke(path, stage, defines, temp.c_str()) || !cache.Store(key, ".spv", temp.c_str()) || !_ReadCode(entry.c_str(), pCode)) {
+        std::error_code error;
+        std::filesystem::remove(temp.c_str(), error);
+        
+        GOGH_LOGGER_ERROR("[Shader] Failed to compile shader, (path=%s, defines=%zu)", path, std::size(defines));
+        ++failed;
+        return false;
+    }
+
+    GOGH_LOGGER_DEBUG("[Shader] Compile shader successful, (path=%s, key=%016llx, includes=%zu, words=%zu)",
+                      path, (unsigned long long) key, std::size(files) - 1, std::size(*pCode));
+    ++compiled;
+    return true;
+}
+
+bool ShaderCompiler::GetKey(const char* path, const Vector<ShaderDefine>& defines, uint64_t* pKey, Vector<String>* pDependencies)
+{
+    uint64_t key = HashCombine(settingsHash, GetStage(path));
+    for (const auto& define : defines) {
+        key = _HashString(key, define.name);
+        key = _HashString(key, define.value);
+    }
+
+    /* the scan skips files already in the list, it has to start from an empty one */
+    Vector<String> files;
+    bool scanned = _ScanIncludes(path, 0, &key, &files);
+
+    if (pDependencies)
+        pDependencies->insert(pDependencies->end(), files.begin(), files.end());
+
+    *pKey = key;
+    return scanned;
+}
+
+VkShaderStageFlagBits ShaderCompiler::GetStage(const char* path)
+{
+    std::filesystem::path file(path);
+    String stem = String(file.stem().string());
+    String extension = String(file.extension().string());
+
+    if (_EndsWith(stem, "_vertex") || extension == ".vert")
+        return VK_SHADER_STAGE_VERTEX_BIT;
+    if (_EndsWith(stem, "_fragment") || extension == ".frag")
+        return VK_SHADER_STAGE_FRAGMENT_BIT;
+    if (_EndsWith(stem, "_compute") || extension == ".comp")
+        return VK_SHADER_STAGE_COMPUTE_BIT;
+    
+    return (VkShaderStageFlagBits) 0;
+}
+
+bool ShaderCompiler::_ScanIncludes(const String& path, uint32_t depth, uint64_t* pHash, Vector<String>* pFiles)
+{
+    if (depth > SHADER_COMPILER_MAX_INCLUDE_DEPTH) {
+        GOGH_LOGGER_ERROR("[Shader] Include nested too deep, (path=%s)", path.c_str());
+        return false;
+    }
+    
+    /* include guards make a second inclusion empty, the content is in the key once */
+    if (std::find(pFiles->begin(), pFiles->end(), path) != pFiles->end())
+        return true;
+
+    pFiles->push_back(path);
+    
+    MappedFile file(path.c_str());
+    if (!file.IsValid()) {
+        GOGH_LOGGER_ERROR("[Shader] Can not open shader source, (path=%s)", path.c_str());
+        return false;
+    }
+
+    const char* data = (const char*) file.GetData();
+    const char* end = data + file.GetSize();
+    
+    /* the spelling of the path must not split the key, ./a/../a/b and a/b are one entry */
+    *pHash = _HashString(*pHash, String(std::filesystem::path(path.c_str()).lexically_normal().generic_string()));
+    *pHash = HashCombine(*pHash, Hash64(data, file.GetSize()));
+
+    for (const char* line = data; line < end; ) {
+        const char* lineEnd = (const char*) memchr(line, '\n', end - line);
+        if (!lineEnd)
+            lineEnd = end;
+
+        const char* p = line;
+        line = lineEnd + 1;
+        
+        while (p < lineEnd && (*p == ' ' || *p == '\t'))
+            ++p;
+        if (p == lineEnd || *p++ != '#')
+            continue;
+        while (p < lineEnd && (*p == ' ' || *p == '\t'))
+            ++p;
+        if (lineEnd - p < 7 || memcmp(p, "include", 7) != 0)
+            continue;
+
+        p += 7;
+        while (p < lineEnd && (*p == ' ' || *p == '\t'))
+            ++p;
+        if (p == lineEnd || (*p != '"' && *p != '<'))
+            continue;
+
+        bool angled = *p == '<';
+        const char* nameEnd = (const char*) memchr(p + 1, angled ? '>' : '"', lineEnd - p - 1);
+        if (!nameEnd)
+            continue;
+        
+        String name(p + 1, nameEnd);
+        String resolved;
+        
+        if (!_ResolveInclude(path, name, angled, &resolved)) {
+            GOGH_LOGGER_ERROR("[Shader] Include not found, (path=%s, include=%s)", path.c_str(), name.c_str());
+            return false;
+        }
+
+        if (!_ScanIncludes(resolved, depth + 1, pHash, pFiles))
+            return false;
+    }
+
+    return true;
+}
+
+bool ShaderCompiler::_ResolveInclude(const String& includer, const String& name, bool angled, String* pPath) const
+{
+    std::error_code error;
+
+    /* like glslc, quoted names are looked up next to the includer first */
+    if (!angled) {
+        std::filesystem::path candidate = std::filesystem::path(includer.c_str()).parent_path() / name.c_str();
+        
+        if (std::filesystem::is_regular_file(candidate, error)) {
+            *pPath = String(candidate.lexically_normal().generic_string());
+            return true;
+        }
+    }
+
+    for (const auto& directory : settings.includeDirectories) {
+        std::filesystem::path candidate = std::filesystem::path(directory.c_str()) / name.c_str();
+        
+        if (std::filesystem::is_regular_file(candidate, error)) {
+            *pPath = String(candidate.lexically_normal().generic_string());
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ShaderCompiler::_Invoke(const char* path, VkShaderStageFlagBits stage, const Vector<ShaderDefine>& defines, const char* outputPath) const
+{
+    Vector<String> arguments = { settings.compiler, String(std::format("-fshader-stage={}", _GetStageName(stage))) };
+    AppendArguments(settings.flags, &arguments);
+
+    for (const auto& define : defines)
+        arguments.push_back(std::empty(define.value) ? String(std::format("-D{}", define.name)) : String(std::format("-D{}={}", define.name, define.value)));
+    
+    for (const auto& directory : settings.includeDirectories) {
+        arguments.push_back("-I");
+        arguments.push_back(directory);
+    }
+
+    arguments.push_back(path);
+    arguments.push_back("-o");
+    arguments.push_back(outputPath);
+
+    return RunProcess(arguments);
+}
+
+bool ShaderCompiler::_ReadCode(const char* path, Vector<uint32_t>* pCode)
+{
+    MappedFile file(path);
+    
+    if (!file.IsValid() || file.GetSize() == 0 || file.GetSize() % sizeof(uint32_t) != 0)
+        return false;
+
+    pCode->resize(file.GetSize() / sizeof(uint32_t));
+    memcpy(std::data(*pCode), file.GetData(), file.GetSize());
+    
+    return true;
+}
@@ -0,0 +1,103 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Cooker/DerivedDataCache.h"
+#include "Driver/VulkanInclude.h"
+
+#include <String.h>
+#include <Vector.h>
+
+// std
+#include <atomic>
+
+/* bump when the way SPIR-V is produced changes for the same source, every entry is compiled again */
+#define SHADER_COMPILER_VERSION 1
+
+/* include chains deeper than this are treated as cycles */
+#define SHADER_COMPILER_MAX_INCLUDE_DEPTH 32
+
+struct ShaderDefine
+{
+    String name;
+    String value;
+};
+
+struct ShaderCompileSettings
+{
+    String compiler = "glslc";
+    String flags = "-O";
+    Vector<String> includeDirectories;
+};
+
+struct ShaderCompileStats
+{
+    uint32_t compiled = 0;
+    uint32_t cached = 0;
+    uint32_t failed = 0;
+};
+
+/*
+ * GLSL to SPIR-V with a content keyed cache. The key of a compile mixes the settings,
+ * the stage, the defines and the path and content of every file in the include
+ * closure, so editing an included file recompiles exactly the shaders that include
+ * it and a warm cache starts without running the compiler at all. The compiler runs
+ * as a process like the asset cooker's, no compiler library is linked into the engine.
+ *
+ * Compile() is thread safe, the library calls it from job workers.
+ */
+class ShaderCompiler
+{
+public:
+    ShaderCompiler(const char* cacheDirectory, const ShaderCompileSettings& settings = {});
+   ~ShaderCompiler() = default;
+
+    /*
+     * SPIR-V of the source with the defines. Every file of the include closure, the
+     * source first, is appended to pDependencies (may be null), also when compiling
+     * fails so a broken shader can still be watched and fixed.
+     */
+    bool Compile(const char* path, const Vector<ShaderDefine>& defines, Vector<uint32_t>* pCode, Vector<String>* pDependencies);
+
+    /* cache key of the compile without running it, reads the whole include closure; pDependencies as in Compile() */
+    bool GetKey(const char* path, const Vector<ShaderDefine>& defines, uint64_t* pKey, Vector<String>* pDependencies);
+
+    /* the cooker's *_vertex/_fragment/_compute naming or a .vert/.frag/.comp extension, 0 when unknown */
+    static VkShaderStageFlagBits GetStage(const char* path);
+
+    ShaderCompileStats GetStats() const { return { compiled.load(), cached.load(), failed.load() }; }
+    
+private:
+    bool _ScanIncludes(const String& path, uint32_t depth, uint64_t* pHash, Vector<String>* pFiles);
+    bool _ResolveInclude(const String& includer, const String& name, bool angled, String* pPath) const;
+    bool _Invoke(const char* path, VkShaderStageFlagBits stage, const Vector<ShaderDefine>& defines, const char* outputPath) const;
+    static bool _ReadCode(const char* path, Vector<uint32_t>* pCode);
+    
+private:
+    DerivedDataCache cache;
+    ShaderCompileSettings settings;
+    uint64_t settingsHash = 0;
+    
+    std::atomic<uint32_t> compiled = 0;
+    std::atomic<uint32_t> cached = 0;
+    std::atomic<uint32_t> failed = 0;
+};
@@ -0,0 +1,329 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "ShaderLibrary.h"
+#include "Driver/RenderDevice.h"
+
+#include <Logger.h>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+
+ShaderLibrary::ShaderLibrary(RenderDevice* _device, JobSystem* pJobSystem, const char* cacheDirectory, const ShaderCompileSettings& settings)
+    : device(_device), jobSystem(pJobSystem), compiler(cacheDirectory, settings)
+{
+    /* nothing */
+}
+
+ShaderLibrary::~ShaderLibrary()
+{
+    /* rebuild jobs still hold programs and lock the mutex */
+    jobSystem->Wait();
+    /* retired or not, any of the pipelines may still be in flight */
+    vkDeviceWaitIdle(device->GetDevice());
+
+    for (const Rebuild& rebuild : rebuilds) {
+        if (rebuild.pipeline)
+            device->DestroyPipeline(rebuild.pipeline);
+    }
+    
+    for (const Retired& entry : retired)
+        device->DestroyPipeline(entry.pipeline);
+
+    for (const auto& program : programs) {
+        Pipeline* pipeline = program->GetPipeline();
+        if (pipeline)
+            device->DestroyPipeline(pipeline);
+    }
+
+    ShaderCompileStats stats = compiler.GetStats();
+    GOGH_LOGGER_DEBUG("[Shader] Destroying shader library, (programs=%zu, compiled=%u, cached=%u, failed=%u, ShaderLibrary: %p)",
+                      std::size(programs), stats.compiled, stats.cached, stats.failed, this);
+}
+
+ShaderProgram* ShaderLibrary::LoadCompute(const char* path, const Vector<ShaderDefine>& defines)
+{
+    return LoadCompute(path, 0, VK_NULL_HANDLE, 0, defines);
+}
+
+ShaderProgram* ShaderLibrary::LoadCompute(const char* path, uint32_t bindingCount, const VkDescriptorSetLayoutBinding* pBindings,
+                                          uint32_t pushConstantSize, const Vector<ShaderDefine>& defines)
+{
+    ShaderProgram* program = _CreateProgram(path, bindingCount, pBindings, pushConstantSize, defines);
+    _Load(program);
+    
+    return program;
+}
+
+ShaderVariantSet* ShaderLibrary::LoadComputeVariants(const char* path, const Vector<ShaderFeature>& features, uint32_t budget)
+{
+    if (std::size(features) > SHADER_VARIANT_MAX_FEATURES) {
+        GOGH_LOGGER_ERROR("[Shader] Too many shader features, (path=%s, features=%zu)", path, std::size(features));
+        return nullptr;
+    }
+
+    variantSets.push_back(std::make_unique<ShaderVariantSet>(this, path, features, budget));
+    return variantSets.back().get();
+}
+
+bool ShaderLibrary::SaveVariantList(const char* path) const
+{
+    Vector<String> lines;
+    
+    for (const auto& variantSet : variantSets) {
+        for (const auto& [mask, program] : variantSet->variants)
+            lines.push_back(String(std::format("{} {}", variantSet->_FormatMask(mask), variantSet->path)));
+    }
+
+    /* stable order, the list is meant to be checked in */
+    std::sort(lines.begin(), lines.end());
+
+    FILE* fp = fopen(path, "wb");
+    if (!fp) {
+        GOGH_LOGGER_ERROR("[Shader] Failed to save variant list, (path=%s)", path);
+        return false;
+    }
+
+    for (const String& line : lines)
+        fprintf(fp, "%s\n", line.c_str());
+
+    fclose(fp);
+    
+    GOGH_LOGGER_INFO("[Shader] Save variant list successful, (path=%s, variants=%zu)", path, std::size(lines));
+    return true;
+}
+
+uint32_t ShaderLibrary::PrecompileVariants(const char* path)
+{
+    auto start = std::chrono::steady_clock::now();
+    
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        GOGH_LOGGER_WARN("[Shader] No variant list to precompile, (path=%s)", path);
+        return 0;
+    }
+
+    Vector<ShaderProgram*> pending;
+    
+    /* one variant per line: features path */
+    char line[4096];
+    while (fgets(line, sizeof(line), fp)) {
+        String text = line;
+        while (!std::empty(text) && (text.back() == '\n' || text.back() == '\r'))
+            text.pop_back();
+
+        size_t space = text.find(' ');
+        if (space == String::npos)
+            continue;
+
+        String shader = FileWatcher::Normalize(text.substr(space + 1));
+        auto variantSet = std::find_if(variantSets.begin(), variantSets.end(), [&](const auto& set) {
+            return FileWatcher::Normalize(set->path) == shader;
+        });
+
+        uint32_t mask = 0;
+        if (variantSet == variantSets.end() || !(*variantSet)->_ParseMask(text.substr(0, space), &mask)) {
+            GOGH_LOGGER_WARN("[Shader] Variant list entry matches no loaded variant set, (entry=%s)", text.c_str());
+            continue;
+        }
+
+        ShaderVariantSet* set = variantSet->get();
+        if (set->variants.find(mask) != set->variants.end() || std::size(set->variants) >= set->budget)
+            continue;
+
+        pending.push_back(set->_CreateVariant(mask));
+    }
+
+    fclose(fp);
+
+    /* variants differing only in specialization share SPIR-V, compile it once before building their pipelines */
+    Vector<ShaderProgram*> followers;
+    HashMap<String, bool> sources;
+    
+    for (size_t i = 0; i < std::size(pending); ) {
+        String source = pending[i]->path;
+        for (const ShaderDefine& define : pending[i]->defines)
+            source += std::format(" {}={}", define.name, define.value);
+
+        if (!sources.try_emplace(source, true).second) {
+            followers.push_back(pending[i]);
+            pending.erase(pending.begin() + i);
+            continue;
+        }
+        
+        ++i;
+    }
+
+    size_t leaderCount = std::size(pending);
+    pending.insert(pending.end(), followers.begin(), followers.end());
+    
+    Vector<Vector<String>> dependencies(std::size(pending));
+    jobSystem->Dispatch((uint32_t) leaderCount, [&](uint32_t index) {
+        pending[index]->pipeline = _Build(pending[index], &dependencies[index]);
+    });
+    jobSystem->Dispatch((uint32_t) (std::size(pending) - leaderCount), [&](uint32_t index) {
+        index += (uint32_t) leaderCount;
+        pending[index]->pipeline = _Build(pending[index], &dependencies[index]);
+    });
+
+    for (size_t i = 0; i < std::size(pending); i++)
+        _Track(pending[i], dependencies[i]);
+
+    GOGH_LOGGER_INFO("[Shader] Precompile variants successful, (path=%s, variants=%zu, time=%.2fms)", path, std::size(pending),
+                     std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    
+    return (uint32_t) std::size(pending);
+}
+
+void ShaderLibrary::Update()
+{
+    ++frame;
+
+    if (hotReload) {
+        Vector<String> changed;
+        watcher.Poll(&changed);
+
+        for (const String& file : changed) {
+            auto it = dependents.find(file);
+            if (it == dependents.end())
+                continue;
+
+            GOGH_LOGGER_INFO("[Shader] Shader source changed, (path=%s, programs=%zu)", file.c_str(), std::size(it->second));
+            
+            for (ShaderProgram* program : it->second)
+                _ScheduleRebuild(program);
+        }
+    }
+
+    Vector<Rebuild> finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.swap(rebuilds);
+    }
+
+    for (Rebuild& rebuild : finished) {
+        ShaderProgram* program = rebuild.program;
+        program->compiling = false;
+        
+        /* an include added by the edit is watched from now on */
+        _Track(program, rebuild.dependencies);
+
+        if (rebuild.pipeline) {
+            Pipeline* previous = program->pipeline.exchange(rebuild.pipeline, std::memory_order_acq_rel);
+            program->generation.fetch_add(1, std::memory_order_release);
+            
+            if (previous)
+                retired.push_back({ previous, frame });
+
+            GOGH_LOGGER_INFO("[Shader] Shader reloaded, (path=%s, generation=%u)", program->path.c_str(), program->GetGeneration());
+        } else {
+            GOGH_LOGGER_ERROR("[Shader] Shader reload failed, keeping the previous pipeline, (path=%s)", program->path.c_str());
+        }
+
+        if (program->dirty) {
+            program->dirty = false;
+            _ScheduleRebuild(program);
+        }
+    }
+
+    while (!std::empty(retired) && frame - retired.front().frame > SHADER_LIBRARY_RETIRE_FRAMES) {
+        device->DestroyPipeline(retired.front().pipeline);
+        retired.erase(retired.begin());
+    }
+}
+
+ShaderProgram* ShaderLibrary::_CreateProgram(const char* path, uint32_t bindingCount, const VkDescriptorSetLayoutBinding* pBindings,
+                                             uint32_t pushConstantSize, const Vector<ShaderDefine>& defines)
+{
+    std::unique_ptr<ShaderProgram> program = std::make_unique<ShaderProgram>();
+    program->path = path;
+    program->defines = defines;
+    if (pBindings)
+        program->bindings.assign(pBindings, pBindings + bindingCount);
+    program->pushConstantSize = pushConstantSize;
+
+    programs.push_back(std::move(program));
+    return programs.back().get();
+}
+
+void ShaderLibrary::_Load(ShaderProgram* program)
+{
+    Vector<String> dependencies;
+    program->pipeline = _Build(program, &dependencies);
+    _Track(program, dependencies);
+}
+
+Pipeline* ShaderLibrary::_Build(ShaderProgram* program, Vector<String>* pDependencies)
+{
+    Vector<uint32_t> code;
+    
+    if (!compiler.Compile(program->path.c_str(), program->defines, &code, pDependencies))
+        return nullptr;
+
+    const VkDescriptorSetLayoutBinding* pBindings = std::empty(program->bindings) ? VK_NULL_HANDLE : std::data(program->bindings);
+    
+    VkSpecializationInfo specializationInfo = {
+        .mapEntryCount = (uint32_t) std::size(program->specializationMap),
+        .pMapEntries = std::data(program->specializationMap),
+        .dataSize = std::size(program->specializationData) * sizeof(uint32_t),
+        .pData = std::data(program->specializationData),
+    };
+    
+    return device->CreateComputePipeline(program->path.c_str(), std::size(code) * sizeof(uint32_t), std::data(code),
+                                         (uint32_t) std::size(program->bindings), pBindings, program->pushConstantSize,
+                                         std::empty(program->specializationMap) ? VK_NULL_HANDLE : &specializationInfo);
+}
+
+void ShaderLibrary::_Track(ShaderProgram* program, const Vector<String>& dependencies)
+{
+    for (const String& dependency : dependencies) {
+        String file = FileWatcher::Normalize(dependency);
+        
+        if (std::find(program->dependencies.begin(), program->dependencies.end(), file) != program->dependencies.end())
+            continue;
+
+        program->dependencies.push_back(file);
+        dependents[file].push_back(program);
+        watcher.Watch(file);
+    }
+}
+
+void ShaderLibrary::_ScheduleRebuild(ShaderProgram* program)
+{
+    /* saves during a rebuild build once more when it finished, never twice at once */
+    if (program->compiling) {
+        program->dirty = true;
+        return;
+    }
+
+    program->compiling = true;
+    
+    jobSystem->Schedule([this, program]() {
+        Rebuild rebuild;
+        rebuild.program = program;
+        rebuild.pipeline = _Build(program, &rebuild.dependencies);
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        rebuilds.push_back(std::move(rebuild));
+    });
+}
@@ -0,0 +1,151 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "ShaderCompiler.h"
+#include "ShaderVariantSet.h"
+#include "Core/FileWatcher.h"
+#include "Core/JobSystem.h"
+
+#include <HashMap.h>
+
+// std
+#include <memory>
+#include <mutex>
+
+class RenderDevice;
+class Pipeline;
+
+/* Update() calls a replaced pipeline stays alive for, covers the frames still in flight using it */
+#define SHADER_LIBRARY_RETIRE_FRAMES 8
+
+/*
+ * A pipeline built from shader source. The pipeline is swapped when a source it
+ * depends on changes, so callers fetch it each time they record instead of keeping
+ * the pointer. A program whose first compile failed has no pipeline until it is fixed.
+ */
+class ShaderProgram
+{
+public:
+    Pipeline* GetPipeline() const { return pipeline.load(std::memory_order_acquire); }
+    /* bumped on every swap, lets users rebuild descriptor sets bound to the old layout */
+    uint32_t GetGeneration() const { return generation.load(std::memory_order_acquire); }
+    const String& GetPath() const { return path; }
+    
+private:
+    friend class ShaderLibrary;
+    friend class ShaderVariantSet;
+    
+    String path;
+    Vector<ShaderDefine> defines;
+    Vector<VkDescriptorSetLayoutBinding> bindings;     /* empty when reflected */
+    uint32_t pushConstantSize = 0;
+    Vector<VkSpecializationMapEntry> specializationMap;
+    Vector<uint32_t> specializationData;
+    Vector<String> dependencies;    /* normalized, as reported by the file watcher */
+
+    std::atomic<Pipeline*> pipeline = nullptr;
+    std::atomic<uint32_t> generation = 0;
+    bool compiling = false;         /* a rebuild job is running */
+    bool dirty = false;             /* changed again while compiling */
+};
+
+/*
+ * Owns the programs compiled from source. Loading compiles on the calling thread,
+ * which with a warm cache is only reading SPIR-V back. With hot reload on, Update()
+ * checks the watched sources, recompiles the programs including a changed file on
+ * the job system and swaps the new pipelines in; a failed recompile keeps the old
+ * pipeline running and logs the error.
+ *
+ * LoadCompute() and Update() belong to the frame thread.
+ */
+class ShaderLibrary
+{
+public:
+    ShaderLibrary(RenderDevice* _device, JobSystem* pJobSystem, const char* cacheDirectory, const ShaderCompileSettings& settings = {});
+   ~ShaderLibrary();
+
+    ShaderLibrary(const ShaderLibrary&) = delete;
+    ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+    /* the layout is reflected from the shader and follows it across reloads */
+    ShaderProgram* LoadCompute(const char* path, const Vector<ShaderDefine>& defines = {});
+    ShaderProgram* LoadCompute(const char* path, uint32_t bindingCount, const VkDescriptorSetLayoutBinding* pBindings,
+                               uint32_t pushConstantSize, const Vector<ShaderDefine>& defines = {});
+
+    /* variants of a shader over features, compiled when first selected, see ShaderVariantSet */
+    ShaderVariantSet* LoadComputeVariants(const char* path, const Vector<ShaderFeature>& features, uint32_t budget = SHADER_VARIANT_DEFAULT_BUDGET);
+
+    /* every variant selected so far, one "FEATURE|FEATURE path" line each, for PrecompileVariants() */
+    bool SaveVariantList(const char* path) const;
+    /* compiles the listed variants of the loaded variant sets on the job system, returns how many */
+    uint32_t PrecompileVariants(const char* path);
+
+    void SetHotReload(bool enable) { hotReload = enable; }
+    
+    /* once per frame, swaps finished rebuilds in and destroys retired pipelines */
+    void Update();
+
+    ShaderCompileStats GetStats() const { return compiler.GetStats(); }
+    
+private:
+    friend class ShaderVariantSet;
+    
+    struct Rebuild
+    {
+        ShaderProgram* program = nullptr;
+        Pipeline* pipeline = nullptr;
+        Vector<String> dependencies;
+    };
+
+    struct Retired
+    {
+        Pipeline* pipeline = nullptr;
+        uint64_t frame = 0;
+    };
+    
+    ShaderProgram* _CreateProgram(const char* path, uint32_t bindingCount, const VkDescriptorSetLayoutBinding* pBindings,
+                                  uint32_t pushConstantSize, const Vector<ShaderDefine>& defines);
+    /* compiles on the calling thread and starts watching the sources */
+    void _Load(ShaderProgram* program);
+    /* any thread, null when compiling or creating the pipeline failed */
+    Pipeline* _Build(ShaderProgram* program, Vector<String>* pDependencies);
+    void _Track(ShaderProgram* program, const Vector<String>& dependencies);
+    void _ScheduleRebuild(ShaderProgram* program);
+    
+private:
+    RenderDevice* device = VK_NULL_HANDLE;
+    JobSystem* jobSystem = nullptr;
+    ShaderCompiler compiler;
+    FileWatcher watcher;
+    bool hotReload = true;
+
+    Vector<std::unique_ptr<ShaderProgram>> programs;
+    Vector<std::unique_ptr<ShaderVariantSet>> variantSets;
+    HashMap<String, Vector<ShaderProgram*>> dependents;     /* normalized source -> programs including it */
+    Vector<Retired> retired;
+    uint64_t frame = 0;
+
+    /* guards the rebuilds finished by job workers */
+    std::mutex mutex;
+    Vector<Rebuild> rebuilds;
+};
@@ -0,0 +1,143 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "ShaderVariantSet.h"
+#include "ShaderLibrary.h"
+
+#include <Logger.h>
+
+// std
+#include <string.h>
+
+ShaderVariantSet::ShaderVariantSet(ShaderLibrary* _library, const char* path, const Vector<ShaderFeature>& features, uint32_t budget)
+    : library(_library), path(path), features(features), budget(budget)
+{
+    featureMask = std::size(features) >= 32 ? UINT32_MAX : (1u << std::size(features)) - 1;
+}
+
+ShaderProgram* ShaderVariantSet::Get(uint32_t mask)
+{
+    mask &= featureMask;
+
+    auto it = variants.find(mask);
+    if (it != variants.end())
+        return it->second;
+
+    if (std::size(variants) >= budget) {
+        if (!budgetExceeded)
+            GOGH_LOGGER_ERROR("[Shader] Variant budget used up, (path=%s, budget=%u, features=%s)", path.c_str(), budget, _FormatMask(mask).c_str());
+        
+        budgetExceeded = true;
+        return nullptr;
+    }
+
+    GOGH_LOGGER_WARN("[Shader] Compiling shader variant on first use, add it to the variant list, (path=%s, features=%s)",
+                     path.c_str(), _FormatMask(mask).c_str());
+
+    ShaderProgram* program = _CreateVariant(mask);
+    library->_Load(program);
+    
+    return program;
+}
+
+uint32_t ShaderVariantSet::GetFeatureBit(const char* name) const
+{
+    for (uint32_t i = 0; i < std::size(features); i++) {
+        if (features[i].name == name)
+            return 1u << i;
+    }
+
+    return 0;
+}
+
+ShaderProgram* ShaderVariantSet::_CreateVariant(uint32_t mask)
+{
+    Vector<ShaderDefine> defines;
+    Vector<VkSpecializationMapEntry> specializationMap;
+    Vector<uint32_t> specializationData;
+
+    for (uint32_t i = 0; i < std::size(features); i++) {
+        const ShaderFeature& feature = features[i];
+        bool enabled = (mask >> i) & 1;
+
+        if (feature.type == SHADER_FEATURE_TYPE_DEFINE) {
+            if (enabled)
+                defines.push_back({ feature.name, "1" });
+            continue;
+        }
+
+        /* disabled features are written too, the variant never depends on the default in the source */
+        specializationMap.push_back({
+            .constantID = feature.constantId,
+            .offset = (uint32_t) (std::size(specializationData) * sizeof(uint32_t)),
+            .size = sizeof(VkBool32),
+        });
+        specializationData.push_back(enabled ? VK_TRUE : VK_FALSE);
+    }
+
+    ShaderProgram* program = library->_CreateProgram(path.c_str(), 0, VK_NULL_HANDLE, 0, defines);
+    program->specializationMap = std::move(specializationMap);
+    program->specializationData = std::move(specializationData);
+    
+    variants[mask] = program;
+    return program;
+}
+
+String ShaderVariantSet::_FormatMask(uint32_t mask) const
+{
+    String text;
+    
+    for (uint32_t i = 0; i < std::size(features); i++) {
+        if (!((mask >> i) & 1))
+            continue;
+
+        if (!std::empty(text))
+            text += "|";
+        text += features[i].name;
+    }
+
+    return std::empty(text) ? String("-") : text;
+}
+
+bool ShaderVariantSet::_ParseMask(const String& text, uint32_t* pMask) const
+{
+    *pMask = 0;
+
+    if (text == "-")
+        return true;
+
+    for (size_t start = 0; start <= std::size(text); ) {
+        size_t end = text.find('|', start);
+        if (end == String::npos)
+            end = std::size(text);
+
+        String name = text.substr(start, end - start);
+        uint32_t bit = GetFeatureBit(name.c_str());
+        
+        if (bit == 0)
+            return false;
+
+        *pMask |= bit;
+        start = end + 1;
+    }
+
+    return true;
+}
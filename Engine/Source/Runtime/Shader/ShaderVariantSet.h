@@ -0,0 +1,96 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include <String.h>
+#include <Vector.h>
+#include <HashMap.h>
+
+// std
+#include <stdint.h>
+
+class ShaderLibrary;
+class ShaderProgram;
+
+/* a variant is selected by a uint32_t mask, one bit per feature */
+#define SHADER_VARIANT_MAX_FEATURES 32
+
+/* variants a set compiles before further masks are refused, keeps the product of features in check */
+#define SHADER_VARIANT_DEFAULT_BUDGET 64
+
+enum ShaderFeatureType
+{
+    /* layout(constant_id = N) const bool NAME = false; one SPIR-V, a pipeline per variant */
+    SHADER_FEATURE_TYPE_SPECIALIZATION = 0,
+    /* #ifdef NAME, a compile per variant, for what specialization can not switch (interfaces, types) */
+    SHADER_FEATURE_TYPE_DEFINE,
+};
+
+struct ShaderFeature
+{
+    String name;
+    ShaderFeatureType type = SHADER_FEATURE_TYPE_SPECIALIZATION;
+    uint32_t constantId = 0;
+};
+
+/*
+ * The permutations of one shader over a list of features, bit i of a mask turns
+ * features[i] on. Every variant is a straight line program: specialization constants
+ * are folded by the driver when the pipeline is created, defines by the compiler, so
+ * nothing branches on a feature at run time.
+ *
+ * Variants are compiled the first time their mask is asked for. The masks asked for
+ * during a session are what ShaderLibrary::SaveVariantList() writes, and precompiling
+ * that list at load time keeps the lazy compiles out of the frame.
+ */
+class ShaderVariantSet
+{
+public:
+    ShaderVariantSet(ShaderLibrary* _library, const char* path, const Vector<ShaderFeature>& features, uint32_t budget);
+   ~ShaderVariantSet() = default;
+
+    /* frame thread, bits of undeclared features are ignored, null once the budget is used up */
+    ShaderProgram* Get(uint32_t mask);
+
+    /* the bit of a feature, 0 when the set does not declare it */
+    uint32_t GetFeatureBit(const char* name) const;
+    
+    const String& GetPath() const { return path; }
+    uint32_t GetVariantCount() const { return (uint32_t) std::size(variants); }
+    
+private:
+    friend class ShaderLibrary;
+
+    /* the program of a new variant, not compiled yet */
+    ShaderProgram* _CreateVariant(uint32_t mask);
+    String _FormatMask(uint32_t mask) const;
+    bool _ParseMask(const String& text, uint32_t* pMask) const;
+    
+private:
+    ShaderLibrary* library = nullptr;
+    String path;
+    Vector<ShaderFeature> features;
+    uint32_t featureMask = 0;
+    uint32_t budget = 0;
+    bool budgetExceeded = false;
+    HashMap<uint32_t, ShaderProgram*> variants;
+};
@@ -0,0 +1,297 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "StreamingManager.h"
+
+#include <Logger.h>
+
+// std
+#include <algorithm>
+#include <filesystem>
+
+StreamingManager::StreamingManager(JobSystem* pJobSystem, size_t memoryBudget, size_t uploadBudget)
+    : jobSystem(pJobSystem), memoryBudget(memoryBudget), uploadBudget(uploadBudget)
+{
+    ioThread = std::thread(&StreamingManager::_IOThreadMain, this);
+    
+    GOGH_LOGGER_DEBUG("[Streaming] Create streaming manager successful, (backend=%s, memoryBudget=%zu MiB, uploadBudget=%zu MiB, StreamingManager: %p)",
+                      reader.IsUsingUring() ? "io_uring" : "threads", memoryBudget >> 20, uploadBudget >> 20, this);
+}
+
+StreamingManager::~StreamingManager()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        _Wake();
+    }
+    
+    ioThread.join();
+
+    /* decode jobs still hold requests and lock the mutex */
+    jobSystem->Wait();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const StreamHandle& request : ready)
+        request->state = STREAM_STATE_CANCELED;
+    
+    GOGH_LOGGER_DEBUG("[Streaming] Destroying streaming manager, (completed=%llu, StreamingManager: %p)", (unsigned long long) stats.completed, this);
+}
+
+StreamHandle StreamingManager::Request(const char* path, int32_t priority, StreamDecode decode, StreamUpload upload)
+{
+    StreamHandle request = std::make_shared<StreamRequest>();
+    request->path = path;
+    request->priority = priority;
+    request->decode = std::move(decode);
+    request->upload = std::move(upload);
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    request->sequence = nextSequence++;
+    queue.emplace(_GetQueueKey(*request), request);
+    _Wake();
+
+    return request;
+}
+
+void StreamingManager::SetPriority(const StreamHandle& handle, int32_t priority)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (handle->GetState() != STREAM_STATE_QUEUED || handle->priority == priority) {
+        handle->priority = priority;
+        return;
+    }
+
+    queue.erase(_GetQueueKey(*handle));
+    handle->priority = priority;
+    queue.emplace(_GetQueueKey(*handle), handle);
+    _Wake();
+}
+
+void StreamingManager::Cancel(const StreamHandle& handle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    switch (handle->GetState()) {
+        case STREAM_STATE_QUEUED: {
+            queue.erase(_GetQueueKey(*handle));
+            handle->state = STREAM_STATE_CANCELED;
+            break;
+        }
+        case STREAM_STATE_UPLOADING: {
+            auto it = std::find(ready.begin(), ready.end(), handle);
+            if (it != ready.end()) {
+                ready.erase(it);
+                _Release(handle.get(), STREAM_STATE_CANCELED);
+            }
+            break;
+        }
+        case STREAM_STATE_READING:
+        case STREAM_STATE_DECODING: {
+            /* the stage in progress finishes and drops the result */
+            handle->canceled = true;
+            break;
+        }
+        default: break;
+    }
+}
+
+void StreamingManager::Update()
+{
+    Vector<StreamHandle> uploads;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        
+        std::sort(ready.begin(), ready.end(), [](const StreamHandle& a, const StreamHandle& b) {
+            return _GetQueueKey(*a) < _GetQueueKey(*b);
+        });
+        
+        size_t bytes = 0;
+        size_t count = 0;
+        while (count < std::size(ready) && (count == 0 || bytes + std::size(ready[count]->bytes) <= uploadBudget))
+            bytes += std::size(ready[count++]->bytes);
+
+        uploads.assign(ready.begin(), ready.begin() + count);
+        ready.erase(ready.begin(), ready.begin() + count);
+    }
+
+    for (const StreamHandle& request : uploads) {
+        request->upload(request->bytes);
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.completed++;
+        stats.uploadedBytes += std::size(request->bytes);
+        _Release(request.get(), STREAM_STATE_COMPLETE);
+    }
+}
+
+StreamingStats StreamingManager::GetStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    stats.queued = (uint32_t) std::size(queue);
+    stats.inFlight = (uint32_t) std::size(active);
+    stats.inFlightBytes = inFlightBytes;
+    
+    return stats;
+}
+
+void StreamingManager::_Wake()
+{
+    wakeCount++;
+    wakeCondition.notify_one();
+}
+
+void StreamingManager::_Release(StreamRequest* pRequest, StreamState state)
+{
+    inFlightBytes -= pRequest->reservedBytes;
+    pRequest->reservedBytes = 0;
+    Vector<uint8_t>().swap(pRequest->bytes);
+    pRequest->state = state;
+    _Wake();
+    
+    /* may drop the last reference */
+    active.erase(pRequest);
+}
+
+void StreamingManager::_IOThreadMain()
+{
+    AsyncRead* reads[ASYNC_READER_QUEUE_DEPTH];
+    std::unique_lock<std::mutex> lock(mutex);
+    
+    while (true) {
+        _StartReads(lock);
+        
+        if (reader.GetPendingCount() == 0) {
+            if (stopping)
+                break;
+            
+            uint64_t seen = wakeCount;
+            wakeCondition.wait(lock, [&] { return stopping || wakeCount != seen; });
+            continue;
+        }
+        
+        /* new requests wait for the next completion, reads in flight keep the disk busy meanwhile */
+        lock.unlock();
+        uint32_t count = reader.Complete(reads, ASYNC_READER_QUEUE_DEPTH, true);
+        lock.lock();
+        
+        for (uint32_t i = 0; i < count; i++)
+            _FinishRead(reads[i]);
+    }
+
+    for (auto& [key, request] : queue)
+        request->state = STREAM_STATE_CANCELED;
+    queue.clear();
+}
+
+void StreamingManager::_StartReads(std::unique_lock<std::mutex>& lock)
+{
+    while (!stopping && !std::empty(queue) && reader.GetPendingCount() < ASYNC_READER_QUEUE_DEPTH) {
+        StreamHandle request = queue.begin()->second;
+        
+        if (request->fileSize < 0) {
+            std::error_code error;
+            
+            lock.unlock();
+            uintmax_t size = std::filesystem::file_size(request->path.c_str(), error);
+            lock.lock();
+
+            if (error) {
+                GOGH_LOGGER_ERROR("[Streaming] Failed to open stream source, (path=%s)", request->path.c_str());
+                if (queue.erase(_GetQueueKey(*request)))
+                    request->state = STREAM_STATE_FAILED;
+                continue;
+            }
+            
+            /* the queue may have changed while unlocked, start over from its front */
+            request->fileSize = (int64_t) size;
+            continue;
+        }
+
+        size_t size = (size_t) request->fileSize;
+        
+        /* a request larger than the whole budget still runs, alone */
+        if (inFlightBytes > 0 && inFlightBytes + size > memoryBudget)
+            break;
+
+        queue.erase(queue.begin());
+        active[request.get()] = request;
+        request->reservedBytes = size;
+        request->state = STREAM_STATE_READING;
+        inFlightBytes += size;
+
+        lock.unlock();
+        request->bytes.resize(size);
+        request->read.path = request->path.c_str();
+        request->read.pDestination = std::data(request->bytes);
+        request->read.size = size;
+        request->read.pUserData = request.get();
+        reader.Submit(&request->read);
+        lock.lock();
+    }
+}
+
+void StreamingManager::_FinishRead(AsyncRead* pRead)
+{
+    StreamRequest* request = static_cast<StreamRequest*>(pRead->pUserData);
+
+    if (request->canceled) {
+        _Release(request, STREAM_STATE_CANCELED);
+        return;
+    }
+    
+    if (!pRead->succeeded) {
+        GOGH_LOGGER_ERROR("[Streaming] Failed to read stream source, (path=%s)", request->path.c_str());
+        _Release(request, STREAM_STATE_FAILED);
+        return;
+    }
+
+    StreamHandle handle = active[request];
+    
+    if (!handle->decode) {
+        handle->state = STREAM_STATE_UPLOADING;
+        ready.push_back(handle);
+        return;
+    }
+
+    handle->state = STREAM_STATE_DECODING;
+    jobSystem->Schedule([this, handle] {
+        bool decoded = handle->decode(&handle->bytes);
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        
+        if (handle->canceled || !decoded) {
+            if (!decoded)
+                GOGH_LOGGER_ERROR("[Streaming] Failed to decode stream source, (path=%s)", handle->path.c_str());
+            _Release(handle.get(), handle->canceled ? STREAM_STATE_CANCELED : STREAM_STATE_FAILED);
+            return;
+        }
+
+        /* decoding may grow the data, the budget follows what is actually held */
+        inFlightBytes += std::size(handle->bytes) - handle->reservedBytes;
+        handle->reservedBytes = std::size(handle->bytes);
+        handle->state = STREAM_STATE_UPLOADING;
+        ready.push_back(handle);
+    });
+}
@@ -0,0 +1,154 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Core/AsyncReader.h"
+#include "Core/JobSystem.h"
+
+#include <String.h>
+#include <HashMap.h>
+
+// std
+#include <map>
+#include <memory>
+
+/* bytes read or decoded but not uploaded yet, requests past it wait in the queue */
+#define STREAMING_MEMORY_BUDGET (256ull << 20)
+
+/* bytes handed to upload callbacks per Update(), one request always goes through */
+#define STREAMING_UPLOAD_BUDGET (32ull << 20)
+
+enum StreamState
+{
+    STREAM_STATE_QUEUED = 0,
+    STREAM_STATE_READING,
+    STREAM_STATE_DECODING,
+    STREAM_STATE_UPLOADING,     /* decoded, waiting for Update() */
+    STREAM_STATE_COMPLETE,
+    STREAM_STATE_CANCELED,
+    STREAM_STATE_FAILED,
+};
+
+/* job worker, may rewrite the bytes in place (decompress, transcode), false fails the request */
+using StreamDecode = std::function<bool(Vector<uint8_t>* pBytes)>;
+/* thread calling Update(), the bytes are freed once it returns */
+using StreamUpload = std::function<void(const Vector<uint8_t>& bytes)>;
+
+class StreamRequest
+{
+public:
+    StreamState GetState() const { return state.load(std::memory_order_acquire); }
+    bool IsDone() const { return GetState() >= STREAM_STATE_COMPLETE; }
+    
+private:
+    friend class StreamingManager;
+    
+    String path;
+    int32_t priority = 0;
+    uint64_t sequence = 0;
+    StreamDecode decode;
+    StreamUpload upload;
+
+    std::atomic<StreamState> state = STREAM_STATE_QUEUED;
+    bool canceled = false;          /* guarded by the manager mutex */
+    int64_t fileSize = -1;
+    size_t reservedBytes = 0;       /* share of the memory budget held by this request */
+    Vector<uint8_t> bytes;
+    AsyncRead read;
+};
+
+/* shared with the manager until the request is done, polling it never blocks */
+using StreamHandle = std::shared_ptr<StreamRequest>;
+
+struct StreamingStats
+{
+    uint32_t queued = 0;
+    uint32_t inFlight = 0;          /* reading, decoding or waiting for upload */
+    size_t inFlightBytes = 0;
+    uint64_t completed = 0;
+    uint64_t uploadedBytes = 0;
+};
+
+/*
+ * Asynchronous asset loading. Requests are served highest priority first by one I/O
+ * thread driving an AsyncReader (io_uring or reader threads), the read bytes are
+ * decoded on the job system and handed to the upload callback from Update() on the
+ * frame thread, which is the only place GPU resources get written.
+ *
+ * Memory held by requests between read and upload stays under the memory budget, so
+ * queueing a whole level never allocates the whole level at once. Nothing here waits
+ * on I/O: the frame only pays for the uploads it is given per Update().
+ */
+class StreamingManager
+{
+public:
+    StreamingManager(JobSystem* pJobSystem, size_t memoryBudget = STREAMING_MEMORY_BUDGET, size_t uploadBudget = STREAMING_UPLOAD_BUDGET);
+   ~StreamingManager();
+
+    StreamingManager(const StreamingManager&) = delete;
+    StreamingManager& operator=(const StreamingManager&) = delete;
+
+    /* higher priority is served first, equal priorities in request order. decode may be empty */
+    StreamHandle Request(const char* path, int32_t priority, StreamDecode decode, StreamUpload upload);
+    
+    /* reorders a request that is still queued, later stages keep their order */
+    void SetPriority(const StreamHandle& handle, int32_t priority);
+    /* the upload callback never runs after Cancel() returned */
+    void Cancel(const StreamHandle& handle);
+
+    /* once per frame on the thread that owns GPU resources */
+    void Update();
+
+    StreamingStats GetStats();
+    
+private:
+    using QueueKey = std::pair<int64_t, uint64_t>;
+    
+    static QueueKey _GetQueueKey(const StreamRequest& request) { return { -(int64_t) request.priority, request.sequence }; }
+    
+    void _IOThreadMain();
+    /* starts queued reads while the budget allows, called with the mutex held */
+    void _StartReads(std::unique_lock<std::mutex>& lock);
+    void _Wake();
+    void _FinishRead(AsyncRead* pRead);
+    void _Release(StreamRequest* pRequest, StreamState state);
+    
+private:
+    JobSystem* jobSystem = nullptr;
+    size_t memoryBudget = 0;
+    size_t uploadBudget = 0;
+    
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::map<QueueKey, StreamHandle> queue;
+    HashMap<StreamRequest*, StreamHandle> active;     /* past the queue, until uploaded */
+    Vector<StreamHandle> ready;
+    uint64_t nextSequence = 0;
+    size_t inFlightBytes = 0;
+    uint64_t wakeCount = 0;
+    StreamingStats stats;
+    
+    /* owned by the I/O thread */
+    AsyncReader reader;
+    std::thread ioThread;
+    bool stopping = false;
+};
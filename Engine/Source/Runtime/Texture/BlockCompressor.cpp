@@ -0,0 +1,431 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "BlockCompressor.h"
+
+// std
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+/* endpoint refinement passes, each one re-picks the indices for the refined endpoints */
+#define BLOCK_COMPRESSOR_REFINE_PASSES 1
+
+/* BC7 4 bit index weights, out of 64 */
+static const uint32_t BC7_WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+/* BC1 palette weight of color0 per index */
+static const float BC1_WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+namespace
+{
+    /* little endian bit stream over one 16 byte block */
+    struct BlockBitWriter
+    {
+        uint8_t* pBlock;
+        uint32_t bit = 0;
+
+        void Write(uint32_t value, uint32_t count)
+          {
+            for (uint32_t i = 0; i < count; i++, bit++)
+                pBlock[bit >> 3] |= (uint8_t) (((value >> i) & 1) << (bit & 7));
+          }
+    };
+}
+
+static void _LoadTexels(const uint8_t* pTexels, uint32_t channels, float (*texels)[4])
+{
+    for (uint32_t i = 0; i < 16; i++)
+        for (uint32_t c = 0; c < 4; c++)
+            texels[i][c] = c < channels ? (float) pTexels[i * 4 + c] : 0.0f;
+}
+
+/* mean and principal axis (power iteration on the covariance) of the block */
+static void _ComputeAxis(const float (*texels)[4], float* mean, float* axis)
+{
+    float covariance[4][4] = {};
+    
+    for (uint32_t c = 0; c < 4; c++) {
+        mean[c] = 0.0f;
+        for (uint32_t i = 0; i < 16; i++)
+            mean[c] += texels[i][c];
+        mean[c] /= 16.0f;
+    }
+
+    for (uint32_t i = 0; i < 16; i++) {
+        float d[4] = { texels[i][0] - mean[0], texels[i][1] - mean[1], texels[i][2] - mean[2], texels[i][3] - mean[3] };
+        for (uint32_t a = 0; a < 4; a++)
+            for (uint32_t b = 0; b < 4; b++)
+                covariance[a][b] += d[a] * d[b];
+    }
+
+    /* start from the row of the widest channel, it is never orthogonal to the answer */
+    uint32_t widest = 0;
+    for (uint32_t c = 1; c < 4; c++)
+        if (covariance[c][c] > covariance[widest][widest])
+            widest = c;
+
+    float v[4] = { covariance[widest][0], covariance[widest][1], covariance[widest][2], covariance[widest][3] };
+    
+    for (uint32_t iteration = 0; iteration < 8; iteration++) {
+        float w[4] = {};
+        float scale = 0.0f;
+        
+        for (uint32_t a = 0; a < 4; a++) {
+            for (uint32_t b = 0; b < 4; b++)
+                w[a] += covariance[a][b] * v[b];
+            scale = std::max(scale, fabsf(w[a]));
+        }
+
+        if (scale < FLT_MIN)
+            break;
+        for (uint32_t c = 0; c < 4; c++)
+            v[c] = w[c] / scale;
+    }
+
+    float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3]);
+    for (uint32_t c = 0; c < 4; c++)
+        axis[c] = length > FLT_MIN ? v[c] / length : 0.0f;
+}
+
+/* endpoints at the extremes of the block projected on its principal axis */
+static void _ComputeEndpoints(const float (*texels)[4], float* e0, float* e1)
+{
+    float mean[4], axis[4];
+    float tMin = FLT_MAX, tMax = -FLT_MAX;
+    
+    _ComputeAxis(texels, mean, axis);
+
+    for (uint32_t i = 0; i < 16; i++) {
+        float t = 0.0f;
+        for (uint32_t c = 0; c < 4; c++)
+            t += (texels[i][c] - mean[c]) * axis[c];
+        tMin = std::min(tMin, t);
+        tMax = std::max(tMax, t);
+    }
+
+    for (uint32_t c = 0; c < 4; c++) {
+        e0[c] = std::clamp(mean[c] + axis[c] * tMax, 0.0f, 255.0f);
+        e1[c] = std::clamp(mean[c] + axis[c] * tMin, 0.0f, 255.0f);
+    }
+}
+
+/* least squares endpoints for fixed indices, weights[i] is the share of e0 in texel i */
+static void _RefineEndpoints(const float (*texels)[4], const float* weights, float* e0, float* e1)
+{
+    float a = 0.0f, b = 0.0f, c = 0.0f;
+    float x0[4] = {}, x1[4] = {};
+
+    for (uint32_t i = 0; i < 16; i++) {
+        float w = weights[i];
+        a += w * w;
+        b += w * (1.0f - w);
+        c += (1.0f - w) * (1.0f - w);
+        for (uint32_t k = 0; k < 4; k++) {
+            x0[k] += w * texels[i][k];
+            x1[k] += (1.0f - w) * texels[i][k];
+        }
+    }
+
+    float determinant = a * c - b * b;
+    if (fabsf(determinant) < 1e-4f)
+        return;
+
+    for (uint32_t k = 0; k < 4; k++) {
+        e0[k] = std::clamp((c * x0[k] - b * x1[k]) / determinant, 0.0f, 255.0f);
+        e1[k] = std::clamp((a * x1[k] - b * x0[k]) / determinant, 0.0f, 255.0f);
+    }
+}
+
+static uint32_t _FindNearest(const float* texel, const float (*palette)[4], uint32_t paletteSize)
+{
+    uint32_t best = 0;
+    float bestError = FLT_MAX;
+    
+    for (uint32_t k = 0; k < paletteSize; k++) {
+        float error = 0.0f;
+        for (uint32_t c = 0; c < 4; c++)
+            error += (texel[c] - palette[k][c]) * (texel[c] - palette[k][c]);
+        
+        if (error < bestError) {
+            bestError = error;
+            best = k;
+        }
+    }
+
+    return best;
+}
+
+static uint16_t _Pack565(const float* color)
+{
+    uint32_t r = (uint32_t) std::clamp(color[0] * (31.0f / 255.0f) + 0.5f, 0.0f, 31.0f);
+    uint32_t g = (uint32_t) std::clamp(color[1] * (63.0f / 255.0f) + 0.5f, 0.0f, 63.0f);
+    uint32_t b = (uint32_t) std::clamp(color[2] * (31.0f / 255.0f) + 0.5f, 0.0f, 31.0f);
+    return (uint16_t) ((r << 11) | (g << 5) | b);
+}
+
+static void _Unpack565(uint16_t value, float* color)
+{
+    uint32_t r = (value >> 11) & 31, g = (value >> 5) & 63, b = value & 31;
+    color[0] = (float) ((r << 3) | (r >> 2));
+    color[1] = (float) ((g << 2) | (g >> 4));
+    color[2] = (float) ((b << 3) | (b >> 2));
+    color[3] = 0.0f;
+}
+
+/* BC1 color block in 4 color mode, shared by BC1 and BC3 */
+static void _EncodeColorBlock(const uint8_t* pTexels, uint8_t* pDestination)
+{
+    float texels[16][4], e0[4], e1[4], palette[4][4], weights[16];
+    uint32_t indices[16];
+    uint16_t c0, c1;
+    
+    _LoadTexels(pTexels, 3, texels);
+    _ComputeEndpoints(texels, e0, e1);
+
+    for (uint32_t pass = 0; ; pass++) {
+        c0 = _Pack565(e0);
+        c1 = _Pack565(e1);
+        _Unpack565(c0, palette[0]);
+        _Unpack565(c1, palette[1]);
+        for (uint32_t c = 0; c < 4; c++) {
+            palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+            palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+        }
+        
+        for (uint32_t i = 0; i < 16; i++)
+            indices[i] = _FindNearest(texels[i], palette, 4);
+
+        if (pass == BLOCK_COMPRESSOR_REFINE_PASSES)
+            break;
+        
+        for (uint32_t i = 0; i < 16; i++)
+            weights[i] = BC1_WEIGHTS[indices[i]];
+        _RefineEndpoints(texels, weights, e0, e1);
+    }
+
+    /* color0 > color1 selects the 4 color mode, swapping the endpoints swaps index 0/1 and 2/3 */
+    if (c0 < c1) {
+        std::swap(c0, c1);
+        for (uint32_t i = 0; i < 16; i++)
+            indices[i] ^= 1;
+    }
+
+    uint32_t bits = 0;
+    for (uint32_t i = 0; i < 16; i++)
+        bits |= (c0 == c1 ? 0 : indices[i]) << (i * 2);
+
+    memcpy(pDestination, &c0, 2);
+    memcpy(pDestination + 2, &c1, 2);
+    memcpy(pDestination + 4, &bits, 4);
+}
+
+static void _QuantizeBC7Endpoint(const float* endpoint, uint32_t* pQuantized, uint32_t* pParity)
+{
+    float bestError = FLT_MAX;
+    
+    for (uint32_t parity = 0; parity < 2; parity++) {
+        uint32_t quantized[4];
+        float error = 0.0f;
+        
+        for (uint32_t c = 0; c < 4; c++) {
+            quantized[c] = (uint32_t) std::clamp((int) floorf((endpoint[c] - (float) parity) * 0.5f + 0.5f), 0, 127);
+            float value = (float) (quantized[c] * 2 + parity);
+            error += (endpoint[c] - value) * (endpoint[c] - value);
+        }
+
+        if (error < bestError) {
+            bestError = error;
+            *pParity = parity;
+            memcpy(pQuantized, quantized, sizeof(quantized));
+        }
+    }
+}
+
+uint32_t BlockCompressor::GetBlockSize(VkFormat format)
+{
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            return 8;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+size_t BlockCompressor::GetImageSize(VkFormat format, uint32_t width, uint32_t height)
+{
+    return (size_t) ((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+}
+
+void BlockCompressor::EncodeBC1(const uint8_t* pTexels, uint8_t* pDestination)
+{
+    _EncodeColorBlock(pTexels, pDestination);
+}
+
+void BlockCompressor::EncodeBC3(const uint8_t* pTexels, uint8_t* pDestination)
+{
+    EncodeBC4(pTexels, 3, pDestination);
+    _EncodeColorBlock(pTexels, pDestination + 8);
+}
+
+void BlockCompressor::EncodeBC4(const uint8_t* pTexels, uint32_t channel, uint8_t* pDestination)
+{
+    uint8_t minValue = 255, maxValue = 0;
+    
+    for (uint32_t i = 0; i < 16; i++) {
+        minValue = std::min(minValue, pTexels[i * 4 + channel]);
+        maxValue = std::max(maxValue, pTexels[i * 4 + channel]);
+    }
+
+    /* value0 > value1 selects the 8 value mode */
+    uint64_t bits = 0;
+    pDestination[0] = maxValue;
+    pDestination[1] = minValue;
+
+    if (maxValue != minValue) {
+        float palette[8] = { (float) maxValue, (float) minValue };
+        for (uint32_t k = 2; k < 8; k++)
+            palette[k] = ((float) (8 - k) * maxValue + (float) (k - 1) * minValue) / 7.0f;
+
+        for (uint32_t i = 0; i < 16; i++) {
+            float value = (float) pTexels[i * 4 + channel];
+            uint32_t best = 0;
+            
+            for (uint32_t k = 1; k < 8; k++)
+                if (fabsf(value - palette[k]) < fabsf(value - palette[best]))
+                    best = k;
+            
+            bits |= (uint64_t) best << (i * 3);
+        }
+    }
+
+    for (uint32_t i = 0; i < 6; i++)
+        pDestination[2 + i] = (uint8_t) (bits >> (i * 8));
+}
+
+void BlockCompressor::EncodeBC5(const uint8_t* pTexels, uint8_t* pDestination)
+{
+    EncodeBC4(pTexels, 0, pDestination);
+    EncodeBC4(pTexels, 1, pDestination + 8);
+}
+
+void BlockCompressor::EncodeBC7(const uint8_t* pTexels, uint8_t* pDestination)
+{
+    float texels[16][4], e0[4], e1[4], palette[16][4], weights[16];
+    uint32_t indices[16], q0[4], q1[4], p0, p1;
+
+    _LoadTexels(pTexels, 4, texels);
+    _ComputeEndpoints(texels, e0, e1);
+
+    for (uint32_t pass = 0; ; pass++) {
+        _QuantizeBC7Endpoint(e0, q0, &p0);
+        _QuantizeBC7Endpoint(e1, q1, &p1);
+
+        for (uint32_t k = 0; k < 16; k++)
+            for (uint32_t c = 0; c < 4; c++)
+                palette[k][c] = (float) (((64 - BC7_WEIGHTS_4[k]) * (q0[c] * 2 + p0) + BC7_WEIGHTS_4[k] * (q1[c] * 2 + p1) + 32) >> 6);
+
+        for (uint32_t i = 0; i < 16; i++)
+            indices[i] = _FindNearest(texels[i], palette, 16);
+        
+        if (pass == BLOCK_COMPRESSOR_REFINE_PASSES)
+            break;
+
+        for (uint32_t i = 0; i < 16; i++)
+            weights[i] = (float) (64 - BC7_WEIGHTS_4[indices[i]]) / 64.0f;
+        _RefineEndpoints(texels, weights, e0, e1);
+    }
+
+    /* the anchor index is stored without its top bit, the weight table is symmetric so swapping flips every index */
+    if (indices[0] & 8) {
+        std::swap(q0, q1);
+        std::swap(p0, p1);
+        for (uint32_t i = 0; i < 16; i++)
+            indices[i] = 15 - indices[i];
+    }
+
+    memset(pDestination, 0, 16);
+    BlockBitWriter writer = { pDestination };
+    
+    writer.Write(1 << 6, 7);
+    for (uint32_t c = 0; c < 4; c++) {
+        writer.Write(q0[c], 7);
+        writer.Write(q1[c], 7);
+    }
+    writer.Write(p0, 1);
+    writer.Write(p1, 1);
+    
+    writer.Write(indices[0], 3);
+    for (uint32_t i = 1; i < 16; i++)
+        writer.Write(indices[i], 4);
+}
+
+void BlockCompressor::Compress(const TextureImage& image, VkFormat format, JobSystem* pJobSystem, uint8_t* pDestination)
+{
+    uint32_t blockSize = GetBlockSize(format);
+    uint32_t blocksX = (image.width + 3) / 4;
+    uint32_t blocksY = (image.height + 3) / 4;
+
+    auto encodeRow = [&](uint32_t by) {
+        uint8_t texels[64];
+        
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            for (uint32_t y = 0; y < 4; y++) {
+                uint32_t sy = std::min(by * 4 + y, image.height - 1);
+                for (uint32_t x = 0; x < 4; x++) {
+                    uint32_t sx = std::min(bx * 4 + x, image.width - 1);
+                    memcpy(texels + (y * 4 + x) * 4, std::data(image.pixels) + ((size_t) sy * image.width + sx) * 4, 4);
+                }
+            }
+
+            uint8_t* block = pDestination + ((size_t) by * blocksX + bx) * blockSize;
+            
+            switch (format) {
+                case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+                case VK_FORMAT_BC1_RGB_SRGB_BLOCK: EncodeBC1(texels, block); break;
+                case VK_FORMAT_BC3_UNORM_BLOCK:
+                case VK_FORMAT_BC3_SRGB_BLOCK: EncodeBC3(texels, block); break;
+                case VK_FORMAT_BC4_UNORM_BLOCK: EncodeBC4(texels, 0, block); break;
+                case VK_FORMAT_BC5_UNORM_BLOCK: EncodeBC5(texels, block); break;
+                case VK_FORMAT_BC7_UNORM_BLOCK:
+                case VK_FORMAT_BC7_SRGB_BLOCK: EncodeBC7(texels, block); break;
+                default: break;
+            }
+        }
+    };
+
+    if (pJobSystem) {
+        pJobSystem->Dispatch(blocksY, encodeRow);
+        return;
+    }
+
+    for (uint32_t by = 0; by < blocksY; by++)
+        encodeRow(by);
+}
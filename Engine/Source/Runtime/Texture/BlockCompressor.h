@@ -0,0 +1,55 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Texture.h"
+#include "Core/JobSystem.h"
+
+/*
+ * CPU BCn encoders, one 4x4 block at a time. Input blocks are 16 RGBA8 texels row by
+ * row, already in the color space of the target format (sRGB formats take sRGB texels).
+ *
+ *   - BC1 / BC3 color: endpoints on the principal axis of the block, refined with one
+ *     least squares pass over the chosen indices
+ *   - BC4 / BC5: one channel per block, min/max endpoints in the 8 value mode
+ *   - BC7: mode 6 only (one subset, RGBA 7.7.7.7 + p-bit, 4 bit indices), the mode that
+ *     covers smooth color and alpha well at a fraction of a full mode search
+ */
+class BlockCompressor
+{
+public:
+    /* bytes per 4x4 block, 0 for formats the compressor can not produce */
+    static uint32_t GetBlockSize(VkFormat format);
+    static size_t GetImageSize(VkFormat format, uint32_t width, uint32_t height);
+    
+    static void EncodeBC1(const uint8_t* pTexels, uint8_t* pDestination);
+    static void EncodeBC3(const uint8_t* pTexels, uint8_t* pDestination);
+    static void EncodeBC4(const uint8_t* pTexels, uint32_t channel, uint8_t* pDestination);
+    static void EncodeBC5(const uint8_t* pTexels, uint8_t* pDestination);
+    static void EncodeBC7(const uint8_t* pTexels, uint8_t* pDestination);
+    
+    /*
+     * Whole image, block rows are spread over the job system. Partial blocks at the
+     * right and bottom edge repeat the last texel. pDestination holds GetImageSize() bytes.
+     */
+    static void Compress(const TextureImage& image, VkFormat format, JobSystem* pJobSystem, uint8_t* pDestination);
+};
@@ -0,0 +1,492 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "KtxTexture.h"
+#include "Core/Zstd.h"
+
+#include <Logger.h>
+
+// std
+#include <algorithm>
+#include <bit>
+#include <stdio.h>
+#include <string.h>
+
+static_assert(sizeof(KtxHeader) == 80, "KTX2 header layout");
+static_assert(sizeof(KtxLevel) == 24, "KTX2 level index layout");
+
+static const uint8_t KTX_IDENTIFIER[12] = { 0xab, 0x4b, 0x54, 0x58, 0x20, 0x32, 0x30, 0xbb, 0x0d, 0x0a, 0x1a, 0x0a };
+
+/* Khronos data format descriptor, basic block */
+#define KTX_DFD_MODEL_RGBSDA 1
+#define KTX_DFD_MODEL_BC1A 128
+#define KTX_DFD_MODEL_BC3 130
+#define KTX_DFD_MODEL_BC4 131
+#define KTX_DFD_MODEL_BC5 132
+#define KTX_DFD_MODEL_BC7 134
+#define KTX_DFD_PRIMARIES_BT709 1
+#define KTX_DFD_TRANSFER_LINEAR 1
+#define KTX_DFD_TRANSFER_SRGB 2
+#define KTX_DFD_CHANNEL_ALPHA 15
+#define KTX_DFD_QUALIFIER_LINEAR 1
+
+namespace
+{
+struct KtxSample
+{
+    uint32_t bitOffset;
+    uint32_t bitLength;
+    uint32_t channel;
+};
+}
+
+static uint64_t _Align(uint64_t value)
+{
+    return (value + KTX_TEXTURE_STAGING_ALIGNMENT - 1) & ~((uint64_t) KTX_TEXTURE_STAGING_ALIGNMENT - 1);
+}
+
+static bool _IsSrgb(VkFormat format)
+{
+    switch (format) {
+        case VK_FORMAT_R8_SRGB:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC2_SRGB_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+        case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+        case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:
+        case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+        case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static size_t _GetLevelSize(VkFormat format, uint32_t width, uint32_t height)
+{
+    uint32_t blockWidth, blockHeight, blockSize;
+    
+    if (!KtxTexture::GetFormatBlock(format, &blockWidth, &blockHeight, &blockSize))
+        return 0;
+    
+    return (size_t) ((width + blockWidth - 1) / blockWidth) * ((height + blockHeight - 1) / blockHeight) * blockSize;
+}
+
+/* descriptor of the formats the texture cooker writes */
+static bool _BuildDataFormatDescriptor(VkFormat format, Vector<uint32_t>* pDescriptor)
+{
+    uint32_t model;
+    uint32_t blockSize;
+    Vector<KtxSample> samples;
+    bool srgb = _IsSrgb(format);
+    
+    switch (format) {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            model = KTX_DFD_MODEL_RGBSDA;
+            blockSize = 4;
+            samples = { { 0, 8, 0 }, { 8, 8, 1 }, { 16, 8, 2 }, { 24, 8, KTX_DFD_CHANNEL_ALPHA } };
+            break;
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            model = KTX_DFD_MODEL_BC1A;
+            blockSize = 8;
+            samples = { { 0, 64, 0 } };
+            break;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+            model = KTX_DFD_MODEL_BC3;
+            blockSize = 16;
+            samples = { { 0, 64, KTX_DFD_CHANNEL_ALPHA }, { 64, 64, 0 } };
+            break;
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            model = KTX_DFD_MODEL_BC4;
+            blockSize = 8;
+            samples = { { 0, 64, 0 } };
+            break;
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            model = KTX_DFD_MODEL_BC5;
+            blockSize = 16;
+            samples = { { 0, 64, 0 }, { 64, 64, 1 } };
+            break;
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            model = KTX_DFD_MODEL_BC7;
+            blockSize = 16;
+            samples = { { 0, 128, 0 } };
+            break;
+        default:
+            return false;
+    }
+
+    uint32_t blockDimension = model == KTX_DFD_MODEL_RGBSDA ? 0 : 0x0303;
+    uint32_t descriptorBlockSize = 24 + 16 * (uint32_t) std::size(samples);
+    
+    pDescriptor->clear();
+    pDescriptor->push_back(4 + descriptorBlockSize);    /* dfdTotalSize */
+    pDescriptor->push_back(0);                          /* Khronos vendor, basic descriptor type */
+    pDescriptor->push_back(2 | (descriptorBlockSize << 16));
+    pDescriptor->push_back(model | (KTX_DFD_PRIMARIES_BT709 << 8) | ((srgb ? KTX_DFD_TRANSFER_SRGB : KTX_DFD_TRANSFER_LINEAR) << 16));
+    pDescriptor->push_back(blockDimension);
+    pDescriptor->push_back(blockSize);
+    pDescriptor->push_back(0);
+
+    for (const KtxSample& sample : samples) {
+        /* alpha is never sRGB encoded */
+        uint32_t qualifiers = srgb && sample.channel == KTX_DFD_CHANNEL_ALPHA ? KTX_DFD_QUALIFIER_LINEAR : 0;
+        
+        pDescriptor->push_back(sample.bitOffset | ((sample.bitLength - 1) << 16) | (sample.channel << 24) | (qualifiers << 28));
+        pDescriptor->push_back(0);
+        pDescriptor->push_back(0);
+        pDescriptor->push_back(sample.bitLength >= 32 ? UINT32_MAX : (1u << sample.bitLength) - 1);
+    }
+
+    return true;
+}
+
+bool KtxTexture::GetFormatBlock(VkFormat format, uint32_t* pBlockWidth, uint32_t* pBlockHeight, uint32_t* pBlockSize)
+{
+    uint32_t blockWidth = 1, blockHeight = 1, blockSize;
+    
+    switch (format) {
+        case VK_FORMAT_R8_UNORM:
+        case VK_FORMAT_R8_SRGB:
+            blockSize = 1;
+            break;
+        case VK_FORMAT_R8G8_UNORM:
+        case VK_FORMAT_R16_UNORM:
+        case VK_FORMAT_R16_SFLOAT:
+            blockSize = 2;
+            break;
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+        case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+        case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
+        case VK_FORMAT_R16G16_UNORM:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R32_SFLOAT:
+            blockSize = 4;
+            break;
+        case VK_FORMAT_R16G16B16A16_UNORM:
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+        case VK_FORMAT_R32G32_SFLOAT:
+            blockSize = 8;
+            break;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            blockSize = 16;
+            break;
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC4_SNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+        case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+        case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+            blockWidth = blockHeight = 4;
+            blockSize = 8;
+            break;
+        case VK_FORMAT_BC2_UNORM_BLOCK:
+        case VK_FORMAT_BC2_SRGB_BLOCK:
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC5_SNORM_BLOCK:
+        case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+        case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+        case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+        case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+        case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+            blockWidth = blockHeight = 4;
+            blockSize = 16;
+            break;
+        case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:
+            blockWidth = blockHeight = 5;
+            blockSize = 16;
+            break;
+        case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+            blockWidth = blockHeight = 6;
+            blockSize = 16;
+            break;
+        case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+            blockWidth = blockHeight = 8;
+            blockSize = 16;
+            break;
+        default:
+            return false;
+    }
+
+    *pBlockWidth = blockWidth;
+    *pBlockHeight = blockHeight;
+    *pBlockSize = blockSize;
+    return true;
+}
+
+KtxTexture::KtxTexture(const char* path) : file(path)
+{
+    if (!file.IsValid())
+        return;
+
+    if (!_Validate(path))
+        return;
+
+    header = reinterpret_cast<const KtxHeader*>(file.GetData());
+    levels = reinterpret_cast<const KtxLevel*>(file.GetData() + sizeof(KtxHeader));
+    levelCount = std::max(header->levelCount, 1u);
+    
+    GOGH_LOGGER_DEBUG("[Texture] Map KTX2 texture successful, (path=%s, size=%ux%u, levels=%u, format=%u, supercompression=%u)",
+                      path, GetWidth(), GetHeight(), levelCount, header->vkFormat, header->supercompressionScheme);
+}
+
+bool KtxTexture::_Validate(const char* path) const
+{
+    if (file.GetSize() < sizeof(KtxHeader) || memcmp(file.GetData(), KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) != 0) {
+        GOGH_LOGGER_ERROR("[Texture] Not a KTX2 texture, (path=%s, size=%zu)", path, file.GetSize());
+        return false;
+    }
+
+    const KtxHeader* fileHeader = reinterpret_cast<const KtxHeader*>(file.GetData());
+    VkFormat format = (VkFormat) fileHeader->vkFormat;
+    uint32_t blockWidth, blockHeight, blockSize;
+    
+    if (fileHeader->pixelWidth == 0 || fileHeader->pixelHeight == 0 || fileHeader->pixelDepth != 0 ||
+        fileHeader->layerCount > 1 || fileHeader->faceCount != 1) {
+        GOGH_LOGGER_ERROR("[Texture] KTX2 texture is not a plain 2D texture, (path=%s, depth=%u, layers=%u, faces=%u)",
+                          path, fileHeader->pixelDepth, fileHeader->layerCount, fileHeader->faceCount);
+        return false;
+    }
+
+    if (fileHeader->supercompressionScheme != KTX_SUPERCOMPRESSION_NONE && fileHeader->supercompressionScheme != KTX_SUPERCOMPRESSION_ZSTD) {
+        GOGH_LOGGER_ERROR("[Texture] KTX2 supercompression is not supported, (path=%s, scheme=%u)", path, fileHeader->supercompressionScheme);
+        return false;
+    }
+
+    if (!GetFormatBlock(format, &blockWidth, &blockHeight, &blockSize)) {
+        GOGH_LOGGER_ERROR("[Texture] KTX2 format is not supported, (path=%s, format=%u)", path, fileHeader->vkFormat);
+        return false;
+    }
+
+    uint32_t fileLevelCount = std::max(fileHeader->levelCount, 1u);
+    uint32_t maxLevelCount = (uint32_t) std::bit_width(std::max(fileHeader->pixelWidth, fileHeader->pixelHeight));
+    
+    if (fileLevelCount > std::min(maxLevelCount, (uint32_t) KTX_TEXTURE_MAX_LEVELS) ||
+        file.GetSize() < sizeof(KtxHeader) + fileLevelCount * sizeof(KtxLevel)) {
+        GOGH_LOGGER_ERROR("[Texture] KTX2 level index is corrupt, (path=%s, levels=%u)", path, fileLevelCount);
+        return false;
+    }
+
+    const KtxLevel* fileLevels = reinterpret_cast<const KtxLevel*>(file.GetData() + sizeof(KtxHeader));
+    
+    for (uint32_t i = 0; i < fileLevelCount; i++) {
+        const KtxLevel& level = fileLevels[i];
+        size_t expected = _GetLevelSize(format, std::max(fileHeader->pixelWidth >> i, 1u), std::max(fileHeader->pixelHeight >> i, 1u));
+        
+        if (level.byteOffset > file.GetSize() || level.byteLength > file.GetSize() - level.byteOffset || level.uncompressedByteLength != expected ||
+            (fileHeader->supercompressionScheme == KTX_SUPERCOMPRESSION_NONE && level.byteLength != expected)) {
+            GOGH_LOGGER_ERROR("[Texture] KTX2 level %u is out of bounds, (path=%s, expected=%zu)", i, path, expected);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool KtxTexture::ReadLevel(uint32_t level, void* pDestination) const
+{
+    const uint8_t* source = file.GetData() + levels[level].byteOffset;
+    size_t size = levels[level].uncompressedByteLength;
+    
+    if (!IsSupercompressed()) {
+        memcpy(pDestination, source, size);
+        return true;
+    }
+
+    if (ZstdDecompress(source, levels[level].byteLength, pDestination, size) != size) {
+        GOGH_LOGGER_ERROR("[Texture] Failed to decode KTX2 level %u, (compressed=%llu, size=%zu)",
+                          level, (unsigned long long) levels[level].byteLength, size);
+        return false;
+    }
+
+    return true;
+}
+
+bool KtxTexture::GetTextureData(TextureData* pTexture) const
+{
+    size_t size = 0;
+    
+    pTexture->format = GetFormat();
+    pTexture->role = pTexture->format == VK_FORMAT_BC5_UNORM_BLOCK ? TEXTURE_ROLE_NORMAL : _IsSrgb(pTexture->format) ? TEXTURE_ROLE_COLOR : TEXTURE_ROLE_LINEAR;
+    pTexture->mips.resize(levelCount);
+
+    for (uint32_t i = 0; i < levelCount; i++) {
+        pTexture->mips[i] = { std::max(GetWidth() >> i, 1u), std::max(GetHeight() >> i, 1u), size, GetLevelSize(i) };
+        size += GetLevelSize(i);
+    }
+
+    pTexture->data.resize(size);
+    for (uint32_t i = 0; i < levelCount; i++) {
+        if (!ReadLevel(i, std::data(pTexture->data) + pTexture->mips[i].offset))
+            return false;
+    }
+
+    return true;
+}
+
+bool KtxTexture::Upload(RenderDevice* device, Image** ppImage, UploadToken* pToken) const
+{
+    VkBufferImageCopy regions[KTX_TEXTURE_MAX_LEVELS];
+    size_t stagingSize = 0;
+    UploadBatcher* batcher = device->GetUploadBatcher();
+
+    *ppImage = VK_NULL_HANDLE;
+    
+    for (uint32_t i = 0; i < levelCount; i++) {
+        regions[i] = {
+            .bufferOffset = _Align(stagingSize),
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = i,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+            .imageOffset = { 0, 0, 0 },
+            .imageExtent = { std::max(GetWidth() >> i, 1u), std::max(GetHeight() >> i, 1u), 1 },
+        };
+        
+        stagingSize = regions[i].bufferOffset + GetLevelSize(i);
+    }
+
+    Image* image = device->CreateImage(GetWidth(), GetHeight(), levelCount, GetFormat(), 0);
+    UploadStaging staging;
+
+    if (!image || !batcher->AllocateStaging(stagingSize, &staging)) {
+        device->DestroyImage(image);
+        
+        GOGH_LOGGER_ERROR("[Texture] Failed to create KTX2 texture resources, (size=%ux%u, levels=%u, stagingSize=%zu)",
+                          GetWidth(), GetHeight(), levelCount, stagingSize);
+        return false;
+    }
+
+    /* a failed read leaves its staging range unused, nothing copies out of it */
+    for (uint32_t i = 0; i < levelCount; i++) {
+        if (!ReadLevel(i, staging.pData + regions[i].bufferOffset)) {
+            batcher->CancelStaging(staging);
+            device->DestroyImage(image);
+            return false;
+        }
+    }
+
+    /* the top mips are what the residency manager drops first under memory pressure */
+    image->SetResidencyPriority(RESIDENCY_PRIORITY_STREAMING);
+
+    /* every level in one copy, batched with the other uploads of the frame */
+    UploadToken token = batcher->CopyToImage(staging, image, levelCount, regions);
+
+    *ppImage = image;
+    if (pToken)
+        *pToken = token;
+    
+    return true;
+}
+
+bool KtxTexture::Write(const char* path, const TextureData& texture)
+{
+    static const uint8_t padding[KTX_TEXTURE_STAGING_ALIGNMENT] = {};
+    uint32_t mipCount = (uint32_t) std::size(texture.mips);
+    Vector<uint32_t> descriptor;
+    
+    if (mipCount == 0 || mipCount > KTX_TEXTURE_MAX_LEVELS || !_BuildDataFormatDescriptor(texture.format, &descriptor)) {
+        GOGH_LOGGER_ERROR("[Texture] Can not write KTX2 texture, (path=%s, mips=%zu, format=%d)", path, std::size(texture.mips), texture.format);
+        return false;
+    }
+
+    KtxHeader header = {};
+    memcpy(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER));
+    header.vkFormat = texture.format;
+    header.typeSize = 1;
+    header.pixelWidth = texture.mips[0].width;
+    header.pixelHeight = texture.mips[0].height;
+    header.faceCount = 1;
+    header.levelCount = mipCount;
+    header.supercompressionScheme = KTX_SUPERCOMPRESSION_NONE;
+    header.dfdByteOffset = (uint32_t) (sizeof(KtxHeader) + mipCount * sizeof(KtxLevel));
+    header.dfdByteLength = (uint32_t) (std::size(descriptor) * sizeof(uint32_t));
+
+    /* the smallest level comes first in the file */
+    KtxLevel levels[KTX_TEXTURE_MAX_LEVELS];
+    uint64_t offset = _Align(header.dfdByteOffset + header.dfdByteLength);
+    
+    for (uint32_t i = mipCount; i-- > 0; ) {
+        levels[i] = { offset, texture.mips[i].size, texture.mips[i].size };
+        offset = _Align(offset + texture.mips[i].size);
+    }
+
+    FILE* fp = fopen(path, "wb");
+    if (!fp) {
+        GOGH_LOGGER_ERROR("[Texture] Failed to open KTX2 texture for writing, (path=%s)", path);
+        return false;
+    }
+
+    bool written = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                   fwrite(levels, sizeof(KtxLevel), mipCount, fp) == mipCount &&
+                   fwrite(std::data(descriptor), sizeof(uint32_t), std::size(descriptor), fp) == std::size(descriptor);
+    uint64_t position = header.dfdByteOffset + header.dfdByteLength;
+
+    for (uint32_t i = mipCount; i-- > 0 && written; ) {
+        written = fwrite(padding, 1, levels[i].byteOffset - position, fp) == levels[i].byteOffset - position &&
+                  (levels[i].byteLength == 0 || fwrite(std::data(texture.data) + texture.mips[i].offset, levels[i].byteLength, 1, fp) == 1);
+        position = levels[i].byteOffset + levels[i].byteLength;
+    }
+
+    written = fclose(fp) == 0 && written;
+
+    if (!written) {
+        GOGH_LOGGER_ERROR("[Texture] Failed to write KTX2 texture, (path=%s)", path);
+        remove(path);
+        return false;
+    }
+
+    return true;
+}
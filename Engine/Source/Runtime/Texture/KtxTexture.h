@@ -0,0 +1,123 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Texture.h"
+#include "Core/MappedFile.h"
+#include "Driver/RenderDevice.h"
+
+/* 32768 texels on the longest side */
+#define KTX_TEXTURE_MAX_LEVELS 16
+
+/* staging offset of every level, a multiple of every supported texel block size and of 4 */
+#define KTX_TEXTURE_STAGING_ALIGNMENT 16
+
+enum KtxSupercompression
+{
+    KTX_SUPERCOMPRESSION_NONE = 0,
+    KTX_SUPERCOMPRESSION_BASIS_LZ,      /* not supported, needs a transcoder */
+    KTX_SUPERCOMPRESSION_ZSTD,
+    KTX_SUPERCOMPRESSION_ZLIB,          /* not supported */
+};
+
+struct KtxHeader
+{
+    uint8_t identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+
+struct KtxLevel
+{
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+/*
+ * KTX2 texture, 2D with a full or partial mip chain in any block or plain format the
+ * upload path knows the texel block of. Like CookedMesh the file is mapped and only the
+ * header and level index are validated. Levels without supercompression are copied
+ * from the mapping into the staging buffer as they are, zstd levels are decoded
+ * straight into it, so every byte is touched once on the CPU either way.
+ *
+ * Array layers, cube faces, 3D textures and Basis Universal payloads are rejected.
+ */
+class KtxTexture
+{
+public:
+    KtxTexture(const char* path);
+   ~KtxTexture() = default;
+
+    bool IsValid() const { return header != nullptr; }
+    const KtxHeader& GetHeader() const { return *header; }
+
+    VkFormat GetFormat() const { return (VkFormat) header->vkFormat; }
+    uint32_t GetWidth() const { return header->pixelWidth; }
+    uint32_t GetHeight() const { return header->pixelHeight; }
+    uint32_t GetLevelCount() const { return levelCount; }
+    bool IsSupercompressed() const { return header->supercompressionScheme != KTX_SUPERCOMPRESSION_NONE; }
+
+    /* size of the level in its GPU format */
+    size_t GetLevelSize(uint32_t level) const { return levels[level].uncompressedByteLength; }
+    
+    /* decodes the level when it is supercompressed, pDestination holds GetLevelSize() bytes */
+    bool ReadLevel(uint32_t level, void* pDestination) const;
+
+    /* copies out of the mapping, for the CPU side tools */
+    bool GetTextureData(TextureData* pTexture) const;
+
+    /*
+     * Queues the upload of every level on the device's upload batcher, one copy with a
+     * region per level, the image is in SHADER_READ_ONLY_OPTIMAL once the batch token
+     * returned in pToken (may be null) completes.
+     */
+    bool Upload(RenderDevice* device, Image** ppImage, UploadToken* pToken = nullptr) const;
+    
+    /* without supercompression, the block formats are already as small as they get */
+    static bool Write(const char* path, const TextureData& texture);
+
+    /* texel block of the format, false for formats the loader does not know */
+    static bool GetFormatBlock(VkFormat format, uint32_t* pBlockWidth, uint32_t* pBlockHeight, uint32_t* pBlockSize);
+    
+private:
+    bool _Validate(const char* path) const;
+    
+private:
+    MappedFile file;
+    const KtxHeader* header = nullptr;
+    const KtxLevel* levels = nullptr;
+    uint32_t levelCount = 0;
+};
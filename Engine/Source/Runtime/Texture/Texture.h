@@ -0,0 +1,63 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Driver/VulkanInclude.h"
+
+#include <Vector.h>
+
+// std
+#include <stdint.h>
+
+/* what the texels mean, decides the filtering color space and the block format */
+enum TextureRole
+{
+    TEXTURE_ROLE_COLOR = 0,     /* sRGB albedo / emissive, BC1, BC3 with alpha, BC7 high quality */
+    TEXTURE_ROLE_NORMAL,        /* tangent space xy, BC5, z is rebuilt in the shader */
+    TEXTURE_ROLE_LINEAR,        /* masks and material parameters, BC1 or BC7 without sRGB */
+    TEXTURE_ROLE_MAX_ENUM,
+};
+
+/* uncompressed RGBA8 image, one mip level */
+struct TextureImage
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    Vector<uint8_t> pixels;
+};
+
+struct TextureMip
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    size_t offset = 0;  /* into TextureData::data */
+    size_t size = 0;
+};
+
+/* every mip level of one texture in its final GPU format, largest first */
+struct TextureData
+{
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    TextureRole role = TEXTURE_ROLE_COLOR;
+    Vector<TextureMip> mips;
+    Vector<uint8_t> data;
+};
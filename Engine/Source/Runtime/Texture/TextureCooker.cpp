@@ -0,0 +1,275 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "TextureCooker.h"
+#include "BlockCompressor.h"
+
+#include <Logger.h>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#  define TEXTURE_COOKER_SSE2
+#  include <emmintrin.h>
+#endif
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+/* resolution of the linear to sRGB table, finer than 8 bit output in the darks */
+#define TEXTURE_COOKER_SRGB_TABLE_SIZE 4096
+
+namespace
+{
+    struct ColorTables
+    {
+        float toLinear[256];
+        uint8_t toSrgb[TEXTURE_COOKER_SRGB_TABLE_SIZE];
+        
+        ColorTables()
+          {
+            for (uint32_t i = 0; i < 256; i++) {
+                float c = (float) i / 255.0f;
+                toLinear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+            }
+
+            for (uint32_t i = 0; i < TEXTURE_COOKER_SRGB_TABLE_SIZE; i++) {
+                float l = (float) i / (float) (TEXTURE_COOKER_SRGB_TABLE_SIZE - 1);
+                float c = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+                toSrgb[i] = (uint8_t) std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f);
+            }
+          }
+    };
+}
+
+static const ColorTables& _GetColorTables()
+{
+    static const ColorTables tables;
+    return tables;
+}
+
+static void _Dispatch(JobSystem* pJobSystem, uint32_t count, const JobSystem::IndexedJob& job)
+{
+    if (pJobSystem) {
+        pJobSystem->Dispatch(count, job);
+        return;
+    }
+    
+    for (uint32_t i = 0; i < count; i++)
+        job(i);
+}
+
+static void _ToLinear(const TextureImage& image, TextureRole role, JobSystem* pJobSystem, float* pLinear)
+{
+    const ColorTables& tables = _GetColorTables();
+    
+    _Dispatch(pJobSystem, image.height, [&](uint32_t y) {
+        const uint8_t* src = std::data(image.pixels) + (size_t) y * image.width * 4;
+        float* dst = pLinear + (size_t) y * image.width * 4;
+        
+        for (uint32_t x = 0; x < image.width * 4; x += 4) {
+            for (uint32_t c = 0; c < 3; c++)
+                dst[x + c] = role == TEXTURE_ROLE_COLOR ? tables.toLinear[src[x + c]] : (float) src[x + c] / 255.0f;
+            dst[x + 3] = (float) src[x + 3] / 255.0f;
+        }
+    });
+}
+
+static void _ToImage(const float* pLinear, uint32_t width, uint32_t height, TextureRole role, JobSystem* pJobSystem, TextureImage* pImage)
+{
+    const ColorTables& tables = _GetColorTables();
+    
+    pImage->width = width;
+    pImage->height = height;
+    pImage->pixels.resize((size_t) width * height * 4);
+
+    _Dispatch(pJobSystem, height, [&](uint32_t y) {
+        const float* src = pLinear + (size_t) y * width * 4;
+        uint8_t* dst = std::data(pImage->pixels) + (size_t) y * width * 4;
+
+        for (uint32_t x = 0; x < width * 4; x += 4) {
+            for (uint32_t c = 0; c < 3; c++) {
+                float value = std::clamp(src[x + c], 0.0f, 1.0f);
+                dst[x + c] = role == TEXTURE_ROLE_COLOR ? tables.toSrgb[(uint32_t) (value * (TEXTURE_COOKER_SRGB_TABLE_SIZE - 1) + 0.5f)]
+                                                        : (uint8_t) (value * 255.0f + 0.5f);
+            }
+            dst[x + 3] = (uint8_t) (std::clamp(src[x + 3], 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+    });
+}
+
+/* 2x2 box filter, odd edges clamp so the last row or column is weighted twice */
+static void _Downsample(const float* pSource, uint32_t sourceWidth, uint32_t sourceHeight, float* pDestination,
+                        uint32_t width, uint32_t height, TextureRole role, JobSystem* pJobSystem)
+{
+    _Dispatch(pJobSystem, height, [&](uint32_t y) {
+        const float* row0 = pSource + (size_t) std::min(y * 2, sourceHeight - 1) * sourceWidth * 4;
+        const float* row1 = pSource + (size_t) std::min(y * 2 + 1, sourceHeight - 1) * sourceWidth * 4;
+        float* dst = pDestination + (size_t) y * width * 4;
+
+        for (uint32_t x = 0; x < width; x++) {
+            uint32_t x0 = std::min(x * 2, sourceWidth - 1) * 4;
+            uint32_t x1 = std::min(x * 2 + 1, sourceWidth - 1) * 4;
+            
+#ifdef TEXTURE_COOKER_SSE2
+            __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(row0 + x0), _mm_loadu_ps(row0 + x1)),
+                                    _mm_add_ps(_mm_loadu_ps(row1 + x0), _mm_loadu_ps(row1 + x1)));
+            _mm_storeu_ps(dst + x * 4, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#else
+            for (uint32_t c = 0; c < 4; c++)
+                dst[x * 4 + c] = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c]) * 0.25f;
+#endif /* TEXTURE_COOKER_SSE2 */
+            
+            if (role == TEXTURE_ROLE_NORMAL) {
+                float n[3] = { dst[x * 4] * 2.0f - 1.0f, dst[x * 4 + 1] * 2.0f - 1.0f, dst[x * 4 + 2] * 2.0f - 1.0f };
+                float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                if (length > 1e-6f)
+                    for (uint32_t c = 0; c < 3; c++)
+                        dst[x * 4 + c] = n[c] / length * 0.5f + 0.5f;
+            }
+        }
+    });
+}
+
+bool TextureCooker::Import(const char* path, TextureImage* pImage)
+{
+    int width, height, channels;
+    
+    stbi_uc* pixels = stbi_load(path, &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+        GOGH_LOGGER_ERROR("[Texture] Failed to load image, (path=%s, reason=%s)", path, stbi_failure_reason());
+        return false;
+    }
+
+    pImage->width = (uint32_t) width;
+    pImage->height = (uint32_t) height;
+    pImage->pixels.assign(pixels, pixels + (size_t) width * height * 4);
+    stbi_image_free(pixels);
+    
+    return true;
+}
+
+TextureRole TextureCooker::GetRoleFromPath(const char* path)
+{
+    String stem = std::filesystem::path(path).stem().string();
+    std::transform(stem.begin(), stem.end(), stem.begin(), [](char c) { return (char) tolower(c); });
+    
+    auto endsWith = [&](const char* suffix) {
+        size_t length = strlen(suffix);
+        return std::size(stem) >= length && stem.compare(std::size(stem) - length, length, suffix) == 0;
+    };
+
+    if (endsWith("_n") || endsWith("_normal"))
+        return TEXTURE_ROLE_NORMAL;
+    
+    if (endsWith("_mask") || endsWith("_orm") || endsWith("_roughness") || endsWith("_metallic") || endsWith("_ao"))
+        return TEXTURE_ROLE_LINEAR;
+    
+    return TEXTURE_ROLE_COLOR;
+}
+
+VkFormat TextureCooker::ChooseFormat(const TextureImage& image, TextureRole role, bool highQuality)
+{
+    if (role == TEXTURE_ROLE_NORMAL)
+        return VK_FORMAT_BC5_UNORM_BLOCK;
+
+    bool alpha = false;
+    for (size_t i = 3; i < std::size(image.pixels) && !alpha; i += 4)
+        alpha = image.pixels[i] != 255;
+
+    bool srgb = role == TEXTURE_ROLE_COLOR;
+    
+    if (highQuality)
+        return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+    if (alpha)
+        return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+    return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+}
+
+void TextureCooker::GenerateMips(const TextureImage& image, TextureRole role, JobSystem* pJobSystem, Vector<TextureImage>* pMips)
+{
+    uint32_t width = image.width;
+    uint32_t height = image.height;
+    
+    pMips->clear();
+    pMips->push_back(image);
+
+    Vector<float> source((size_t) width * height * 4);
+    Vector<float> destination;
+    _ToLinear(image, role, pJobSystem, std::data(source));
+
+    while (width > 1 || height > 1) {
+        uint32_t mipWidth = std::max(width / 2, 1u);
+        uint32_t mipHeight = std::max(height / 2, 1u);
+
+        destination.resize((size_t) mipWidth * mipHeight * 4);
+        _Downsample(std::data(source), width, height, std::data(destination), mipWidth, mipHeight, role, pJobSystem);
+        _ToImage(std::data(destination), mipWidth, mipHeight, role, pJobSystem, &pMips->emplace_back());
+        
+        std::swap(source, destination);
+        width = mipWidth;
+        height = mipHeight;
+    }
+}
+
+void TextureCooker::Cook(const TextureImage& image, const TextureCookSettings& settings, JobSystem* pJobSystem, TextureData* pTexture)
+{
+    auto start = std::chrono::steady_clock::now();
+    Vector<TextureImage> mips;
+
+    if (settings.generateMips)
+        GenerateMips(image, settings.role, pJobSystem, &mips);
+    else
+        mips.push_back(image);
+
+    auto filtered = std::chrono::steady_clock::now();
+    
+    pTexture->format = ChooseFormat(image, settings.role, settings.highQuality);
+    pTexture->role = settings.role;
+    pTexture->mips.clear();
+
+    size_t size = 0;
+    for (const TextureImage& mip : mips) {
+        TextureMip& level = pTexture->mips.emplace_back();
+        level.width = mip.width;
+        level.height = mip.height;
+        level.offset = size;
+        level.size = BlockCompressor::GetImageSize(pTexture->format, mip.width, mip.height);
+        size += level.size;
+    }
+
+    pTexture->data.resize(size);
+    for (size_t i = 0; i < std::size(mips); i++)
+        BlockCompressor::Compress(mips[i], pTexture->format, pJobSystem, std::data(pTexture->data) + pTexture->mips[i].offset);
+
+    auto encoded = std::chrono::steady_clock::now();
+    size_t rawSize = (size_t) image.width * image.height * 4;
+    
+    GOGH_LOGGER_INFO("[Texture] Cook texture successful, (size=%ux%u, mips=%zu, format=%d, bytes=%zu, raw=%zu, ratio=%.1fx, mips=%.1f ms, encode=%.1f ms)",
+                     image.width, image.height, std::size(mips), (int) pTexture->format, size, rawSize, (double) rawSize / (double) size,
+                     std::chrono::duration<double, std::milli>(filtered - start).count(),
+                     std::chrono::duration<double, std::milli>(encoded - filtered).count());
+}
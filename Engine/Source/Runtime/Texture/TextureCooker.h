@@ -0,0 +1,55 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#pragma once
+
+#include "Texture.h"
+#include "Core/JobSystem.h"
+
+struct TextureCookSettings
+{
+    TextureRole role = TEXTURE_ROLE_COLOR;
+    bool generateMips = true;
+    bool highQuality = false;   /* BC7 instead of BC1/BC3 for color and linear textures */
+};
+
+/*
+ * Source image to GPU ready mip chain. Mips are filtered in linear space (sRGB texels
+ * are linearized first, normals are renormalized per level), every level is box
+ * filtered from the previous float level so rounding never accumulates, with SSE2
+ * doing one RGBA texel per instruction. Rows and block rows run on the job system.
+ */
+class TextureCooker
+{
+public:
+    /* any format stb_image reads, expanded to RGBA8 */
+    static bool Import(const char* path, TextureImage* pImage);
+    
+    /* role from the file name: *_n, *_normal are normal maps, *_mask, *_orm, *_roughness, *_metallic, *_ao linear */
+    static TextureRole GetRoleFromPath(const char* path);
+    
+    static VkFormat ChooseFormat(const TextureImage& image, TextureRole role, bool highQuality);
+
+    /* pMips receives the full chain down to 1x1, level 0 is the image itself */
+    static void GenerateMips(const TextureImage& image, TextureRole role, JobSystem* pJobSystem, Vector<TextureImage>* pMips);
+
+    static void Cook(const TextureImage& image, const TextureCookSettings& settings, JobSystem* pJobSystem, TextureData* pTexture);
+};
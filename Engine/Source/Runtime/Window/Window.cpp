@@ -30,6 +30,9 @@ Window::Window(uint32_t w, uint32_t h, const char *title)
     glfwInit();
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
     hwnd = glfwCreateWindow(w, h, title, nullptr, nullptr);
+
+    glfwSetWindowUserPointer(hwnd, this);
+    glfwSetFramebufferSizeCallback(hwnd, _FramebufferSizeCallback);
 }
 
 Window::~Window()
@@ -50,4 +53,24 @@ bool Window::IsShouldClose()
 void Window::PollEvents()
 {
     glfwPollEvents();
+}
+
+void Window::GetFramebufferSize(uint32_t* pWidth, uint32_t* pHeight)
+{
+    int w, h;
+    glfwGetFramebufferSize(hwnd, &w, &h);
+    
+    *pWidth = static_cast<uint32_t>(w);
+    *pHeight = static_cast<uint32_t>(h);
+}
+
+bool Window::IsFramebufferResized()
+{
+    return framebufferResized.exchange(false, std::memory_order_acq_rel);
+}
+
+void Window::_FramebufferSizeCallback(GLFWwindow* window, int, int)
+{
+    Window* self = static_cast<Window*>(glfwGetWindowUserPointer(window));
+    self->framebufferResized.store(true, std::memory_order_release);
 }
\ No newline at end of file
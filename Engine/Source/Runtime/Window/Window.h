@@ -22,6 +22,10 @@
 
 #include <GLFW/glfw3.h>
 
+// std
+#include <atomic>
+#include <stdint.h>
+
 class Window
 {
 public:
@@ -33,7 +37,16 @@ public:
     bool IsShouldClose();
    
     void PollEvents();
+
+    void GetFramebufferSize(uint32_t* pWidth, uint32_t* pHeight);
+
+    /* reads and clears the framebuffer resize flag, which the GLFW callback sets */
+    bool IsFramebufferResized();
+    
+private:
+    static void _FramebufferSizeCallback(GLFWwindow* window, int width, int height);
     
 private:
     GLFWwindow *hwnd = nullptr;
+    std::atomic<bool> framebufferResized = false;
 };
\ No newline at end of file
@@ -0,0 +1,62 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include <Engine/Engine.h>
+
+// std
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* default cache location, relative to the working directory */
+#define COOKER_DEFAULT_CACHE_DIRECTORY "DerivedDataCache"
+
+static void _PrintUsage()
+{
+    fprintf(stderr, "usage: Cooker <sourceDirectory> <outputDirectory> [-cache <directory>] [-j <workers>]\n");
+}
+
+int main(int argc, char** argv)
+{
+    const char* cacheDirectory = COOKER_DEFAULT_CACHE_DIRECTORY;
+    uint32_t workerCount = 0;
+    
+    setvbuf(stdout, NULL, _IONBF, 0);
+    setvbuf(stderr, NULL, _IONBF, 0);
+    
+    if (argc < 3) {
+        _PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "-cache") == 0 && i + 1 < argc) {
+            cacheDirectory = argv[++i];
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            workerCount = (uint32_t) strtoul(argv[++i], NULL, 10);
+        } else {
+            _PrintUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    return Gogh_Cooker_CookDirectory(argv[1], argv[2], cacheDirectory, workerCount) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
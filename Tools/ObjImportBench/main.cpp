@@ -0,0 +1,259 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "Mesh/ObjImporter.h"
+#include "Core/JobSystem.h"
+#include "Core/MappedFile.h"
+
+#include <MM.h>
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader/tiny_obj_loader.h>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+
+#define BENCH_DEFAULT_ITERATIONS 3
+
+/* rough bytes one grid vertex of the generated file takes, v + vt + vn and two faces */
+#define BENCH_BYTES_PER_GRID_VERTEX 205
+
+/* the std::hash<vertex_t> the tinyobj loader in Document/Miscs/main.cpp used */
+struct LegacyVertexHash
+{
+    size_t operator()(const Vertex& vertex) const
+      {
+        size_t h1 = std::hash<float>{}(vertex.position.x);
+        size_t h2 = std::hash<float>{}(vertex.position.y);
+        size_t h3 = std::hash<float>{}(vertex.position.z);
+        size_t h4 = std::hash<float>{}(vertex.texcoord.x);
+        size_t h5 = std::hash<float>{}(vertex.texcoord.y);
+        size_t h6 = std::hash<float>{}(vertex.normal.x);
+        size_t h7 = std::hash<float>{}(vertex.normal.y);
+        size_t h8 = std::hash<float>{}(vertex.normal.z);
+        return h1 ^ (h2 << 1) ^ (h3 << 2) ^ (h4 << 3) ^ (h5 << 4) ^ (h6 << 5) ^ (h7 << 6) ^ (h8 << 7);
+      }
+};
+
+static void _PrintUsage()
+{
+    fprintf(stderr, "usage: ObjImportBench <path> [-iterations <count>] [-threads <count>]\n");
+    fprintf(stderr, "       ObjImportBench -generate <path> <megabytes>\n");
+}
+
+/* the tinyobj + std::unordered_map path the importer replaced, kept as the reference output */
+static bool _ImportTinyObj(const char* path, MeshData* pMesh)
+{
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+
+    pMesh->vertices.clear();
+    pMesh->indices.clear();
+    
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path)) {
+        fprintf(stderr, "tinyobj failed to load %s: %s\n", path, err.c_str());
+        return false;
+    }
+
+    std::unordered_map<Vertex, uint32_t, LegacyVertexHash> uniqueVertices;
+    
+    for (const tinyobj::shape_t& shape : shapes) {
+        for (const tinyobj::index_t& index : shape.mesh.indices) {
+            Vertex vertex = {};
+            
+            if (index.vertex_index >= 0)
+                vertex.position = glm::vec3(attrib.vertices[3 * index.vertex_index + 0], attrib.vertices[3 * index.vertex_index + 1], attrib.vertices[3 * index.vertex_index + 2]);
+            
+            if (index.texcoord_index >= 0)
+                vertex.texcoord = glm::vec2(attrib.texcoords[2 * index.texcoord_index + 0], attrib.texcoords[2 * index.texcoord_index + 1]);
+            
+            if (index.normal_index >= 0)
+                vertex.normal = glm::vec3(attrib.normals[3 * index.normal_index + 0], attrib.normals[3 * index.normal_index + 1], attrib.normals[3 * index.normal_index + 2]);
+            
+            if (uniqueVertices.count(vertex) == 0) {
+                uniqueVertices[vertex] = (uint32_t) std::size(pMesh->vertices);
+                pMesh->vertices.push_back(vertex);
+            }
+            
+            pMesh->indices.push_back(uniqueVertices[vertex]);
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Writes a deterministic heightfield of about the requested size, every grid vertex
+ * has its own v / vt / vn and the cells are split into triangles, so both loaders
+ * triangulate the same way and their outputs can be compared one to one.
+ */
+static bool _GenerateObj(const char* path, uint64_t megabytes)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "failed to open %s for writing\n", path);
+        return false;
+    }
+
+    static char buffer[1 << 20];
+    setvbuf(file, buffer, _IOFBF, sizeof(buffer));
+    
+    uint64_t gridVertexCount = megabytes * 1024 * 1024 / BENCH_BYTES_PER_GRID_VERTEX;
+    uint32_t side = std::max<uint32_t>((uint32_t) sqrt((double) gridVertexCount), 2);
+    
+    for (uint32_t z = 0; z < side; z++) {
+        for (uint32_t x = 0; x < side; x++) {
+            float height = (float) ((x * 7 + z * 13) % 100) * 0.01f;
+            fprintf(file, "v %.6f %.6f %.6f\n", (float) x * 0.01f, height, (float) z * 0.01f);
+            fprintf(file, "vt %.6f %.6f\n", (float) x / (float) (side - 1), (float) z / (float) (side - 1));
+            fprintf(file, "vn %.6f %.6f %.6f\n", height - 0.5f, 1.0f, 0.5f - height);
+        }
+    }
+
+    for (uint32_t z = 0; z + 1 < side; z++) {
+        for (uint32_t x = 0; x + 1 < side; x++) {
+            /* OBJ indices are 1-based */
+            uint64_t i0 = (uint64_t) z * side + x + 1;
+            uint64_t i1 = i0 + 1;
+            uint64_t i2 = i0 + side;
+            uint64_t i3 = i2 + 1;
+            fprintf(file, "f %llu/%llu/%llu %llu/%llu/%llu %llu/%llu/%llu\n",
+                    (unsigned long long) i0, (unsigned long long) i0, (unsigned long long) i0,
+                    (unsigned long long) i2, (unsigned long long) i2, (unsigned long long) i2,
+                    (unsigned long long) i1, (unsigned long long) i1, (unsigned long long) i1);
+            fprintf(file, "f %llu/%llu/%llu %llu/%llu/%llu %llu/%llu/%llu\n",
+                    (unsigned long long) i1, (unsigned long long) i1, (unsigned long long) i1,
+                    (unsigned long long) i2, (unsigned long long) i2, (unsigned long long) i2,
+                    (unsigned long long) i3, (unsigned long long) i3, (unsigned long long) i3);
+        }
+    }
+
+    bool ok = ferror(file) == 0;
+    ok = fclose(file) == 0 && ok;
+    
+    if (ok)
+        printf("generated %s, %ux%u grid\n", path, side, side);
+    
+    return ok;
+}
+
+static bool _SameMesh(const MeshData& a, const MeshData& b)
+{
+    return std::size(a.vertices) == std::size(b.vertices) &&
+           std::size(a.indices) == std::size(b.indices) &&
+           std::equal(std::begin(a.vertices), std::end(a.vertices), std::begin(b.vertices)) &&
+           std::equal(std::begin(a.indices), std::end(a.indices), std::begin(b.indices));
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t iterationCount = BENCH_DEFAULT_ITERATIONS;
+    uint32_t workerCount = 0;
+    
+    setvbuf(stdout, NULL, _IONBF, 0);
+    setvbuf(stderr, NULL, _IONBF, 0);
+
+    if (argc == 4 && strcmp(argv[1], "-generate") == 0)
+        return _GenerateObj(argv[2], strtoull(argv[3], NULL, 10)) ? EXIT_SUCCESS : EXIT_FAILURE;
+    
+    if (argc < 2) {
+        _PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-iterations") == 0 && i + 1 < argc) {
+            iterationCount = (uint32_t) strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) {
+            /* counts the calling thread, the job system adds workers on top of it */
+            workerCount = (uint32_t) strtoul(argv[++i], NULL, 10);
+        } else {
+            _PrintUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (iterationCount == 0) {
+        _PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    const char* path = argv[1];
+    
+    /* touch every page once so neither path pays for the cold read */
+    {
+        MappedFile file(path);
+        if (!file.IsValid()) {
+            fprintf(stderr, "failed to map %s\n", path);
+            return EXIT_FAILURE;
+        }
+
+        volatile uint8_t sink = 0;
+        for (size_t offset = 0; offset < file.GetSize(); offset += 4096)
+            sink = sink ^ file.GetData()[offset];
+
+        printf("file %s, %.1f MiB\n", path, (double) file.GetSize() / (1024.0 * 1024.0));
+    }
+
+    /* 1 thread means no job system, the importer then parses on the calling thread */
+    JobSystem* jobSystem = workerCount == 1 ? nullptr : MemoryNew<JobSystem>(workerCount == 0 ? 0 : workerCount - 1);
+    uint32_t threadCount = jobSystem ? jobSystem->GetThreadCount() : 1;
+    
+    MeshData reference, imported;
+    double tinyObjMilliseconds = 1e30, importerMilliseconds = 1e30;
+    double tinyObjTotal = 0.0, importerTotal = 0.0;
+    
+    for (uint32_t iteration = 0; iteration < iterationCount; iteration++) {
+        auto start = std::chrono::steady_clock::now();
+        if (!_ImportTinyObj(path, &reference))
+            return EXIT_FAILURE;
+        
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        tinyObjMilliseconds = std::min(tinyObjMilliseconds, elapsed);
+        tinyObjTotal += elapsed;
+        
+        start = std::chrono::steady_clock::now();
+        if (!ObjImporter::Import(path, jobSystem, &imported)) {
+            fprintf(stderr, "ObjImporter failed to import %s\n", path);
+            return EXIT_FAILURE;
+        }
+
+        elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        importerMilliseconds = std::min(importerMilliseconds, elapsed);
+        importerTotal += elapsed;
+    }
+
+    printf("vertices=%zu indices=%zu threads=%u iterations=%u\n", std::size(imported.vertices), std::size(imported.indices), threadCount, iterationCount);
+    printf("tinyobj      avg %10.1f ms  min %10.1f ms\n", tinyObjTotal / iterationCount, tinyObjMilliseconds);
+    printf("ObjImporter  avg %10.1f ms  min %10.1f ms\n", importerTotal / iterationCount, importerMilliseconds);
+    printf("speedup      %.2fx, output %s\n", tinyObjMilliseconds / importerMilliseconds, _SameMesh(reference, imported) ? "identical" : "DIFFERS");
+
+    MemoryDelete(jobSystem);
+    return _SameMesh(reference, imported) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,227 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "Window/Window.h"
+#include "Driver/RenderDevice.h"
+#include "Render/RenderQueue.h"
+#include "Mesh/VertexFormat.h"
+
+// glm
+#include <glm/gtc/matrix_transform.hpp>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* defaults match the frame sizes the render queue is tuned for */
+#define BENCH_DEFAULT_PACKETS 100000
+#define BENCH_DEFAULT_ITERATIONS 100
+#define BENCH_DEFAULT_MESHES 256
+#define BENCH_DEFAULT_MATERIALS 64
+
+/* the pipeline the renderer draws queued packets with, run from the directory the Demo runs from */
+#define BENCH_VERTEX_SHADER_PATH "shaders/spir-v/instanced_vertex.spv"
+#define BENCH_FRAGMENT_SHADER_PATH "shaders/spir-v/mesh_fragment.spv"
+
+#define BENCH_TARGET_SIZE 256
+#define BENCH_TARGET_FORMAT VK_FORMAT_R8G8B8A8_UNORM
+
+/* a cube worth of indices, the buffers are recorded but never read */
+#define BENCH_MESH_VERTEX_COUNT 24
+#define BENCH_MESH_INDEX_COUNT 36
+
+struct BenchMesh
+{
+    Buffer* vertexBuffer = VK_NULL_HANDLE;
+    Buffer* indexBuffer = VK_NULL_HANDLE;
+};
+
+static void _PrintUsage()
+{
+    fprintf(stderr, "usage: RenderQueueBench [-packets <count>] [-iterations <count>] [-meshes <count>] [-materials <count>] [-threads <count>]\n");
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t packetCount = BENCH_DEFAULT_PACKETS;
+    uint32_t iterationCount = BENCH_DEFAULT_ITERATIONS;
+    uint32_t meshCount = BENCH_DEFAULT_MESHES;
+    uint32_t materialCount = BENCH_DEFAULT_MATERIALS;
+    uint32_t threadCount = RENDER_QUEUE_MAX_BUCKETS;
+    
+    setvbuf(stdout, NULL, _IONBF, 0);
+    setvbuf(stderr, NULL, _IONBF, 0);
+
+    for (int i = 1; i < argc; i++) {
+        uint32_t* pValue = nullptr;
+        
+        if (strcmp(argv[i], "-packets") == 0) pValue = &packetCount;
+        else if (strcmp(argv[i], "-iterations") == 0) pValue = &iterationCount;
+        else if (strcmp(argv[i], "-meshes") == 0) pValue = &meshCount;
+        else if (strcmp(argv[i], "-materials") == 0) pValue = &materialCount;
+        else if (strcmp(argv[i], "-threads") == 0) pValue = &threadCount;
+
+        if (pValue == nullptr || i + 1 >= argc) {
+            _PrintUsage();
+            return EXIT_FAILURE;
+        }
+
+        *pValue = (uint32_t) strtoul(argv[++i], NULL, 10);
+    }
+
+    if (packetCount == 0 || iterationCount == 0 || meshCount == 0 || materialCount == 0 || threadCount == 0 || threadCount > RENDER_QUEUE_MAX_BUCKETS) {
+        _PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    Window window(BENCH_TARGET_SIZE, BENCH_TARGET_SIZE, "RenderQueueBench");
+    RenderDevice device(&window);
+
+    /* same pipeline as the renderer's queue pipeline, cooked meshes use the default vertex format */
+    VkVertexInputBindingDescription vertexBinding;
+    Vector<VkVertexInputAttributeDescription> vertexAttributes;
+    VertexFormatEncoder::GetVertexInputDescription(VertexFormat(), &vertexBinding, &vertexAttributes);
+    
+    VkFormat targetFormat = BENCH_TARGET_FORMAT;
+    GraphicsPipelineDesc pipelineDesc = {
+        .vertexPath = BENCH_VERTEX_SHADER_PATH,
+        .fragmentPath = BENCH_FRAGMENT_SHADER_PATH,
+        .colorFormatCount = 1,
+        .pColorFormats = &targetFormat,
+        .vertexAttributeCount = (uint32_t) std::size(vertexAttributes),
+        .pVertexAttributes = std::data(vertexAttributes),
+        .vertexStride = vertexBinding.stride,
+        .instanceStride = sizeof(InstanceData),
+        .firstInstanceLocation = RENDER_QUEUE_INSTANCE_LOCATION,
+    };
+
+    Pipeline* pipeline = device.CreateGraphicsPipeline(pipelineDesc);
+    if (!pipeline) {
+        fprintf(stderr, "failed to create the queue pipeline, run from the directory holding %s\n", BENCH_VERTEX_SHADER_PATH);
+        return EXIT_FAILURE;
+    }
+
+    Vector<BenchMesh> meshes(meshCount);
+    for (BenchMesh& mesh : meshes) {
+        mesh.vertexBuffer = device.CreateBuffer(vertexBinding.stride * BENCH_MESH_VERTEX_COUNT, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        mesh.indexBuffer = device.CreateBuffer(sizeof(uint32_t) * BENCH_MESH_INDEX_COUNT, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+    }
+
+    Buffer* instanceBuffer = device.CreateBuffer(sizeof(InstanceData) * packetCount, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+    Image* target = device.CreateImage(BENCH_TARGET_SIZE, BENCH_TARGET_SIZE, 1, BENCH_TARGET_FORMAT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+    VkImageSubresourceRange targetRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    VkImageView targetView = device.AcquireImageView(target, VK_IMAGE_VIEW_TYPE_2D, targetRange);
+    CommandList* commandList = device.CreateCommandList();
+    
+    /* a fixed seed keeps the packet stream, and so the stats, the same from run to run */
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<uint32_t> meshDistribution(0, meshCount - 1);
+    std::uniform_int_distribution<uint32_t> materialDistribution(0, materialCount - 1);
+    std::uniform_real_distribution<float> positionDistribution(-100.0f, 100.0f);
+    
+    struct BenchDraw { uint32_t mesh; uint32_t material; glm::vec3 position; };
+    Vector<BenchDraw> draws(packetCount);
+    for (BenchDraw& draw : draws)
+        draw = { meshDistribution(random), materialDistribution(random), { positionDistribution(random), positionDistribution(random), positionDistribution(random) } };
+
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 200.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 1.0f, 500.0f);
+    glm::mat4 viewProjection = projection * view;
+
+    RenderQueue queue(threadCount);
+    Vector<InstanceData> instances;
+    RenderQueue::Stats stats = {};
+    double emitMicroseconds = 0.0, sortMicroseconds = 0.0, translateMicroseconds = 0.0;
+    double minSortMicroseconds = 1e30, minTranslateMicroseconds = 1e30;
+    
+    for (uint32_t iteration = 0; iteration < iterationCount; iteration++) {
+        auto emitStart = std::chrono::steady_clock::now();
+        
+        queue.Reset();
+        for (uint32_t i = 0; i < packetCount; i++) {
+            const BenchDraw& draw = draws[i];
+            const BenchMesh& mesh = meshes[draw.mesh];
+            
+            DrawPacket packet;
+            packet.pipeline = pipeline;
+            packet.vertexBuffer = mesh.vertexBuffer;
+            packet.indexBuffer = mesh.indexBuffer;
+            packet.indexCount = BENCH_MESH_INDEX_COUNT;
+            packet.materialIndex = draw.material;
+            packet.transform = glm::translate(glm::mat4(1.0f), draw.position);
+
+            glm::vec4 clip = viewProjection * packet.transform[3];
+            float depth = clip.w > 0.0f ? clip.z / clip.w : 0.0f;
+            packet.key = SortKey::Make(0, 0, pipeline->GetSortId(), draw.material, draw.mesh, SortKey::QuantizeDepth(depth, 0.0f, 1.0f));
+
+            /* spread like draws emitted from threadCount threads */
+            queue.GetBucket(i % threadCount)->Submit(packet);
+        }
+        
+        emitMicroseconds += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - emitStart).count();
+
+        queue.Sort();
+        
+        /* recorded only, the bench measures the CPU side of Translate() */
+        commandList->Reset();
+        commandList->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        commandList->ImageBarrier(target->GetVkImage(),
+                                  0,
+                                  VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                  VK_IMAGE_LAYOUT_UNDEFINED,
+                                  VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                                  VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+        commandList->BeginRendering(targetView, BENCH_TARGET_SIZE, BENCH_TARGET_SIZE, {});
+        queue.Translate(commandList, viewProjection, iteration, instanceBuffer, &instances, &stats);
+        commandList->EndRendering();
+        commandList->End();
+
+        sortMicroseconds += stats.sortMicroseconds;
+        translateMicroseconds += stats.translateMicroseconds;
+        minSortMicroseconds = std::min(minSortMicroseconds, stats.sortMicroseconds);
+        minTranslateMicroseconds = std::min(minTranslateMicroseconds, stats.translateMicroseconds);
+    }
+
+    printf("packets=%u meshes=%u materials=%u threads=%u iterations=%u\n", packetCount, meshCount, materialCount, threadCount, iterationCount);
+    printf("emit       avg %10.1f us\n", emitMicroseconds / iterationCount);
+    printf("sort       avg %10.1f us  min %10.1f us\n", sortMicroseconds / iterationCount, minSortMicroseconds);
+    printf("translate  avg %10.1f us  min %10.1f us\n", translateMicroseconds / iterationCount, minTranslateMicroseconds);
+    printf("stats      packets=%u drawCalls=%u pipelineBinds=%u descriptorBinds=%u vertexBufferBinds=%u indexBufferBinds=%u\n",
+           stats.packets, stats.drawCalls, stats.pipelineBinds, stats.descriptorBinds, stats.vertexBufferBinds, stats.indexBufferBinds);
+
+    device.DestroyCommandLis(commandList);
+    device.ReleaseImageView(target, targetView);
+    device.DestroyImage(target);
+    device.DestroyBuffer(instanceBuffer);
+    
+    for (const BenchMesh& mesh : meshes) {
+        device.DestroyBuffer(mesh.vertexBuffer);
+        device.DestroyBuffer(mesh.indexBuffer);
+    }
+    
+    device.DestroyPipeline(pipeline);
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,218 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "Render/Scene.h"
+
+#include <MM.h>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_DEFAULT_ENTITIES 1000000
+#define BENCH_DEFAULT_ITERATIONS 20
+
+/* a fixed step keeps the integrated values, and so the checksum, the same from run to run */
+#define BENCH_TIME_STEP (1.0f / 60.0f)
+
+struct Position { float x, y, z; };
+struct Velocity { float x, y, z; };
+struct Rotation { float x, y, z, w; };
+
+/* the layout the queries are compared against, one heap object per entity in no particular order */
+struct HeapObject
+{
+    Position position;
+    Velocity velocity;
+    Rotation rotation;
+};
+
+struct BenchTiming
+{
+    double total = 0.0;
+    double min = 1e30;
+
+    void Add(double milliseconds)
+      {
+        total += milliseconds;
+        min = std::min(min, milliseconds);
+      }
+};
+
+static void _PrintUsage()
+{
+    fprintf(stderr, "usage: SceneBench [-entities <count>] [-iterations <count>] [-threads <count>]\n");
+}
+
+static double _ElapsedMilliseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static inline void _Integrate(Position& position, const Velocity& velocity)
+{
+    position.x += velocity.x * BENCH_TIME_STEP;
+    position.y += velocity.y * BENCH_TIME_STEP;
+    position.z += velocity.z * BENCH_TIME_STEP;
+}
+
+static double _Checksum(Scene* scene)
+{
+    double sum = 0.0;
+    scene->ForEach<Position>([&](const Position& position) { sum += position.x + position.y + position.z; });
+    return sum;
+}
+
+static void _PrintTiming(const char* name, const BenchTiming& timing, uint32_t iterationCount, uint32_t entityCount)
+{
+    printf("%-16s avg %8.2f ms  min %8.2f ms  %6.2f ns/entity\n", name, timing.total / iterationCount, timing.min, timing.min * 1e6 / entityCount);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t entityCount = BENCH_DEFAULT_ENTITIES;
+    uint32_t iterationCount = BENCH_DEFAULT_ITERATIONS;
+    uint32_t threadCount = 0;
+    
+    setvbuf(stdout, NULL, _IONBF, 0);
+    setvbuf(stderr, NULL, _IONBF, 0);
+
+    for (int i = 1; i < argc; i++) {
+        uint32_t* pValue = nullptr;
+        
+        if (strcmp(argv[i], "-entities") == 0) pValue = &entityCount;
+        else if (strcmp(argv[i], "-iterations") == 0) pValue = &iterationCount;
+        else if (strcmp(argv[i], "-threads") == 0) pValue = &threadCount;
+
+        if (pValue == nullptr || i + 1 >= argc) {
+            _PrintUsage();
+            return EXIT_FAILURE;
+        }
+
+        *pValue = (uint32_t) strtoul(argv[++i], NULL, 10);
+    }
+
+    if (entityCount == 0 || iterationCount == 0) {
+        _PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    /* threads counts the calling thread, 0 uses every hardware thread */
+    JobSystem jobSystem(threadCount == 0 ? 0 : threadCount - 1);
+    Scene scene;
+    
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < entityCount; i++) {
+        Position position = { distribution(random), distribution(random), distribution(random) };
+        Velocity velocity = { distribution(random), distribution(random), distribution(random) };
+        scene.Create(position, velocity, Rotation { 0.0f, 0.0f, 0.0f, 1.0f });
+    }
+    
+    printf("entities=%u archetypes=%u chunks=%u threads=%u iterations=%u\n",
+           scene.GetEntityCount(), scene.GetArchetypeCount(), scene.GetChunkCount(), jobSystem.GetThreadCount(), iterationCount);
+    printf("%-16s %8.2f ms\n", "create", _ElapsedMilliseconds(start));
+
+    /* the same values in heap objects visited in shuffled order, as pointer based objects end up */
+    Vector<HeapObject*> objects;
+    objects.reserve(entityCount);
+    scene.ForEach<Position, Velocity, Rotation>([&](const Position& position, const Velocity& velocity, const Rotation& rotation) {
+        objects.push_back(MemoryNew<HeapObject>(HeapObject { position, velocity, rotation }));
+    });
+    std::shuffle(std::begin(objects), std::end(objects), random);
+    
+    BenchTiming forEach, forEachChunk, forEachParallel, heapObjects;
+    
+    for (uint32_t iteration = 0; iteration < iterationCount; iteration++) {
+        start = std::chrono::steady_clock::now();
+        scene.ForEach<Position, Velocity, Rotation>([](Position& position, const Velocity& velocity, const Rotation&) {
+            _Integrate(position, velocity);
+        });
+        forEach.Add(_ElapsedMilliseconds(start));
+
+        start = std::chrono::steady_clock::now();
+        scene.ForEachChunk<Position, Velocity, Rotation>([](uint32_t count, Entity*, Position* positions, const Velocity* velocities, const Rotation*) {
+            for (uint32_t i = 0; i < count; i++)
+                _Integrate(positions[i], velocities[i]);
+        });
+        forEachChunk.Add(_ElapsedMilliseconds(start));
+
+        start = std::chrono::steady_clock::now();
+        scene.ForEachParallel<Position, Velocity, Rotation>(&jobSystem, [](Position& position, const Velocity& velocity, const Rotation&) {
+            _Integrate(position, velocity);
+        });
+        forEachParallel.Add(_ElapsedMilliseconds(start));
+
+        start = std::chrono::steady_clock::now();
+        for (HeapObject* object : objects)
+            _Integrate(object->position, object->velocity);
+        heapObjects.Add(_ElapsedMilliseconds(start));
+    }
+    
+    _PrintTiming("ForEach", forEach, iterationCount, entityCount);
+    _PrintTiming("ForEachChunk", forEachChunk, iterationCount, entityCount);
+    _PrintTiming("ForEachParallel", forEachParallel, iterationCount, entityCount);
+    _PrintTiming("heap objects", heapObjects, iterationCount, entityCount);
+
+    /* the scene took three steps per iteration, one per query, catch the heap copies up before comparing */
+    double heapSum = 0.0;
+    for (HeapObject* object : objects) {
+        for (uint32_t step = 0; step < 2 * iterationCount; step++)
+            _Integrate(object->position, object->velocity);
+        
+        heapSum += object->position.x + object->position.y + object->position.z;
+    }
+    
+    double sceneSum = _Checksum(&scene);
+    printf("%-16s scene %.3f, heap objects %.3f\n", "checksum", sceneSum, heapSum);
+    
+    /* deferred structural changes: every 10th entity dies, every 8th loses its rotation, one in 100 spawns another */
+    SceneCommandBuffer commandBuffer;
+    start = std::chrono::steady_clock::now();
+    scene.ForEachParallel<Position, Velocity>(&jobSystem, [&](Entity entity, const Position& position, const Velocity& velocity) {
+        if (entity.index % 10 == 0)
+            commandBuffer.Destroy(entity);
+        else if (entity.index % 8 == 0)
+            commandBuffer.Remove<Rotation>(entity);
+        
+        if (entity.index % 100 == 1)
+            commandBuffer.Create(position, velocity);
+    });
+    double recordMilliseconds = _ElapsedMilliseconds(start);
+
+    start = std::chrono::steady_clock::now();
+    commandBuffer.Playback(&scene);
+    double playbackMilliseconds = _ElapsedMilliseconds(start);
+    
+    printf("%-16s record %.2f ms, playback %.2f ms, entities=%u archetypes=%u\n",
+           "commands", recordMilliseconds, playbackMilliseconds, scene.GetEntityCount(), scene.GetArchetypeCount());
+
+    for (HeapObject* object : objects)
+        MemoryDelete(object);
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
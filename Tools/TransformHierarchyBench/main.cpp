@@ -0,0 +1,239 @@
+/* -------------------------------------------------------------------------------- *\
+|*                                                                                  *|
+|*    Copyright (C) 2019-2024 RedGogh All rights reserved.                          *|
+|*                                                                                  *|
+|*    Licensed under the Apache License, Version 2.0 (the "License");               *|
+|*    you may not use this file except in compliance with the License.              *|
+|*    You may obtain a copy of the License at                                       *|
+|*                                                                                  *|
+|*        http://www.apache.org/licenses/LICENSE-2.0                                *|
+|*                                                                                  *|
+|*    Unless required by applicable law or agreed to in writing, software           *|
+|*    distributed under the License is distributed on an "AS IS" BASIS,             *|
+|*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.      *|
+|*    See the License for the specific language governing permissions and           *|
+|*    limitations under the License.                                                *|
+|*                                                                                  *|
+\* -------------------------------------------------------------------------------- */
+
+
+/* Create by Red Gogh on 2026/10/18 */
+
+#include "Render/TransformHierarchy.h"
+
+#include <MM.h>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// glm
+#include <glm/gtc/matrix_transform.hpp>
+
+#define BENCH_DEFAULT_NODES 1000000
+#define BENCH_DEFAULT_ROOTS 1000
+#define BENCH_DEFAULT_LEVELS 10
+#define BENCH_DEFAULT_FRAMES 30
+/* dirty nodes per frame, in hundredths of a percent of all nodes */
+#define BENCH_DEFAULT_DIRTY_BASIS_POINTS 100
+
+/* world matrices checked against the glm reference after the frames, and the allowed error */
+#define BENCH_VERIFY_NODES 10000
+#define BENCH_VERIFY_EPSILON 1e-3f
+
+struct BenchTiming
+{
+    double total = 0.0;
+    double min = 1e30;
+    double max = 0.0;
+
+    void Add(double milliseconds)
+      {
+        total += milliseconds;
+        min = std::min(min, milliseconds);
+        max = std::max(max, milliseconds);
+      }
+};
+
+static void _PrintUsage()
+{
+    fprintf(stderr, "usage: TransformHierarchyBench [-nodes <count>] [-roots <count>] [-levels <count>] [-frames <count>] [-dirty <basis points>] [-threads <count>]\n");
+}
+
+static double _ElapsedMilliseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void _PrintTiming(const char* name, const BenchTiming& timing, uint32_t frameCount)
+{
+    printf("%-16s avg %8.2f ms  min %8.2f ms  max %8.2f ms\n", name, timing.total / frameCount, timing.min, timing.max);
+}
+
+/* parent * T * R * S composed with glm from the root down, the reference for one node */
+static glm::mat4 _ReferenceWorld(const TransformHierarchy& hierarchy, TransformNode node)
+{
+    glm::mat4 local = glm::translate(glm::mat4(1.0f), hierarchy.GetPosition(node)) *
+                      glm::mat4_cast(hierarchy.GetRotation(node)) *
+                      glm::scale(glm::mat4(1.0f), hierarchy.GetScale(node));
+
+    TransformNode parent = hierarchy.GetParent(node);
+    return parent == TRANSFORM_NULL_NODE ? local : _ReferenceWorld(hierarchy, parent) * local;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t nodeCount = BENCH_DEFAULT_NODES;
+    uint32_t rootCount = BENCH_DEFAULT_ROOTS;
+    uint32_t levelCount = BENCH_DEFAULT_LEVELS;
+    uint32_t frameCount = BENCH_DEFAULT_FRAMES;
+    uint32_t dirtyBasisPoints = BENCH_DEFAULT_DIRTY_BASIS_POINTS;
+    uint32_t threadCount = 0;
+    
+    setvbuf(stdout, NULL, _IONBF, 0);
+    setvbuf(stderr, NULL, _IONBF, 0);
+
+    for (int i = 1; i < argc; i++) {
+        uint32_t* pValue = nullptr;
+        
+        if (strcmp(argv[i], "-nodes") == 0) pValue = &nodeCount;
+        else if (strcmp(argv[i], "-roots") == 0) pValue = &rootCount;
+        else if (strcmp(argv[i], "-levels") == 0) pValue = &levelCount;
+        else if (strcmp(argv[i], "-frames") == 0) pValue = &frameCount;
+        else if (strcmp(argv[i], "-dirty") == 0) pValue = &dirtyBasisPoints;
+        else if (strcmp(argv[i], "-threads") == 0) pValue = &threadCount;
+
+        if (pValue == nullptr || i + 1 >= argc) {
+            _PrintUsage();
+            return EXIT_FAILURE;
+        }
+
+        *pValue = (uint32_t) strtoul(argv[++i], NULL, 10);
+    }
+
+    if (rootCount == 0 || levelCount == 0 || nodeCount < rootCount || frameCount == 0 || dirtyBasisPoints > 10000) {
+        _PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    /* threads counts the calling thread, 0 uses every hardware thread and 1 updates inline */
+    JobSystem* jobSystem = threadCount == 1 ? nullptr : MemoryNew<JobSystem>(threadCount == 0 ? 0 : threadCount - 1);
+    TransformHierarchy hierarchy(jobSystem);
+    
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    
+    auto randomRotation = [&]() {
+        return glm::angleAxis(distribution(random) * glm::pi<float>(), glm::normalize(glm::vec3(distribution(random), distribution(random), distribution(random)) + glm::vec3(0.0f, 2.0f, 0.0f)));
+    };
+    
+    /* roots first, the rest spread evenly over the lower levels with a random parent one level up */
+    Vector<TransformNode> nodes;
+    Vector<uint32_t> parentIndices;
+    nodes.reserve(nodeCount);
+    parentIndices.reserve(nodeCount);
+    
+    uint32_t levelBegin = 0, levelEnd = 0;
+    for (uint32_t level = 0; level < levelCount; level++) {
+        uint32_t levelSize = level == 0 ? rootCount : (nodeCount - rootCount) / (levelCount - 1) + (level <= (nodeCount - rootCount) % (levelCount - 1) ? 1 : 0);
+        std::uniform_int_distribution<uint32_t> parentDistribution(levelBegin, levelEnd == 0 ? 0 : levelEnd - 1);
+        
+        for (uint32_t i = 0; i < levelSize; i++) {
+            uint32_t parentIndex = level == 0 ? UINT32_MAX : parentDistribution(random);
+            TransformNode node = hierarchy.Create(level == 0 ? TRANSFORM_NULL_NODE : nodes[parentIndex]);
+            hierarchy.SetLocal(node, glm::vec3(distribution(random), distribution(random), distribution(random)), randomRotation(), glm::vec3(1.0f + 0.1f * distribution(random)));
+            nodes.push_back(node);
+            parentIndices.push_back(parentIndex);
+        }
+
+        levelBegin = levelEnd;
+        levelEnd = (uint32_t) std::size(nodes);
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    hierarchy.Update();
+    double firstMilliseconds = _ElapsedMilliseconds(start);
+    
+    printf("nodes=%u roots=%u levels=%u threads=%u frames=%u\n",
+           hierarchy.GetNodeCount(), rootCount, hierarchy.GetStats().levels, jobSystem ? jobSystem->GetThreadCount() : 1, frameCount);
+    printf("%-16s %8.2f ms, sort and full recompute\n", "first update", firstMilliseconds);
+    
+    uint32_t dirtyCount = (uint32_t) ((uint64_t) nodeCount * dirtyBasisPoints / 10000);
+    std::uniform_int_distribution<uint32_t> nodeDistribution(0, nodeCount - 1);
+    BenchTiming dirtyUpdate, fullUpdate, cleanUpdate, glmChain;
+    uint64_t updatedNodes = 0;
+    
+    /* the prototype's translate / rotate x3 / scale chain per node, over every node in creation order */
+    Vector<glm::vec3> eulerAngles(nodeCount);
+    Vector<glm::mat4> chainWorlds(nodeCount);
+    for (uint32_t i = 0; i < nodeCount; i++)
+        eulerAngles[i] = glm::eulerAngles(hierarchy.GetRotation(nodes[i]));
+    
+    for (uint32_t frame = 0; frame < frameCount; frame++) {
+        for (uint32_t i = 0; i < dirtyCount; i++)
+            hierarchy.SetRotation(nodes[nodeDistribution(random)], randomRotation());
+        
+        start = std::chrono::steady_clock::now();
+        hierarchy.Update();
+        dirtyUpdate.Add(_ElapsedMilliseconds(start));
+        updatedNodes += hierarchy.GetStats().updatedNodes;
+
+        start = std::chrono::steady_clock::now();
+        hierarchy.Update();
+        cleanUpdate.Add(_ElapsedMilliseconds(start));
+        
+        /* touching every root makes the next update recompute the whole hierarchy */
+        for (uint32_t i = 0; i < rootCount; i++)
+            hierarchy.SetPosition(nodes[i], hierarchy.GetPosition(nodes[i]));
+        
+        start = std::chrono::steady_clock::now();
+        hierarchy.Update();
+        fullUpdate.Add(_ElapsedMilliseconds(start));
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < nodeCount; i++) {
+            const glm::vec3& angles = eulerAngles[i];
+            glm::mat4 local = glm::translate(glm::mat4(1.0f), hierarchy.GetPosition(nodes[i]));
+            local = glm::rotate(local, angles.x, glm::vec3(1.0f, 0.0f, 0.0f));
+            local = glm::rotate(local, angles.y, glm::vec3(0.0f, 1.0f, 0.0f));
+            local = glm::rotate(local, angles.z, glm::vec3(0.0f, 0.0f, 1.0f));
+            local = glm::scale(local, hierarchy.GetScale(nodes[i]));
+            chainWorlds[i] = parentIndices[i] == UINT32_MAX ? local : chainWorlds[parentIndices[i]] * local;
+        }
+        glmChain.Add(_ElapsedMilliseconds(start));
+    }
+    
+    printf("%-16s %u per frame, %.0f recomputed per frame on average\n", "dirty nodes", dirtyCount, (double) updatedNodes / frameCount);
+    _PrintTiming("dirty update", dirtyUpdate, frameCount);
+    _PrintTiming("clean update", cleanUpdate, frameCount);
+    _PrintTiming("full update", fullUpdate, frameCount);
+    _PrintTiming("glm chain", glmChain, frameCount);
+
+    /* a fixed sample of nodes against parent * T * R * S composed with glm */
+    uint32_t mismatches = 0;
+    float maxError = 0.0f;
+    std::uniform_int_distribution<uint32_t> verifyDistribution(0, nodeCount - 1);
+    for (uint32_t i = 0; i < std::min<uint32_t>(BENCH_VERIFY_NODES, nodeCount); i++) {
+        TransformNode node = nodes[verifyDistribution(random)];
+        glm::mat4 reference = _ReferenceWorld(hierarchy, node);
+        const glm::mat4& world = hierarchy.GetWorld(node);
+        
+        float error = 0.0f;
+        for (uint32_t column = 0; column < 4; column++)
+            for (uint32_t row = 0; row < 4; row++)
+                error = std::max(error, fabsf(world[column][row] - reference[column][row]));
+
+        maxError = std::max(maxError, error);
+        mismatches += error > BENCH_VERIFY_EPSILON ? 1 : 0;
+    }
+    
+    printf("%-16s %u of %u nodes off the glm reference, max error %g\n", "verify", mismatches, std::min<uint32_t>(BENCH_VERIFY_NODES, nodeCount), maxError);
+    
+    MemoryDelete(jobSystem);
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file